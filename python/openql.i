@@ -15,12 +15,16 @@
 %include "std_complex.i"
 
 
+class Program;
+
 namespace std {
    %template(vectori) vector<int>;
    %template(vectorui) vector<size_t>;
    %template(vectorf) vector<float>;
    %template(vectord) vector<double>;
    %template(vectorc) vector<std::complex<double>>;
+   %template(vectors) vector<std::string>;
+   %template(vectorp) vector<Program*>;
 };
 
 %{
@@ -267,6 +271,50 @@ None
 """
 
 
+%feature("docstring") Unitary::clear_decomposition_cache
+""" Empties the cache of unitary decompositions (option
+unitary_decomposition_cache) and resets its hit and miss counters
+
+Parameters
+----------
+None
+
+Returns
+-------
+None
+"""
+
+
+%feature("docstring") Unitary::get_decomposition_cache_hits
+""" Returns the number of decompositions taken from the cache since it was
+last cleared
+
+Parameters
+----------
+None
+
+Returns
+-------
+int
+    number of cache hits
+"""
+
+
+%feature("docstring") Unitary::get_decomposition_cache_misses
+""" Returns the number of decompositions that were not found in the cache
+since it was last cleared
+
+Parameters
+----------
+None
+
+Returns
+-------
+int
+    number of cache misses
+"""
+
+
 
 
 
@@ -537,6 +585,21 @@ Returns
 """
 
 
+%feature("docstring") Kernel::get_gate_count
+""" Returns the number of gates in the kernel.
+
+Parameters
+----------
+None
+
+Returns
+-------
+int
+    number of gates in the kernel; zero after the kernel was moved into a
+    program with take set
+"""
+
+
 %feature("docstring") Kernel::gate
 """ adds custom/default gates to kernel.
 
@@ -715,6 +778,10 @@ Parameters
 ----------
 arg1 : kernel
     kernel to be added
+arg2: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 
@@ -727,6 +794,10 @@ arg1 : kernel
     kernel to be executed
 arg2: Operation
     classical relational operation (<, >, <=, >=, ==, !=)
+arg3: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 %feature("docstring") Program::add_if
@@ -738,6 +809,10 @@ arg1 : Program
     program to be executed
 arg2: Operation
     classical relational operation (<, >, <=, >=, ==, !=)
+arg3: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 %feature("docstring") Program::add_if_else
@@ -751,6 +826,10 @@ arg2 : kernel
     kernel to be executed when specified condition is false (else part).
 arg3: Operation
     classical relational operation (<, >, <=, >=, ==, !=)
+arg4: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 %feature("docstring") Program::add_if_else
@@ -764,6 +843,10 @@ arg2 : Program
     program to be executed when specified condition is false (else part).
 arg3: Operation
     classical relational operation (<, >, <=, >=, ==, !=)
+arg4: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 
@@ -776,6 +859,10 @@ arg1 : kernel
     kernel to be executed
 arg2: Operation
     classical relational operation (<, >, <=, >=, ==, !=)
+arg3: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 %feature("docstring") Program::add_do_while
@@ -787,6 +874,10 @@ arg1 : Program
     program to be executed repeatedly
 arg2: Operation
     classical relational operation (<, >, <=, >=, ==, !=)
+arg3: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 
@@ -799,6 +890,10 @@ arg1 : Kernel
     program to be executed repeatedly
 arg2: int
     iteration count
+arg3: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 %feature("docstring") Program::add_for
@@ -810,6 +905,10 @@ arg1 : Program
     sub-program to be executed repeatedly
 arg2: int
     iteration count
+arg3: bool, optional
+    when True, the contents of the kernels are moved into this program instead
+    of copied, which is faster for large kernels but leaves the given
+    kernels/programs empty
 """
 
 
@@ -822,6 +921,29 @@ None
 """
 
 
+%feature("docstring") Program::save_snapshot
+""" Saves the kernels of the program in their current state, e.g. after
+compilation, to a binary snapshot file.
+
+Parameters
+----------
+arg1 : str
+    name of the snapshot file
+"""
+
+
+%feature("docstring") Program::load_snapshot
+""" Replaces the kernels of the program by those stored in a binary snapshot
+file. Custom gates are taken from the platform of this program, which may
+differ from the platform used when saving the snapshot.
+
+Parameters
+----------
+arg1 : str
+    name of the snapshot file
+"""
+
+
 %feature("docstring") Program::qasm
 """ Generates and returns program QASM
 
@@ -938,5 +1060,43 @@ arg3 : str
     value of the option. 
 """
 
+%feature("docstring") Compiler::get_pass_profile
+""" Returns the pass profile of the last compilation
+
+Parameters
+----------
+None
+
+Returns
+-------
+str
+    JSON object with, per pass, the wall time and CPU time in seconds, the
+    peak RSS increase in bytes, and the number of gates per kernel before and
+    after the pass. Use json.loads() to parse it.
+"""
+
+%feature("docstring") compile_many
+""" Compiles several programs with the default pass pipeline, as
+Program.compile() does for each of them. Each thread sets up the pipeline for
+a backend once and reuses it for the programs it compiles, so setup costs
+such as the mapper's distance matrix are only paid once per thread. When
+compiling in parallel, the programs should have different names, so their
+output files don't collide, and the memory figures of the pass profiles
+cover the whole process.
+
+Parameters
+----------
+arg1 : list of Program
+    programs to be compiled.
+arg2 : int
+    number of threads to compile on, 0 for the number of hardware threads
+    (default: 1).
+
+Returns
+-------
+list of str
+    pass profile of each program, as returned by Compiler.get_pass_profile().
+"""
+
 // Include the header file with above prototypes
 %include "openql_i.h"
@@ -173,6 +173,11 @@ class build_ext(_build_ext):
             if 'OPENQL_ENABLE_INITIAL_PLACEMENT' in os.environ:
                 cmd = cmd['-DWITH_INITIAL_PLACEMENT=ON']
 
+            # The highest log level compiled in can be lowered using an
+            # environment variable, e.g. OPENQL_MAX_LOG_LEVEL=LOG_WARNING.
+            if 'OPENQL_MAX_LOG_LEVEL' in os.environ:
+                cmd = cmd['-DOPENQL_MAX_LOG_LEVEL=' + os.environ['OPENQL_MAX_LOG_LEVEL']]
+
             # C++ tests can be enabled using an environment variable. They'll
             # be run before the install.
             if 'OPENQL_BUILD_TESTS' in os.environ:
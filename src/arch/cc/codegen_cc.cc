@@ -332,6 +332,14 @@ void codegen_cc::bundleFinish(size_t startCycle, size_t durationInCycles, bool i
                                         << ", maxDurationInCycles=" << maxDurationInCycles
                     ));
 
+            // within a loop body, the first use of an instrument starts at the loop start, padding up to that
+            // point is emitted before the loop by repeatFinish()
+            if(inRepeat && !repeatInstrUsed[instrIdx]) {
+                repeatInstrUsed[instrIdx] = true;
+                repeatEntryCycle[instrIdx] = lastEndCycle[instrIdx];
+                lastEndCycle[instrIdx] = repeatStartCycle;
+            }
+
             padToCycle(lastEndCycle[instrIdx], startCycle, ic.ii.slot, ic.ii.instrumentName);
 
             // emit code for slot
@@ -586,6 +594,75 @@ void codegen_cc::doWhileEnd(const std::string &label, size_t op0, const std::str
     emit("", "jmp", QL_SS2S("@" << label), "# FIXME: we don't support conditions, just an endless loop'");        // FIXME: just endless loop
 }
 
+/************************************************************************\
+| Loop compaction
+\************************************************************************/
+
+/*
+    A run of identical windows of bundles (see ir::find_repeats(), which must be
+    called with 'contained' set) is generated as a single window inside a loop.
+    Code for the window is collected separately between repeatStart() and
+    repeatFinish(), because padding of the instruments used in the loop must
+    be emitted before the loop starts, and we only know which instruments are
+    used once the body has been generated.
+
+    Instruments not used in the body are left alone, they will be padded
+    lazily as usual. Note that the VCD output only shows the first iteration.
+*/
+void codegen_cc::repeatStart(const std::string &label, size_t startCycle, size_t periodInCycles, size_t iterations)
+{
+    if(inRepeat) {
+        QL_FATAL("Inconsistency detected: nested loop compaction not supported");
+    }
+    inRepeat = true;
+    repeatLabel = label;
+    repeatStartCycle = startCycle;
+    repeatPeriodInCycles = periodInCycles;
+    repeatIterations = iterations;
+    repeatInstrUsed.assign(settings.getInstrumentsSize(), false);
+
+    // collect loop body separately
+    repeatSavedCode = codeSection.str();
+    codeSection.str("");
+}
+
+void codegen_cc::repeatFinish()
+{
+    size_t endCycle = repeatStartCycle + repeatPeriodInCycles;
+
+    // pad the instruments used to the end of the period, so every iteration takes the same time
+    for(size_t instrIdx=0; instrIdx<repeatInstrUsed.size(); instrIdx++) {
+        if(repeatInstrUsed[instrIdx]) {
+            const settings_cc::tInstrumentControl ic = settings.getInstrumentControl(instrIdx);
+            padToCycle(lastEndCycle[instrIdx], endCycle, ic.ii.slot, ic.ii.instrumentName);
+        }
+    }
+    std::string body = codeSection.str();
+
+    // restore code before loop, and pad the instruments used up to the loop start
+    codeSection.str("");
+    codeSection << repeatSavedCode;
+    repeatSavedCode.clear();
+    comment(QL_SS2S("# REPEAT_START(" << repeatIterations << "): cycle " << repeatStartCycle << "-" << endCycle << " per iteration"));
+    for(size_t instrIdx=0; instrIdx<repeatInstrUsed.size(); instrIdx++) {
+        if(repeatInstrUsed[instrIdx]) {
+            const settings_cc::tInstrumentControl ic = settings.getInstrumentControl(instrIdx);
+            padToCycle(repeatEntryCycle[instrIdx], repeatStartCycle, ic.ii.slot, ic.ii.instrumentName);
+            lastEndCycle[instrIdx] = repeatStartCycle + repeatIterations*repeatPeriodInCycles;
+        }
+    }
+
+    // emit the loop
+    emit("", "move", QL_SS2S(repeatIterations << ",R61"), "# R61 is the 'repeat loop counter'");   // NB: R62 is used by forStart()
+    emit((repeatLabel+":").c_str(), "", QL_SS2S(""), "# ");        // just a label
+    codeSection << body;
+    emit("", "loop", QL_SS2S("R61,@" << repeatLabel), "# R61 is the 'repeat loop counter'");
+    comment("# REPEAT_END");
+    comment("");
+
+    inRepeat = false;
+}
+
 /************************************************************************\
 |
 | private functions
@@ -70,6 +70,10 @@ public:
     void doWhileStart(const std::string &label);
     void doWhileEnd(const std::string &label, size_t op0, const std::string &opName, size_t op1);
 
+    // Loop compaction: bundles generated between repeatStart() and repeatFinish() form the body of a loop
+    void repeatStart(const std::string &label, size_t startCycle, size_t periodInCycles, size_t iterations);
+    void repeatFinish();
+
 private:    // vars
     static const int MAX_SLOTS = 12;                            // physical maximum of CC
     static const int MAX_INSTRS = MAX_SLOTS;                    // maximum number of instruments in config file
@@ -91,6 +95,16 @@ private:    // vars
     unsigned int lastEndCycle[MAX_INSTRS];                      // vector[instrIdx], maintain where we got per slot, kernel scope
     std::vector<std::vector<tBundleInfo>> bundleInfo;           // matrix[instrIdx][group], bundle scope
     utils::Json codewordTable;                                  // codewords versus signals per instrument group
+
+    // loop compaction state, see repeatStart()
+    bool inRepeat = false;
+    std::string repeatLabel;
+    size_t repeatStartCycle;
+    size_t repeatPeriodInCycles;
+    size_t repeatIterations;
+    std::string repeatSavedCode;                                // code generated before the loop body
+    std::vector<bool> repeatInstrUsed;                          // vector[instrIdx], whether instrument is used in loop body
+    unsigned int repeatEntryCycle[MAX_INSTRS];                  // vector[instrIdx], lastEndCycle on entry of loop
 #if OPT_FEEDBACK
     Json inputLutTable;                                         // input LUT usage per instrument group
 #endif
@@ -33,6 +33,9 @@
 
 #include <scheduler.h>
 
+// maximum number of bundles in a window that is folded into a loop by option 'backend_cc_loop_compaction'
+static const size_t MAX_REPEAT_WINDOW = 32;
+
 // define classical QASM instructions as generated by classical.h
 // FIXME: should be moved to a more sensible location
 #define QASM_CLASSICAL_INSTRUCTION_LIST   \
@@ -264,7 +267,39 @@ void eqasm_backend_cc::codegenBundles(ir::bundles_t &bundles, const quantum_plat
 {
     QL_IOUT("Generating .vq1asm for bundles");
 
+    // find runs of repeated windows of bundles, which are generated as loops
+    ir::repeats_t repeats;
+    if(options::get("backend_cc_loop_compaction") == "yes") {
+        repeats = ir::find_repeats(bundles, MAX_REPEAT_WINDOW, true);
+    }
+    auto repeatIt = repeats.begin();
+    size_t nrBundles = bundles.size();
+    size_t thisBundle = 0;
+    size_t bodyEnd = 0;                     // index of first bundle after loop body
+    size_t skipUntil = 0;                   // bundles from bodyEnd up to this index are covered by the loop
+
     for(ir::bundle_t &bundle : bundles) {
+        size_t bundleNr = thisBundle++;
+        if(bundleNr >= bodyEnd && bundleNr < skipUntil) {
+            bundleIdx++;                    // keep numbering consistent with uncompacted code
+            continue;
+        }
+
+        if(repeatIt != repeats.end() && repeatIt->first_bundle == bundleNr) {
+            size_t iterations = repeatIt->repetitions;
+            // keep the last bundle out of the loop, it pads the end of the kernel
+            if(bundleNr + iterations*repeatIt->bundles_per_window == nrBundles) {
+                iterations--;
+            }
+            if(iterations >= 2) {
+                QL_DOUT("Repeating bundles " << bundleNr << "-" << bundleNr+repeatIt->bundles_per_window-1 << " " << iterations << " times");
+                codegen.repeatStart(QL_SS2S("__repeat_" << bundleIdx), repeatIt->start_cycle, repeatIt->period_in_cycles, iterations);
+                bodyEnd = bundleNr + repeatIt->bundles_per_window;
+                skipUntil = bundleNr + iterations*repeatIt->bundles_per_window;
+            }
+            ++repeatIt;
+        }
+
         // generate bundle header
         QL_DOUT(QL_SS2S("Bundle " << bundleIdx << ": start_cycle=" << bundle.start_cycle << ", duration_in_cycles=" << bundle.duration_in_cycles));
         codegen.bundleStart(QL_SS2S("## Bundle " << bundleIdx++
@@ -329,6 +364,10 @@ void eqasm_backend_cc::codegenBundles(ir::bundles_t &bundles, const quantum_plat
         // generate bundle trailer, and code for classical gates
         bool isLastBundle = &bundle==&bundles.back();
         codegen.bundleFinish(bundle.start_cycle, bundle.duration_in_cycles, isLastBundle);
+
+        if(bundleNr+1 == bodyEnd) {
+            codegen.repeatFinish();
+        }
     }   // for(bundles)
 
     QL_IOUT("Generating .vq1asm for bundles [Done]");
@@ -6,6 +6,7 @@
 
 #include "scheduler.h"
 #include "mapper.h"
+#include "kernel_dedup.h"
 #include "clifford.h"
 #include "latency_compensation.h"
 #include "buffer_insertion.h"
@@ -327,10 +328,21 @@ Str get_cc_light_instruction_name(
     return cc_light_instr_name;
 }
 
+Str qisa_statistics_report(const qisa_statistics_t &stats, const Str &comment_prefix) {
+    StrStrm ss;
+    ss << comment_prefix << "Loops introduced by QISA compression: " << stats.loops << "\n";
+    ss << comment_prefix << "Bundles emitted: " << stats.emitted_bundles << " of " << stats.bundles << "\n";
+    ss << comment_prefix << "QISA compression ratio: "
+       << (stats.emitted_bundles ? (Real)stats.bundles / (Real)stats.emitted_bundles : 1.0) << "\n";
+    return ss.str();
+}
+
 Str ir2qisa(
     quantum_kernel &kernel,
     const quantum_platform &platform,
-    MaskManager &gMaskManager
+    MaskManager &gMaskManager,
+    Bool compress_loops,
+    qisa_statistics_t *stats
 ) {
     QL_IOUT("Generating CC-Light QISA");
 
@@ -414,6 +426,16 @@ Str ir2qisa(
         );
     }
 
+    // find runs of repeated windows of bundles to fold into loops; windows
+    // are compared after combining sections, so equal windows also use the
+    // same mask registers (the MaskManager maps a qubit set to a single
+    // register, and all masks are set once at program start)
+    ir::repeats_t repeats;
+    if (compress_loops) {
+        repeats = ir::find_repeats(bundles2, MAX_LOOP_WINDOW, false);
+    }
+    auto repeat_it = repeats.begin();
+
     // And now generate qisa
     // each section of a bundle will become a SIMD (all operations in a section are the same, see above)
     // for the operands of the SIMD, a mask will be used
@@ -421,7 +443,7 @@ Str ir2qisa(
     // kernel prologue (start label) and epilogue are generated by the caller or ir2qisa
     StrStrm ssqisa;   // output qisa in here
     UInt curr_cycle = 0; // first instruction should be with pre-interval 1, 'bs 1' FIXME HvS start in cycle 0
-    for (ir::bundle_t &abundle : bundles2) {
+    auto emit_bundle = [&](const ir::bundle_t &abundle) {
         Str iname;
         StrStrm sspre, ssinst;
         auto bcycle = abundle.start_cycle;
@@ -504,6 +526,74 @@ Str ir2qisa(
             ssqisa << sspre.str() << ssinst.str() << std::endl;
         }
         curr_cycle+=delta;
+    };
+
+    UInt nbundles = bundles2.size();
+    UInt bundle_nr = 0;
+    UInt loop_nr = 0;
+    auto it = bundles2.begin();
+    while (it != bundles2.end()) {
+        if (repeat_it != repeats.end() && repeat_it->first_bundle == bundle_nr) {
+            const ir::repeat_t &rep = *repeat_it++;
+            UInt window = rep.bundles_per_window;
+            UInt iterations = rep.repetitions;
+
+            // keep the last bundle out of the loop, it is followed by the wait for its duration
+            if (bundle_nr + window * iterations == nbundles) {
+                iterations--;
+            }
+            if (iterations >= 2) {
+                QL_DOUT("Folding bundles " << bundle_nr << " to " << bundle_nr + window - 1
+                    << " into a loop of " << iterations << " iterations");
+
+                // the loop is emitted as a for loop kernel would be, using its prologue and
+                // epilogue; the epilogue branches to the first '_'-separated token of the
+                // FOR_END kernel name, so the label can't contain underscores
+                Str label = kernel.name;
+                label.erase(std::remove(label.begin(), label.end(), '_'), label.end());
+                label += "loop" + to_string(loop_nr++);
+                quantum_kernel kstart(label + "_start", platform, kernel.qubit_count, kernel.creg_count, kernel.breg_count);
+                kstart.set_kernel_type(kernel_type_t::FOR_START);
+                kstart.iterations = iterations;
+                quantum_kernel kend(label + "_end", platform, kernel.qubit_count, kernel.creg_count, kernel.breg_count);
+                kend.set_kernel_type(kernel_type_t::FOR_END);
+
+                // every iteration starts with a bundle at pre-interval 1, so wait up to the cycle before the
+                // window on entry, and at the end of the body up to the cycle before the next iteration
+                UInt entry_cycle = rep.start_cycle - 1;
+                if (entry_cycle > curr_cycle) {
+                    ssqisa << "    qwait " << entry_cycle - curr_cycle << std::endl;
+                }
+                ssqisa << cc_light_eqasm_compiler::get_qisa_prologue(kstart);
+                ssqisa << label << ":" << std::endl;
+                curr_cycle = entry_cycle;
+                for (UInt i = 0; i < window; i++) {
+                    emit_bundle(*it++);
+                }
+                UInt next_cycle = entry_cycle + rep.period_in_cycles;
+                if (next_cycle > curr_cycle) {
+                    ssqisa << "    qwait " << next_cycle - curr_cycle << std::endl;
+                }
+                ssqisa << cc_light_eqasm_compiler::get_qisa_epilogue(kend);
+
+                // skip the other iterations
+                curr_cycle = entry_cycle + iterations * rep.period_in_cycles;
+                std::advance(it, window * (iterations - 1));
+                bundle_nr += window * iterations;
+                if (stats) {
+                    stats->loops++;
+                    stats->emitted_bundles += window;
+                    stats->bundles += window * iterations;
+                }
+                continue;
+            }
+        }
+        emit_bundle(*it++);
+        bundle_nr++;
+        if (stats) {
+            stats->emitted_bundles++;
+            stats->bundles++;
+        }
     }
 
     auto & lastBundle = bundles2.back();
@@ -736,11 +826,264 @@ void cc_light_eqasm_compiler::ccl_decompose_post_schedule_bundles(
     QL_IOUT("Post scheduling decomposition [Done]");
 }
 
+/*
+ * Fused post-scheduling stage: latency compensation, buffer delay insertion
+ * and ccl_decompose_post_schedule in a single cycle-ordered sweep over each
+ * kernel, with the result being identical to running these passes in sequence
+ * (including the removal of wait and dummy gates by ir::bundler).
+ *
+ * The passes each look up the latency and type of every gate in the JSON
+ * instruction settings, and bundle and unbundle the circuit. Here, the
+ * attributes of each instruction are looked up once per program, and
+ * bundles are just the runs of gates with equal cycle values in the sorted
+ * circuit. The buffer delay between two bundles only depends on the sets of
+ * buffer types in them, so these are kept as bit sets and combined using a
+ * dense table instead of looking up all pairs of gates.
+ */
+namespace {
+
+// buffer types for which <type1>_<type2>_buffer settings are recognized; instructions without type get "none"
+const Vec<Str> post_schedule_buffer_types = {"none", "mw", "flux", "readout"};
+
+// buffer type index of instructions with any other type; no buffer delays apply to these
+const UInt OTHER_BUFFER_TYPE = 4;
+const UInt NUM_BUFFER_TYPES = 5;
+
+// attributes of an instruction as used by the post-scheduling stage
+struct post_schedule_instr_t {
+    Bool has_latency;           // there is a latency setting, compensated for by latency_cycles
+    Int latency_cycles;
+    UInt buffer_type;           // index in post_schedule_buffer_types or OTHER_BUFFER_TYPE
+    Bool is_flux;               // type is flux
+    Bool is_custom;             // there is a custom gate definition in the platform
+};
+
+class post_scheduler {
+private:
+    const quantum_platform &platform;
+    Map<Str, post_schedule_instr_t> instrs;                 // cache of instruction attributes by gate name
+    UInt buffer_cycles[NUM_BUFFER_TYPES][NUM_BUFFER_TYPES]; // buffer delay between two types of instructions
+
+    // cz_mode auto decomposition, see ccl_decompose_post_schedule_bundles()
+    Bool decompose_cz;
+    Bool edges_loaded = false;
+    Map<Pair<UInt,UInt>, UInt> qubitpair2edge;              // map: pair of qubits to edge (from grid configuration)
+    Map<UInt, Vec<UInt>> edge_detunes_qubits;               // map: edge to vector of qubits that edge detunes
+
+    const post_schedule_instr_t &lookup(const Str &id) {
+        auto it = instrs.find(id);
+        if (it != instrs.end()) {
+            return it->second;
+        }
+        post_schedule_instr_t instr{false, 0, 0, false, false};
+        Str op_type("none");
+        if (platform.instruction_settings.count(id) > 0) {
+            const auto &settings = platform.instruction_settings[id];
+            if (settings.count("latency") > 0) {
+                Real latency_ns = settings["latency"];
+                instr.has_latency = true;
+                instr.latency_cycles = Int(round_away_from_zero(latency_ns / platform.cycle_time));
+            }
+            if (settings.count("type") > 0) {
+                op_type = settings["type"].get<Str>();
+            }
+        }
+        instr.buffer_type = OTHER_BUFFER_TYPE;
+        for (UInt t = 0; t < post_schedule_buffer_types.size(); t++) {
+            if (op_type == post_schedule_buffer_types[t]) {
+                instr.buffer_type = t;
+            }
+        }
+        instr.is_flux = op_type == "flux";
+        instr.is_custom = platform.instruction_map.find(id) != platform.instruction_map.end();
+        return instrs.set(id) = instr;
+    }
+
+    void load_edges() {
+        if (edges_loaded) {
+            return;
+        }
+        edges_loaded = true;
+        for (auto &anedge : platform.topology["edges"]) {
+            UInt s = anedge["src"];
+            UInt d = anedge["dst"];
+            UInt e = anedge["id"];
+            Pair<UInt,UInt> aqpair(s,d);
+            if (qubitpair2edge.find(aqpair) != qubitpair2edge.end()) {
+                QL_FATAL("re-defining edge " << s << "->" << d << " !");
+            }
+            qubitpair2edge.set(aqpair) = e;
+        }
+        auto &constraints = platform.resources["detuned_qubits"]["connection_map"];
+        for (auto it = constraints.begin(); it != constraints.end(); ++it) {
+            UInt edgeNo = stoi(it.key());
+            for (auto &q : it.value()) {
+                edge_detunes_qubits.set(edgeNo).push_back(q);
+            }
+        }
+    }
+
+    // buffer delay between bundles with the given sets of buffer types
+    UInt buffer_delay(UInt prev_types, UInt curr_types) const {
+        UInt delay = 0;
+        for (UInt p = 0; p < NUM_BUFFER_TYPES; p++) {
+            if (prev_types & (1ull << p)) {
+                for (UInt c = 0; c < NUM_BUFFER_TYPES; c++) {
+                    if (curr_types & (1ull << c)) {
+                        delay = max(delay, buffer_cycles[p][c]);
+                    }
+                }
+            }
+        }
+        return delay;
+    }
+
+public:
+    explicit post_scheduler(const quantum_platform &platform) : platform(platform) {
+        for (UInt p = 0; p < NUM_BUFFER_TYPES; p++) {
+            for (UInt c = 0; c < NUM_BUFFER_TYPES; c++) {
+                buffer_cycles[p][c] = 0;
+                if (p < post_schedule_buffer_types.size() && c < post_schedule_buffer_types.size()) {
+                    auto bname = post_schedule_buffer_types[p] + "_" + post_schedule_buffer_types[c] + "_buffer";
+                    if (platform.hardware_settings.count(bname) > 0) {
+                        buffer_cycles[p][c] = UInt(ceil(
+                            static_cast<float>(platform.hardware_settings[bname]) /
+                            platform.cycle_time));
+                    }
+                }
+            }
+        }
+        decompose_cz = options::get("cz_mode") == "auto";
+    }
+
+    void run(quantum_kernel &kernel) {
+        if (kernel.c.empty()) {
+            return;
+        }
+        QL_ASSERT(kernel.cycles_valid);
+
+        // latency compensation
+        Vec<Pair<gate*, const post_schedule_instr_t*>> gates;
+        gates.reserve(kernel.c.size());
+        Bool compensated_one = false;
+        for (auto gp : kernel.c) {
+            const auto &instr = lookup(gp->name);
+            if (instr.has_latency) {
+                gp->cycle = gp->cycle + instr.latency_cycles;
+                compensated_one = true;
+            }
+            gates.emplace_back(gp, &instr);
+        }
+        if (compensated_one) {
+            std::stable_sort(
+                gates.begin(), gates.end(),
+                [](const Pair<gate*, const post_schedule_instr_t*> &a, const Pair<gate*, const post_schedule_instr_t*> &b) {
+                    return a.first->cycle < b.first->cycle;
+                }
+            );
+        }
+
+        // sweep over the bundles, i.e. the runs of gates with equal cycle
+        circuit result;
+        result.reserve(gates.size());
+        UInt curr_cycle = 0;        // cycle of current bundle before buffer insertion
+        UInt bundle_start = 0;      // index of first gate of current bundle in result
+        UInt prev_types = 0;        // set of buffer types in previous bundle
+        UInt curr_types = 0;        // set of buffer types in current bundle
+        UInt buffer_cycles_accum = 0;
+        Vec<const post_schedule_instr_t*> bundle_instrs;
+        auto finish_bundle = [&]() {
+            buffer_cycles_accum += buffer_delay(prev_types, curr_types);
+            UInt start_cycle = curr_cycle + buffer_cycles_accum;
+            UInt bundle_end = result.size();
+            for (UInt i = bundle_start; i < bundle_end; i++) {
+                result[i]->cycle = start_cycle;
+            }
+
+            // post-schedule decomposition, adding gates at the end of the bundle
+            if (decompose_cz) {
+                for (UInt i = bundle_start; i < bundle_end; i++) {
+                    gate *gp = result[i];
+                    if (gp->operands.size() != 2) {
+                        continue;
+                    }
+                    if (!bundle_instrs[i - bundle_start]->is_custom) {
+                        QL_FATAL("custom instruction not found for : " << gp->name << " !");
+                    }
+                    if (!bundle_instrs[i - bundle_start]->is_flux) {
+                        continue;
+                    }
+                    load_edges();
+                    auto it = qubitpair2edge.find({gp->operands[0], gp->operands[1]});
+                    if (it != qubitpair2edge.end()) {
+                        for (auto &q : edge_detunes_qubits.get(it->second)) {
+                            custom_gate *g = new custom_gate("sqf q" + to_string(q));
+                            g->operands.push_back(q);
+                            g->cycle = start_cycle;
+                            result.push_back(g);
+                        }
+                    }
+                }
+            }
+
+            prev_types = curr_types;
+            curr_types = 0;
+            bundle_instrs.clear();
+        };
+        for (auto &entry : gates) {
+            gate *gp = entry.first;
+            if (gp->type() == gate_type_t::__wait_gate__ || gp->type() == gate_type_t::__dummy_gate__) {
+                continue;
+            }
+            if (gp->cycle < curr_cycle) {
+                QL_FATAL("Error: circuit not ordered by cycle value");
+            }
+            if (gp->cycle > curr_cycle) {
+                if (bundle_start < result.size()) {
+                    finish_bundle();
+                }
+                curr_cycle = gp->cycle;
+                bundle_start = result.size();
+            }
+            result.push_back(gp);
+            bundle_instrs.push_back(entry.second);
+            curr_types |= 1ull << entry.second->buffer_type;
+        }
+        if (bundle_start < result.size()) {
+            finish_bundle();
+        }
+
+        kernel.c = result;
+        QL_ASSERT(kernel.cycles_valid);
+    }
+};
+
+} // anonymous namespace
+
+void cc_light_eqasm_compiler::ccl_post_schedule(
+    quantum_program *programp,
+    const quantum_platform &platform,
+    const Str &passname
+) {
+    report_statistics(programp, platform, "in", passname, "# ");
+    report_qasm(programp, platform, "in", passname);
+
+    post_scheduler ps(platform);
+    for (auto &kernel : programp->kernels) {
+        QL_DOUT("Post-scheduling kernel: " << kernel.name);
+        ps.run(kernel);
+    }
+
+    report_statistics(programp, platform, "out", passname, "# ");
+    report_qasm(programp, platform, "out", passname);
+}
+
 void cc_light_eqasm_compiler::map(
     quantum_program *programp,
     const quantum_platform &platform,
     const Str &passname,
-    Str *mapStatistics
+    Str *mapStatistics,
+    mapper::Grid *gridcache
 ) {
     auto mapopt = options::get("mapper");
     if (mapopt == "no") {
@@ -752,14 +1095,35 @@ void cc_light_eqasm_compiler::map(
     report_qasm(programp, platform, "in", passname);
 
     mapper::Mapper mapper;  // virgin mapper creation; for role of Init functions, see comment at top of mapper.h
-    mapper.Init(&platform); // platform specifies number of real qubits, i.e. locations for virtual qubits
+    mapper.Init(&platform, gridcache); // platform specifies number of real qubits, i.e. locations for virtual qubits
 
     auto rf = ReportFile(programp, "out", passname);
 
     UInt total_swaps = 0;        // for reporting, data is mapper specific
     UInt total_moves = 0;        // for reporting, data is mapper specific
     Real total_timetaken = 0.0;  // total over kernels of time taken by mapper
+    KernelDeduplicator dedup(passname);
     for (auto &kernel : programp->kernels) {
+        // a kernel identical to one mapped before, from the same entry mapping, gets a copy of its result
+        Vec<UInt> dedupstats;
+        if (dedup.reuse(kernel, mapper.EntryHash(), &dedupstats)) {
+            QL_IOUT("Mapping kernel: " << kernel.name << " reusing the result of an identical kernel");
+            programp->qubit_count = platform.qubit_number;
+
+            StrStrm ss;
+            report_kernel_statistics(ss, kernel, platform, "# ");
+            ss << "# ----- swaps added: " << dedupstats[0] << std::endl;
+            ss << "# ----- of which moves added: " << dedupstats[1] << std::endl;
+            ss << "# ----- deduplicated: reused the result of an identical kernel" << std::endl;
+            rf << ss.str();
+
+            total_swaps += dedupstats[0];
+            total_moves += dedupstats[1];
+
+            *mapStatistics += ss.str();
+            continue;
+        }
+
         QL_IOUT("Mapping kernel: " << kernel.name);
 
         // compute timetaken, start interval timer here
@@ -768,6 +1132,7 @@ void cc_light_eqasm_compiler::map(
         high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
         mapper.Map(kernel);
+        dedup.store(kernel, {mapper.nswapsadded, mapper.nmovesadded});
         // kernel.qubit_count starts off as number of virtual qubits, i.e. highest indexed qubit minus 1
         // kernel.qubit_count is updated by Map to highest index of real qubits used minus -1
         programp->qubit_count = platform.qubit_number;
@@ -801,6 +1166,7 @@ void cc_light_eqasm_compiler::map(
     ss << "# Total no. of swaps: " << total_swaps << std::endl;
     ss << "# Total no. of moves of swaps: " << total_moves << std::endl;
     ss << "# Total time taken: " << total_timetaken << std::endl;
+    ss << dedup.get_statistics("# ");
     rf << ss.str();
 
     report_qasm(programp, platform, "out", passname);
@@ -908,18 +1274,15 @@ void cc_light_eqasm_compiler::compile(quantum_program *programp, const quantum_p
 
     rcschedule(programp, platform, "rcscheduler");
 
-    latency_compensation(programp, platform, "ccl_latency_compensation");
-
-    insert_buffer_delays(programp, platform, "ccl_insert_buffer_delays");
-
-    // decompose meta-instructions after scheduling
-    ccl_decompose_post_schedule(programp, platform, "ccl_decompose_post_schedule");
+    // latency compensation, buffer delay insertion and decomposition of meta-instructions after scheduling
+    ccl_post_schedule(programp, platform, "ccl_post_schedule");
 
     // just before code generation, emit quantumsim script to best match target architecture
     write_quantumsim_script(programp, platform, "write_quantumsim_script_mapped");
 
     // and now for real
-    qisa_code_generation(programp, platform, "qisa_code_generation");
+    qisa_statistics_t qisa_stats;
+    qisa_code_generation(programp, platform, "qisa_code_generation", &qisa_stats);
 
     // timing to be moved to pass manager
     // computing timetaken, stop interval timer
@@ -935,6 +1298,9 @@ void cc_light_eqasm_compiler::compile(quantum_program *programp, const quantum_p
     }
     rf.write_totals_statistics(programp->kernels, platform, "# ");
     rf << "# Total time taken: " << total_timetaken << "\n";
+    if (options::get("ccl_loop_compression") == "yes") {
+        rf << qisa_statistics_report(qisa_stats, "# ");
+    }
     report_qasm(programp, platform, "out", "cc_light_compiler");
 
     QL_DOUT("Compiling CCLight eQASM [Done]");
@@ -1051,19 +1417,35 @@ void cc_light_eqasm_compiler::ccl_decompose_pre_schedule_kernel(
 void cc_light_eqasm_compiler::qisa_code_generation(
     quantum_program *programp,
     const quantum_platform &platform,
-    const Str &passname
+    const Str &passname,
+    qisa_statistics_t *stats
 ) {
     (void)passname;
     MaskManager mask_manager;
     StrStrm ssqisa, sskernels_qisa;
+    qisa_statistics_t local_stats;
+    if (!stats) {
+        stats = &local_stats;
+    }
+
+    // loops reuse the registers of for loops, so they can't be nested in one
+    Bool compress_loops = options::get("ccl_loop_compression") == "yes";
+    Bool in_for = false;
+
     sskernels_qisa << "start:" << std::endl;
     for (auto &kernel : programp->kernels) {
+        if (kernel.type == kernel_type_t::FOR_START) {
+            in_for = true;
+        }
         sskernels_qisa << std::endl << kernel.name << ":" << std::endl;
         sskernels_qisa << get_qisa_prologue(kernel);
         if (!kernel.c.empty()) {
-            sskernels_qisa << ir2qisa(kernel, platform, mask_manager);
+            sskernels_qisa << ir2qisa(kernel, platform, mask_manager, compress_loops && !in_for, stats);
         }
         sskernels_qisa << get_qisa_epilogue(kernel);
+        if (kernel.type == kernel_type_t::FOR_END) {
+            in_for = false;
+        }
     }
     sskernels_qisa << std::endl
                    << "    br always, start" << std::endl
@@ -16,6 +16,11 @@
 #include "eqasm_compiler.h"
 
 namespace ql {
+
+namespace mapper {
+class Grid;
+} // namespace mapper
+
 namespace arch {
 
 // eqasm code : set of cc_light_eqasm instructions
@@ -78,7 +83,37 @@ utils::Str classical_instruction2qisa(classical_cc *classical_in);
 // FIXME HvS attribute of gate or just in json? Generalization to arch_operation_name is unnecessary
 utils::Str get_cc_light_instruction_name(const utils::Str &id, const quantum_platform &platform);
 
-utils::Str ir2qisa(quantum_kernel &kernel, const quantum_platform &platform, MaskManager &gMaskManager);
+/**
+ * Bundle counts of generated QISA, to report the effect of loop compression.
+ */
+struct qisa_statistics_t {
+    utils::UInt bundles = 0;            // number of bundles executed, i.e. before compression
+    utils::UInt emitted_bundles = 0;    // number of bundles in the QISA code
+    utils::UInt loops = 0;              // number of loops introduced
+};
+
+/**
+ * Formats the loop compression statistics as report lines, each starting with
+ * comment_prefix.
+ */
+utils::Str qisa_statistics_report(const qisa_statistics_t &stats, const utils::Str &comment_prefix = "");
+
+// maximum number of bundles in a window that is folded into a loop by option ccl_loop_compression
+const utils::UInt MAX_LOOP_WINDOW = 32;
+
+/**
+ * Generates QISA for the bundles of a kernel. With compress_loops, runs of
+ * repeated windows of bundles are folded into loops using the FOR_START and
+ * FOR_END prologue and epilogue; these use registers r29..r31, so the kernel
+ * must not be the body of a for loop itself.
+ */
+utils::Str ir2qisa(
+    quantum_kernel &kernel,
+    const quantum_platform &platform,
+    MaskManager &gMaskManager,
+    utils::Bool compress_loops = false,
+    qisa_statistics_t *stats = nullptr
+);
 
 /**
  * cclight eqasm compiler
@@ -98,7 +133,16 @@ public:
     void ccl_decompose_pre_schedule(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname);
     void ccl_decompose_post_schedule(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname);
     static void ccl_decompose_post_schedule_bundles(ir::bundles_t &bundles_dst, const quantum_platform &platform);
-    static void map(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname, utils::Str *mapStatistics);
+    // latency_compensation, insert_buffer_delays and ccl_decompose_post_schedule fused into a single sweep per kernel
+    void ccl_post_schedule(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname);
+    // gridcache, when given, keeps the mapper's grid for the next program on the same topology (see Mapper::Init)
+    static void map(
+        quantum_program *programp,
+        const quantum_platform &platform,
+        const utils::Str &passname,
+        utils::Str *mapStatistics,
+        mapper::Grid *gridcache = nullptr
+    );
 
     // cc_light_instr is needed by some cc_light backend passes and by cc_light resource_management:
     // - each bundle section will only have gates with the same cc_light_instr name; prepares for SIMD/SOMQ
@@ -133,7 +177,8 @@ public:
 
     // qisa_code_generation pass
     // generates qisa from IR
-    static void qisa_code_generation(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname);
+    // stats, when given, receives the bundle counts of the generated QISA
+    static void qisa_code_generation(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname, qisa_statistics_t *stats = nullptr);
 
 private:
     // write cc_light scheduled bundles for quantumsim
@@ -4,6 +4,8 @@
 
 #include "arch/cc_light/cc_light_resource_manager.h"
 
+#include "utils/exception.h"
+
 namespace ql {
 namespace arch {
 
@@ -36,48 +38,59 @@ Str ccl_get_operation_name(gate *ins, const quantum_platform &platform) {
     return operation_name;
 }
 
-ccl_qubit_resource_t::ccl_qubit_resource_t(
+ccl_resource_t::ccl_resource_t(
+    const Str &n,
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    UInt &state_size,
+    UInt arrays
 ) :
-    resource_t("qubits", dir)
+    name(n)
 {
     // DOUT("... creating " << name << " resource");
     count = platform.resources[name]["count"];
-    state.resize(count);
-    for (UInt q = 0; q < count; q++) {
-        state[q] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+    offset = state_size;
+    state_size += arrays * count;
+}
+
+UInt ccl_resource_t::index(UInt array, UInt i) const {
+    if (i >= count) {
+        throw Exception("index " + to_string(i) + " is out of range of the " + to_string(count) + " elements of resource " + name);
     }
+    return offset + array * count + i;
 }
 
-ccl_qubit_resource_t *ccl_qubit_resource_t::clone() const & {
-    QL_DOUT("Cloning/copying ccl_qubit_resource_t");
-    return new ccl_qubit_resource_t(*this);
+ccl_qubit_resource_t::ccl_qubit_resource_t(
+    const quantum_platform &platform,
+    UInt &state_size
+) :
+    ccl_resource_t("qubits", platform, state_size, 1)
+{
 }
 
-ccl_qubit_resource_t *ccl_qubit_resource_t::clone() && {
-    QL_DOUT("Cloning/moving ccl_qubit_resource_t");
-    return new ccl_qubit_resource_t(std::move(*this));
+void ccl_qubit_resource_t::init(Vec<UInt> &state, scheduling_direction_t dir) const {
+    for (UInt q = 0; q < count; q++) {
+        state[index(BUSY, q)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+    }
 }
 
 Bool ccl_qubit_resource_t::available(
+    const Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-    Str operation_type = ccl_get_operation_type(ins, platform);
-
+    const ccl_operation_t &op
+) const {
     for (auto q : ins->operands) {
+        UInt busy = state[index(BUSY, q)];
         if (forward_scheduling == direction) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qubit: " << q << " is busy till cycle : " << state[q]);
-            if (op_start_cycle < state[q]) {
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qubit: " << q << " is busy till cycle : " << busy);
+            if (op_start_cycle < busy) {
                 QL_DOUT("    " << name << " resource busy ...");
                 return false;
             }
         } else {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qubit: " << q << " is busy from cycle : " << state[q]);
-            if (op_start_cycle + operation_duration > state[q]) {
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qubit: " << q << " is busy from cycle : " << busy);
+            if (op_start_cycle + op.duration > busy) {
                 QL_DOUT("    " << name << " resource busy ...");
                 return false;
             }
@@ -88,36 +101,25 @@ Bool ccl_qubit_resource_t::available(
 }
 
 void ccl_qubit_resource_t::reserve(
+    Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-
+    const ccl_operation_t &op
+) const {
     for (auto q : ins->operands) {
-        state[q] = (forward_scheduling == direction ?  op_start_cycle + operation_duration : op_start_cycle );
-        QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qubit: " << q << " reserved till/from cycle: " << state[q]);
+        UInt &busy = state[index(BUSY, q)];
+        busy = (forward_scheduling == direction ?  op_start_cycle + op.duration : op_start_cycle );
+        QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qubit: " << q << " reserved till/from cycle: " << busy);
     }
 }
 
 ccl_qwg_resource_t::ccl_qwg_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    UInt &state_size
 ) :
-    resource_t("qwgs", dir)
+    ccl_resource_t("qwgs", platform, state_size, 3)
 {
-    // DOUT("... creating " << name << " resource");
-    count = platform.resources[name]["count"];
-    fromcycle.resize(count);
-    tocycle.resize(count);
-    operations.resize(count);
-
-    for (UInt i = 0; i < count; i++) {
-        fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        operations[i] = "";
-    }
     auto & constraints = platform.resources[name]["connection_map"];
     for (auto it = constraints.cbegin(); it != constraints.cend(); ++it) {
         // COUT(it.key() << " : " << it.value() );
@@ -129,41 +131,40 @@ ccl_qwg_resource_t::ccl_qwg_resource_t(
     }
 }
 
-ccl_qwg_resource_t *ccl_qwg_resource_t::clone() const & {
-    QL_DOUT("Cloning/copying ccl_qwg_resource_t");
-    return new ccl_qwg_resource_t(*this);
-}
-
-ccl_qwg_resource_t *ccl_qwg_resource_t::clone() && {
-    QL_DOUT("Cloning/moving ccl_qwg_resource_t");
-    return new ccl_qwg_resource_t(std::move(*this));
+void ccl_qwg_resource_t::init(Vec<UInt> &state, scheduling_direction_t dir) const {
+    for (UInt i = 0; i < count; i++) {
+        state[index(FROM, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+        state[index(TO, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+        state[index(OPERATION, i)] = 0;
+    }
 }
 
 Bool ccl_qwg_resource_t::available(
+    const Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    Str operation_name = ccl_get_operation_name(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_mw = (operation_type == "mw");
-    if (is_mw) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_mw) {
         for (auto q : ins->operands) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qubit2qwg.at(q) << " is busy from cycle: " << fromcycle[qubit2qwg.at(q)] << " to cycle: " << tocycle[qubit2qwg.at(q)] << " for operation: " << operations[qubit2qwg.at(q)]);
+            UInt qwg = qubit2qwg.at(q);
+            UInt fromcycle = state[index(FROM, qwg)];
+            UInt tocycle = state[index(TO, qwg)];
+            UInt operation = state[index(OPERATION, qwg)];
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qwg << " is busy from cycle: " << fromcycle << " to cycle: " << tocycle << " for operation: " << operation);
             if (direction == forward_scheduling) {
                 if (
-                    op_start_cycle < fromcycle[qubit2qwg.at(q)]
-                    || (op_start_cycle < tocycle[qubit2qwg.at(q)] && operations[qubit2qwg.at(q)] != operation_name)
+                    op_start_cycle < fromcycle
+                    || (op_start_cycle < tocycle && operation != op.name)
                 ) {
                     QL_DOUT("    " << name << " resource busy ...");
                     return false;
                 }
             } else {
                 if (
-                    op_start_cycle + operation_duration > tocycle[qubit2qwg.at(q)]
-                    || ( op_start_cycle + operation_duration > fromcycle[qubit2qwg.at(q)] && operations[qubit2qwg.at(q)] != operation_name)
+                    op_start_cycle + op.duration > tocycle
+                    || ( op_start_cycle + op.duration > fromcycle && operation != op.name)
                 ) {
                     QL_DOUT("    " << name << " resource busy ...");
                     return false;
@@ -176,54 +177,46 @@ Bool ccl_qwg_resource_t::available(
 }
 
 void ccl_qwg_resource_t::reserve(
+    Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    Str operation_name = ccl_get_operation_name(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_mw = operation_type == "mw";
-    if (is_mw) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_mw) {
         for (auto q : ins->operands) {
+            UInt qwg = qubit2qwg.at(q);
+            UInt &fromcycle = state[index(FROM, qwg)];
+            UInt &tocycle = state[index(TO, qwg)];
+            UInt &operation = state[index(OPERATION, qwg)];
             if (direction == forward_scheduling) {
-                if (operations[qubit2qwg.at(q)] == operation_name) {
-                    tocycle[qubit2qwg.at(q)] = max(tocycle[qubit2qwg.at(q)], op_start_cycle + operation_duration);
+                if (operation == op.name) {
+                    tocycle = max(tocycle, op_start_cycle + op.duration);
                 } else {
-                    fromcycle[qubit2qwg.at(q)] = op_start_cycle;
-                    tocycle[qubit2qwg.at(q)] = op_start_cycle + operation_duration;
-                    operations[qubit2qwg.at(q)] = operation_name;
+                    fromcycle = op_start_cycle;
+                    tocycle = op_start_cycle + op.duration;
+                    operation = op.name;
                 }
             } else {
-                if (operations[qubit2qwg.at(q)] == operation_name) {
-                    fromcycle[qubit2qwg.at(q)] = min(fromcycle[qubit2qwg.at(q)], op_start_cycle);
+                if (operation == op.name) {
+                    fromcycle = min(fromcycle, op_start_cycle);
                 } else {
-                    fromcycle[qubit2qwg.at(q)] = op_start_cycle;
-                    tocycle[qubit2qwg.at(q)] = op_start_cycle + operation_duration;
-                    operations[qubit2qwg.at(q)] = operation_name;
+                    fromcycle = op_start_cycle;
+                    tocycle = op_start_cycle + op.duration;
+                    operation = op.name;
                 }
             }
-            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qubit2qwg.at(q) << " reserved from cycle: " << fromcycle[qubit2qwg.at(q)] << " to cycle: " << tocycle[qubit2qwg.at(q)] << " for operation: " << operations[qubit2qwg.at(q)]);
+            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qwg << " reserved from cycle: " << fromcycle << " to cycle: " << tocycle << " for operation: " << operation);
         }
     }
 }
 
 ccl_meas_resource_t::ccl_meas_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    UInt &state_size
 ) :
-    resource_t("meas_units", dir)
+    ccl_resource_t("meas_units", platform, state_size, 2)
 {
-    // DOUT("... creating " << name << " resource");
-    count = platform.resources[name]["count"];
-    fromcycle.resize(count);
-    tocycle.resize(count);
-
-    for (UInt i=0; i<count; i++) {
-        fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-    }
     auto &constraints = platform.resources[name]["connection_map"];
     for (auto it = constraints.begin(); it != constraints.end(); ++it) {
         // COUT(it.key() << " : " << it.value());
@@ -235,42 +228,40 @@ ccl_meas_resource_t::ccl_meas_resource_t(
     }
 }
 
-ccl_meas_resource_t *ccl_meas_resource_t::clone() const & {
-    QL_DOUT("Cloning/copying ccl_meas_resource_t");
-    return new ccl_meas_resource_t(*this);
-}
-
-ccl_meas_resource_t *ccl_meas_resource_t::clone() && {
-    QL_DOUT("Cloning/moving ccl_meas_resource_t");
-    return new ccl_meas_resource_t(std::move(*this));
+void ccl_meas_resource_t::init(Vec<UInt> &state, scheduling_direction_t dir) const {
+    for (UInt i = 0; i < count; i++) {
+        state[index(FROM, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+        state[index(TO, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+    }
 }
 
 Bool ccl_meas_resource_t::available(
+    const Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_measure = (operation_type == "readout");
-    if (is_measure) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_readout) {
         for (auto q : ins->operands) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << qubit2meas.at(q) << " is busy from cycle: " << fromcycle[qubit2meas.at(q)] << " to cycle: " << tocycle[qubit2meas.at(q)] );
+            UInt meas = qubit2meas.at(q);
+            UInt fromcycle = state[index(FROM, meas)];
+            UInt tocycle = state[index(TO, meas)];
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << meas << " is busy from cycle: " << fromcycle << " to cycle: " << tocycle);
             if (direction == forward_scheduling) {
-                if (op_start_cycle != fromcycle[qubit2meas.at(q)]) {
+                if (op_start_cycle != fromcycle) {
                     // If current measurement on same measurement-unit does not start in the
                     // same cycle, then it should wait for current measurement to finish
-                    if (op_start_cycle < tocycle[qubit2meas.at(q)]) {
+                    if (op_start_cycle < tocycle) {
                         QL_DOUT("    " << name << " resource busy ...");
                         return false;
                     }
                 }
             } else {
-                if (op_start_cycle != fromcycle[qubit2meas.at(q)]) {
+                if (op_start_cycle != fromcycle) {
                     // If current measurement on same measurement-unit does not start in the
                     // same cycle, then it should wait until it would finish at start of or earlier than current measurement
-                    if (op_start_cycle + operation_duration > fromcycle[qubit2meas.at(q)]) {
+                    if (op_start_cycle + op.duration > fromcycle) {
                         QL_DOUT("    " << name << " resource busy ...");
                         return false;
                     }
@@ -283,37 +274,28 @@ Bool ccl_meas_resource_t::available(
 }
 
 void ccl_meas_resource_t::reserve(
+    Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_measure = (operation_type == "readout");
-    if (is_measure) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_readout) {
         for (auto q : ins->operands) {
-            fromcycle[qubit2meas.at(q)] = op_start_cycle;
-            tocycle[qubit2meas.at(q)] = op_start_cycle + operation_duration;
-            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << qubit2meas.at(q) << " reserved from cycle: " << fromcycle[qubit2meas.at(q)] << " to cycle: " << tocycle[qubit2meas.at(q)]);
+            UInt meas = qubit2meas.at(q);
+            state[index(FROM, meas)] = op_start_cycle;
+            state[index(TO, meas)] = op_start_cycle + op.duration;
+            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << meas << " reserved from cycle: " << state[index(FROM, meas)] << " to cycle: " << state[index(TO, meas)]);
         }
     }
 }
 
 ccl_edge_resource_t::ccl_edge_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    UInt &state_size
 ) :
-    resource_t("edges", dir)
+    ccl_resource_t("edges", platform, state_size, 1)
 {
-    // DOUT("... creating " << name << " resource");
-    count = platform.resources[name]["count"];
-    state.resize(count);
-
-    for (UInt i = 0; i < count; i++) {
-        state[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-    }
-
     for (auto &anedge : platform.topology["edges"]) {
         UInt s = anedge["src"];
         UInt d = anedge["dst"];
@@ -340,27 +322,20 @@ ccl_edge_resource_t::ccl_edge_resource_t(
     }
 }
 
-ccl_edge_resource_t *ccl_edge_resource_t::clone() const & {
-    QL_DOUT("Cloning/copying ccl_edge_resource_t");
-    return new ccl_edge_resource_t(*this);
-}
-
-ccl_edge_resource_t *ccl_edge_resource_t::clone() && {
-    QL_DOUT("Cloning/moving ccl_edge_resource_t");
-    return new ccl_edge_resource_t(std::move(*this));
+void ccl_edge_resource_t::init(Vec<UInt> &state, scheduling_direction_t dir) const {
+    for (UInt i = 0; i < count; i++) {
+        state[index(BUSY, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+    }
 }
 
 Bool ccl_edge_resource_t::available(
+    const Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-
-    auto gname = ins->name;
-    Bool is_flux = (operation_type == "flux");
-    if (is_flux) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
             // single qubit flux operation does not reserve an edge resource
@@ -371,20 +346,21 @@ Bool ccl_edge_resource_t::available(
             qubits_pair_t aqpair(q0, q1);
             auto it = qubits2edge.find(aqpair);
             if (it != qubits2edge.end()) {
-                auto edge_no = qubits2edge.at(aqpair);
+                auto edge_no = it->second;
 
-                QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " is busy till/from cycle : " << state[edge_no] << " for operation: " << ins->name);
+                QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " is busy till/from cycle : " << state[index(BUSY, edge_no)] << " for operation: " << ins->name);
 
-                Vec<UInt> edges2check(edge2edges.get(edge_no));
-                edges2check.push_back(edge_no);
-                for (auto &e : edges2check) {
+                // the edge itself and the edges that cannot execute a two-qubit gate in parallel to it
+                const Vec<UInt> &edges2check = edge2edges.get(edge_no);
+                for (UInt i = 0; i <= edges2check.size(); i++) {
+                    UInt e = (i < edges2check.size() ? edges2check[i] : edge_no);
                     if (direction == forward_scheduling) {
-                        if (op_start_cycle < state[e]) {
+                        if (op_start_cycle < state[index(BUSY, e)]) {
                             QL_DOUT("    " << name << " resource busy ...");
                             return false;
                         }
                     } else {
-                        if (op_start_cycle + operation_duration > state[e]) {
+                        if (op_start_cycle + op.duration > state[index(BUSY, e)]) {
                             QL_DOUT("    " << name << " resource busy ...");
                             return false;
                         }
@@ -402,16 +378,13 @@ Bool ccl_edge_resource_t::available(
 }
 
 void ccl_edge_resource_t::reserve(
+    Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-
-    auto gname = ins->name;
-    Bool is_flux = (operation_type == "flux");
-    if (is_flux) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
             // single qubit flux operation does not reserve an edge resource
@@ -420,18 +393,12 @@ void ccl_edge_resource_t::reserve(
             auto q1 = ins->operands[1];
             qubits_pair_t aqpair(q0, q1);
             auto edge_no = qubits2edge.at(aqpair);
-            if (direction == forward_scheduling) {
-                state[edge_no] = op_start_cycle + operation_duration;
-                for (auto &e : edge2edges.get(edge_no)) {
-                    state[e] = op_start_cycle + operation_duration;
-                }
-            } else {
-                state[edge_no] = op_start_cycle;
-                for (auto &e : edge2edges.get(edge_no)) {
-                    state[e] = op_start_cycle;
-                }
+            UInt busy = (direction == forward_scheduling ? op_start_cycle + op.duration : op_start_cycle);
+            state[index(BUSY, edge_no)] = busy;
+            for (auto &e : edge2edges.get(edge_no)) {
+                state[index(BUSY, e)] = busy;
             }
-            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " reserved till cycle: " << state[ edge_no ] << " for operation: " << ins->name);
+            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " reserved till cycle: " << state[index(BUSY, edge_no)] << " for operation: " << ins->name);
         } else {
             QL_FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
         }
@@ -440,23 +407,10 @@ void ccl_edge_resource_t::reserve(
 
 ccl_detuned_qubits_resource_t::ccl_detuned_qubits_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    UInt &state_size
 ) :
-    resource_t("detuned_qubits", dir)
+    ccl_resource_t("detuned_qubits", platform, state_size, 3)
 {
-    // DOUT("... creating " << name << " resource");
-    count = platform.resources[name]["count"];
-    fromcycle.resize(count);
-    tocycle.resize(count);
-    operations.resize(count);
-
-    // initialize resource state machine to be free for all qubits
-    for (UInt i = 0; i < count; i++) {
-        fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        operations[i] = "";
-    }
-
     // initialize qubitpair2edge map from json description; this is a constant map
     for (auto &anedge : platform.topology["edges"]) {
         UInt s = anedge["src"];
@@ -485,29 +439,25 @@ ccl_detuned_qubits_resource_t::ccl_detuned_qubits_resource_t(
     }
 }
 
-ccl_detuned_qubits_resource_t *ccl_detuned_qubits_resource_t::clone() const & {
-    QL_DOUT("Cloning/copying ccl_detuned_qubits_resource_t");
-    return new ccl_detuned_qubits_resource_t(*this);
-}
-
-ccl_detuned_qubits_resource_t *ccl_detuned_qubits_resource_t::clone() && {
-    QL_DOUT("Cloning/moving ccl_detuned_qubits_resource_t");
-    return new ccl_detuned_qubits_resource_t(std::move(*this));
+// initialize resource state machine to be free for all qubits
+void ccl_detuned_qubits_resource_t::init(Vec<UInt> &state, scheduling_direction_t dir) const {
+    for (UInt i = 0; i < count; i++) {
+        state[index(FROM, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+        state[index(TO, i)] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
+        state[index(OPERATION, i)] = 0;
+    }
 }
 
 // When a two-qubit flux gate, check whether the qubits it would detune are not busy with a rotation.
 // When a one-qubit rotation, check whether the qubit is not detuned (busy with a flux gate).
 Bool ccl_detuned_qubits_resource_t::available(
+    const Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    auto gname = ins->name;
-    Bool is_flux = operation_type == "flux";
-    if (is_flux) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
             // single qubit flux operation does not reserve a detuned qubits resource
@@ -518,22 +468,25 @@ Bool ccl_detuned_qubits_resource_t::available(
             qubits_pair_t aqpair(q0, q1);
             auto it = qubitpair2edge.find(aqpair);
             if (it != qubitpair2edge.end()) {
-                auto edge_no = qubitpair2edge.at(aqpair);
+                auto edge_no = it->second;
 
                 for (auto &q : edge_detunes_qubits.get(edge_no)) {
-                    QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
+                    UInt fromcycle = state[index(FROM, q)];
+                    UInt tocycle = state[index(TO, q)];
+                    UInt operation = state[index(OPERATION, q)];
+                    QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle << " till: " << tocycle << " with operation_type: " << op.type);
                     if (direction == forward_scheduling) {
                         if (
-                            op_start_cycle < fromcycle[q]
-                            || ( op_start_cycle < tocycle[q] && operations[q] != operation_type)
+                            op_start_cycle < fromcycle
+                            || ( op_start_cycle < tocycle && operation != op.type)
                         ) {
                             QL_DOUT("    " << name << " resource busy for a two-qubit gate...");
                             return false;
                         }
                     } else {
                         if (
-                            op_start_cycle + operation_duration > tocycle[q]
-                            || ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type)
+                            op_start_cycle + op.duration > tocycle
+                            || ( op_start_cycle + op.duration > fromcycle && operation != op.type)
                         ) {
                             QL_DOUT("    " << name << " resource busy for a two-qubit gate...");
                             return false;
@@ -549,48 +502,76 @@ Bool ccl_detuned_qubits_resource_t::available(
         }
     }
 
-    Bool is_mw = operation_type == "mw";
-    if (is_mw) {
+    if (op.is_mw) {
         for (auto q : ins->operands) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
+            UInt fromcycle = state[index(FROM, q)];
+            UInt tocycle = state[index(TO, q)];
+            UInt operation = state[index(OPERATION, q)];
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle << " till: " << tocycle << " with operation_type: " << op.type);
             if (direction == forward_scheduling) {
-                if (op_start_cycle < fromcycle[q]) {
-                    QL_DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " < fromcycle[" << q << "] " << fromcycle[q] );
+                if (op_start_cycle < fromcycle) {
+                    QL_DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " < fromcycle[" << q << "] " << fromcycle );
                     return false;
                 }
-                if (op_start_cycle < tocycle[q] && operations[q] != operation_type) {
-                    QL_DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " < tocycle[" << q << "] " << tocycle[q] );
+                if (op_start_cycle < tocycle && operation != op.type) {
+                    QL_DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " < tocycle[" << q << "] " << tocycle );
                     return false;
                 }
             } else {
-                if (op_start_cycle + operation_duration > tocycle[q]) {
-                    QL_DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " + duration > tocycle[" << q << "] " << tocycle[q] );
+                if (op_start_cycle + op.duration > tocycle) {
+                    QL_DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " + duration > tocycle[" << q << "] " << tocycle );
                     return false;
                 }
-                if (op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type) {
-                    QL_DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " + duration > fromcycle[" << q << "] " << fromcycle[q] );
+                if (op_start_cycle + op.duration > fromcycle && operation != op.type) {
+                    QL_DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " + duration > fromcycle[" << q << "] " << fromcycle );
                     return false;
                 }
             }
         }
     }
-    if (is_flux || is_mw) QL_DOUT("    " << name << " resource available ...");
+    if (op.is_flux || op.is_mw) QL_DOUT("    " << name << " resource available ...");
     return true;
 }
 
+// sets qubit q busy with an operation of the given type, extending the cycles it is busy
+// when it was already busy with an operation of that type
+static void reserve_detuned_qubit(
+    UInt &fromcycle,
+    UInt &tocycle,
+    UInt &operation,
+    scheduling_direction_t direction,
+    UInt op_start_cycle,
+    const ccl_operation_t &op
+) {
+    if (direction == forward_scheduling) {
+        if (operation == op.type) {
+            tocycle = max(tocycle, op_start_cycle + op.duration);
+        } else {
+            fromcycle = op_start_cycle;
+            tocycle = op_start_cycle + op.duration;
+            operation = op.type;
+        }
+    } else {
+        if (operation == op.type) {
+            fromcycle = min(fromcycle, op_start_cycle);
+        } else {
+            fromcycle = op_start_cycle;
+            tocycle = op_start_cycle + op.duration;
+            operation = op.type;
+        }
+    }
+}
+
 // A two-qubit flux gate must set the qubits it would detune to detuned, busy with a flux gate.
 // A one-qubit rotation gate must set its operand qubit to busy, busy with a rotation.
 void ccl_detuned_qubits_resource_t::reserve(
+    Vec<UInt> &state,
+    scheduling_direction_t direction,
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
-) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    auto gname = ins->name;
-    Bool is_flux = operation_type == "flux";
-    if (is_flux) {
+    const ccl_operation_t &op
+) const {
+    if (op.is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
             // single qubit flux operation does not reserve a detuned qubits resource
@@ -601,109 +582,158 @@ void ccl_detuned_qubits_resource_t::reserve(
             auto edge_no = qubitpair2edge.at(aqpair);
 
             for (auto &q : edge_detunes_qubits.get(edge_no)) {
-                if (direction == forward_scheduling) {
-                    if (operations[q] == operation_type) {
-                        tocycle[q] = max(tocycle[q], op_start_cycle + operation_duration);
-                        QL_DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                    } else {
-                        fromcycle[q] = op_start_cycle;
-                        tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
-                        QL_DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                    }
-                } else {
-                    if (operations[q] == operation_type) {
-                        fromcycle[q] = min(fromcycle[q], op_start_cycle);
-                        QL_DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                    } else {
-                        fromcycle[q] = op_start_cycle;
-                        tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
-                        QL_DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                    }
-                }
-                QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " detunes qubit: " << q << " reserved from cycle: " << fromcycle[q] << " till cycle: " << tocycle[q] << " for operation: " << ins->name);
+                reserve_detuned_qubit(state[index(FROM, q)], state[index(TO, q)], state[index(OPERATION, q)], direction, op_start_cycle, op);
+                QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " detunes qubit: " << q << " reserved from cycle: " << state[index(FROM, q)] << " till cycle: " << state[index(TO, q)] << " for operation: " << ins->name);
             }
         } else {
             QL_FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
         }
     }
-    Bool is_mw = operation_type == "mw";
-    if (is_mw) {
+    if (op.is_mw) {
         for (auto q : ins->operands) {
-            if (direction == forward_scheduling) {
-                if (operations[q] == operation_type) {
-                    tocycle[q] = max(tocycle[q], op_start_cycle + operation_duration);
-                    QL_DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                } else {
-                    fromcycle[q] = op_start_cycle;
-                    tocycle[q] = op_start_cycle + operation_duration;
-                    operations[q] = operation_type;
-                    QL_DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                }
-            } else {
-                if (operations[q] == operation_type) {
-                    fromcycle[q] = min(fromcycle[q], op_start_cycle);
-                    QL_DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                } else {
-                    fromcycle[q] = op_start_cycle;
-                    tocycle[q] = op_start_cycle + operation_duration;
-                    operations[q] = operation_type;
-                    QL_DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                }
-            }
-            QL_DOUT("... reserved " << name << ". op_start_cycle: " << op_start_cycle << " for qubit: " << q << " reserved from cycle: " << fromcycle[q] << " till cycle: " << tocycle[q] << " for operation: " << ins->name);
+            reserve_detuned_qubit(state[index(FROM, q)], state[index(TO, q)], state[index(OPERATION, q)], direction, op_start_cycle, op);
+            QL_DOUT("... reserved " << name << ". op_start_cycle: " << op_start_cycle << " for qubit: " << q << " reserved from cycle: " << state[index(FROM, q)] << " till cycle: " << state[index(TO, q)] << " for operation: " << ins->name);
         }
     }
 }
 
+// numbers the given string in the given numbering, starting at 1, so that 0 is no operation
+static UInt number_of(Map<Str, UInt> &numbers, const Str &s) {
+    auto it = numbers.find(s);
+    if (it != numbers.end()) {
+        return it->second;
+    }
+    UInt n = numbers.size() + 1;
+    numbers.set(s) = n;
+    return n;
+}
+
 // Allocate those resources that were specified in the config file.
 // Those that are not specified, are not allocatd, so are not used in scheduling/mapping.
 // The resource names tested below correspond to the names of the resources sections in the config file.
-cc_light_resource_manager_t::cc_light_resource_manager_t(
-    const quantum_platform &platform,
-    scheduling_direction_t dir
-) :
-    platform_resource_manager_t(platform, dir)
-{
-    QL_DOUT("Constructing (platform,dir) parameterized platform_resource_manager_t");
-    QL_DOUT("New one for direction " << dir << " with no of resources : " << platform.resources.size() );
+ccl_resources_t::ccl_resources_t(const quantum_platform &platform) : state_size(0) {
+    QL_DOUT("New one with no of resources : " << platform.resources.size() );
     for (auto it = platform.resources.cbegin(); it != platform.resources.cend(); ++it) {
         // COUT(it.key() << " : " << it.value() << "\n");
         Str n = it.key();
 
         // DOUT("... about to create " << n << " resource");
         if (n == "qubits") {
-            resource_t * ares = new ccl_qubit_resource_t(platform, dir);
-            resource_ptrs.push_back( ares );
+            qubits.reset(new ccl_qubit_resource_t(platform, state_size));
         } else if (n == "qwgs") {
-            resource_t * ares = new ccl_qwg_resource_t(platform, dir);
-            resource_ptrs.push_back( ares );
+            qwgs.reset(new ccl_qwg_resource_t(platform, state_size));
         } else if (n == "meas_units") {
-            resource_t * ares = new ccl_meas_resource_t(platform, dir);
-            resource_ptrs.push_back( ares );
+            meas_units.reset(new ccl_meas_resource_t(platform, state_size));
         } else if (n == "edges") {
-            resource_t * ares = new ccl_edge_resource_t(platform, dir);
-            resource_ptrs.push_back( ares );
+            edges.reset(new ccl_edge_resource_t(platform, state_size));
         } else if (n == "detuned_qubits") {
-            resource_t * ares = new ccl_detuned_qubits_resource_t(platform, dir);
-            resource_ptrs.push_back( ares );
+            detuned_qubits.reset(new ccl_detuned_qubits_resource_t(platform, state_size));
         } else {
             QL_FATAL("Error : Un-modelled resource, i.e. resource not supported by implementation: '" << n << "'");
         }
     }
+
+    // number the operation types and names of the instructions, as ccl_get_operation_type
+    // and ccl_get_operation_name would find them, so that they can be compared as numbers
+    Map<Str, UInt> types;
+    Map<Str, UInt> names;
+    mw_type = number_of(types, "mw");
+    flux_type = number_of(types, "flux");
+    readout_type = number_of(types, "readout");
+    for (auto it = platform.instruction_settings.cbegin(); it != platform.instruction_settings.cend(); ++it) {
+        const Json &settings = it.value();
+        Str operation_type("cc_light_type");
+        if (settings.count("type") > 0 && !settings["type"].is_null()) {
+            operation_type = settings["type"].get<Str>();
+        }
+        Str operation_name(it.key());
+        if (settings.count("cc_light_instr") > 0 && !settings["cc_light_instr"].is_null()) {
+            operation_name = settings["cc_light_instr"].get<Str>();
+        }
+        instructions.set(it.key()) = {number_of(types, operation_type), number_of(names, operation_name)};
+    }
+}
+
+ccl_operation_t ccl_resources_t::get_operation(gate *ins, const quantum_platform &platform) const {
+    auto it = instructions.find(ins->name);
+    if (it == instructions.end()) {
+        QL_JSON_ASSERT(platform.instruction_settings, ins->name, ins->name);
+        QL_FATAL("instruction '" << ins->name << "' was added to the platform after its resources were described");
+    }
+    ccl_operation_t op;
+    op.duration = ccl_get_operation_duration(ins, platform);
+    op.type = it->second.type;
+    op.name = it->second.name;
+    op.is_mw = op.type == mw_type;
+    op.is_flux = op.type == flux_type;
+    op.is_readout = op.type == readout_type;
+    return op;
+}
+
+cc_light_resource_manager_t::cc_light_resource_manager_t(
+    const quantum_platform &platform,
+    scheduling_direction_t dir
+) :
+    platform_resource_manager_t(platform, dir),
+    resources(std::make_shared<const ccl_resources_t>(platform)),
+    direction(dir),
+    state(resources->state_size)
+{
+    QL_DOUT("Constructing (platform,dir) parameterized platform_resource_manager_t");
+    QL_DOUT("New one for direction " << dir << " with state of " << state.size() << " cycles and operations");
+    if (resources->qubits) resources->qubits->init(state, dir);
+    if (resources->qwgs) resources->qwgs->init(state, dir);
+    if (resources->meas_units) resources->meas_units->init(state, dir);
+    if (resources->edges) resources->edges->init(state, dir);
+    if (resources->detuned_qubits) resources->detuned_qubits->init(state, dir);
     // DOUT("Done constructing inited platform_resource_manager_t");
 }
 
 cc_light_resource_manager_t *cc_light_resource_manager_t::clone() const & {
-    QL_DOUT("Cloning/copying cc_light_resource_manager_t");
+    // DOUT("Cloning/copying cc_light_resource_manager_t");
     return new cc_light_resource_manager_t(*this);
 }
 
 cc_light_resource_manager_t *cc_light_resource_manager_t::clone() && {
-    QL_DOUT("Cloning/moving cc_light_resource_manager_t");
+    // DOUT("Cloning/moving cc_light_resource_manager_t");
     return new cc_light_resource_manager_t(std::move(*this));
 }
 
+Bool cc_light_resource_manager_t::available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) const {
+    // DOUT("checking availability of resources for: " << ins->qasm());
+    if (state.empty()) {
+        return true;
+    }
+    ccl_operation_t op = resources->get_operation(ins, platform);
+    const ccl_resources_t &r = *resources;
+    return (!r.qubits || r.qubits->available(state, direction, op_start_cycle, ins, op))
+        && (!r.qwgs || r.qwgs->available(state, direction, op_start_cycle, ins, op))
+        && (!r.meas_units || r.meas_units->available(state, direction, op_start_cycle, ins, op))
+        && (!r.edges || r.edges->available(state, direction, op_start_cycle, ins, op))
+        && (!r.detuned_qubits || r.detuned_qubits->available(state, direction, op_start_cycle, ins, op));
+}
+
+void cc_light_resource_manager_t::reserve(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    // DOUT("reserving resources for: " << ins->qasm());
+    if (state.empty()) {
+        return;
+    }
+    ccl_operation_t op = resources->get_operation(ins, platform);
+    const ccl_resources_t &r = *resources;
+    if (r.qubits) r.qubits->reserve(state, direction, op_start_cycle, ins, op);
+    if (r.qwgs) r.qwgs->reserve(state, direction, op_start_cycle, ins, op);
+    if (r.meas_units) r.meas_units->reserve(state, direction, op_start_cycle, ins, op);
+    if (r.edges) r.edges->reserve(state, direction, op_start_cycle, ins, op);
+    if (r.detuned_qubits) r.detuned_qubits->reserve(state, direction, op_start_cycle, ins, op);
+}
+
 } // namespace arch
 } // namespace ql
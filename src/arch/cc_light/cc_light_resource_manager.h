@@ -5,10 +5,12 @@
 #pragma once
 
 #include <fstream>
+#include <memory>
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/pair.h"
 #include "utils/vec.h"
+#include "utils/map.h"
 #include "utils/json.h"
 #include "resource_manager.h"
 
@@ -30,66 +32,97 @@ utils::Str ccl_get_operation_type(gate *ins, const quantum_platform &platform);
 utils::Str ccl_get_operation_name(gate *ins, const quantum_platform &platform);
 
 
+// ============ properties of an operation that the resources depend on
+
+// looked up once per available() and reserve() call from the constant tables of the resource manager;
+// the operation names and types are numbered so that the states of the resources can record them,
+// with 0 for no operation
+struct ccl_operation_t {
+    utils::UInt duration;   // in cycles
+    utils::UInt type;       // number of the operation type
+    utils::UInt name;       // number of the operation name
+    utils::Bool is_mw;
+    utils::Bool is_flux;
+    utils::Bool is_readout;
+};
+
+
 // ============ classes of resources that _may_ appear in a configuration file
 // these are a superset of those allocated by the cc_light_resource_manager_t constructor below
+//
+// Each class holds the constant description of the resource, taken from the configuration file,
+// and the rules to check and reserve it. The state of the resource, i.e. the cycles from and to which
+// its elements are busy and with what operation, is kept by the resource manager in a single vector,
+// of which each resource occupies `arrays` arrays of `count` elements starting at index `offset`.
+
+class ccl_resource_t {
+public:
+    utils::Str name;
+    utils::UInt count;
+    utils::UInt offset;
+
+    ccl_resource_t(const utils::Str &n, const quantum_platform &platform, utils::UInt &state_size, utils::UInt arrays);
+
+    // index in the state of element i of the given array of the resource
+    utils::UInt index(utils::UInt array, utils::UInt i) const;
+};
 
 // Each qubit can be used by only one gate at a time.
-class ccl_qubit_resource_t : public resource_t {
+class ccl_qubit_resource_t : public ccl_resource_t {
 public:
+    // state: one array busy with
     // fwd: qubit q is busy till cycle=state[q], i.e. all cycles < state[q] it is busy, i.e. start_cycle must be >= state[q]
     // bwd: qubit q is busy from cycle=state[q], i.e. all cycles >= state[q] it is busy, i.e. start_cycle+duration must be <= state[q]
-    utils::Vec<utils::UInt> state;
+    static const utils::UInt BUSY = 0;
 
-    ccl_qubit_resource_t(const quantum_platform &platform, scheduling_direction_t dir);
+    ccl_qubit_resource_t(const quantum_platform &platform, utils::UInt &state_size);
 
-    ccl_qubit_resource_t *clone() const & override;
-    ccl_qubit_resource_t *clone() && override;
-
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    void init(utils::Vec<utils::UInt> &state, scheduling_direction_t dir) const;
+    utils::Bool available(const utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
+    void reserve(utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
 };
 
 // Single-qubit rotation gates (instructions of 'mw' type) are controlled by qwgs.
 // Each qwg controls a private set of qubits.
 // A qwg can control multiple qubits at the same time, but only when they perform the same gate and start at the same time.
-class ccl_qwg_resource_t : public resource_t {
+class ccl_qwg_resource_t : public ccl_resource_t {
 public:
-    utils::Vec<utils::UInt> fromcycle;          // qwg is busy from cycle==fromcycle[qwg], inclusive
-    utils::Vec<utils::UInt> tocycle;            // qwg is busy to cycle==tocycle[qwg], not inclusive
+    // state: qwg is busy from cycle==FROM[qwg], inclusive, to cycle==TO[qwg], not inclusive,
+    // with operation_name==OPERATION[qwg]
+    static const utils::UInt FROM = 0;
+    static const utils::UInt TO = 1;
+    static const utils::UInt OPERATION = 2;
 
     // there was a bug here: when qwg is busy from cycle i with operation x
     // then a new x is ok when starting at i or later
     // but a new y must wait until the last x has finished;
     // the bug was that a new x was always ok (so also when starting earlier than cycle i)
 
-    utils::Vec<utils::Str> operations;    // with operation_name==operations[qwg]
     utils::Map<utils::UInt,utils::UInt> qubit2qwg;      // on qwg==qubit2qwg[q]
 
-    ccl_qwg_resource_t(const quantum_platform & platform, scheduling_direction_t dir);
-
-    ccl_qwg_resource_t *clone() const & override;
-    ccl_qwg_resource_t *clone() && override;
+    ccl_qwg_resource_t(const quantum_platform &platform, utils::UInt &state_size);
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    void init(utils::Vec<utils::UInt> &state, scheduling_direction_t dir) const;
+    utils::Bool available(const utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
+    void reserve(utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
 };
 
 // Single-qubit measurements (instructions of 'readout' type) are controlled by measurement units.
 // Each one controls a private set of qubits.
 // A measurement unit can control multiple qubits at the same time, but only when they start at the same time.
-class ccl_meas_resource_t : public resource_t {
+class ccl_meas_resource_t : public ccl_resource_t {
 public:
-    utils::Vec<utils::UInt> fromcycle;  // last measurement start cycle
-    utils::Vec<utils::UInt> tocycle;    // is busy till cycle
-    utils::Map<utils::UInt,utils::UInt> qubit2meas;
+    // state: last measurement start cycle FROM[meas], busy till cycle TO[meas]
+    static const utils::UInt FROM = 0;
+    static const utils::UInt TO = 1;
 
-    ccl_meas_resource_t(const quantum_platform & platform, scheduling_direction_t dir);
+    utils::Map<utils::UInt,utils::UInt> qubit2meas;
 
-    ccl_meas_resource_t *clone() const & override;
-    ccl_meas_resource_t *clone() && override;
+    ccl_meas_resource_t(const quantum_platform &platform, utils::UInt &state_size);
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    void init(utils::Vec<utils::UInt> &state, scheduling_direction_t dir) const;
+    utils::Bool available(const utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
+    void reserve(utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
 };
 
 // Two-qubit flux gates only operate on neighboring qubits, i.e. qubits connected by an edge.
@@ -101,23 +134,23 @@ public:
 // A parked qubit cannot engage in any gate, so also not a two-qubit gate.
 // As a consequence, for each edge executing a two-qubit gate,
 // certain other edges cannot execute a two-qubit gate in parallel.
-class ccl_edge_resource_t : public resource_t
+class ccl_edge_resource_t : public ccl_resource_t
 {
 public:
+    // state: one array busy with
     // fwd: edge is busy till cycle=state[edge], i.e. all cycles < state[edge] it is busy, i.e. start_cycle must be >= state[edge]
     // bwd: edge is busy from cycle=state[edge], i.e. all cycles >= state[edge] it is busy, i.e. start_cycle+duration must be <= state[edge]
-    utils::Vec<utils::UInt> state;                          // machine state recording the cycles that given edge is free/busy
+    static const utils::UInt BUSY = 0;
+
     typedef utils::Pair<utils::UInt, utils::UInt> qubits_pair_t;
     utils::Map<qubits_pair_t, utils::UInt> qubits2edge;      // constant helper table to find edge between a pair of qubits
     utils::Map<utils::UInt, utils::Vec<utils::UInt>> edge2edges;  // constant "edges" table from configuration file
 
-    ccl_edge_resource_t(const quantum_platform &platform, scheduling_direction_t dir);
-
-    ccl_edge_resource_t *clone() const & override;
-    ccl_edge_resource_t *clone() && override;
+    ccl_edge_resource_t(const quantum_platform &platform, utils::UInt &state_size);
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate * ins, const quantum_platform & platform) override;
+    void init(utils::Vec<utils::UInt> &state, scheduling_direction_t dir) const;
+    utils::Bool available(const utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
+    void reserve(utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
 };
 
 // A two-qubit flux gate lowers the frequency of its source qubit to get near the freq of its target qubit.
@@ -135,38 +168,69 @@ public:
 // A one-qubit rotation gate must set its operand qubit to busy, busy with a rotation.
 //
 // The resource state machine maintains:
-// - fromcycle[q]: qubit q is busy from cycle fromcycle[q]
-// - tocycle[q]: to cycle tocycle[q] with an operation of the current operation type ...
-// - operations[q]: a "flux" or a "mw" (note: "" is initial value different from these two)
-// The fromcycle and tocycle are needed since a qubit can be busy with multiple "flux"s (i.e. being the detuned qubit for several "flux"s),
-// so the second, third, etc. of these "flux"s can be scheduled in parallel to the first but not earlier than fromcycle[q],
+// - FROM[q]: qubit q is busy from cycle FROM[q]
+// - TO[q]: to cycle TO[q] with an operation of the current operation type ...
+// - OPERATION[q]: a "flux" or a "mw" (note: 0, no operation, is initial value different from these two)
+// The FROM and TO are needed since a qubit can be busy with multiple "flux"s (i.e. being the detuned qubit for several "flux"s),
+// so the second, third, etc. of these "flux"s can be scheduled in parallel to the first but not earlier than FROM[q],
 // since till that cycle is was likely to be busy with "mw", which doesn't allow a "flux" in parallel. Similar for backward scheduling.
 // The other members contain internal copies of the resource description and grid configuration of the json file.
-class ccl_detuned_qubits_resource_t : public resource_t {
+class ccl_detuned_qubits_resource_t : public ccl_resource_t {
 public:
-    utils::Vec<utils::UInt> fromcycle;                              // qubit q is busy from cycle fromcycle[q]
-    utils::Vec<utils::UInt> tocycle;                                // till cycle tocycle[q]
-    utils::Vec<utils::Str> operations;                        // with an operation of operation_type==operations[q]
+    static const utils::UInt FROM = 0;
+    static const utils::UInt TO = 1;
+    static const utils::UInt OPERATION = 2;
 
     typedef utils::Pair<utils::UInt, utils::UInt> qubits_pair_t;
     utils::Map<qubits_pair_t, utils::UInt> qubitpair2edge;           // map: pair of qubits to edge (from grid configuration)
     utils::Map<utils::UInt, utils::Vec<utils::UInt>> edge_detunes_qubits; // map: edge to vector of qubits that edge detunes (resource desc.)
 
-    ccl_detuned_qubits_resource_t(const quantum_platform &platform, scheduling_direction_t dir);
+    ccl_detuned_qubits_resource_t(const quantum_platform &platform, utils::UInt &state_size);
 
-    ccl_detuned_qubits_resource_t *clone() const & override;
-    ccl_detuned_qubits_resource_t *clone() && override;
+    void init(utils::Vec<utils::UInt> &state, scheduling_direction_t dir) const;
+    utils::Bool available(const utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
+    void reserve(utils::Vec<utils::UInt> &state, scheduling_direction_t dir, utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op) const;
+};
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+// Constant description of the resources specified in the config file, with the numbering of the
+// operation names and types of its instructions; it is created with the resource manager and shared by all its copies.
+// Those resources that are not specified, are not allocated, so are not used in scheduling/mapping.
+class ccl_resources_t {
+public:
+    std::unique_ptr<ccl_qubit_resource_t> qubits;
+    std::unique_ptr<ccl_qwg_resource_t> qwgs;
+    std::unique_ptr<ccl_meas_resource_t> meas_units;
+    std::unique_ptr<ccl_edge_resource_t> edges;
+    std::unique_ptr<ccl_detuned_qubits_resource_t> detuned_qubits;
+    utils::UInt state_size;
+
+    // type and name numbers of the operation of each instruction of instruction_settings
+    struct instruction_t {
+        utils::UInt type;
+        utils::UInt name;
+    };
+    utils::Map<utils::Str, instruction_t> instructions;
+    utils::UInt mw_type;
+    utils::UInt flux_type;
+    utils::UInt readout_type;
+
+    explicit ccl_resources_t(const quantum_platform &platform);
+
+    ccl_operation_t get_operation(gate *ins, const quantum_platform &platform) const;
 };
 
 // ============ platform specific resource_manager matching config file resources sections with resource classes above
 // each config file resources section must have a resource class above
 // not all resource classes above need to be actually used and specified in a config file; only those specified, are used
+//
+// a copy shares the constant description of the resources and copies their state, a single vector
 
 class cc_light_resource_manager_t : public platform_resource_manager_t {
 public:
+    std::shared_ptr<const ccl_resources_t> resources;
+    scheduling_direction_t direction;
+    utils::Vec<utils::UInt> state;
+
     cc_light_resource_manager_t() = default;
 
     // Allocate those resources that were specified in the config file.
@@ -176,6 +240,9 @@ public:
 
     cc_light_resource_manager_t *clone() const & override;
     cc_light_resource_manager_t *clone() && override;
+
+    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) const override;
+    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
 };
 
 } // namespace arch
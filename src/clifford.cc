@@ -4,7 +4,9 @@
 
 #include "clifford.h"
 
+#include <mutex>
 #include "utils/num.h"
+#include "utils/map.h"
 #include "circuit.h"
 #include "report.h"
 #include "kernel.h"
@@ -17,6 +19,16 @@ using namespace utils;
 class Clifford {
 public:
 
+    ~Clifford() {
+        for (auto &qubit_templates : templates) {
+            for (auto &tmpl : qubit_templates) {
+                for (auto gp : tmpl.gates) {
+                    delete gp;
+                }
+            }
+        }
+    }
+
     void clifford_optimize_kernel(
         quantum_kernel &kernel,
         const quantum_platform &platform,
@@ -26,15 +38,20 @@ public:
 
         nq = kernel.qubit_count;
         ct = kernel.cycle_time;
+        track_frames = options::get("clifford_twoqubit_frames") == "yes";
         QL_DOUT("Clifford " << passname << " on kernel " << kernel.name << " ...");
 
-        // copy circuit kernel.c to take input from;
+        // move circuit kernel.c out to take input from;
         // output will fill kernel.c again
-        circuit input_circuit = kernel.c;
-        kernel.c.clear();
+        circuit input_circuit;
+        input_circuit.swap(kernel.c);
+        kernel.c.reserve(input_circuit.size());
 
-        cliffstate.resize(nq, 0);       // 0 is identity; for all qubits accumulated state is set to identity
-        cliffcycles.resize(nq, 0);      // for all qubits, no accumulated cycles
+        cliffstate.assign(nq, 0);       // 0 is identity; for all qubits accumulated state is set to identity
+        cliffcycles.assign(nq, 0);      // for all qubits, no accumulated cycles
+        if (templates.size() < nq) {
+            templates.resize(nq, Vec<clifford_template_t>(24));
+        }
         total_saved = 0;                // reset saved, just for reporting
 
         /*
@@ -48,12 +65,15 @@ public:
         reducing the number of cycles that the sequence takes, the circuit latency and the gate count.
 
         The clifford group is represented by:
-        - Int string2cs(Str gname): the clifford state of a gate with the given name; identity is 0
+        - Int string2cs(Str gname): the clifford state of a gate with the given name; identity is 0;
+          looked up in a table that is built once
         - a state diagram clifftrans[24][24] that represents for two given clifford (sequences),
           to which clifford the combination is equivalent to;
           so clifford(sequence1; sequence2) == clifftrans[clifford(sequence1)][clifford(sequence2)].
         - UInt cs2cycles(Int cs): the minimum number of cycles needed to implement a clifford of state cs
-        - void k.clifford(Int csq, UInt q): generates minimal clifford sequence for state csq and qubit q
+        - void k.clifford(Int csq, UInt q): generates minimal clifford sequence for state csq and qubit q;
+          this resolves the gates of the sequence through the platform, so it is only called the first time
+          a state is generated for a qubit, after which the result is kept as a template and copied
 
         Therefore, maintain for each qubit q while scanning:
         - cliffstate[q]:    clifford state of sequence until now per qubit; initially identity
@@ -70,6 +90,13 @@ public:
         - those affecting a single qubit but not being a clifford: push out state for that qubit, clearing it
         - those affecting a single qubit and being a conditional gate: push out state for that qubit, clearing it
         - remaining case is a single qubit clifford: add it to the state
+
+        With option clifford_twoqubit_frames, a cz or cnot doesn't necessarily end the sequences of its qubits:
+        when the accumulated cliffords of both qubits, moved to after the two-qubit gate,
+        again form a clifford per qubit (i.e. the two-qubit gate conjugates the one frame into another),
+        and this doesn't make the pending sequences longer, the two-qubit gate is output right away
+        and accumulation continues with the conjugated frame.
+        The conjugation is looked up in a table of all 24x24 frames per two-qubit gate, built once.
         */
         for (auto gp : input_circuit) {
             QL_DOUT("... gate: " << gp->qasm());
@@ -81,6 +108,9 @@ public:
                 // sync all qubits: create gate sequences corresponding to what was accumulated in cliffstate, for all qubits
                 sync_all(kernel);
                 kernel.c.push_back(gp);
+            } else if (track_frames && push_through(kernel, gp)) {
+                // cz/cnot output before the accumulated cliffords of its operands
+                QL_DOUT("... frame moved through " << gp->qasm());
             } else if (gp->operands.size() != 1) {                 // gates like CNOT/CZ/TOFFOLI
                 // sync particular qubits: create gate sequences corresponding to what was accumulated in cliffstate, for those particular operand qubits
                 for (auto q : gp->operands) {
@@ -119,11 +149,93 @@ public:
     }
 
 private:
+    /**
+     * The gates generated by k.clifford() for a clifford state and qubit;
+     * valid is false until they have been generated once.
+     */
+    struct clifford_template_t {
+        Bool valid = false;
+        Bool copyable = true;
+        Vec<gate*> gates;
+    };
+
     UInt nq;
     UInt ct;
+    Bool track_frames;
     Vec<Int> cliffstate; // current accumulated clifford state per qubit
     Vec<UInt> cliffcycles; // current accumulated clifford cycles per qubit
     UInt total_saved; // total number of cycles saved per kernel
+    Vec<Vec<clifford_template_t>> templates; // [qubit][state] gates to output for clifford state on qubit
+
+    // output the gate sequence for clifford state csq on qubit q
+    void generate(quantum_kernel &k, Int csq, UInt q) {
+        auto &tmpl = templates[q][csq];
+        if (tmpl.valid && tmpl.copyable) {
+            for (auto gp : tmpl.gates) {
+                k.c.push_back(copy_gate(gp));
+            }
+            k.cycles_valid = false;
+            return;
+        }
+        UInt start = k.c.size();
+        k.clifford(csq, q);          // generates clifford(csq) in kernel.c
+        if (!tmpl.valid) {
+            tmpl.valid = true;
+            for (UInt i = start; i < k.c.size() && tmpl.copyable; i++) {
+                gate *copy = copy_gate(k.c[i]);
+                if (copy == nullptr) {
+                    tmpl.copyable = false;
+                } else {
+                    tmpl.gates.push_back(copy);
+                }
+            }
+        }
+    }
+
+    // if gp is a cz or cnot through which the accumulated cliffords of its operands can be moved
+    // without making them more expensive, output gp and replace the accumulated cliffords by the
+    // conjugated ones, and return true; otherwise return false
+    Bool push_through(quantum_kernel &k, gate *gp) {
+        if (
+            gp->operands.size() != 2
+            || gp->is_conditional()
+            || !gp->creg_operands.empty()
+            || !gp->breg_operands.empty()
+            || gp->operands[0] == gp->operands[1]
+        ) {
+            return false;
+        }
+        Str gname = gp->name;
+        UInt p = gname.find(' ');
+        if (p != Str::npos) {
+            gname = gname.substr(0, p);
+        }
+        const Int *table;
+        if (gname == "cz" || gname == "cphase") {
+            table = frame_table(false);
+        } else if (gname == "cnot") {
+            table = frame_table(true);
+        } else {
+            return false;
+        }
+        UInt a = gp->operands[0];
+        UInt b = gp->operands[1];
+        Int result = table[cliffstate[a] * 24 + cliffstate[b]];
+        if (result < 0) {
+            return false;
+        }
+        Int csa = result / 24;
+        Int csb = result % 24;
+        if (cs2cycles(csa) + cs2cycles(csb) > cs2cycles(cliffstate[a]) + cs2cycles(cliffstate[b])) {
+            return false;
+        }
+        QL_DOUT("... q[" << a << "],q[" << b << "]: from " << cs2string(cliffstate[a]) << "," << cs2string(cliffstate[b])
+                         << " to " << cs2string(csa) << "," << cs2string(csb));
+        cliffstate[a] = csa;
+        cliffstate[b] = csb;
+        k.c.push_back(gp);
+        return true;
+    }
 
     // create gate sequences for all accumulated cliffords, output them and reset state
     void sync_all(quantum_kernel &k) {
@@ -139,7 +251,7 @@ private:
         Int csq = cliffstate[q];
         if (csq != 0) {
             QL_DOUT("... sync q[" << q << "]: generating clifford " << cs2string(csq));
-            k.clifford(csq, q);          // generates clifford(csq) in kernel.c
+            generate(k, csq, q);
             UInt  acc_cycles = cliffcycles[q];
             UInt  ins_cycles = cs2cycles(csq);
             QL_DOUT("... qubit q[" << q << "]: accumulated: " << acc_cycles << ", inserted: " << ins_cycles);
@@ -181,29 +293,196 @@ private:
 
     // find the clifford state from identity to given clifford gate by name
     static Int string2cs(const Str &gname) {
-        if (gname == "identity")         return 0;
-        else if (gname == "i")           return 0;
-        else if (gname == "pauli_x")     return 3;
-        else if (gname == "x")           return 3;
-        else if (gname == "rx180")       return 3;
-        else if (gname == "pauli_y")     return 6;
-        else if (gname == "y")           return 6;
-        else if (gname == "ry180")       return 6;
-        else if (gname == "pauli_z")     return 9;
-        else if (gname == "z")           return 9;
-        else if (gname == "hadamard")    return 12;
-        else if (gname == "h")           return 12;
-        else if (gname == "xm90")        return 13;
-        else if (gname == "mrx90")       return 13;
-        else if (gname == "s")           return 14;
-        else if (gname == "ym90")        return 15;
-        else if (gname == "mry90")       return 15;
-        else if (gname == "x90")         return 16;
-        else if (gname == "rx90")        return 16;
-        else if (gname == "y90")         return 21;
-        else if (gname == "ry90")        return 21;
-        else if (gname == "sdag")        return 23;
-        else return -1;
+        static const Map<Str, Int> name2cs = {
+            {"identity", 0},
+            {"i", 0},
+            {"pauli_x", 3},
+            {"x", 3},
+            {"rx180", 3},
+            {"pauli_y", 6},
+            {"y", 6},
+            {"ry180", 6},
+            {"pauli_z", 9},
+            {"z", 9},
+            {"hadamard", 12},
+            {"h", 12},
+            {"xm90", 13},
+            {"mrx90", 13},
+            {"s", 14},
+            {"ym90", 15},
+            {"mry90", 15},
+            {"x90", 16},
+            {"rx90", 16},
+            {"y90", 21},
+            {"ry90", 21},
+            {"sdag", 23}
+        };
+        auto it = name2cs.find(gname);
+        if (it == name2cs.end()) {
+            return -1;
+        }
+        return it->second;
+    }
+
+    // the 2x2 matrix of the gate sequence that k.clifford() generates for clifford state cs
+    static cmat_t cs2mat(Int cs) {
+        enum { X90, MX90, X180, Y90, MY90, Y180, END };
+        static const Int sequences[24][4] = {
+            { END },
+            { Y90, X90, END },
+            { MX90, MY90, END },
+            { X180, END },
+            { MY90, MX90, END },
+            { X90, MY90, END },
+            { Y180, END },
+            { MY90, X90, END },
+            { X90, Y90, END },
+            { X180, Y180, END },
+            { Y90, MX90, END },
+            { MX90, Y90, END },
+            { Y90, X180, END },
+            { MX90, END },
+            { X90, MY90, MX90, END },
+            { MY90, END },
+            { X90, END },
+            { X90, Y90, X90, END },
+            { MY90, X180, END },
+            { X90, Y180, END },
+            { X90, MY90, X90, END },
+            { Y90, END },
+            { MX90, Y180, END },
+            { X90, Y90, MX90, END }
+        };
+        cmat_t result(identity_c);
+        for (UInt i = 0; sequences[cs][i] != END; i++) {
+            Int g = sequences[cs][i];
+            Real angle = (g == X180 || g == Y180) ? M_PI : (g == MX90 || g == MY90) ? -M_PI / 2 : M_PI / 2;
+            Complex c = std::cos(angle / 2);
+            Complex s = std::sin(angle / 2);
+            cmat_t m;
+            if (g == X90 || g == MX90 || g == X180) {
+                m.m[0] = c; m.m[1] = Complex(0, -1) * s; m.m[2] = Complex(0, -1) * s; m.m[3] = c;
+            } else {
+                m.m[0] = c; m.m[1] = -s; m.m[2] = s; m.m[3] = c;
+            }
+            cmat_t r;
+            for (UInt row = 0; row < 2; row++) {
+                for (UInt col = 0; col < 2; col++) {
+                    r.m[row*2 + col] = m.m[row*2] * result.m[col] + m.m[row*2 + 1] * result.m[2 + col];
+                }
+            }
+            result = r;
+        }
+        return result;
+    }
+
+    // index of the clifford state whose matrix equals m up to global phase, or -1
+    static Int mat2cs(const cmat_t &m) {
+        for (Int cs = 0; cs < 24; cs++) {
+            cmat_t c = cs2mat(cs);
+            // m equals c up to phase iff m.c^dagger is a multiple of the identity
+            Complex d[4];
+            for (UInt row = 0; row < 2; row++) {
+                for (UInt col = 0; col < 2; col++) {
+                    d[row*2 + col] = m.m[row*2] * std::conj(c.m[col*2]) + m.m[row*2 + 1] * std::conj(c.m[col*2 + 1]);
+                }
+            }
+            if (std::abs(d[1]) < 1e-6 && std::abs(d[2]) < 1e-6 && std::abs(d[0] - d[3]) < 1e-6 && std::abs(d[0]) > 1e-6) {
+                return cs;
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * Conjugation table of the frames (pairs of clifford states on the two operands, the first operand
+     * being the most significant qubit) through cz (cnot false) or cnot (cnot true):
+     * table[csa * 24 + csb] is csa' * 24 + csb' such that gate . (csa x csb) == (csa' x csb') . gate,
+     * or -1 when the conjugated frame is not a product of single-qubit cliffords.
+     */
+    static const Int *frame_table(Bool cnot) {
+        static Int tables[2][24 * 24];
+        static std::once_flag once;
+        std::call_once(once, [] {
+            for (UInt t = 0; t < 2; t++) {
+                for (Int csa = 0; csa < 24; csa++) {
+                    for (Int csb = 0; csb < 24; csb++) {
+                        tables[t][csa * 24 + csb] = conjugate_frame(t == 1, csa, csb);
+                    }
+                }
+            }
+        });
+        return tables[cnot ? 1 : 0];
+    }
+
+    static Int conjugate_frame(Bool cnot, Int csa, Int csb) {
+        cmat_t ma = cs2mat(csa);
+        cmat_t mb = cs2mat(csb);
+
+        // frame f = ma x mb, indexed by 2 * (bit of a) + (bit of b)
+        Complex f[4][4];
+        for (UInt i = 0; i < 2; i++) for (UInt k = 0; k < 2; k++) {
+            for (UInt j = 0; j < 2; j++) for (UInt l = 0; l < 2; l++) {
+                f[i*2 + k][j*2 + l] = ma.m[i*2 + j] * mb.m[k*2 + l];
+            }
+        }
+
+        // gate g is a real symmetric permutation times signs and its own inverse, so g f g^dagger = g f g;
+        // apply it as a map of basis states with sign
+        UInt perm[4];
+        Real sign[4];
+        for (UInt x = 0; x < 4; x++) {
+            perm[x] = (cnot && (x & 2)) ? x ^ 1 : x;
+            sign[x] = (!cnot && x == 3) ? -1.0 : 1.0;
+        }
+        Complex h[4][4];
+        for (UInt r = 0; r < 4; r++) {
+            for (UInt c = 0; c < 4; c++) {
+                h[perm[r]][perm[c]] = sign[r] * f[r][c] * sign[c];
+            }
+        }
+
+        // factor h as a' x b' using its largest element
+        UInt br = 0, bc = 0;
+        for (UInt r = 0; r < 4; r++) {
+            for (UInt c = 0; c < 4; c++) {
+                if (std::abs(h[r][c]) > std::abs(h[br][bc])) {
+                    br = r;
+                    bc = c;
+                }
+            }
+        }
+        cmat_t fa, fb;
+        for (UInt i = 0; i < 2; i++) {
+            for (UInt j = 0; j < 2; j++) {
+                fa.m[i*2 + j] = h[i*2 + (br & 1)][j*2 + (bc & 1)];
+                fb.m[i*2 + j] = h[(br & 2) + i][(bc & 2) + j];
+            }
+        }
+        Int csa2 = mat2cs(fa);
+        Int csb2 = mat2cs(fb);
+        if (csa2 < 0 || csb2 < 0) {
+            return -1;
+        }
+
+        // check that h is indeed the product, up to global phase
+        cmat_t pa = cs2mat(csa2);
+        cmat_t pb = cs2mat(csb2);
+        Complex phase = 0;
+        for (UInt i = 0; i < 2; i++) for (UInt k = 0; k < 2; k++) {
+            for (UInt j = 0; j < 2; j++) for (UInt l = 0; l < 2; l++) {
+                phase += std::conj(pa.m[i*2 + j] * pb.m[k*2 + l]) * h[i*2 + k][j*2 + l];
+            }
+        }
+        phase /= 4.0;
+        for (UInt i = 0; i < 2; i++) for (UInt k = 0; k < 2; k++) {
+            for (UInt j = 0; j < 2; j++) for (UInt l = 0; l < 2; l++) {
+                if (std::abs(phase * pa.m[i*2 + j] * pb.m[k*2 + l] - h[i*2 + k][j*2 + l]) > 1e-6) {
+                    return -1;
+                }
+            }
+        }
+        return csa2 * 24 + csb2;
     }
 
     // find the duration of the gate sequence corresponding to given clifford state
@@ -5,6 +5,12 @@
 #include "compiler.h"
 
 #include <iostream>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
+#include "utils/map.h"
 #include "options.h"
 
 namespace ql {
@@ -20,12 +26,20 @@ quantum_compiler::quantum_compiler(const Str &n) : name(n) {
     constructPassManager();
 }
 
+/**
+ * @brief   Compiler destructor
+ */
+quantum_compiler::~quantum_compiler() {
+    delete passManager;
+}
+
 /**
  * @brief   Compiles the program passed as parameter
  * @param   quantum_program   Object reference to the program to be compiled
  */
 void quantum_compiler::compile(quantum_program *program) {
     QL_DOUT("Compiler compiles program ");
+    program->invalidate_kernel_index();
     passManager->compile(program);
 }
 
@@ -48,6 +62,51 @@ void quantum_compiler::addPass(const Str &realPassName) {
     passManager->addPassNamed(realPassName, realPassName);
 }
 
+/**
+ * @brief   Adds the passes of the default compilation pipeline, as used by
+ *          quantum_program::compile_modular(), for the given backend
+ * @param   eqasm_compiler_name Name of the eqasm compiler of the platform
+ */
+void quantum_compiler::addDefaultPasses(const Str &eqasm_compiler_name) {
+    ///@note-rn: WriterPass needs Reader pass to recreate the subciruits! ==> However, then Reader needs to be used to recreate the subcircuits. However, if I do that tests will fail because the harddware configuration file is in synq with qasm reader and tests (error: unrecognized instr prepz)
+    addPass("Writer", "initialqasmwriter");
+    addPass("RotationOptimizer", "rotation_optimize");
+    addPass("DecomposeToffoli", "decompose_toffoli");
+    addPass("CliffordOptimize", "clifford_prescheduler");
+    addPass("Scheduler", "prescheduler");
+    addPass("CliffordOptimize", "clifford_postscheduler");
+    addPass("Writer", "scheduledqasmwriter");
+
+    // backend passes
+    QL_DOUT("Calling backend compiler passes for eqasm_compiler_name: " << eqasm_compiler_name);
+    if (eqasm_compiler_name.empty()) {
+        QL_FATAL("eqasm compiler name must be specified in the hardware configuration file !");
+    } else if (eqasm_compiler_name == "none" || eqasm_compiler_name == "qx") {
+        QL_WOUT("The eqasm compiler attribute indicated that no backend passes are needed.");
+    } else if (eqasm_compiler_name == "cc_light_compiler") {
+        // from here CCL backend starts
+        addPass("CCLPrepCodeGeneration", "ccl_prep_code_generation");
+        addPass("CCLDecomposePreSchedule", "ccl_decompose_pre_schedule");
+        addPass("WriteQuantumSim", "write_quantumsim_script_unmapped");
+        addPass("CliffordOptimize", "clifford_premapper");
+        addPass("Map", "mapper");
+        addPass("CliffordOptimize", "clifford_postmapper");
+        addPass("RCSchedule", "rcscheduler");
+        addPass("CCLPostSchedule", "ccl_post_schedule");
+        addPass("WriteQuantumSim", "write_quantumsim_script_mapped");
+        addPass("Writer", "lastqasmwriter");
+        addPass("QisaCodeGeneration", "qisa_code_generation");
+        ///@note-rn: Calling the backend like this is equivalend to calling passes individually as above.
+        //addPass("BackendCompiler");
+        //setPassOption("BackendCompiler", "eqasm_compiler_name", eqasm_compiler_name);
+    } else if (eqasm_compiler_name == "eqasm_backend_cc") {
+        addPass("BackendCompiler");
+        setPassOption("BackendCompiler", "eqasm_compiler_name", "eqasm_backend_cc");
+    } else {
+        QL_FATAL("the '" << eqasm_compiler_name << "' eqasm compiler backend is not suported !");
+    }
+}
+
 /**
  * @brief   Sets a pass option
  * @param   passName String name of the pass
@@ -70,14 +129,82 @@ void quantum_compiler::setPassOption(
     }
 }
 
+/**
+ * @brief   Returns the pass profile of the last compilation
+ * @return  JSON object as documented in pass_profiler.h
+ */
+const Json &quantum_compiler::getPassProfile() const {
+    return passManager->getPassProfile();
+}
+
 /**
  * @brief   Constructs the sequence of compiler passes
  */
 void quantum_compiler::constructPassManager() {
     QL_DOUT("Construct the passManager");
-    passManager = new PassManager("empty");
+    passManager = new PassManager(name);
 
     assert(passManager);
 }
 
+Vec<Json> compile_many(const Vec<quantum_program*> &programs, UInt num_threads) {
+    for (const quantum_program *program : programs) {
+        if (program->kernels.empty()) {
+            QL_FATAL("compiling a program with no kernels !");
+        }
+    }
+    if (num_threads == 0) {
+        num_threads = std::max<UInt>(1, std::thread::hardware_concurrency());
+    }
+    num_threads = std::max<UInt>(1, std::min<UInt>(num_threads, programs.size()));
+    QL_IOUT("compiling " << programs.size() << " programs on " << num_threads << " threads ...");
+
+    Vec<Json> profiles(programs.size());
+    Vec<std::exception_ptr> errors(programs.size());
+    std::atomic<UInt> next(0);
+    std::atomic<Bool> failed(false);
+
+    // each worker takes the next program that is not taken yet, so the
+    // programs are spread over the workers whatever their sizes
+    auto worker = [&]() {
+        Map<Str, std::unique_ptr<quantum_compiler>> compilers;
+        while (!failed) {
+            UInt i = next++;
+            if (i >= programs.size()) {
+                break;
+            }
+            quantum_program *program = programs[i];
+            try {
+                auto &compiler = compilers.set(program->eqasm_compiler_name);
+                if (!compiler) {
+                    compiler.reset(new quantum_compiler("Hard Coded Compiler"));
+                    compiler->addDefaultPasses(program->eqasm_compiler_name);
+                }
+                compiler->compile(program);
+                profiles[i] = compiler->getPassProfile();
+                QL_IOUT("compilation of program '" << program->name << "' done.");
+            } catch (...) {
+                errors[i] = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    Vec<std::future<void>> futures;
+    for (UInt t = 1; t < num_threads; t++) {
+        futures.push_back(std::async(std::launch::async, worker));
+    }
+    worker();
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return profiles;
+}
+
 } // namespace ql
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "utils/str.h"
+#include "utils/json.h"
+#include "utils/vec.h"
 #include "program.h"
 #include "passmanager.h"
 
@@ -17,11 +19,16 @@ class quantum_compiler {
 public:
 
     quantum_compiler(const utils::Str &name);
+    quantum_compiler(const quantum_compiler &) = delete;
+    quantum_compiler &operator=(const quantum_compiler &) = delete;
+    ~quantum_compiler();
 
     void compile(quantum_program*);
+    void addDefaultPasses(const utils::Str &eqasm_compiler_name);
     void addPass(const utils::Str &realPassName, const utils::Str &symbolicPassName);
     void addPass(const utils::Str &realPassName);
     void setPassOption(const utils::Str &passName, const utils::Str &optionName, const utils::Str &optionValue);
+    const utils::Json &getPassProfile() const;
 
 private:
 
@@ -31,4 +38,16 @@ private:
     PassManager *passManager;
 };
 
+/**
+ * Compiles the given programs with the default pass pipeline, as
+ * compile_modular() would, on up to num_threads threads (0 for the number of
+ * hardware threads). Each thread builds the pipeline for a backend once and
+ * reuses it, with the state the passes keep between programs, for all the
+ * programs with that backend that it compiles. Returns the pass profile of
+ * each program, in the order of the programs. If compiling a program fails,
+ * no new programs are started and the error of the first failing program is
+ * rethrown once the others are done.
+ */
+utils::Vec<utils::Json> compile_many(const utils::Vec<quantum_program*> &programs, utils::UInt num_threads = 1);
+
 } // namespace ql
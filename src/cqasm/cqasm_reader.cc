@@ -4,7 +4,13 @@
 
 #include "cqasm_reader.h"
 
+#include <fstream>
+#include <algorithm>
 #include "utils/tree.h"
+#include "utils/list.h"
+#include "utils/map.h"
+#include "utils/trace.h"
+#include "options.h"
 #include "platform.h"
 #include "kernel.h"
 #include "program.h"
@@ -80,6 +86,35 @@ static Real convert_angle(Real angle, AngleConversionMethod method) {
     }
 }
 
+/**
+ * Operand of a cQASM instruction as parsed by the fast-path reader, which does
+ * not construct a libqasm semantic tree (see ReaderImpl::fast_path()).
+ */
+struct FastOperand {
+
+    /**
+     * The libqasm type code of the operand: Q for qubit references, B for bit
+     * references, i for integer literals, or r for real literals.
+     */
+    char type;
+
+    /**
+     * The indices for qubit and bit references.
+     */
+    Vec<UInt> indices;
+
+    /**
+     * The value of integer literals.
+     */
+    Int int_value;
+
+    /**
+     * The value of real literals.
+     */
+    Real real_value;
+
+};
+
 /**
  * Interface class for parsing an OpenQL parameter (qubit, creg, breg, duration,
  * or angle) from the cQASM argument list.
@@ -94,6 +129,11 @@ public:
      * gates).
      */
     virtual T get(const lqt::Any<lqv::Node> &operands, UInt sgmq_index) const = 0;
+
+    /**
+     * Same as above, for operands parsed by the fast-path reader.
+     */
+    virtual T get(const Vec<FastOperand> &operands, UInt sgmq_index) const = 0;
 };
 
 /**
@@ -116,6 +156,12 @@ public:
         (void)sgmq_index;
         return value;
     }
+
+    T get(const Vec<FastOperand> &operands, UInt sgmq_index) const override {
+        (void)operands;
+        (void)sgmq_index;
+        return value;
+    }
 };
 
 /**
@@ -165,6 +211,15 @@ public:
             throw Exception("unexpected operand type at " + location(*operands[index]));
         }
     }
+
+    UInt get(const Vec<FastOperand> &operands, UInt sgmq_index) const override {
+        const auto &op = operands[index];
+        if (op.type == 'i') {
+            return itou(op.int_value);
+        } else {
+            return op.indices[sgmq_index];
+        }
+    }
 };
 
 /**
@@ -188,13 +243,19 @@ public:
         Real val;
         if (auto i = operands[index]->as_const_int()) {
             val = i->value;
-        } else if (auto r = operands[index]->as_const_int()) {
+        } else if (auto r = operands[index]->as_const_real()) {
             val = r->value;
         } else {
             throw Exception("expected a real number at " + location(*operands[index]));
         }
         return convert_angle(val, method);
     }
+
+    Real get(const Vec<FastOperand> &operands, UInt sgmq_index) const override {
+        (void)sgmq_index;
+        const auto &op = operands[index];
+        return convert_angle(op.type == 'i' ? op.int_value : op.real_value, method);
+    }
 };
 
 /**
@@ -214,6 +275,13 @@ public:
      */
     lqi::Instruction cq_insn;
 
+    /**
+     * The name and parameter typespec of the cQASM instruction, as used by the
+     * fast-path reader to resolve instructions without libqasm.
+     */
+    Str cq_name;
+    Str cq_params;
+
     /**
      * The name of the gate in OpenQL.
      */
@@ -300,6 +368,8 @@ private:
         const Str &params
     ) :
         cq_insn(name, params),
+        cq_name(name),
+        cq_params(params),
         ql_name(name),
         ql_all_qubits(false),
         ql_all_cregs(false),
@@ -716,6 +786,202 @@ static lqv::Value op_lxor_bb(const lqv::Values &v) {
     return retval;
 }
 
+/**
+ * Minimal tokenizer for a single line of cQASM, used by the fast-path reader.
+ * Every function that fails to recognize what it's looking for returns false,
+ * in which case the line is to be handled by libqasm instead. Whitespace and
+ * comments are skipped before every token.
+ */
+class FastScanner {
+private:
+    const char *ptr;
+    const char *end;
+
+    /**
+     * Skips spaces, tabs, carriage returns, and comments.
+     */
+    void skip_space() {
+        while (ptr < end) {
+            if (*ptr == ' ' || *ptr == '\t' || *ptr == '\r') {
+                ptr++;
+            } else if (*ptr == '#') {
+                ptr = end;
+            } else {
+                break;
+            }
+        }
+    }
+
+    /**
+     * Scans a decimal integer literal without sign. The number of digits is
+     * limited such that the value can't overflow.
+     */
+    Bool digits(UInt &value) {
+        const char *start = ptr;
+        value = 0;
+        while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+            value = value * 10 + (*ptr++ - '0');
+        }
+        return ptr > start && ptr - start <= 18;
+    }
+
+public:
+
+    /**
+     * Creates a scanner for the given range of characters.
+     */
+    FastScanner(const char *begin, const char *end) : ptr(begin), end(end) {}
+
+    /**
+     * Returns whether only whitespace and comments are left.
+     */
+    Bool at_end() {
+        skip_space();
+        return ptr == end;
+    }
+
+    /**
+     * Consumes the given character if it is next.
+     */
+    Bool accept(char c) {
+        skip_space();
+        if (ptr < end && *ptr == c) {
+            ptr++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Returns whether the given character is next, without consuming it.
+     */
+    Bool peek(char c) {
+        skip_space();
+        return ptr < end && *ptr == c;
+    }
+
+    /**
+     * Scans an identifier. Identifiers with uppercase characters are only
+     * accepted if allow_upper is set, because cQASM keywords and instruction
+     * names are case-insensitive, and we leave the associated corner cases to
+     * libqasm.
+     */
+    Bool identifier(Str &ident, Bool allow_upper = false) {
+        skip_space();
+        const char *start = ptr;
+        while (ptr < end) {
+            char c = *ptr;
+            if ((c >= 'a' && c <= 'z') || c == '_' || (ptr > start && c >= '0' && c <= '9')) {
+                ptr++;
+            } else if (allow_upper && c >= 'A' && c <= 'Z') {
+                ptr++;
+            } else {
+                break;
+            }
+        }
+        if (ptr == start) {
+            return false;
+        }
+        ident.assign(start, ptr);
+        return true;
+    }
+
+    /**
+     * Scans an unsigned decimal integer literal.
+     */
+    Bool uint_literal(UInt &value) {
+        skip_space();
+        return digits(value);
+    }
+
+    /**
+     * Scans the version number following the version keyword.
+     */
+    Bool version(Str &version) {
+        skip_space();
+        const char *start = ptr;
+        while (ptr < end && ((*ptr >= '0' && *ptr <= '9') || *ptr == '.')) {
+            ptr++;
+        }
+        version.assign(start, ptr);
+        return ptr > start;
+    }
+
+    /**
+     * Scans an integer or real literal, optionally preceded by a minus sign.
+     * Reals must have digits before the period; anything else is left to
+     * libqasm.
+     */
+    Bool number(FastOperand &op) {
+        skip_space();
+        const char *start = ptr;
+        Bool negative = false;
+        if (ptr < end && *ptr == '-') {
+            negative = true;
+            ptr++;
+        }
+        UInt value;
+        if (!digits(value)) {
+            return false;
+        }
+        if (ptr < end && (*ptr == '.' || *ptr == 'e' || *ptr == 'E')) {
+            if (*ptr == '.') {
+                ptr++;
+                while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+                    ptr++;
+                }
+            }
+            if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+                ptr++;
+                if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+                    ptr++;
+                }
+                UInt exponent;
+                if (!digits(exponent)) {
+                    return false;
+                }
+            }
+            op.type = 'r';
+            op.real_value = std::strtod(Str(start, ptr).c_str(), nullptr);
+        } else {
+            op.type = 'i';
+            op.int_value = negative ? -(Int)value : (Int)value;
+        }
+        return true;
+    }
+
+    /**
+     * Scans the index list of a qubit or bit reference, including the square
+     * brackets, appending the indices to the given vector. Indices must be
+     * less than the given limit.
+     */
+    Bool index_list(Vec<UInt> &indices, UInt limit) {
+        if (!accept('[')) {
+            return false;
+        }
+        do {
+            UInt first, last;
+            if (!uint_literal(first)) {
+                return false;
+            }
+            last = first;
+            if (accept(':')) {
+                if (!uint_literal(last) || last < first) {
+                    return false;
+                }
+            }
+            if (last >= limit) {
+                return false;
+            }
+            for (UInt index = first; index <= last; index++) {
+                indices.push_back(index);
+            }
+        } while (accept(','));
+        return accept(']');
+    }
+
+};
+
 /**
  * Private implementation for the opaque public Reader class; as in it's not in
  * public headers, reducing compile time.
@@ -741,18 +1007,36 @@ private:
      */
     Vec<typename GateConversionRule::Ptr> gateset;
 
+    /**
+     * The gateset indexed by cQASM instruction name, for the fast-path reader.
+     * Built when first needed.
+     */
+    Map<Str, Vec<typename GateConversionRule::Ptr>> fast_gateset;
+
+    /**
+     * Operand list of the instruction currently being parsed by the fast-path
+     * reader. This is reused between instructions to avoid allocations; only
+     * the first fast_operand_count entries are valid.
+     */
+    Vec<FastOperand> fast_operands;
+    UInt fast_operand_count;
+
+    /**
+     * Scratch space for checking qubit reuse in the fast-path reader.
+     */
+    Vec<UInt> fast_qubits;
+
     /**
      * Number of subcircuits added using this reader.
      */
     UInt subcircuit_count;
 
     /**
-     * Builds a libqasm Analyzer for the configured gateset. If no gateset is
-     * configured (i.e. gateset is empty), then backward-compatible defaults are
-     * inserted.
+     * If no gateset is configured (i.e. gateset is empty), inserts
+     * backward-compatible defaults.
      */
-    lqa::Analyzer build_analyzer() {
-        
+    void add_default_gateset() {
+
         // If no gateset has been specified yet, add a default one for backward
         // compatibility purposes. This default emulates the behavior of the
         // convertor from before it was configurable.
@@ -824,7 +1108,17 @@ private:
             gateset.back()->cq_insn.allow_conditional = false;
             gateset.back()->cq_insn.allow_parallel = false;
         }
-        
+
+    }
+
+    /**
+     * Builds a libqasm Analyzer for the configured gateset. If no gateset is
+     * configured (i.e. gateset is empty), then backward-compatible defaults are
+     * inserted.
+     */
+    lqa::Analyzer build_analyzer() {
+        add_default_gateset();
+
         // Construct the actual analyzer.
         auto a = lqa::Analyzer("1.1");
         a.register_default_functions_and_mappings();
@@ -839,6 +1133,135 @@ private:
         return a;
     }
 
+    /**
+     * Increases the qubit, creg, and breg counts of the program to at least the
+     * given values.
+     */
+    void update_program_counts(UInt num_qubits, UInt num_cregs, UInt num_bregs) {
+        if (num_qubits > program.qubit_count) {
+            QL_IOUT("increasing program qubit count from " << program.qubit_count << " to " << num_qubits);
+            program.qubit_count = num_qubits;
+        }
+        if (num_cregs > program.creg_count) {
+            QL_IOUT("increasing program creg count from " << program.creg_count << " to " << num_cregs);
+            program.creg_count = num_cregs;
+        }
+        if (num_bregs > program.breg_count) {
+            QL_IOUT("increasing program breg count from " << program.breg_count << " to " << num_bregs);
+            program.breg_count = num_bregs;
+        }
+    }
+
+    /**
+     * Adds the OpenQL gate(s) for a single cQASM instruction to the given
+     * kernel, using the given conversion rule, and assigns the given cycle
+     * number to them. num_gates tracks the number of gates in the kernel that
+     * have been assigned a cycle, and cycles_might_be_valid is cleared when
+     * the instruction expanded into more than one gate. Operands is either a
+     * libqasm operand list or a fast-path reader operand list.
+     */
+    template <class Operands>
+    static void add_gates(
+        quantum_kernel &kernel,
+        const GateConversionRule &gcr,
+        const Operands &operands,
+        UInt sgmq_count,
+        cond_type_t cond,
+        const Vec<UInt> &cond_bregs,
+        UInt cycle,
+        UInt &num_gates,
+        Bool &cycles_might_be_valid
+    ) {
+
+        // Loop over the single-gate-multiple-qubit instances of the
+        // instruction and add an OpenQL gate for each, as OpenQL does not
+        // support this abstraction.
+        for (UInt sgmq_index = 0; sgmq_index < sgmq_count; sgmq_index++) {
+
+            // Determine qubit argument list.
+            utils::Vec<utils::UInt> qubits;
+            for (const auto &arg : gcr.ql_qubits) {
+                qubits.push_back(arg->get(operands, sgmq_index));
+            }
+            if (gcr.ql_all_qubits) {
+                for (UInt qubit = 0; qubit < kernel.qubit_count; qubit++) {
+                    qubits.push_back(qubit);
+                }
+            }
+
+            // Determine creg argument list.
+            utils::Vec<utils::UInt> cregs;
+            for (const auto &arg : gcr.ql_cregs) {
+                cregs.push_back(arg->get(operands, sgmq_index));
+            }
+            if (gcr.ql_all_cregs) {
+                for (UInt creg = 0; creg < kernel.creg_count; creg++) {
+                    cregs.push_back(creg);
+                }
+            }
+
+            // Determine breg argument list.
+            utils::Vec<utils::UInt> bregs;
+            for (const auto &arg : gcr.ql_bregs) {
+                bregs.push_back(arg->get(operands, sgmq_index));
+            }
+            if (gcr.ql_all_bregs) {
+                for (UInt breg = 0; breg < kernel.breg_count; breg++) {
+                    cregs.push_back(breg);
+                }
+            }
+
+            // Determine duration and angle.
+            utils::UInt duration = gcr.ql_duration->get(operands, sgmq_index);
+            utils::Real angle = gcr.ql_angle->get(operands, sgmq_index);
+
+            // Handle gates with implicit single-gate-multiple-qubit behavior.
+            UInt impl_sgmq_count = gcr.implicit_sgmq ? qubits.size() : 1;
+            for (UInt impl_sgmq_index = 0; impl_sgmq_index < impl_sgmq_count; impl_sgmq_index++) {
+                utils::Vec<utils::UInt> cur_qubits;
+                if (gcr.implicit_sgmq) {
+                    cur_qubits = {qubits.at(impl_sgmq_index)};
+                } else {
+                    cur_qubits = qubits;
+                }
+
+                // Add implicit bregs if needed.
+                auto cur_bregs = bregs;
+                if (gcr.implicit_breg) {
+                    cur_bregs.insert(cur_bregs.cend(), cur_qubits.cbegin(), cur_qubits.cend());
+                }
+
+                // Add the gate to the kernel.
+                kernel.gate(gcr.ql_name, cur_qubits, cregs, duration, angle, bregs, cond, cond_bregs);
+
+                // If that added more than one gate, invalidate timing
+                // information.
+                if (kernel.c.size() > num_gates + 1) {
+                    cycles_might_be_valid = false;
+                }
+
+                // Set timing information for the added gates.
+                while (num_gates < kernel.c.size()) {
+                    kernel.c.at(num_gates++)->cycle = cycle;
+                }
+
+            }
+
+        }
+    }
+
+    /**
+     * Sets the cycles_valid flag of a kernel converted from cQASM.
+     */
+    static void set_cycles_valid(quantum_kernel &kernel, Bool cycles_might_be_valid) {
+        if (cycles_might_be_valid) {
+            QL_IOUT("cQASM schedule for kernel " << kernel.name << " *might* be valid");
+            kernel.cycles_valid = cycles_might_be_valid;
+        } else {
+            QL_IOUT("cQASM schedule for kernel " << kernel.name << " is invalid; kernel needs to be (re)scheduled");
+        }
+    }
+
     /**
      * Handles the parse result of string2circuit() and file2circuit().
      */
@@ -894,18 +1317,7 @@ private:
         if (num_qubits > platform.qubit_number) {
             throw Exception("cQASM file needs " + to_string(num_qubits) + " qubits, but platform only supports " + to_string(platform.qubit_number));
         }
-        if (num_qubits > program.qubit_count) {
-            QL_IOUT("increasing program qubit count from " << program.qubit_count << " to " << num_qubits);
-            program.qubit_count = num_qubits;
-        }
-        if (num_cregs > program.creg_count) {
-            QL_IOUT("increasing program creg count from " << program.creg_count << " to " << num_cregs);
-            program.creg_count = num_cregs;
-        }
-        if (num_bregs > program.breg_count) {
-            QL_IOUT("increasing program breg count from " << program.breg_count << " to " << num_bregs);
-            program.breg_count = num_bregs;
-        }
+        update_program_counts(num_qubits, num_cregs, num_bregs);
 
         // Add the subcircuits one by one.
         for (const auto &sc : ar.root->subcircuits) {
@@ -1033,82 +1445,11 @@ private:
                         sgmq_count = 1;
                     }
 
-                    // Loop over the single-gate-multiple-qubit instances of the
-                    // instruction and add an OpenQL gate for each, as OpenQL
-                    // does not support this abstraction.
-                    for (UInt sgmq_index = 0; sgmq_index < sgmq_count; sgmq_index++) {
-
-                        // Determine qubit argument list.
-                        utils::Vec<utils::UInt> qubits;
-                        for (const auto &arg : gcr->ql_qubits) {
-                            qubits.push_back(arg->get(insn->operands, sgmq_index));
-                        }
-                        if (gcr->ql_all_qubits) {
-                            for (UInt qubit = 0; qubit < num_qubits; qubit++) {
-                                qubits.push_back(qubit);
-                            }
-                        }
-
-                        // Determine creg argument list.
-                        utils::Vec<utils::UInt> cregs;
-                        for (const auto &arg : gcr->ql_cregs) {
-                            cregs.push_back(arg->get(insn->operands, sgmq_index));
-                        }
-                        if (gcr->ql_all_cregs) {
-                            for (UInt creg = 0; creg < num_cregs; creg++) {
-                                cregs.push_back(creg);
-                            }
-                        }
-
-                        // Determine breg argument list.
-                        utils::Vec<utils::UInt> bregs;
-                        for (const auto &arg : gcr->ql_bregs) {
-                            bregs.push_back(arg->get(insn->operands, sgmq_index));
-                        }
-                        if (gcr->ql_all_bregs) {
-                            for (UInt breg = 0; breg < num_bregs; breg++) {
-                                cregs.push_back(breg);
-                            }
-                        }
-
-                        // Determine duration and angle.
-                        utils::UInt duration = gcr->ql_duration->get(insn->operands, sgmq_index);
-                        utils::Real angle = gcr->ql_angle->get(insn->operands, sgmq_index);
-
-                        // Handle gates with implicit single-gate-multiple-qubit
-                        // behavior.
-                        UInt impl_sgmq_count = gcr->implicit_sgmq ? qubits.size() : 1;
-                        for (UInt impl_sgmq_index = 0; impl_sgmq_index < impl_sgmq_count; impl_sgmq_index++) {
-                            utils::Vec<utils::UInt> cur_qubits;
-                            if (gcr->implicit_sgmq) {
-                                cur_qubits = {qubits.at(impl_sgmq_index)};
-                            } else {
-                                cur_qubits = qubits;
-                            }
-
-                            // Add implicit bregs if needed.
-                            auto cur_bregs = bregs;
-                            if (gcr->implicit_breg) {
-                                cur_bregs.insert(cur_bregs.cend(), cur_qubits.cbegin(), cur_qubits.cend());
-                            }
-
-                            // Add the gate to the kernel.
-                            kernel.gate(gcr->ql_name, cur_qubits, cregs, duration, angle, bregs, cond, cond_bregs);
-
-                            // If that added more than one gate, invalidate
-                            // timing information.
-                            if (kernel.c.size() > num_gates + 1) {
-                                cycles_might_be_valid = false;
-                            }
-
-                            // Set timing information for the added gates.
-                            while (num_gates < kernel.c.size()) {
-                                kernel.c.at(num_gates++)->cycle = cycle;
-                            }
-
-                        }
-
-                    }
+                    // Add the OpenQL gates for the instruction.
+                    add_gates(
+                        kernel, *gcr, insn->operands, sgmq_count, cond, cond_bregs,
+                        cycle, num_gates, cycles_might_be_valid
+                    );
 
                 }
 
@@ -1119,12 +1460,7 @@ private:
             // Assume that the cycle times in the cQASM schedule are valid if
             // they pass sanity checks (the cQASM file may already have been
             // scheduled).
-            if (cycles_might_be_valid) {
-                QL_IOUT("cQASM schedule for kernel " << kernel.name << " *might* be valid");
-                kernel.cycles_valid = cycles_might_be_valid;
-            } else {
-                QL_IOUT("cQASM schedule for kernel " << kernel.name << " is invalid; kernel needs to be (re)scheduled");
-            }
+            set_cycles_valid(kernel, cycles_might_be_valid);
 
             // Append the kernel to program.
             if (sc->iterations > 1) {
@@ -1137,6 +1473,312 @@ private:
 
     }
 
+    /**
+     * Subcircuit converted by the fast-path reader. These are only added to
+     * the program once the complete input has been converted.
+     */
+    struct FastSubcircuit {
+        quantum_kernel kernel;
+        UInt iterations;
+        UInt cycle;
+        UInt num_gates;
+        Bool cycles_might_be_valid;
+    };
+
+    /**
+     * Builds the gateset index used by the fast-path reader, if it hasn't been
+     * built yet.
+     */
+    void build_fast_gateset() {
+        if (!fast_gateset.empty()) {
+            return;
+        }
+        add_default_gateset();
+        for (const auto &gcr : gateset) {
+            fast_gateset.set(gcr->cq_name).push_back(gcr);
+        }
+    }
+
+    /**
+     * Parses a single operand into the next entry of fast_operands. Only qubit
+     * and bit references using the legacy q[...] and b[...] notation, and
+     * integer and real literals are supported.
+     */
+    Bool fast_operand(FastScanner &scan, UInt num_qubits) {
+        if (fast_operand_count == fast_operands.size()) {
+            fast_operands.emplace_back();
+        }
+        auto &op = fast_operands[fast_operand_count++];
+        op.indices.clear();
+        Str ident;
+        if (scan.identifier(ident)) {
+            if (ident == "q") {
+                op.type = 'Q';
+            } else if (ident == "b") {
+                op.type = 'B';
+            } else {
+                return false;
+            }
+            return scan.index_list(op.indices, num_qubits);
+        }
+        return scan.number(op);
+    }
+
+    /**
+     * Parses a single instruction (without condition) into name and
+     * fast_operands, and resolves it to a conversion rule. The skip
+     * instruction is returned with a null rule. sgmq_count is set to the
+     * number of parallel gates described by single-gate-multiple-qubit
+     * notation.
+     */
+    Bool fast_instruction(
+        FastScanner &scan,
+        UInt num_qubits,
+        Str &name,
+        const GateConversionRule *&rule,
+        UInt &sgmq_count
+    ) {
+        if (!scan.identifier(name)) {
+            return false;
+        }
+        fast_operand_count = 0;
+        if (!scan.at_end() && !scan.peek('|') && !scan.peek('}')) {
+            do {
+                if (!fast_operand(scan, num_qubits)) {
+                    return false;
+                }
+            } while (scan.accept(','));
+        }
+
+        // Handle skip instructions.
+        if (name == "skip") {
+            rule = nullptr;
+            return fast_operand_count == 1 && fast_operands[0].type == 'i' && fast_operands[0].int_value >= 1;
+        }
+
+        // Resolve the instruction. Integer literals are promoted to reals
+        // where needed, like libqasm does. Ambiguous overloads are left to
+        // libqasm.
+        auto it = fast_gateset.find(name);
+        if (it == fast_gateset.end()) {
+            return false;
+        }
+        rule = nullptr;
+        for (const auto &gcr : it->second) {
+            const auto &params = gcr->cq_params;
+            if (params.size() != fast_operand_count) {
+                continue;
+            }
+            Bool match = true;
+            for (UInt idx = 0; idx < fast_operand_count; idx++) {
+                char type = fast_operands[idx].type;
+                if (params[idx] != type && !(params[idx] == 'r' && type == 'i')) {
+                    match = false;
+                    break;
+                }
+            }
+            if (match) {
+                if (rule) {
+                    return false;
+                }
+                rule = gcr.get();
+            }
+        }
+        if (!rule) {
+            return false;
+        }
+
+        // Determine the single-gate-multiple-qubit count, and check the
+        // restrictions of the instruction.
+        sgmq_count = 0;
+        fast_qubits.clear();
+        for (UInt idx = 0; idx < fast_operand_count; idx++) {
+            const auto &op = fast_operands[idx];
+            if (op.type != 'Q' && op.type != 'B') {
+                continue;
+            }
+            if (sgmq_count && op.indices.size() != sgmq_count) {
+                return false;
+            }
+            sgmq_count = op.indices.size();
+            if (op.type == 'Q') {
+                fast_qubits.insert(fast_qubits.end(), op.indices.begin(), op.indices.end());
+            }
+        }
+        if (!sgmq_count) {
+            sgmq_count = 1;
+        }
+        if (sgmq_count > 1 && !rule->cq_insn.allow_parallel) {
+            return false;
+        }
+        if (!rule->cq_insn.allow_reused_qubits) {
+            std::sort(fast_qubits.begin(), fast_qubits.end());
+            if (std::adjacent_find(fast_qubits.begin(), fast_qubits.end()) != fast_qubits.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Converts cQASM using the fast-path reader, which handles the subset of
+     * cQASM that most generated files use (version and qubits statements,
+     * subcircuits, bundles of unconditional instructions with literal and
+     * q[...]/b[...] operands, and skip) line by line, without building a
+     * libqasm semantic tree. The gates are added to the kernels through the
+     * same conversion rules as for the libqasm path, so the result is
+     * identical.
+     *
+     * next_line must be a function that reads the next line of the input into
+     * its Str argument, and returns false when there are no more lines. If
+     * anything outside of the supported subset is encountered, false is
+     * returned without modifying the program, and the input should be
+     * converted using libqasm instead. This includes invalid input, so error
+     * messages always come from libqasm.
+     */
+    template <class LineSource>
+    Bool fast_path(LineSource &&next_line) {
+        build_fast_gateset();
+
+        List<FastSubcircuit> subcircuits;
+        FastSubcircuit *sc = nullptr;
+        UInt sc_count = subcircuit_count;
+        Bool have_version = false;
+        UInt num_qubits = 0;
+        UInt num_bregs = platform.qubit_number;
+        Str line;
+        Str ident;
+        UInt line_nr = 0;
+
+        auto give_up = [&line_nr]() {
+            QL_IOUT("cQASM line " << line_nr << " not supported by the fast-path reader, using libqasm");
+            return false;
+        };
+
+        try {
+            while (next_line(line)) {
+                line_nr++;
+                FastScanner scan(line.data(), line.data() + line.size());
+                if (scan.at_end()) {
+                    continue;
+                }
+
+                // Handle the version and qubits statements, which must come
+                // first, in that order.
+                if (!have_version) {
+                    if (
+                        !scan.identifier(ident) || ident != "version" || !scan.version(ident)
+                        || (ident != "1" && ident != "1.0" && ident != "1.1") || !scan.at_end()
+                    ) {
+                        return give_up();
+                    }
+                    have_version = true;
+                    continue;
+                }
+                if (!num_qubits) {
+                    if (
+                        !scan.identifier(ident) || ident != "qubits" || !scan.uint_literal(num_qubits)
+                        || !num_qubits || num_qubits > platform.qubit_number || !scan.at_end()
+                    ) {
+                        return give_up();
+                    }
+                    continue;
+                }
+
+                // Handle subcircuit headers.
+                if (scan.accept('.')) {
+                    UInt iterations = 1;
+                    if (!scan.identifier(ident, true)) {
+                        return give_up();
+                    }
+                    if (scan.accept('(')) {
+                        if (!scan.uint_literal(iterations) || !iterations || !scan.accept(')')) {
+                            return give_up();
+                        }
+                    }
+                    if (!scan.at_end()) {
+                        return give_up();
+                    }
+                    subcircuits.push_back({
+                        quantum_kernel(
+                            ident + "_" + to_string(sc_count++),
+                            platform, num_qubits, 0, num_bregs
+                        ),
+                        iterations, 1, 0, true
+                    });
+                    sc = &subcircuits.back();
+                    continue;
+                }
+
+                // Instructions before the first subcircuit header go into a
+                // nameless subcircuit.
+                if (!sc) {
+                    subcircuits.push_back({
+                        quantum_kernel("_" + to_string(sc_count++), platform, num_qubits, 0, num_bregs),
+                        1, 1, 0, true
+                    });
+                    sc = &subcircuits.back();
+                }
+
+                // Handle a bundle, with or without braces.
+                Bool braces = scan.accept('{');
+                UInt bundle_size = 0;
+                Bool parallel_allowed = true;
+                do {
+                    const GateConversionRule *rule;
+                    UInt sgmq_count;
+                    if (!fast_instruction(scan, num_qubits, ident, rule, sgmq_count)) {
+                        return give_up();
+                    }
+                    bundle_size++;
+                    if (!rule) {
+                        if (bundle_size > 1 || scan.peek('|')) {
+                            return give_up();
+                        }
+                        sc->cycle += fast_operands[0].int_value;
+                        break;
+                    }
+                    parallel_allowed &= rule->cq_insn.allow_parallel;
+                    add_gates(
+                        sc->kernel, *rule, fast_operands, sgmq_count, cond_always, {},
+                        sc->cycle, sc->num_gates, sc->cycles_might_be_valid
+                    );
+                    if (scan.accept('|')) {
+                        continue;
+                    }
+                    sc->cycle++;
+                    break;
+                } while (true);
+                if ((braces && !scan.accept('}')) || !scan.at_end() || (bundle_size > 1 && !parallel_allowed)) {
+                    return give_up();
+                }
+
+            }
+        } catch (Exception &e) {
+            QL_IOUT("fast-path cQASM reader failed (" << e.what() << "), using libqasm");
+            return false;
+        }
+        if (!num_qubits) {
+            return give_up();
+        }
+
+        // The input was converted successfully, so commit the result to the
+        // program.
+        update_program_counts(num_qubits, 0, num_bregs);
+        for (auto &fsc : subcircuits) {
+            set_cycles_valid(fsc.kernel, fsc.cycles_might_be_valid);
+            if (fsc.iterations > 1) {
+                program.add_for(fsc.kernel, fsc.iterations);
+            } else {
+                program.add(fsc.kernel);
+            }
+        }
+        subcircuit_count = sc_count;
+        QL_TRACE("cqasm_reader.fast_path", line_nr);
+        QL_IOUT("converted " << line_nr << " lines of cQASM using the fast-path reader");
+        return true;
+    }
+
 public:
 
     /**
@@ -1149,6 +1791,10 @@ public:
         platform(platform),
         program(program),
         gateset(),
+        fast_gateset(),
+        fast_operands(),
+        fast_operand_count(0),
+        fast_qubits(),
         subcircuit_count(0)
     {}
 
@@ -1163,6 +1809,7 @@ public:
      */
     void load_gateset(const Json &json) {
         gateset.clear();
+        fast_gateset.clear();
         if (!json.is_array()) {
             throw Exception("cQASM gateset JSON should be an array at the top level");
         }
@@ -1177,6 +1824,24 @@ public:
      * kernels to the selected OpenQL program.
      */
     void string2circuit(const utils::Str &cqasm_str) {
+        if (options::get("cqasm_fast_path") == "yes") {
+            UInt pos = 0;
+            auto next_line = [&cqasm_str, &pos](Str &line) {
+                if (pos >= cqasm_str.size()) {
+                    return false;
+                }
+                auto eol = cqasm_str.find('\n', pos);
+                if (eol == Str::npos) {
+                    eol = cqasm_str.size();
+                }
+                line.assign(cqasm_str, pos, eol - pos);
+                pos = eol + 1;
+                return true;
+            };
+            if (fast_path(next_line)) {
+                return;
+            }
+        }
         handle_parse_result(build_analyzer().analyze_string(cqasm_str));
     }
 
@@ -1186,6 +1851,15 @@ public:
      * kernels to the selected OpenQL program.
      */
     void file2circuit(const utils::Str &cqasm_fname) {
+        if (options::get("cqasm_fast_path") == "yes") {
+            std::ifstream file(cqasm_fname);
+            auto next_line = [&file](Str &line) {
+                return (Bool)std::getline(file, line);
+            };
+            if (file && fast_path(next_line)) {
+                return;
+            }
+        }
         handle_parse_result(build_analyzer().analyze(cqasm_fname));
     }
 
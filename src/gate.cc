@@ -7,6 +7,7 @@
 #include <cctype>
 #include "utils/num.h"
 #include "utils/str.h"
+#include "classical.h"
 
 namespace ql {
 
@@ -809,4 +810,58 @@ cmat_t composite_gate::mat() const {
     return m;   // FIXME: never initialized
 }
 
+/**
+ * Returns a copy of the given gate with all its attributes, or nullptr when the
+ * gate is of a type that cannot be copied this way.
+ */
+gate *copy_gate(const gate *gp) {
+    switch (gp->type()) {
+        case __custom_gate__: {
+            // the custom_gate copy constructor only copies the definition
+            auto orig = dynamic_cast<const custom_gate*>(gp);
+            if (orig == nullptr) {
+                return nullptr;
+            }
+            auto g = new custom_gate(*orig);
+            g->operands = orig->operands;
+            g->breg_operands = orig->breg_operands;
+            g->cond_operands = orig->cond_operands;
+            g->condition = orig->condition;
+            g->int_operand = orig->int_operand;
+            g->angle = orig->angle;
+            g->cycle = orig->cycle;
+            g->visual_type = orig->visual_type;
+            g->arch_operation_name = orig->arch_operation_name;
+            return g;
+        }
+        case __identity_gate__: return new identity(*dynamic_cast<const identity*>(gp));
+        case __hadamard_gate__: return new hadamard(*dynamic_cast<const hadamard*>(gp));
+        case __pauli_x_gate__:  return new pauli_x(*dynamic_cast<const pauli_x*>(gp));
+        case __pauli_y_gate__:  return new pauli_y(*dynamic_cast<const pauli_y*>(gp));
+        case __pauli_z_gate__:  return new pauli_z(*dynamic_cast<const pauli_z*>(gp));
+        case __phase_gate__:    return new phase(*dynamic_cast<const phase*>(gp));
+        case __phasedag_gate__: return new phasedag(*dynamic_cast<const phasedag*>(gp));
+        case __t_gate__:        return new t(*dynamic_cast<const t*>(gp));
+        case __tdag_gate__:     return new tdag(*dynamic_cast<const tdag*>(gp));
+        case __rx90_gate__:     return new rx90(*dynamic_cast<const rx90*>(gp));
+        case __mrx90_gate__:    return new mrx90(*dynamic_cast<const mrx90*>(gp));
+        case __rx180_gate__:    return new rx180(*dynamic_cast<const rx180*>(gp));
+        case __ry90_gate__:     return new ry90(*dynamic_cast<const ry90*>(gp));
+        case __mry90_gate__:    return new mry90(*dynamic_cast<const mry90*>(gp));
+        case __ry180_gate__:    return new ry180(*dynamic_cast<const ry180*>(gp));
+        case __rx_gate__:       return new rx(*dynamic_cast<const rx*>(gp));
+        case __ry_gate__:       return new ry(*dynamic_cast<const ry*>(gp));
+        case __rz_gate__:       return new rz(*dynamic_cast<const rz*>(gp));
+        case __prepz_gate__:    return new prepz(*dynamic_cast<const prepz*>(gp));
+        case __cnot_gate__:     return new cnot(*dynamic_cast<const cnot*>(gp));
+        case __cphase_gate__:   return new cphase(*dynamic_cast<const cphase*>(gp));
+        case __toffoli_gate__:  return new toffoli(*dynamic_cast<const toffoli*>(gp));
+        case __measure_gate__:  return new measure(*dynamic_cast<const measure*>(gp));
+        case __swap_gate__:     return new swap(*dynamic_cast<const swap*>(gp));
+        case __wait_gate__:     return new wait(*dynamic_cast<const wait*>(gp));
+        case __classical_gate__: return new classical(*dynamic_cast<const classical*>(gp));
+        default:                return nullptr;
+    }
+}
+
 } // namespace ql
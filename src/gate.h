@@ -122,8 +122,8 @@ const utils::Complex rx180_c[] = {
 };
 
 const utils::Complex ry180_c[] = {
-    0.0, -utils::IM,
-    -utils::IM, 0.0
+    0.0, -1.0,
+    1.0, 0.0
 };
 
 /**
@@ -506,4 +506,11 @@ public:
     cmat_t mat() const override;
 };
 
+/**
+ * Returns a copy of the given gate with all its attributes, or nullptr when the
+ * gate is of a type that cannot be copied this way (composite and special
+ * gates).
+ */
+gate *copy_gate(const gate *gp);
+
 } // namespace ql
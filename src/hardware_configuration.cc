@@ -55,7 +55,8 @@ void hardware_configuration::load(
     Json &hardware_settings,
     Json &resources,
     Json &topology,
-    Json &aliases
+    Json &aliases,
+    Json &qubit_attributes
 ) {
     Json config;
     try {
@@ -105,6 +106,11 @@ void hardware_configuration::load(
         topology = config["topology"];
     }
 
+    // load qubit attributes, optional
+    if (config.count("qubit_attributes") > 0) {
+        qubit_attributes = config["qubit_attributes"];
+    }
+
     // load instructions
     const Json &instructions = config["instructions"];
     static const std::regex comma_space_pattern("\\s*,\\s*");
@@ -28,7 +28,8 @@ public:
         utils::Json &hardware_settings,
         utils::Json &resources,
         utils::Json &topology,
-        utils::Json &aliases
+        utils::Json &aliases,
+        utils::Json &qubit_attributes
     );
 
 };
@@ -0,0 +1,270 @@
+/** \file
+ * Qubit interaction graph.
+ */
+
+#include "interaction_graph.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace ql {
+
+using namespace utils;
+
+static Bool is_interaction(const gate &g, const InteractionGraphOptions &options) {
+    switch (g.type()) {
+        case __wait_gate__:
+            if (!options.include_waits) {
+                return false;
+            }
+            break;
+        case __classical_gate__:
+        case __dummy_gate__:
+        case __display__:
+            return false;
+        default:
+            break;
+    }
+    if (options.two_qubit_gates_only) {
+        return g.operands.size() == 2;
+    }
+    return g.operands.size() > 1;
+}
+
+static Real get_gate_weight(const gate &g, const Map<Str, Real> &weights) {
+    if (weights.empty()) {
+        return 1;
+    }
+    auto it = weights.find(g.name);
+    if (it == weights.end()) {
+        it = weights.find(g.name.substr(0, g.name.find(' ')));
+    }
+    return it == weights.end() ? 1 : it->second;
+}
+
+// Calls handle for each gate of the circuit in the cycle window of the options,
+// in circuit order, until max_two_qubit_gates interactions have been handled.
+// Returns whether gates were left out at the end because of that limit.
+template <typename Handler>
+static Bool select_gates(const circuit &ckt, const InteractionGraphOptions &options, Handler handle) {
+    UInt two_qubit_gates = 0;
+    for (const gate *gp : ckt) {
+        if (options.max_two_qubit_gates != 0 && two_qubit_gates >= options.max_two_qubit_gates) {
+            return true;
+        }
+        if (gp->cycle < options.first_cycle || (options.end_cycle != MAX_CYCLE && gp->cycle >= options.end_cycle)) {
+            continue;
+        }
+        handle(*gp);
+        if (is_interaction(*gp, options)) {
+            two_qubit_gates++;
+        }
+    }
+    return false;
+}
+
+void InteractionGraph::add_gate(Vec<Entry> &entries, const gate &g, Real weight) {
+    const Vec<UInt> &q = g.operands;
+    for (UInt i = 0; i < q.size(); i++) {
+        for (UInt j = i + 1; j < q.size(); j++) {
+            if (q[i] != q[j]) {
+                entries.push_back({q[i], {q[j], 1, 1, weight}});
+                entries.push_back({q[j], {q[i], 1, 0, weight}});
+            }
+        }
+    }
+}
+
+// Sorts the entries by row and column, and sums the entries of the same edge
+// into the compressed rows; the entries are consumed.
+void InteractionGraph::build(Vec<Entry> &entries) {
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.row < b.row || (a.row == b.row && a.edge.qubit < b.edge.qubit);
+    });
+    edges.clear();
+    offsets.assign(qubit_count + 1, 0);
+    for (UInt e = 0; e < entries.size(); e++) {
+        const Entry &entry = entries[e];
+        if (e > 0 && entry.row == entries[e - 1].row && entry.edge.qubit == edges.back().qubit) {
+            edges.back().count += entry.edge.count;
+            edges.back().forward_count += entry.edge.forward_count;
+            edges.back().weight += entry.edge.weight;
+        } else {
+            edges.push_back(entry.edge);
+            offsets[entry.row + 1]++;
+        }
+    }
+    for (UInt q = 0; q < qubit_count; q++) {
+        offsets[q + 1] += offsets[q];
+    }
+    entries.clear();
+}
+
+InteractionGraph::InteractionGraph(UInt qubit_count) :
+    qubit_count(qubit_count),
+    offsets(qubit_count + 1, 0),
+    use_counts(qubit_count, 0),
+    gate_count(0),
+    truncated(false)
+{
+}
+
+InteractionGraph::InteractionGraph(
+    const circuit &ckt,
+    UInt qubit_count,
+    const InteractionGraphOptions &options
+) : InteractionGraph(qubit_count) {
+    Vec<Entry> entries;
+    truncated = select_gates(ckt, options, [&](const gate &g) {
+        for (auto q : g.operands) {
+            use_counts.at(q)++;
+        }
+        if (is_interaction(g, options)) {
+            add_gate(entries, g, get_gate_weight(g, options.weights));
+            gate_count++;
+        }
+    });
+    build(entries);
+}
+
+Vec<InteractionGraph> InteractionGraph::slices(
+    const circuit &ckt,
+    UInt qubit_count,
+    UInt cycles_per_slice,
+    const InteractionGraphOptions &options
+) {
+    if (cycles_per_slice == 0) {
+        QL_FATAL("Interaction graph slices must be at least one cycle long");
+    }
+    Vec<InteractionGraph> graphs;
+    Vec<Vec<Entry>> entries;
+    Bool truncated = select_gates(ckt, options, [&](const gate &g) {
+        if (g.cycle == MAX_CYCLE) {
+            QL_FATAL("Interaction graph slices need a scheduled circuit; gate " << g.qasm() << " has no cycle");
+        }
+        UInt slice = (g.cycle - options.first_cycle) / cycles_per_slice;
+        while (graphs.size() <= slice) {
+            graphs.emplace_back(qubit_count);
+            entries.emplace_back();
+        }
+        for (auto q : g.operands) {
+            graphs[slice].use_counts.at(q)++;
+        }
+        if (is_interaction(g, options)) {
+            add_gate(entries[slice], g, get_gate_weight(g, options.weights));
+            graphs[slice].gate_count++;
+        }
+    });
+    for (UInt slice = 0; slice < graphs.size(); slice++) {
+        graphs[slice].build(entries[slice]);
+    }
+    if (truncated && !graphs.empty()) {
+        graphs.back().truncated = true;
+    }
+    return graphs;
+}
+
+void InteractionGraph::add(const InteractionGraph &other) {
+    Vec<Entry> entries;
+    entries.reserve(edges.size() + other.edges.size());
+    auto collect = [&entries](const InteractionGraph &graph) {
+        for (UInt q = 0; q < graph.qubit_count; q++) {
+            for (const Edge &edge : graph.get_neighbors(q)) {
+                entries.push_back({q, edge});
+            }
+        }
+    };
+    collect(*this);
+    collect(other);
+    if (other.qubit_count > qubit_count) {
+        qubit_count = other.qubit_count;
+        use_counts.resize(qubit_count, 0);
+    }
+    for (UInt q = 0; q < other.qubit_count; q++) {
+        use_counts[q] += other.use_counts[q];
+    }
+    gate_count += other.gate_count;
+    truncated |= other.truncated;
+    build(entries);
+}
+
+UInt InteractionGraph::get_qubit_count() const {
+    return qubit_count;
+}
+
+UInt InteractionGraph::get_edge_count() const {
+    return edges.size() / 2;
+}
+
+UInt InteractionGraph::get_gate_count() const {
+    return gate_count;
+}
+
+UInt InteractionGraph::get_use_count(UInt qubit) const {
+    return use_counts.at(qubit);
+}
+
+Bool InteractionGraph::is_truncated() const {
+    return truncated;
+}
+
+InteractionGraph::Neighbors InteractionGraph::get_neighbors(UInt qubit) const {
+    QL_ASSERT(qubit < qubit_count);
+    return Neighbors(edges.data() + offsets[qubit], edges.data() + offsets[qubit + 1]);
+}
+
+const InteractionGraph::Edge *InteractionGraph::find_edge(UInt qubit, UInt other) const {
+    Neighbors neighbors = get_neighbors(qubit);
+    const Edge *edge = std::lower_bound(neighbors.begin(), neighbors.end(), other, [](const Edge &e, UInt q) {
+        return e.qubit < q;
+    });
+    return (edge != neighbors.end() && edge->qubit == other) ? edge : nullptr;
+}
+
+UInt InteractionGraph::get_count(UInt qubit, UInt other) const {
+    const Edge *edge = find_edge(qubit, other);
+    return edge ? edge->count : 0;
+}
+
+Real InteractionGraph::get_weight(UInt qubit, UInt other) const {
+    const Edge *edge = find_edge(qubit, other);
+    return edge ? edge->weight : 0;
+}
+
+Str InteractionGraph::get_matrix_string() const {
+    StrStrm ss;
+
+    // Use the following for properly aligned matrix print for visual inspection
+    // This can be problematic of width not set properly to be processed by gnuplot script
+#define ALIGNMENT (std::setw(4))
+
+    // Use the following to print tabs which will not be visually appealing but it will
+    // generate the columns properly for further processing by other tools
+    // #define ALIGNMENT ("    ")
+
+    ss << ALIGNMENT << " ";
+    for (UInt c = 0; c < qubit_count; c++) {
+        ss << ALIGNMENT << "q" + to_string(c);
+    }
+    ss << std::endl;
+
+    for (UInt p = 0; p < qubit_count; p++) {
+        ss << ALIGNMENT << "q" + to_string(p);
+        const Edge *edge = get_neighbors(p).begin();
+        const Edge *end = get_neighbors(p).end();
+        for (UInt c = 0; c < qubit_count; c++) {
+            UInt count = 0;
+            if (edge != end && edge->qubit == c) {
+                count = edge->count;
+                ++edge;
+            }
+            ss << ALIGNMENT << count;
+        }
+        ss << std::endl;
+    }
+#undef ALIGNMENT
+
+    return ss.str();
+}
+
+} // namespace ql
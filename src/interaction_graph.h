@@ -0,0 +1,128 @@
+/** \file
+ * Qubit interaction graph.
+ */
+
+#pragma once
+
+#include "utils/num.h"
+#include "utils/str.h"
+#include "utils/vec.h"
+#include "utils/map.h"
+#include "circuit.h"
+
+namespace ql {
+
+/**
+ * Selects the gates of a circuit that an InteractionGraph is built from, and
+ * what each of them weighs.
+ */
+struct InteractionGraphOptions {
+    // only take gates scheduled in cycles [first_cycle, end_cycle) into account;
+    // the default includes unscheduled gates, which have cycle MAX_CYCLE
+    utils::UInt first_cycle = 0;
+    utils::UInt end_cycle = MAX_CYCLE;
+
+    // stop after this many two-qubit gates have been taken into account; 0 means no limit
+    utils::UInt max_two_qubit_gates = 0;
+
+    // weight of the gates with the given name, or the given first word of
+    // their name (e.g. "cz" for "cz q0,q1"); other gates weigh 1
+    utils::Map<utils::Str, utils::Real> weights;
+
+    // only gates with exactly two qubit operands are interactions, as
+    // initial placement assumes; otherwise gates with more operands add an
+    // edge for every pair of them
+    utils::Bool two_qubit_gates_only = false;
+
+    // count waits and barriers on several qubits as interactions too, as
+    // initial placement and the interaction graph visualizer always did
+    utils::Bool include_waits = false;
+};
+
+/**
+ * Undirected graph of the qubits of a circuit, with an edge between every two
+ * qubits that are operands of the same gate. Gates with more than two qubit
+ * operands add an edge for every pair of them, unless the options say
+ * otherwise. Waits and barriers are not interactions unless the options say
+ * so, and classical gates never are. The edges of each qubit are stored in
+ * compressed sparse row form, sorted by the other qubit, so the graph takes
+ * space in proportion to the number of distinct interactions and an edge is
+ * found by binary search.
+ */
+class InteractionGraph {
+public:
+    struct Edge {
+        utils::UInt qubit;          // the qubit at the other end
+        utils::UInt count;          // number of gates between both qubits
+        utils::UInt forward_count;  // number of those in which the qubit of the row comes first
+        utils::Real weight;         // sum of the weights of those gates
+    };
+
+    class Neighbors {
+    private:
+        const Edge *first;
+        const Edge *last;
+    public:
+        Neighbors(const Edge *first, const Edge *last) : first(first), last(last) {}
+        const Edge *begin() const { return first; }
+        const Edge *end() const { return last; }
+        utils::UInt size() const { return last - first; }
+    };
+
+private:
+    utils::UInt qubit_count;
+    utils::Vec<utils::UInt> offsets;     // edges of qubit q are edges[offsets[q]] up to edges[offsets[q + 1]]
+    utils::Vec<Edge> edges;
+    utils::Vec<utils::UInt> use_counts;  // gates per qubit, including single-qubit gates, waits and barriers
+    utils::UInt gate_count;              // gates that added edges
+    utils::Bool truncated;
+
+    struct Entry {
+        utils::UInt row;
+        Edge edge;
+    };
+    static void add_gate(utils::Vec<Entry> &entries, const gate &g, utils::Real weight);
+    void build(utils::Vec<Entry> &entries);
+
+public:
+    explicit InteractionGraph(utils::UInt qubit_count = 0);
+    InteractionGraph(const circuit &ckt, utils::UInt qubit_count, const InteractionGraphOptions &options = {});
+
+    /**
+     * Builds a graph for each window of cycles_per_slice cycles of the given
+     * scheduled circuit, starting at options.first_cycle, in a single sweep.
+     */
+    static utils::Vec<InteractionGraph> slices(
+        const circuit &ckt,
+        utils::UInt qubit_count,
+        utils::UInt cycles_per_slice,
+        const InteractionGraphOptions &options = {}
+    );
+
+    /**
+     * Adds the edges and gates of the given graph to this one, e.g. to combine
+     * the graphs of the kernels of a program.
+     */
+    void add(const InteractionGraph &other);
+
+    utils::UInt get_qubit_count() const;
+    utils::UInt get_edge_count() const;
+    utils::UInt get_gate_count() const;
+    utils::UInt get_use_count(utils::UInt qubit) const;
+
+    // true when max_two_qubit_gates made the graph leave out gates at the end of the circuit
+    utils::Bool is_truncated() const;
+
+    Neighbors get_neighbors(utils::UInt qubit) const;
+    const Edge *find_edge(utils::UInt qubit, utils::UInt other) const;
+    utils::UInt get_count(utils::UInt qubit, utils::UInt other) const;
+    utils::Real get_weight(utils::UInt qubit, utils::UInt other) const;
+
+    /**
+     * Returns the gate counts as a dense matrix with a row and column per
+     * qubit, as written by write_interaction_matrix().
+     */
+    utils::Str get_matrix_string() const;
+};
+
+} // namespace ql
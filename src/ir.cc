@@ -4,6 +4,8 @@
 
 #include "ir.h"
 
+#include "utils/hash.h"
+#include "utils/trace.h"
 #include "options.h"
 
 namespace ql {
@@ -108,6 +110,7 @@ bundles_t bundler(const circuit &circ, UInt cycle_time) {
     QL_DOUT("bundler ...");
 
     for (auto &gp : circ) {
+        QL_TRACE("bundler.gate", trace::id_of(gp));
         QL_DOUT(". adding gate(@" << gp->cycle << ")  " << gp->qasm());
         if (gp->type() == gate_type_t::__wait_gate__ ||    // FIXME HvS: wait must be written as well
             gp->type() == gate_type_t::__dummy_gate__
@@ -175,6 +178,181 @@ bundles_t bundler(const circuit &circ, UInt cycle_time) {
     return bundles;
 }
 
+// hash of everything find_repeats() compares for a gate, see gates_equal()
+UInt gate_hash(const gate *gp) {
+    UInt seed = 0;
+    hash_combine(seed, gp->name);
+    hash_combine_range(seed, gp->operands);
+    hash_combine_range(seed, gp->creg_operands);
+    hash_combine_range(seed, gp->breg_operands);
+    hash_combine_range(seed, gp->cond_operands);
+    hash_combine(seed, (Int)gp->condition);
+    hash_combine(seed, gp->int_operand);
+    hash_combine(seed, gp->duration);
+    hash_combine(seed, gp->angle);
+    return seed;
+}
+
+Bool gates_equal(const gate *g1, const gate *g2) {
+    return g1->name == g2->name
+        && g1->operands == g2->operands
+        && g1->creg_operands == g2->creg_operands
+        && g1->breg_operands == g2->breg_operands
+        && g1->cond_operands == g2->cond_operands
+        && g1->condition == g2->condition
+        && g1->int_operand == g2->int_operand
+        && g1->duration == g2->duration
+        && g1->angle == g2->angle;
+}
+
+// hash of a bundle, ignoring its start cycle
+static UInt bundle_hash(const bundle_t &abundle) {
+    UInt seed = 0;
+    hash_combine(seed, abundle.duration_in_cycles);
+    for (const auto &sec : abundle.parallel_sections) {
+        for (auto gp : sec) {
+            hash_combine(seed, gate_hash(gp));
+        }
+        hash_combine(seed, (UInt)sec.size());
+    }
+    return seed;
+}
+
+// whether two bundles are equal, ignoring their start cycles
+static Bool bundles_equal(const bundle_t &b1, const bundle_t &b2) {
+    if (b1.duration_in_cycles != b2.duration_in_cycles
+        || b1.parallel_sections.size() != b2.parallel_sections.size()) {
+        return false;
+    }
+    auto sec2_it = b2.parallel_sections.begin();
+    for (const auto &sec1 : b1.parallel_sections) {
+        const auto &sec2 = *sec2_it++;
+        if (sec1.size() != sec2.size()) {
+            return false;
+        }
+        auto gp2_it = sec2.begin();
+        for (auto gp1 : sec1) {
+            if (!gates_equal(gp1, *gp2_it++)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Find runs of repeated bundle windows, for backends that can fold them into
+ * loops to reduce program size. See ir.h for the conditions.
+ */
+repeats_t find_repeats(const bundles_t &bundles, UInt max_window, Bool contained) {
+    repeats_t repeats;
+
+    // index the bundles, so windows can be addressed randomly
+    Vec<const bundle_t *> bs;
+    for (const auto &abundle : bundles) {
+        bs.push_back(&abundle);
+    }
+    UInt n = bs.size();
+    if (n < 2 || max_window == 0) {
+        return repeats;
+    }
+
+    // per bundle: its hash, and the cycle until which any bundle up to but excluding it is busy
+    Vec<UInt> hashes(n);
+    Vec<UInt> busy_until(n + 1, 0);
+    for (UInt i = 0; i < n; i++) {
+        hashes[i] = bundle_hash(*bs[i]);
+        busy_until[i + 1] = max(busy_until[i], bs[i]->start_cycle + bs[i]->duration_in_cycles);
+    }
+    auto start = [&](UInt i) -> UInt { return bs[i]->start_cycle; };
+
+    // compare window [j, j+len) to window [i, i+len) up to cycle offset;
+    // hashes first, then the real thing
+    auto windows_equal = [&](UInt i, UInt j, UInt len) -> Bool {
+        for (UInt k = 0; k < len; k++) {
+            if (hashes[i + k] != hashes[j + k]) {
+                return false;
+            }
+            if (start(i + k) - start(i) != start(j + k) - start(j)) {
+                return false;
+            }
+        }
+        for (UInt k = 0; k < len; k++) {
+            if (!bundles_equal(*bs[i + k], *bs[j + k])) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    QL_DOUT("find_repeats: " << n << " bundles, max_window=" << max_window << ", contained=" << contained);
+    UInt i = 0;
+    while (i + 1 < n) {
+        repeat_t best{i, 0, 0, start(i), 0};
+        UInt best_saved = 0;
+        for (UInt len = 1; len <= max_window && i + 2 * len <= n; len++) {
+            if (hashes[i] != hashes[i + len]) {
+                continue;
+            }
+            UInt period = start(i + len) - start(i);
+
+            // in contained mode each iteration must start idle and finish within its period
+            if (contained) {
+                if (busy_until[i] > start(i)) {
+                    break;          // holds for all window lengths
+                }
+                Bool fits = true;
+                for (UInt k = 0; k < len && fits; k++) {
+                    fits = start(i + k) - start(i) + bs[i + k]->duration_in_cycles <= period;
+                }
+                if (!fits) {
+                    continue;
+                }
+            }
+
+            UInt reps = 1;
+            while (
+                i + (reps + 1) * len <= n
+                && start(i + reps * len) == start(i) + reps * period
+                && windows_equal(i, i + reps * len, len)
+            ) {
+                reps++;
+            }
+
+            // what follows the run must not start before the run has finished
+            while (reps >= 2) {
+                UInt next = i + reps * len < n ? start(i + reps * len) : busy_until[n];
+                if (next >= start(i) + reps * period) {
+                    break;
+                }
+                reps--;
+            }
+            if (reps < 2) {
+                continue;
+            }
+
+            UInt saved = len * (reps - 1);
+            if (saved > best_saved) {
+                best_saved = saved;
+                best.bundles_per_window = len;
+                best.repetitions = reps;
+                best.period_in_cycles = period;
+            }
+        }
+
+        if (best_saved > 0) {
+            QL_DOUT("... repeat at bundle " << best.first_bundle << " (cycle " << best.start_cycle
+                << "): " << best.repetitions << " x " << best.bundles_per_window
+                << " bundles, period " << best.period_in_cycles << " cycles");
+            repeats.push_back(best);
+            i += best.bundles_per_window * best.repetitions;
+        } else {
+            i++;
+        }
+    }
+    return repeats;
+}
+
 /**
  * Print the bundles with an indication (taken from 'at') from where this
  * function was called.
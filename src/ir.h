@@ -7,6 +7,7 @@
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/list.h"
+#include "utils/vec.h"
 #include "gate.h"
 #include "circuit.h"
 
@@ -24,6 +25,23 @@ public:
 
 typedef utils::List<bundle_t> bundles_t;          // note that subsequent bundles can overlap in time
 
+/**
+ * A run of identical bundle windows as found by find_repeats(). The windows
+ * are consecutive in the bundle list and their start cycles are equidistant,
+ * so the run can be emitted as a loop of repetitions iterations over a body of
+ * bundles_per_window bundles taking period_in_cycles cycles per iteration.
+ */
+class repeat_t {
+public:
+    utils::UInt first_bundle;                        // index of the first bundle of the first window
+    utils::UInt bundles_per_window;                  // number of bundles in each window
+    utils::UInt repetitions;                         // number of windows, at least 2
+    utils::UInt start_cycle;                         // start cycle of the first window
+    utils::UInt period_in_cycles;                    // distance in cycles between the starts of subsequent windows
+};
+
+typedef utils::Vec<repeat_t> repeats_t;           // ordered by first_bundle, never overlapping
+
 /**
  * Create a circuit with valid cycle values from the bundled internal
  * representation.
@@ -50,6 +68,40 @@ utils::Str qasm(const bundles_t &bundles);
  */
 bundles_t bundler(const circuit &circ, utils::UInt cycle_time);
 
+/**
+ * Returns a hash of the name, operands, condition, integer operand, duration
+ * and angle of the given gate, i.e. of everything compared by gates_equal().
+ */
+utils::UInt gate_hash(const gate *gp);
+
+/**
+ * Whether the given gates have the same name, operands, condition, integer
+ * operand, duration and angle.
+ */
+utils::Bool gates_equal(const gate *g1, const gate *g2);
+
+/**
+ * Find runs of repeated bundle windows, for backends that can fold them into
+ * loops to reduce program size.
+ *
+ * Two windows are equal when they contain the same number of bundles, the
+ * bundles have the same duration and the same start cycle relative to the
+ * start of their window, and the sections of corresponding bundles contain
+ * gates with equal name, operands, conditions, angle and duration, in the same
+ * order. Candidate windows are compared by hash first and only verified
+ * member by member when the hashes match. The search is greedy from the start
+ * of the bundle list, and for each start picks the window length (up to
+ * max_window) that folds away the most bundles.
+ *
+ * When contained is true, the run is only reported when all gates in a window
+ * end within the period of that window, and no bundle before the run is still
+ * busy when the run starts. This is what a backend needs when it pads the
+ * timeline of each iteration to the period, like the CC backend does. In all
+ * cases the run is shortened when the bundle following it (or the end of the
+ * last bundle) would otherwise start before the run has finished.
+ */
+repeats_t find_repeats(const bundles_t &bundles, utils::UInt max_window, utils::Bool contained);
+
 /**
  * Print the bundles with an indication (taken from 'at') from where this
  * function was called.
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <algorithm>
 #include <iterator>
+#include <functional>
 
 
 #define K_PI 3.141592653589793238462643383279502884197169399375105820974944592307816406L
@@ -52,6 +53,10 @@ quantum_kernel::quantum_kernel(
     // FIXME: what is the reason we can specify qubit_count and creg_count here anyway
 }
 
+void quantum_kernel::circuit_changed() {
+    circuit_generation++;
+}
+
 void quantum_kernel::set_condition(const operation &oper) {
     if ((oper.operands[0])->as_creg().id >= creg_count || (oper.operands[1]->as_creg().id >= creg_count)) {
         QL_EOUT("Out of range operand(s) for '" << oper.operation_name);
@@ -91,6 +96,20 @@ const circuit &quantum_kernel::get_circuit() const {
     return c;
 }
 
+const InteractionGraph &quantum_kernel::get_interaction_graph() const {
+    kernel_interaction_graph_t &cache = interaction_graph;
+    if (
+        !cache.valid
+        || cache.circuit_generation != circuit_generation
+        || cache.graph.get_qubit_count() != qubit_count
+    ) {
+        cache.graph = InteractionGraph(c, qubit_count);
+        cache.valid = true;
+        cache.circuit_generation = circuit_generation;
+    }
+    return cache.graph;
+}
+
 void quantum_kernel::identity(UInt qubit) {
     gate("identity", qubit);
 }
@@ -1022,8 +1041,13 @@ void quantum_kernel::gate(
         QL_IOUT("The list is this many items long: " << u.instructionlist.size());
         //COUT("Instructionlist" << to_string(u.instructionlist));
         cycles_valid = false;
+        UInt start = c.size();
         Int end_index = recursiveRelationsForUnitaryDecomposition(u,qubits, u_size, 0);
         QL_DOUT("Total number of gates added: " << end_index);
+        if (options::get("unitary_decomposition_optimize") == "yes") {
+            optimize_unitary_gates(start);
+            QL_DOUT("Number of gates after optimization: " << c.size() - start);
+        }
     } else {
         QL_EOUT("Unitary " << u.name << " not decomposed. Cannot be added to kernel!");
         throw Exception("Unitary '" + u.name + "' not decomposed. Cannot be added to kernel!", false);
@@ -1146,6 +1170,134 @@ void quantum_kernel::multicontrolled_ry(
     cycles_valid = false;
 }
 
+/**
+ * Role of a gate on one of its qubits, for deciding which gates commute on it.
+ */
+enum class unitary_qubit_role_t {
+    Z,      // diagonal on the qubit: rz, or control of cnot
+    X,      // target of cnot
+    OTHER   // anything else, e.g. ry
+};
+
+static unitary_qubit_role_t unitary_qubit_role(const ql::gate *gp, UInt qubit) {
+    switch (gp->type()) {
+        case __rz_gate__:
+            return unitary_qubit_role_t::Z;
+        case __cnot_gate__:
+            return gp->operands[0] == qubit ? unitary_qubit_role_t::Z : unitary_qubit_role_t::X;
+        default:
+            return unitary_qubit_role_t::OTHER;
+    }
+}
+
+// Removes redundancy from the rz, ry and cnot gates added for a decomposed unitary, i.e. the gates
+// from index start of the circuit onwards, in a single pass over them:
+// - rotations by a zero angle are dropped, which is where the decomposition found nothing to do;
+// - a rotation is merged into an earlier rotation about the same axis on the same qubit,
+//   when only gates it commutes with (for rz: other rz and cnot controls) are in between;
+// - a cnot cancels an earlier identical cnot, when only gates that commute with it
+//   (rz and cnot controls on its control, cnot targets on its target) are in between;
+//   this is what happens at the seams between the multiplexed rotations of the recursion.
+// For each qubit, the indices of the gates acting on it are kept, so the search for an earlier gate
+// stops at the first gate on the qubit that doesn't commute.
+void quantum_kernel::optimize_unitary_gates(UInt start) {
+    static const Real ANGLE_TOLERANCE = 1e-10;
+
+    Vec<ql::gate*> gates(c.begin() + start, c.end());
+    Vec<Bool> live(gates.size(), true);
+    UInt nqubits = 0;
+    for (auto gp : gates) {
+        for (auto q : gp->operands) {
+            nqubits = max(nqubits, q + 1);
+        }
+    }
+    Vec<Vec<UInt>> on_qubit(nqubits);
+
+    // index of the latest live gate on qubit before the current one that satisfies found,
+    // skipping those that satisfy commutes; gates.size() when none
+    auto find_earlier = [&](UInt qubit, const std::function<Bool(const ql::gate*)> &found, const std::function<Bool(const ql::gate*)> &commutes) {
+        const auto &indices = on_qubit[qubit];
+        for (auto it = indices.rbegin(); it != indices.rend(); ++it) {
+            if (!live[*it]) {
+                continue;
+            }
+            if (found(gates[*it])) {
+                return *it;
+            }
+            if (!commutes(gates[*it])) {
+                break;
+            }
+        }
+        return (UInt)gates.size();
+    };
+
+    for (UInt i = 0; i < gates.size(); i++) {
+        ql::gate *gp = gates[i];
+        gate_type_t type = gp->type();
+        if (type == __rz_gate__ || type == __ry_gate__) {
+            UInt q = gp->operands[0];
+            if (std::abs(gp->angle) < ANGLE_TOLERANCE) {
+                live[i] = false;
+                continue;
+            }
+            UInt j = find_earlier(
+                q,
+                [type](const ql::gate *other) { return other->type() == type; },
+                [type, q](const ql::gate *other) {
+                    return type == __rz_gate__ && unitary_qubit_role(other, q) == unitary_qubit_role_t::Z;
+                }
+            );
+            if (j < gates.size()) {
+                Real angle = gates[j]->angle + gp->angle;
+                live[i] = false;
+                if (std::abs(angle) < ANGLE_TOLERANCE) {
+                    live[j] = false;
+                } else {
+                    delete gates[j];
+                    if (type == __rz_gate__) {
+                        gates[j] = new ql::rz(q, angle);
+                    } else {
+                        gates[j] = new ql::ry(q, angle);
+                    }
+                }
+                continue;
+            }
+        } else if (type == __cnot_gate__) {
+            UInt control = gp->operands[0];
+            UInt target = gp->operands[1];
+            auto is_same = [control, target](const ql::gate *other) {
+                return other->type() == __cnot_gate__ && other->operands[0] == control && other->operands[1] == target;
+            };
+            UInt j = find_earlier(
+                control,
+                is_same,
+                [control](const ql::gate *other) { return unitary_qubit_role(other, control) == unitary_qubit_role_t::Z; }
+            );
+            if (j < gates.size() && j == find_earlier(
+                target,
+                is_same,
+                [target](const ql::gate *other) { return unitary_qubit_role(other, target) == unitary_qubit_role_t::X; }
+            )) {
+                live[i] = false;
+                live[j] = false;
+                continue;
+            }
+        }
+        for (auto q : gp->operands) {
+            on_qubit[q].push_back(i);
+        }
+    }
+
+    c.resize(start);
+    for (UInt i = 0; i < gates.size(); i++) {
+        if (live[i]) {
+            c.push_back(gates[i]);
+        } else {
+            delete gates[i];
+        }
+    }
+}
+
 /**
  * qasm output
  */
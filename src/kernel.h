@@ -14,6 +14,7 @@
 #include "hardware_configuration.h"
 #include "unitary.h"
 #include "platform.h"
+#include "interaction_graph.h"
 
 namespace ql {
 
@@ -25,6 +26,40 @@ enum class kernel_type_t {
     ELSE_START, ELSE_END
 };
 
+/**
+ * Statistics of the circuit of a kernel as written to the report files. They
+ * are collected in a single sweep over the circuit and cached in the kernel by
+ * report.cc; the remaining members identify the circuit generation and the
+ * pass they were collected for, so that report.cc can tell whether they are
+ * still valid.
+ */
+class kernel_statistics_t {
+public:
+    utils::UInt             circuit_latency;
+    utils::UInt             quantum_gates;
+    utils::UInt             non_single_qubit_gates;
+    utils::UInt             classical_operations;
+    utils::Vec<utils::UInt> qubit_usecount;           // number of gates per qubit
+    utils::Vec<utils::UInt> qubit_usedcyclecount;     // number of cycles per qubit
+
+    utils::Bool             valid = false;
+    utils::UInt             pass_generation = 0;      // see report_start_pass()
+    utils::Bool             after_pass = false;       // collected after the pass was done with the circuit
+    utils::UInt             circuit_generation = 0;   // see quantum_kernel::circuit_changed()
+};
+
+/**
+ * Interaction graph of the circuit of a kernel, cached by
+ * quantum_kernel::get_interaction_graph(). It is reused only as long as the
+ * circuit generation of the kernel is the one it was built for.
+ */
+class kernel_interaction_graph_t {
+public:
+    InteractionGraph        graph;
+    utils::Bool             valid = false;
+    utils::UInt             circuit_generation = 0;   // see quantum_kernel::circuit_changed()
+};
+
 class quantum_kernel {
 public: // FIXME: should be private
     utils::Str              name;
@@ -40,6 +75,9 @@ public: // FIXME: should be private
     instruction_map_t       instruction_map;
     utils::Vec<utils::UInt> cond_operands;    // see gate interface: condition mode to make new gates conditional
     cond_type_t             condition;        // kernel condition mode is set by gate_preset_condition()
+    utils::UInt             circuit_generation = 0;   // see circuit_changed()
+    mutable kernel_statistics_t statistics;   // cache of report.cc
+    mutable kernel_interaction_graph_t interaction_graph; // cache of get_interaction_graph()
 
 public:
     quantum_kernel(const utils::Str &name);
@@ -53,6 +91,12 @@ public:
 
     // FIXME: add constructor which allows setting iterations and type, and use that in program.h::add_for(), etc
 
+    // tells the caches of this kernel that its circuit may have changed, by
+    // incrementing circuit_generation; the pass manager does so for all
+    // kernels before and after every pass, other code that modifies c
+    // directly must call this itself
+    void circuit_changed();
+
     void set_condition(const operation &oper);
     void set_kernel_type(kernel_type_t typ);
 
@@ -61,6 +105,14 @@ public:
     circuit &get_circuit();
     const circuit &get_circuit() const;
 
+    /**
+     * Returns the interaction graph of the circuit over all qubits of the
+     * kernel, with the default options (waits and barriers left out). It is
+     * built once and reused by the interaction matrix output for as long as
+     * the circuit is not changed by a pass.
+     */
+    const InteractionGraph &get_interaction_graph() const;
+
     void identity(utils::UInt qubit);
     void i(utils::UInt qubit);
     void hadamard(utils::UInt qubit);
@@ -272,6 +324,10 @@ private:
         const utils::Vec<utils::UInt> &qubits
     );
 
+    // removes redundancy from the gates added for a decomposed unitary,
+    // i.e. the gates from index start of the circuit onwards
+    void optimize_unitary_gates(utils::UInt start);
+
 public:
 
     /**
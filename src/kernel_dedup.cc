@@ -0,0 +1,174 @@
+/** \file
+ * Deduplication of identical kernel bodies within a pass.
+ */
+
+#include "kernel_dedup.h"
+
+#include "utils/hash.h"
+#include "options.h"
+#include "ir.h"
+
+namespace ql {
+
+using namespace utils;
+
+KernelDeduplicator::KernelDeduplicator(const Str &passname) :
+    passname(passname),
+    enabled(options::get("kernel_dedup") == "yes"),
+    pending(false),
+    nkernels(0),
+    ndeduplicated(0)
+{
+}
+
+KernelDeduplicator::~KernelDeduplicator() {
+    for (auto &e : entries) {
+        delete_circuit(e.input);
+        delete_circuit(e.output);
+    }
+}
+
+UInt KernelDeduplicator::body_hash(const quantum_kernel &k, UInt key) {
+    UInt seed = 0;
+    hash_combine(seed, key);
+    hash_combine(seed, k.qubit_count);
+    hash_combine(seed, k.creg_count);
+    hash_combine(seed, k.breg_count);
+    for (auto gp : k.c) {
+        hash_combine(seed, ir::gate_hash(gp));
+        hash_combine(seed, gp->cycle);
+    }
+    hash_combine(seed, (UInt)k.c.size());
+    return seed;
+}
+
+Bool KernelDeduplicator::body_equal(const entry_t &e, const quantum_kernel &k, UInt key) {
+    if (e.key != key
+        || e.qubit_count != k.qubit_count
+        || e.creg_count != k.creg_count
+        || e.breg_count != k.breg_count
+        || e.input.size() != k.c.size()) {
+        return false;
+    }
+    for (UInt i = 0; i < k.c.size(); i++) {
+        const gate *g1 = e.input[i];
+        const gate *g2 = k.c[i];
+        if (g1->type() != g2->type() || g1->cycle != g2->cycle || !ir::gates_equal(g1, g2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// copies all gates of from to the end of to; when a gate can't be copied,
+// deletes the copies made so far and returns false
+Bool KernelDeduplicator::copy_circuit(const circuit &from, circuit &to) {
+    UInt size = to.size();
+    to.reserve(size + from.size());
+    for (auto gp : from) {
+        gate *copy = copy_gate(gp);
+        if (copy == nullptr) {
+            for (UInt i = size; i < to.size(); i++) {
+                delete to[i];
+            }
+            to.resize(size);
+            return false;
+        }
+        to.push_back(copy);
+    }
+    return true;
+}
+
+void KernelDeduplicator::delete_circuit(circuit &c) {
+    for (auto gp : c) {
+        delete gp;
+    }
+    c.clear();
+}
+
+Bool KernelDeduplicator::reuse(quantum_kernel &k, UInt key, Vec<UInt> *stats) {
+    if (pending) {
+        // store() was not called for the previous kernel
+        delete_circuit(entries.back().input);
+        entries.pop_back();
+        pending = false;
+    }
+    if (!enabled || k.c.empty()) {
+        return false;
+    }
+    nkernels++;
+
+    UInt hash = body_hash(k, key);
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        for (auto i : it->second) {
+            const entry_t &e = entries[i];
+            if (!body_equal(e, k, key)) {
+                continue;
+            }
+            circuit c;
+            if (!copy_circuit(e.output, c)) {
+                break;
+            }
+            QL_DOUT(passname << ": kernel " << k.name << " is identical to a kernel seen before, reusing its result");
+            // the gates k had are dropped without deleting them: gates are not
+            // owned by the circuit that holds them, and these may still be
+            // referenced by the kernel the user added to the program (which
+            // is copied shallowly) or by the input snapshot of another pass;
+            // passes that replace a whole circuit, like the mapper, do the same
+            k.c.swap(c);
+            k.qubit_count = e.output_qubit_count;
+            k.cycles_valid = e.output_cycles_valid;
+            if (stats != nullptr) {
+                *stats = e.stats;
+            }
+            ndeduplicated++;
+            return true;
+        }
+    }
+
+    entry_t e;
+    e.hash = hash;
+    e.key = key;
+    e.qubit_count = k.qubit_count;
+    e.creg_count = k.creg_count;
+    e.breg_count = k.breg_count;
+    if (!copy_circuit(k.c, e.input)) {
+        return false;
+    }
+    entries.push_back(std::move(e));
+    pending = true;
+    return false;
+}
+
+void KernelDeduplicator::store(const quantum_kernel &k, const Vec<UInt> &stats) {
+    if (!pending) {
+        return;
+    }
+    pending = false;
+
+    entry_t &e = entries.back();
+    if (!copy_circuit(k.c, e.output)) {
+        delete_circuit(e.input);
+        entries.pop_back();
+        return;
+    }
+    e.output_qubit_count = k.qubit_count;
+    e.output_cycles_valid = k.cycles_valid;
+    e.stats = stats;
+    index.set(e.hash).push_back(entries.size() - 1);
+}
+
+UInt KernelDeduplicator::get_deduplicated_count() const {
+    return ndeduplicated;
+}
+
+Str KernelDeduplicator::get_statistics(const Str &prefix) const {
+    if (!enabled) {
+        return "";
+    }
+    return prefix + "Total no. of kernels deduplicated: " + to_string(ndeduplicated)
+        + " of " + to_string(nkernels) + "\n";
+}
+
+} // namespace ql
@@ -0,0 +1,114 @@
+/** \file
+ * Deduplication of identical kernel bodies within a pass.
+ */
+
+#pragma once
+
+#include "utils/num.h"
+#include "utils/str.h"
+#include "utils/vec.h"
+#include "utils/map.h"
+#include "kernel.h"
+
+namespace ql {
+
+/**
+ * Lets a pass that transforms each kernel of a program independently of the
+ * other kernels do the work only once for structurally identical kernels, as
+ * they arise when the same body is added to a program many times, e.g. under
+ * different control-flow phi nodes. Used as follows:
+ *
+ *     KernelDeduplicator dedup(passname);
+ *     for (auto &k : programp->kernels) {
+ *         if (dedup.reuse(k)) {
+ *             continue;
+ *         }
+ *         ... transform k ...
+ *         dedup.store(k);
+ *     }
+ *
+ * Two kernels are identical when they have the same qubit, creg and breg
+ * counts, and their circuits contain gates of the same type and cycle that are
+ * equal according to ir::gates_equal(), in the same order. The key passed to
+ * reuse() must cover any state outside the kernel that the transformation
+ * depends on. Bodies are compared by hash first, and only gate by gate when
+ * the hashes match.
+ *
+ * Reusing a result replaces the circuit of the kernel by a copy of the circuit
+ * stored for the first such kernel, so that later passes can still modify the
+ * gates of each kernel in place. The replaced gates are not deleted, since
+ * they may be shared with the kernel object of the user. Empty kernels and
+ * kernels with gates that copy_gate() can't copy are never deduplicated.
+ *
+ * Deduplication is enabled by option kernel_dedup; when it is off, reuse()
+ * always returns false and store() does nothing. It is only used by the passes
+ * whose cost per kernel is well above that of hashing and copying the circuit:
+ * the prescheduler, the mapper and the resource-constrained scheduler. The
+ * optimizers and decomposition passes are linear in the kernel size anyway,
+ * and code generation emits per-kernel labels and branches, so these still
+ * process every kernel.
+ */
+class KernelDeduplicator {
+public:
+
+    explicit KernelDeduplicator(const utils::Str &passname);
+    ~KernelDeduplicator();
+
+    /**
+     * Looks for a kernel stored before that is identical to k and was stored
+     * with the same key. When found, replaces the circuit and qubit count of k
+     * by those stored for it, sets stats (when not nullptr) to the statistics
+     * stored with it, and returns true. Otherwise, takes a snapshot of k to be
+     * completed by store() after the transformation, and returns false.
+     */
+    utils::Bool reuse(quantum_kernel &k, utils::UInt key = 0, utils::Vec<utils::UInt> *stats = nullptr);
+
+    /**
+     * Stores the transformed kernel, together with statistics of the
+     * transformation that the pass wants to report for all kernels identical
+     * to it, for the kernel passed to the last call of reuse().
+     */
+    void store(const quantum_kernel &k, const utils::Vec<utils::UInt> &stats = {});
+
+    /**
+     * Returns the number of kernels for which reuse() returned true.
+     */
+    utils::UInt get_deduplicated_count() const;
+
+    /**
+     * Returns a line reporting the number of deduplicated kernels, starting
+     * with the given prefix, or an empty string when deduplication is off.
+     */
+    utils::Str get_statistics(const utils::Str &prefix) const;
+
+private:
+
+    struct entry_t {
+        utils::UInt hash;
+        utils::UInt key;
+        utils::UInt qubit_count;
+        utils::UInt creg_count;
+        utils::UInt breg_count;
+        circuit input;
+        circuit output;
+        utils::UInt output_qubit_count;
+        utils::Bool output_cycles_valid;
+        utils::Vec<utils::UInt> stats;
+    };
+
+    static utils::UInt body_hash(const quantum_kernel &k, utils::UInt key);
+    static utils::Bool body_equal(const entry_t &e, const quantum_kernel &k, utils::UInt key);
+    static utils::Bool copy_circuit(const circuit &from, circuit &to);
+    static void delete_circuit(circuit &c);
+
+    utils::Str passname;
+    utils::Bool enabled;
+    utils::Vec<entry_t> entries;
+    utils::Map<utils::UInt, utils::Vec<utils::UInt>> index;    // hash -> indices in entries
+    utils::Bool pending;                                        // whether entries.back() awaits store()
+    utils::UInt nkernels;
+    utils::UInt ndeduplicated;
+
+};
+
+} // namespace ql
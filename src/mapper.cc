@@ -4,7 +4,11 @@
 
 #include "mapper.h"
 
+#include <algorithm>
+#include <functional>
 #include "utils/filesystem.h"
+#include "utils/trace.h"
+#include "utils/hash.h"
 
 #ifdef INITIALPLACE
 #include <thread>
@@ -25,6 +29,7 @@ void Grid::Init(const quantum_platform *p) {
     QL_DOUT("Grid::Init");
     platformp = p;
     nq = platformp->qubit_number;
+    key = to_string(nq) + " " + platformp->topology.dump();
     QL_DOUT("... number of real qbits=" << nq);
 
     Str formstr;
@@ -205,7 +210,7 @@ void Grid::ComputeDist() {
 }
 
 void Grid::DPRINTGrid() const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         PrintGrid();
     }
 }
@@ -246,6 +251,10 @@ void Grid::PrintGrid() const {
     }
 }
 
+Bool Grid::IsFor(const quantum_platform *p) const {
+    return !key.empty() && key == to_string(p->qubit_number) + " " + p->topology.dump();
+}
+
 // init multi-core attributes
 void Grid::InitCores() {
     if (platformp->topology.count("number_of_cores") <= 0) {
@@ -369,6 +378,183 @@ void Grid::SortNbs() {
     }
 }
 
+// CorePartitioner initializer
+void CorePartitioner::Init(const Grid *g) {
+    gridp = g;
+    nq = gridp->nq;
+    ncores = gridp->ncores;
+    nqpc = nq/ncores;
+}
+
+// whether components of the given sizes can be assigned to the cores, by first-fit decreasing;
+// virtual qubits not in any of these components always fit in the remaining room,
+// since there are not more virtual qubits than real qubits
+Bool CorePartitioner::Fits(Vec<UInt> sizes) const {
+    std::sort(sizes.begin(), sizes.end(), std::greater<UInt>());
+    Vec<UInt> room(ncores, nqpc);
+    for (auto sz : sizes) {
+        Bool placed = false;
+        for (auto &r : room) {
+            if (r >= sz) {
+                r -= sz;
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// find the slice of circuit c that starts at gate index start, and assign cores to the virtual qubits for it
+UInt CorePartitioner::NextSlice(const circuit &c, UInt start, Vec<UInt> &vcore) const {
+    // union-find of the virtual qubits that interact by multi-qubit gates in the slice
+    Vec<UInt> parent(nq);
+    Vec<UInt> size(nq, 1);
+    for (UInt v = 0; v < nq; v++) {
+        parent[v] = v;
+    }
+    auto root = [&parent](UInt v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+    Vec<Bool> used(nq, false);  // whether the virtual qubit is used in the slice
+
+    UInt end;
+    for (end = start; end < c.size(); end++) {
+        gate *gp = c[end];
+        if (gp->type() == __classical_gate__ || gp->type() == __dummy_gate__) {
+            continue;
+        }
+        if (gp->type() != __wait_gate__ && gp->operands.size() > 1) {
+            Vec<UInt> roots;
+            for (auto v : gp->operands) {
+                UInt r = root(v);
+                if (std::find(roots.begin(), roots.end(), r) == roots.end()) {
+                    roots.push_back(r);
+                }
+            }
+            if (roots.size() > 1) {
+                UInt merged = 0;
+                for (auto r : roots) {
+                    merged += size[r];
+                }
+                Vec<UInt> sizes = {merged};
+                for (UInt v = 0; v < nq; v++) {
+                    if (parent[v] == v && size[v] > 1 && std::find(roots.begin(), roots.end(), v) == roots.end()) {
+                        sizes.push_back(size[v]);
+                    }
+                }
+                if (!Fits(sizes)) {
+                    if (end == start) {
+                        QL_FATAL("Mapper: gate " << gp->qasm() << " uses more qubits than fit in one core");
+                    }
+                    break;
+                }
+                for (auto r : roots) {
+                    parent[r] = roots[0];
+                }
+                size[roots[0]] = merged;
+            }
+        }
+        for (auto v : gp->operands) {
+            used[v] = true;
+        }
+    }
+
+    // collect the components of more than one virtual qubit, largest first
+    Map<UInt, Vec<UInt>> members;
+    for (UInt v = 0; v < nq; v++) {
+        if (size[root(v)] > 1) {
+            members.set(root(v)).push_back(v);
+        }
+    }
+    Vec<Vec<UInt>> comps;
+    for (auto &kv : members) {
+        comps.push_back(kv.second);
+    }
+    std::stable_sort(comps.begin(), comps.end(), [](const Vec<UInt> &a, const Vec<UInt> &b) {
+        return a.size() > b.size();
+    });
+
+    // assign each component to the core with room that already holds most of its virtual qubits;
+    // when that doesn't work out, fall back to first-fit decreasing, which Fits has shown to succeed
+    Vec<UInt> room(ncores, nqpc);
+    Vec<UInt> newcore(nq, UNDEFINED_QUBIT);
+    Bool assigned = true;
+    for (auto &comp : comps) {
+        UInt best = UNDEFINED_QUBIT;
+        UInt bestcount = 0;
+        for (UInt core = 0; core < ncores; core++) {
+            if (room[core] < comp.size()) {
+                continue;
+            }
+            UInt count = 0;
+            for (auto v : comp) {
+                if (vcore[v] == core) {
+                    count++;
+                }
+            }
+            if (best == UNDEFINED_QUBIT || count > bestcount) {
+                best = core;
+                bestcount = count;
+            }
+        }
+        if (best == UNDEFINED_QUBIT) {
+            assigned = false;
+            break;
+        }
+        room[best] -= comp.size();
+        for (auto v : comp) {
+            newcore[v] = best;
+        }
+    }
+    if (!assigned) {
+        room.assign(ncores, nqpc);
+        newcore.assign(nq, UNDEFINED_QUBIT);
+        for (auto &comp : comps) {
+            UInt core = 0;
+            while (room[core] < comp.size()) {
+                core++;
+                QL_ASSERT(core < ncores);
+            }
+            room[core] -= comp.size();
+            for (auto v : comp) {
+                newcore[v] = core;
+            }
+        }
+    }
+
+    // the other mapped virtual qubits stay in their core when there is room,
+    // those that don't fit there anymore and those that are mapped first go to the core with most room
+    for (UInt v = 0; v < nq; v++) {
+        if (newcore[v] == UNDEFINED_QUBIT && vcore[v] != UNDEFINED_QUBIT && room[vcore[v]] > 0) {
+            newcore[v] = vcore[v];
+            room[vcore[v]]--;
+        }
+    }
+    for (UInt v = 0; v < nq; v++) {
+        if (newcore[v] == UNDEFINED_QUBIT && (vcore[v] != UNDEFINED_QUBIT || used[v])) {
+            UInt best = 0;
+            for (UInt core = 1; core < ncores; core++) {
+                if (room[core] > room[best]) {
+                    best = core;
+                }
+            }
+            QL_ASSERT(room[best] > 0);
+            newcore[v] = best;
+            room[best]--;
+        }
+    }
+    vcore.swap(newcore);
+    return end;
+}
+
 // map real qubit to the virtual qubit index that is mapped to it (i.e. backward map);
 // when none, return UNDEFINED_QUBIT;
 // a second vector next to v2rMap (i.e. an r2vMap) would speed this up;
@@ -504,7 +690,7 @@ void Virt2Real::Swap(UInt r0, UInt r1) {
 }
 
 void Virt2Real::DPRINTReal(UInt r) const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         PrintReal(r);
     }
 }
@@ -556,7 +742,7 @@ void Virt2Real::PrintVirt(UInt v) const {
 }
 
 void Virt2Real::DPRINTReal(const Str &s, UInt r0, UInt r1) const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         PrintReal(s, r0, r1);
     }
 }
@@ -572,7 +758,7 @@ void Virt2Real::PrintReal(const Str &s, UInt r0, UInt r1) const {
 }
 
 void Virt2Real::DPRINT(const Str &s) const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         Print(s);
     }
 }
@@ -666,7 +852,7 @@ UInt FreeCycle::Max() const {
 }
 
 void FreeCycle::DPRINT(const Str &s) const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         Print(s);
     }
 }
@@ -793,6 +979,99 @@ void FreeCycle::Add(gate *g, UInt startCycle) {
     }
 }
 
+// explicit GateFactory constructor
+// needed for virgin construction
+GateFactory::GateFactory() : genprim(false), prepinitsstate(false) {
+}
+
+GateFactory::~GateFactory() {
+    Clear();
+}
+
+// (re)initialize for the current option values, clearing the cache
+void GateFactory::Init() {
+    QL_DOUT("GateFactory::Init");
+    genprim = (options::get("mapper") == "maxfidelity");
+    prepinitsstate = (options::get("mapprepinitsstate") == "yes");
+    Clear();
+}
+
+void GateFactory::Clear() {
+    for (auto &kv : expansions) {
+        for (auto gp : kv.second.gates) {
+            delete gp;
+        }
+    }
+    expansions.clear();
+    name_ids.clear();
+}
+
+Bool GateFactory::key_t::operator<(const key_t &other) const {
+    if (name_id != other.name_id) return name_id < other.name_id;
+    if (duration != other.duration) return duration < other.duration;
+    if (angle != other.angle) return angle < other.angle;
+    return qubits < other.qubits;
+}
+
+// create the gate(s) for gname with given operands in kernel k's circuit k.c
+// return whether this was successful
+Bool GateFactory::Create(
+    quantum_kernel &k,
+    const Str &gname,
+    const Vec<UInt> &qubits,
+    const Vec<UInt> &cregs,
+    UInt duration,
+    Real angle,
+    const Vec<UInt> &bregs,
+    cond_type_t gcond,
+    const Vec<UInt> &gcondregs
+) {
+    // gates with classical/bit operands or a condition (also one preset in the kernel) are rare; don't memoise them
+    if (!cregs.empty() || !bregs.empty() || gcond != cond_always || !gcondregs.empty() || k.condition != cond_always) {
+        return k.gate_nonfatal(gname, qubits, cregs, duration, angle, bregs, gcond, gcondregs);
+    }
+
+    auto nit = name_ids.find(gname);
+    if (nit == name_ids.end()) {
+        nit = name_ids.emplace(gname, name_ids.size()).first;
+    }
+    key_t key{nit->second, qubits, duration, angle};
+
+    auto it = expansions.find(key);
+    if (it != expansions.end() && it->second.copyable) {
+        for (auto gp : it->second.gates) {
+            k.c.push_back(copy_gate(gp));
+        }
+        if (it->second.added) {
+            k.cycles_valid = false;
+        }
+        return it->second.added;
+    }
+
+    UInt start = k.c.size();
+    Bool added = k.gate_nonfatal(gname, qubits, cregs, duration, angle, bregs, gcond, gcondregs);
+    if (it == expansions.end()) {
+        expansion_t &expansion = expansions.set(key);
+        expansion.added = added;
+        expansion.copyable = true;
+        for (UInt i = start; i < k.c.size() && expansion.copyable; i++) {
+            gate *copy = copy_gate(k.c[i]);
+            if (copy == nullptr) {
+                expansion.copyable = false;
+            } else {
+                expansion.gates.push_back(copy);
+            }
+        }
+        if (!expansion.copyable) {
+            for (auto gp : expansion.gates) {
+                delete gp;
+            }
+            expansion.gates.clear();
+        }
+    }
+    return added;
+}
+
 // explicit Past constructor
 // needed for virgin construction
 Past::Past() {
@@ -800,11 +1079,12 @@ Past::Past() {
 }
 
 // past initializer
-void Past::Init(const quantum_platform *p, quantum_kernel *k, Grid *g) {
+void Past::Init(const quantum_platform *p, quantum_kernel *k, Grid *g, GateFactory *f) {
     QL_DOUT("Past::Init");
     platformp = p;
     kernelp = k;
     gridp = g;
+    factoryp = f;
 
     nq = platformp->qubit_number;
     nb = kernelp->breg_count;
@@ -819,6 +1099,10 @@ void Past::Init(const quantum_platform *p, quantum_kernel *k, Grid *g) {
     nswapsadded = 0;            // no swaps or moves added yet to this past; AddSwap adds one here
     nmovesadded = 0;            // no moves added yet to this past; AddSwap may add one here
     cycle.clear();              // no gates have cycles assigned in this past; scheduling gate updates this
+    trackfidelity = factoryp->genprim;     // i.e. mapper option is maxfidelity
+    if (trackfidelity) {
+        fidelity.Init(*platformp);  // all qubits at fidelity 1; scheduling gate updates this
+    }
 }
 
 // import Past's v2r from v2r_value
@@ -832,7 +1116,7 @@ void Past::ExportV2r(Virt2Real &v2r_destination) const {
 }
 
 void Past::DFcPrint() const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         fc.Print("");
     }
 }
@@ -893,6 +1177,9 @@ void Past::Schedule() {
         fc.Add(gp, startCycle);
         cycle.set(gp) = startCycle; // cycle[gp] is private to this past but gp->cycle is private to gp
         gp->cycle = startCycle; // so gp->cycle gets assigned for each alter' Past and finally definitively for mainPast
+        if (trackfidelity) {
+            fidelity.Add(gp, startCycle);
+        }
         // DOUT("... set " << gp->qasm() << " at cycle " << startCycle);
 
         // insert gate gp in lg, the list of gates, in cycle[gp] order, and inside this order, as late as possible
@@ -985,7 +1272,7 @@ Bool Past::new_gate(
     QL_ASSERT(circ.empty());
     QL_ASSERT(kernelp->c.empty());
     // create gate(s) in kernelp->c
-    added = kernelp->gate_nonfatal(gname, qubits, cregs, duration, angle, bregs, gcond, gcondregs);
+    added = factoryp->Create(*kernelp, gname, qubits, cregs, duration, angle, bregs, gcond, gcondregs);
     circ = kernelp->c;
     kernelp->c.clear();
     for (auto gp : circ) {
@@ -1029,9 +1316,8 @@ void Past::GenMove(circuit &circ, UInt &r0, UInt &r1) {
 
     // first (optimistically) create the move circuit and add it to circ
     Bool created;
-    auto mapperopt = options::get("mapper");
     if (gridp->IsInterCoreHop(r0, r1)) {
-        if (mapperopt == "maxfidelity") {
+        if (factoryp->genprim) {
             created = new_gate(circ, "tmove_prim", {r0,r1});    // gates implementing tmove returned in circ
         } else {
             created = new_gate(circ, "tmove_real", {r0,r1});    // gates implementing tmove returned in circ
@@ -1043,7 +1329,7 @@ void Past::GenMove(circuit &circ, UInt &r0, UInt &r1) {
             }
         }
     } else {
-        if (mapperopt == "maxfidelity") {
+        if (factoryp->genprim) {
             created = new_gate(circ, "move_prim", {r0,r1});    // gates implementing move returned in circ
         } else {
             created = new_gate(circ, "move_real", {r0,r1});    // gates implementing move returned in circ
@@ -1157,9 +1443,8 @@ void Past::AddSwap(UInt r0, UInt r1) {
                 QL_DOUT("... reversed swap to become swap(q" << r0 << ",q" << r1 << ") ...");
             }
         }
-        auto mapperopt = options::get("mapper");
         if (gridp->IsInterCoreHop(r0, r1)) {
-            if (mapperopt == "maxfidelity") {
+            if (factoryp->genprim) {
                 created = new_gate(circ, "tswap_prim", {r0,r1});    // gates implementing tswap returned in circ
             } else {
                 created = new_gate(circ, "tswap_real", {r0,r1});    // gates implementing tswap returned in circ
@@ -1172,7 +1457,7 @@ void Past::AddSwap(UInt r0, UInt r1) {
             }
             QL_DOUT("... tswap(q" << r0 << ",q" << r1 << ") ...");
         } else {
-            if (mapperopt == "maxfidelity") {
+            if (factoryp->genprim) {
                 created = new_gate(circ, "swap_prim", {r0,r1});    // gates implementing swap returned in circ
             } else {
                 created = new_gate(circ, "swap_real", {r0,r1});    // gates implementing swap returned in circ
@@ -1254,19 +1539,18 @@ void Past::MakeReal(gate *gp, circuit &circ) {
     stripname(gname);
 
     Vec<UInt> real_qubits = gp->operands;// starts off as copy of virtual qubits!
+    Bool isprepz = factoryp->prepinitsstate && (gname == "prepz" || gname == "Prepz");
     for (auto &qi : real_qubits) {
         qi = MapQubit(qi);          // and now they are real
-        auto mapprepinitsstateopt = options::get("mapprepinitsstate");
-        if (mapprepinitsstateopt == "yes" && (gname == "prepz" || gname == "Prepz")) {
+        if (isprepz) {
             v2r.SetRs(qi, rs_wasinited);
         } else {
             v2r.SetRs(qi, rs_hasstate);
         }
     }
 
-    auto mapperopt = options::get("mapper");
     Str real_gname = gname;
-    if (mapperopt == "maxfidelity") {
+    if (factoryp->genprim) {
         QL_DOUT("MakeReal: with mapper==maxfidelity generate _prim");
         real_gname.append("_prim");
     } else {
@@ -1345,6 +1629,10 @@ UInt Past::MaxFreeCycle() const {
     return fc.Max();
 }
 
+Real Past::Fidelity() const {
+    return fidelity.Fidelity();
+}
+
 // nonq and q gates follow separate flows through Past:
 // - q gates are put in waitinglg when added and then scheduled; and then ordered by cycle into lg
 //      in lg they are waiting to be inspected and scheduled, until [too many are there,] a nonq comes or end-of-circuit
@@ -1378,6 +1666,66 @@ void Past::Out(circuit &oc) {
     outlg.clear();
 }
 
+// for multi-core platforms: move the virtual qubits to the cores given by vcore, by swaps/moves between cores,
+// and map the virtual qubits that are not mapped yet to free real qubits in their cores
+void Past::MoveToCores(const Vec<UInt> &vcore) {
+    // each exchange puts a virtual qubit in its core for good, so this terminates
+    Bool moved = true;
+    while (moved) {
+        moved = false;
+        for (UInt v = 0; v < nq; v++) {
+            UInt rv = v2r[v];
+            if (vcore[v] == UNDEFINED_QUBIT || rv == UNDEFINED_QUBIT || gridp->CoreOf(rv) == vcore[v]) {
+                continue;
+            }
+            // find a real qubit in the core of v to exchange rv with:
+            // preferably one holding a virtual qubit that must go to the current core of v, so that both arrive,
+            // otherwise a free one, otherwise one holding a virtual qubit that must leave that core anyhow
+            UInt rt = UNDEFINED_QUBIT;
+            Int rtrank = 0;
+            for (UInt r = 0; r < nq; r++) {
+                if (gridp->CoreOf(r) != vcore[v]) {
+                    continue;
+                }
+                UInt w = v2r.GetVirt(r);
+                Int rank;
+                if (w == UNDEFINED_QUBIT) {
+                    rank = 2;
+                } else if (vcore[w] == UNDEFINED_QUBIT || vcore[w] == vcore[v]) {
+                    continue;
+                } else if (vcore[w] == gridp->CoreOf(rv)) {
+                    rank = 3;
+                } else {
+                    rank = 1;
+                }
+                if (rank > rtrank) {
+                    rt = r;
+                    rtrank = rank;
+                }
+            }
+            QL_ASSERT(rt != UNDEFINED_QUBIT);
+            AddSwap(rv, rt);        // this just remaps when there is no state to preserve
+            moved = true;
+        }
+    }
+
+    for (UInt v = 0; v < nq; v++) {
+        if (vcore[v] == UNDEFINED_QUBIT || v2r[v] != UNDEFINED_QUBIT) {
+            continue;
+        }
+        UInt r;
+        for (r = 0; r < nq; r++) {
+            if (gridp->CoreOf(r) == vcore[v] && v2r.GetVirt(r) == UNDEFINED_QUBIT) {
+                break;
+            }
+        }
+        QL_ASSERT(r < nq);
+        QL_ASSERT(v2r.GetRs(r) != rs_hasstate);
+        v2r[v] = r;
+    }
+    Schedule();
+}
+
 // explicit Alter constructor
 // needed for virgin construction
 Alter::Alter() {
@@ -1386,16 +1734,17 @@ Alter::Alter() {
 
 // Alter initializer
 // This should only be called after a virgin construction and not after cloning a path.
-void Alter::Init(const quantum_platform *p, quantum_kernel *k, Grid *g) {
+void Alter::Init(const quantum_platform *p, quantum_kernel *k, Grid *g, GateFactory *f) {
     QL_DOUT("Alter::Init(number of qubits=" << p->qubit_number);
     platformp = p;
     kernelp = k;
     gridp = g;
+    factoryp = f;
 
     nq = platformp->qubit_number;
     ct = platformp->cycle_time;
     // total, fromSource and fromTarget start as empty vectors
-    past.Init(platformp, kernelp, gridp);      // initializes past to empty
+    past.Init(platformp, kernelp, gridp, factoryp);      // initializes past to empty
     didscore = false;                   // will not print score for now
 }
 
@@ -1427,7 +1776,7 @@ void Alter::partialPrint(const Str &hd, const Vec<UInt> &pp) {
 }
 
 void Alter::DPRINT(const Str &s) const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         Print(s);
     }
 }
@@ -1449,7 +1798,7 @@ void Alter::Print(const Str &s) const {
 }
 
 void Alter::DPRINT(const Str &s, const Vec<Alter> &va) {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         Print(s, va);
     }
 }
@@ -1469,7 +1818,7 @@ void Alter::Print(const Str &s, const Vec<Alter> &va) {
 }
 
 void Alter::DPRINT(const Str &s, const List<Alter> &la) {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_LOG_ENABLED(LOG_DEBUG)) {
         Print(s, la);
     }
 }
@@ -1560,8 +1909,7 @@ void Alter::Extend(const Past &currPast, const Past &basePast) {
 
     auto mapperopt = options::get("mapper");
     if (mapperopt == "maxfidelity") {
-        QL_FATAL("Mapper option maxfidelity has been disabled");
-        // score = quick_fidelity(past.lg);
+        score = -past.Fidelity();   // higher fidelity is better, and lower score is considered better
     } else {
         score = past.MaxFreeCycle() - basePast.MaxFreeCycle();
     }
@@ -1874,69 +2222,59 @@ public:
         Str initialplace2qhorizonopt = options::get("initialplace2qhorizon");
         Int prefix = parse_int(initialplace2qhorizonopt);
 
-        // compute ipusecount[] to know which virtual qubits are actually used
+        // the interaction graph of the circuit provides both the uses of the virtual qubits
+        // and the two-qubit gates between them, up to the specified max number of two-qubit gates;
+        // as before, any gate with two qubit operands counts as two-qubit gate, waits included
+        QL_DOUT("... compute interaction graph of circuit");
+        InteractionGraphOptions graph_options;
+        graph_options.max_two_qubit_gates = prefix > 0 ? prefix : 0;
+        graph_options.two_qubit_gates_only = true;
+        graph_options.include_waits = true;
+        InteractionGraph graph(circ, nvq, graph_options);
+
+        // use the use counts to know which virtual qubits are actually used
         // use it to compute v2i, mapping (non-contiguous) virtual qubit indices to contiguous facility indices
         // (the MIP model is shorter when the indices are contiguous)
-        // finally, nfac is set to the number of these facilities;
-        // only consider virtual qubit uses until the specified max number of two qubit gates has been seen
-        QL_DOUT("... compute ipusecount by scanning circuit");
-        Vec<UInt>  ipusecount;// ipusecount[v] = count of use of virtual qubit v in current circuit
-        ipusecount.resize(nvq,0);       // initially all 0
+        // finally, nfac is set to the number of these facilities
         Vec<UInt> v2i;        // v2i[virtual qubit index v] -> index of facility i
         v2i.resize(nvq,UNDEFINED_QUBIT);// virtual qubit v not used by circuit as gate operand
-
-        Int twoqubitcount = 0;
-        for (auto &gp : circ) {
-            if (prefix == 0 || twoqubitcount < prefix) {
-                for (auto v : gp->operands) {
-                    ipusecount[v] += 1;
-                }
-            }
-            if (gp->operands.size() == 2) {
-                twoqubitcount++;
-            }
-        }
         nfac = 0;
         for (UInt v=0; v < nvq; v++) {
-            if (ipusecount[v] != 0) {
+            if (graph.get_use_count(v) != 0) {
                 v2i[v] = nfac;
                 nfac += 1;
             }
         }
         QL_DOUT("... number of facilities: " << nfac << " while number of used virtual qubits is: " << nvq);
 
-        // precompute refcount (used by the model as constants) by scanning circuit;
-        // refcount[i][j] = count of two-qubit gates between facilities i and j in current circuit
+        // precompute refcount (used by the model as constants) from the interaction graph;
+        // refcount[i][j] = count of two-qubit gates between facilities i and j in current circuit,
+        // with i as first and j as second operand
         // at the same time, set anymap and currmap
         // anymap = there are no two-qubit gates so any map will do
         // currmap = in the current map, all two-qubit gates are NN so current map will do
-        QL_DOUT("... compute refcount by scanning circuit");
+        QL_DOUT("... compute refcount from interaction graph");
         Vec<Vec<UInt>>  refcount;
         refcount.resize(nfac); for (UInt i=0; i<nfac; i++) refcount[i].resize(nfac,0);
         Bool anymap = true;    // true when all refcounts are 0
         Bool currmap = true;   // true when in current map all two-qubit gates are NN
 
-        twoqubitcount = 0;
-        for (auto &gp : circ) {
-            auto &q = gp->operands;
-            if (q.size() == 2) {
-                if (prefix == 0 || twoqubitcount < prefix) {
-                    anymap = false;
-                    refcount[v2i[q[0]]][v2i[q[1]]] += 1;
-
-                    if (
-                        v2r[q[0]] == UNDEFINED_QUBIT
-                        || v2r[q[1]] == UNDEFINED_QUBIT
-                        || gridp->Distance(v2r[q[0]], v2r[q[1]]) > 1
-                    ) {
-                        currmap = false;
-                    }
+        for (UInt v = 0; v < nvq; v++) {
+            for (const auto &edge : graph.get_neighbors(v)) {
+                anymap = false;
+                refcount[v2i[v]][v2i[edge.qubit]] = edge.forward_count;
+
+                if (
+                    v2r[v] == UNDEFINED_QUBIT
+                    || v2r[edge.qubit] == UNDEFINED_QUBIT
+                    || gridp->Distance(v2r[v], v2r[edge.qubit]) > 1
+                ) {
+                    currmap = false;
                 }
-                twoqubitcount++;
             }
         }
-        if (prefix != 0 && twoqubitcount >= prefix) {
-            QL_DOUT("InitialPlace: only considered " << prefix << " of " << twoqubitcount << " two-qubit gates, so resulting mapping is not exact");
+        if (graph.is_truncated()) {
+            QL_DOUT("InitialPlace: only considered " << prefix << " of the two-qubit gates, so resulting mapping is not exact");
         }
         if (anymap) {
             QL_DOUT("InitialPlace: no two-qubit gates found, so no constraints, and any mapping is ok");
@@ -2127,14 +2465,14 @@ public:
         QL_DOUT("..2 nvq=" << nvq);
         Mip::SolveExitStatus s;
         QL_DOUT("Just before solve: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
-        QL_DOUT("Just before solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size() << " ipusecount.size()=" << ipusecount.size());
+        QL_DOUT("Just before solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size());
         QL_DOUT("..2b nvq=" << nvq);
         {
             s = mip.solve();
         }
         QL_DOUT("..3 nvq=" << nvq);
         QL_DOUT("Just after solve: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
-        QL_DOUT("Just after solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size() << " ipusecount.size()=" << ipusecount.size());
+        QL_DOUT("Just after solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size());
         QL_ASSERT(nvq == nlocs);         // consistency check, mainly to let it crash
 
         // computing iptimetaken, stop interval timer
@@ -2347,7 +2685,7 @@ void Mapper::GenShortestPaths(gate *gp, UInt src, UInt tgt, UInt budget, List<Al
         // add src to this path (so that it becomes a distance 0 path with one qubit, src)
         // and add the Alter to the result list
         Alter a;
-        a.Init(platformp, kernelp, &grid);
+        a.Init(platformp, kernelp, &grid, &factory);
         a.targetgp = gp;
         a.Add2Front(src);
         resla.push_back(a);
@@ -2540,6 +2878,7 @@ Alter Mapper::ChooseAlter(List<Alter> &la, Future &future) {
 
 // Map the gate/operands of a gate that has been routed or doesn't require routing
 void Mapper::MapRoutedGate(gate *gp, Past &past) {
+    QL_TRACE("mapper.map_gate", trace::id_of(gp));
     QL_DOUT("MapRoutedGate on virtual: " << gp->qasm() );
 
     // MakeReal of this gate maps its qubit operands and optionally updates its gate name
@@ -2560,6 +2899,7 @@ void Mapper::MapRoutedGate(gate *gp, Past &past) {
 // and taking it out of future when done with it
 void Mapper::CommitAlter(Alter &resa, Future &future, Past &past) {
     gate *resgp = resa.targetgp;   // and the 2q target gate then in resgp
+    QL_TRACE("mapper.commit_alter", trace::id_of(resgp));
     resa.DPRINT("... CommitAlter, alternative to commit, will add swaps and then map target 2q gate");
 
     Str mapselectswapsopt = options::get("mapselectswaps");
@@ -2675,7 +3015,7 @@ Bool Mapper::MapMappableGates(Future &future, Past &past, List<gate*> &lg, Bool
         }
         // avlist (qlg) only contains 2q gates (when alsoNN2q: only non-NN ones; otherwise also perhaps NN ones)
         lg = qlg;
-        if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+        if (QL_LOG_ENABLED(LOG_DEBUG)) {
             for (auto gp : lg) {
                 QL_DOUT("... 2q gate returned: " << gp->qasm());
             }
@@ -2827,8 +3167,7 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
             // DOUT("... ... SelectAlter level=" << level << ", no gates to evaluate next; RECURSION BOTTOM");
             auto mapperopt = options::get("mapper");
             if (mapperopt == "maxfidelity") {
-                QL_FATAL("Mapper option maxfidelity has been disabled");
-                // a.score = quick_fidelity(past_copy.lg);
+                a.score = -past_copy.Fidelity();
             } else {
                 a.score = past_copy.MaxFreeCycle() - basePast.MaxFreeCycle();
             }
@@ -2891,7 +3230,7 @@ void Mapper::MapCircuit(quantum_kernel &kernel, Virt2Real &v2r) {
     kernel.c.clear();       // future has copied kernel.c to private data; kernel.c ready for use by new_gate
     kernelp = &kernel;      // keep kernel to call kernelp->gate() inside Past.new_gate(), to create new gates
 
-    mainPast.Init(platformp, kernelp, &grid);  // mainPast and Past clones inside Alters ready for generating output schedules into
+    mainPast.Init(platformp, kernelp, &grid, &factory);  // mainPast and Past clones inside Alters ready for generating output schedules into
     mainPast.ImportV2r(v2r);    // give it the current mapping/state
     // mainPast.DPRINT("start mapping");
 
@@ -2910,6 +3249,55 @@ void Mapper::MapCircuit(quantum_kernel &kernel, Virt2Real &v2r) {
     nmovesadded = mainPast.NumberOfMovesAdded();
 }
 
+// Map the circuit's gates in the provided context (v2r maps), updating circuit and v2r maps,
+// for a multi-core platform in two levels (option mapmulticore=partition)
+void Mapper::MapCircuitPartitioned(quantum_kernel &kernel, Virt2Real &v2r) {
+    circuit input_gatepv = kernel.c;    // copy to allow kernel.c use by Past.new_gate
+    kernel.c.clear();
+    kernelp = &kernel;
+
+    Past mainPast;
+    mainPast.Init(platformp, kernelp, &grid, &factory);
+    mainPast.ImportV2r(v2r);
+
+    CorePartitioner partitioner;
+    partitioner.Init(&grid);
+    Vec<UInt> vcore(nq, UNDEFINED_QUBIT);
+    for (UInt v = 0; v < nq; v++) {
+        if (v2r[v] != UNDEFINED_QUBIT) {
+            vcore[v] = grid.CoreOf(v2r[v]);
+        }
+    }
+
+    UInt nslices = 0;
+    UInt start = 0;
+    while (start < input_gatepv.size()) {
+        UInt end = partitioner.NextSlice(input_gatepv, start, vcore);
+        QL_DOUT("MapCircuitPartitioned: slice " << nslices << " with gates " << start << " to " << end);
+        mainPast.MoveToCores(vcore);
+        for (UInt i = start; i < end; i++) {
+            gate *gp = input_gatepv[i];
+            if (gp->type() == __classical_gate__) {
+                mainPast.ByPass(gp);
+            } else if (gp->type() != __dummy_gate__) {
+                MapRoutedGate(gp, mainPast);
+            }
+        }
+        start = end;
+        nslices++;
+    }
+    mainPast.FlushAll();
+    QL_DOUT("MapCircuitPartitioned: " << nslices << " slices");
+
+    circuit outCirc;
+    mainPast.Out(outCirc);
+    kernel.c.swap(outCirc);
+    kernel.cycles_valid = true;
+    mainPast.ExportV2r(v2r);
+    nswapsadded = mainPast.NumberOfSwapsAdded();
+    nmovesadded = mainPast.NumberOfMovesAdded();
+}
+
 // decompose all gates that have a definition with _prim appended to its name
 void Mapper::MakePrimitives(quantum_kernel &kernel) {
     QL_DOUT("MakePrimitives circuit ...");
@@ -2918,7 +3306,7 @@ void Mapper::MakePrimitives(quantum_kernel &kernel) {
     kernel.c.clear();                           // kernel.c ready for use by new_gate
 
     Past            mainPast;                   // output window in which gates are scheduled
-    mainPast.Init(platformp, kernelp, &grid);
+    mainPast.Init(platformp, kernelp, &grid, &factory);
 
     for (auto & gp : input_gatepv) {
         circuit tmpCirc;
@@ -2983,7 +3371,11 @@ void Mapper::Map(quantum_kernel& kernel) {
     mapassumezeroinitstateopt = options::get("mapassumezeroinitstate");
     QL_DOUT("Mapper::Map before MapCircuit: mapassumezeroinitstateopt=" << mapassumezeroinitstateopt);
 
-    MapCircuit(kernel, v2r);        // updates kernel.c with swaps, maps all gates, updates v2r map
+    if (grid.ncores > 1 && options::get("mapmulticore") == "partition") {
+        MapCircuitPartitioned(kernel, v2r);     // idem, partitioning the virtual qubits over the cores
+    } else {
+        MapCircuit(kernel, v2r);    // updates kernel.c with swaps, maps all gates, updates v2r map
+    }
     v2r.DPRINT("After heuristics");
 
     MakePrimitives(kernel);         // decompose to primitives as specified in the config file
@@ -2995,11 +3387,28 @@ void Mapper::Map(quantum_kernel& kernel) {
     QL_DOUT("Mapping kernel " << kernel.name << " [DONE]");
 }
 
+// hash of the mapping that Map starts from
+// until inter-kernel mapping is implemented, this is the program initial mapping for each kernel
+UInt Mapper::EntryHash() const {
+    Virt2Real   v2r;
+    v2r.Init(nq);
+
+    Vec<UInt> v2rMap;
+    Vec<Int> rsMap;
+    v2r.Export(v2rMap);
+    v2r.Export(rsMap);
+
+    UInt seed = 0;
+    hash_combine_range(seed, v2rMap);
+    hash_combine_range(seed, rsMap);
+    return seed;
+}
+
 // initialize mapper for whole program
 // lots could be split off for the whole program, once that is needed
 //
 // initialization for a particular kernel is separate (in Map entry)
-void Mapper::Init(const quantum_platform *p) {
+void Mapper::Init(const quantum_platform *p, Grid *gridcache) {
     // DOUT("Mapping initialization ...");
     // DOUT("... Grid initialization: platform qubits->coordinates, ->neighbors, distance ...");
     platformp = p;
@@ -3010,7 +3419,17 @@ void Mapper::Init(const quantum_platform *p) {
     // DOUT("... platform/real number of qubits=" << nq << ");
     cycle_time = p->cycle_time;
 
-    grid.Init(platformp);
+    if (gridcache && gridcache->IsFor(platformp)) {
+        QL_DOUT("... Grid copied from the grid of a previous program on the same topology");
+        grid = *gridcache;
+        grid.platformp = platformp;
+    } else {
+        grid.Init(platformp);
+        if (gridcache) {
+            *gridcache = grid;
+        }
+    }
+    factory.Init();
 
     // DOUT("Mapping initialization [DONE]");
 }
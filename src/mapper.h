@@ -18,7 +18,7 @@
 #include "resource_manager.h"
 #include "gate.h"
 #include "scheduler.h"
-//#include "metrics.h"
+#include "metrics.h"
 
 namespace ql {
 namespace mapper {
@@ -103,12 +103,17 @@ public:
     utils::Map<utils::UInt,utils::Int> x;          // x[i] is x coordinate of qubit i
     utils::Map<utils::UInt,utils::Int> y;          // y[i] is y coordinate of qubit i
     utils::Vec<utils::Vec<utils::UInt>> dist;      // dist[i][j] is computed distance between qubits i and j;
+    utils::Str key;                                // qubit count and topology the grid was computed from
 
     // Grid initializer
     // initialize mapper internal grid maps from configuration
     // this remains constant over multiple kernels on the same platform
     void Init(const quantum_platform *p);
 
+    // whether Init was done for a platform with the same qubit count and topology as the given one,
+    // so that a copy of this grid can be used for it after pointing platformp to it
+    utils::Bool IsFor(const quantum_platform *p) const;
+
     // core index from qubit index
     // when multi-core assumes full and uniform core connectivity
     utils::UInt CoreOf(utils::UInt qi) const;
@@ -167,6 +172,40 @@ public:
 
 };
 
+// =========================================================================================
+// CorePartitioner: partitioning of the virtual qubits over the cores of a multi-core platform
+//
+// used by the two-level mapping of multi-core platforms (option mapmulticore=partition):
+// the circuit is cut into time slices, such that in each slice the virtual qubits that interact by multi-qubit gates
+// can be assigned to cores without any interaction crossing a core boundary;
+// each slice ends just before the gate that would make this impossible.
+// For each slice, the connected components of its interaction graph are assigned to cores,
+// each to the core with room that already holds most of its virtual qubits,
+// so that the number of virtual qubits that have to move to another core between slices (the cut between
+// the partitions of two consecutive slices) is kept low; the other virtual qubits stay where they are when possible.
+// Since within a core connectivity is full (see Grid::CoreOf), all multi-qubit gates of a slice are nearest neighbor
+// once the virtual qubits have been moved to their cores, so no routing within the cores is needed.
+class CorePartitioner {
+public:
+    // initialize for the given grid
+    void Init(const Grid *g);
+
+    // find the slice of circuit c that starts at gate index start;
+    // vcore[v] on entry is the core of virtual qubit v at the start of the slice, or UNDEFINED_QUBIT when v is not mapped;
+    // on return it is the core assigned to v for the slice, also for virtual qubits that the slice maps first;
+    // the index of the gate just behind the slice is returned
+    utils::UInt NextSlice(const circuit &c, utils::UInt start, utils::Vec<utils::UInt> &vcore) const;
+
+private:
+    const Grid                  *gridp;     // grid, to know the number of cores
+    utils::UInt                 nq;         // number of (real and virtual) qubits
+    utils::UInt                 ncores;     // number of cores
+    utils::UInt                 nqpc;       // number of qubits per core
+
+    // whether components of the given sizes can be assigned to the cores, by first-fit decreasing
+    utils::Bool Fits(utils::Vec<utils::UInt> sizes) const;
+};
+
 // =========================================================================================
 // Virt2Real: map of a virtual qubit index to its real qubit index
 //
@@ -366,6 +405,73 @@ public:
 
 };
 
+// =========================================================================================
+// GateFactory: creation of the gates that the mapper generates
+//
+// all gates that the mapper generates (swaps, moves, the _real and _prim versions of gates)
+// are created through quantum_kernel::gate_nonfatal;
+// for each gate, that builds the canonical "name q3,q5" form, searches the instruction map
+// for specialized and parameterized composite and custom gates, and expands decompositions;
+// because the mapper generates the same gates on the same real qubits over and over again,
+// the result of each creation is memoised, keyed on the gate name and its real qubit operands,
+// and later creations of the same gate just copy the gates of the stored expansion.
+//
+// there is one GateFactory per Mapper, shared by all Pasts (and so by the Pasts of all Alters);
+// it also holds the mapper options that determine which gates are generated,
+// so that these are not looked up again for each generated gate.
+class GateFactory {
+public:
+    utils::Bool                 genprim;        // mapper option is maxfidelity: generate _prim instead of _real gates
+    utils::Bool                 prepinitsstate; // option mapprepinitsstate: prepz leaves its operand in inited state
+
+    GateFactory();
+    ~GateFactory();
+
+    // (re)initialize for the current option values, clearing the cache
+    void Init();
+
+    // create the gate(s) for gname with given operands in kernel k's circuit k.c
+    // return whether this was successful;
+    // as quantum_kernel::gate_nonfatal, but memoised when no classical/bit operands nor condition are involved
+    utils::Bool Create(
+        quantum_kernel &k,
+        const utils::Str &gname,
+        const utils::Vec<utils::UInt> &qubits,
+        const utils::Vec<utils::UInt> &cregs,
+        utils::UInt duration,
+        utils::Real angle,
+        const utils::Vec<utils::UInt> &bregs,
+        cond_type_t gcond,
+        const utils::Vec<utils::UInt> &gcondregs
+    );
+
+private:
+    GateFactory(const GateFactory &) = delete;
+    GateFactory &operator=(const GateFactory &) = delete;
+
+    // key of a memoised expansion: gate name id, real qubit operands, and the remaining non-default parameters
+    struct key_t {
+        utils::UInt             name_id;
+        utils::Vec<utils::UInt> qubits;
+        utils::UInt             duration;
+        utils::Real             angle;
+        utils::Bool operator<(const key_t &other) const;
+    };
+
+    // memoised expansion: whether creation succeeded and the template gates that were created;
+    // when any of those cannot be copied, the expansion is not memoised and creation is done again each time
+    struct expansion_t {
+        utils::Bool             added;
+        utils::Bool             copyable;
+        utils::Vec<gate *>      gates;
+    };
+
+    void Clear();
+
+    utils::Map<utils::Str, utils::UInt> name_ids;   // gate name -> name id in keys
+    utils::Map<key_t, expansion_t>      expansions; // memoised expansions
+};
+
 // =========================================================================================
 // Past: state of the mapper while somewhere in the mapping process
 //
@@ -405,6 +511,7 @@ private:
     const quantum_platform      *platformp; // platform describing resources for scheduling
     quantum_kernel              *kernelp;   // current kernel for creating gates
     Grid                        *gridp;     // pointer to grid to know which hops are inter-core
+    GateFactory                 *factoryp;  // pointer to factory creating the gates that the mapper generates
 
     Virt2Real                   v2r;        // state: current Virt2Real map, imported/exported to kernel
     FreeCycle                   fc;         // state: FreeCycle map (including resource_manager) of this Past
@@ -424,6 +531,8 @@ private:
     //        although updated by set_cycle called from MakeAvailable/TakeAvailable
     utils::UInt                  nswapsadded;// number of swaps (including moves) added to this past
     utils::UInt                  nmovesadded;// number of moves added to this past
+    utils::Bool                  trackfidelity; // whether fidelity is updated, i.e. mapper option is maxfidelity
+    FidelityState                fidelity;   // state: estimated fidelity of the gates scheduled in this Past
 
 public:
 
@@ -432,7 +541,7 @@ public:
     Past();
 
     // past initializer
-    void Init(const quantum_platform *p, quantum_kernel *k, Grid *g);
+    void Init(const quantum_platform *p, quantum_kernel *k, Grid *g, GateFactory *f);
 
     // import Past's v2r from v2r_value
     void ImportV2r(const Virt2Real &v2r_value);
@@ -553,6 +662,10 @@ public:
 
     utils::UInt MaxFreeCycle() const;
 
+    // estimated fidelity of all gates scheduled in this past, for mapper option maxfidelity;
+    // it is updated incrementally while scheduling, so evaluating it doesn't rescan the gates
+    utils::Real Fidelity() const;
+
     // nonq and q gates follow separate flows through Past:
     // - q gates are put in waitinglg when added and then scheduled; and then ordered by cycle into lg
     //      in lg they are waiting to be inspected and scheduled, until [too many are there,] a nonq comes or end-of-circuit
@@ -566,6 +679,11 @@ public:
     // mainPast flushes outlg to parameter oc
     void Out(circuit &oc);
 
+    // for multi-core platforms: move the virtual qubits to the cores given by vcore, by swaps/moves between cores,
+    // and map the virtual qubits that are not mapped yet to free real qubits in their cores;
+    // vcore[v] is the core for virtual qubit v, or UNDEFINED_QUBIT when v should stay unmapped
+    void MoveToCores(const utils::Vec<utils::UInt> &vcore);
+
 };
 
 // =========================================================================================
@@ -606,6 +724,7 @@ public:
     const quantum_platform  *platformp;  // descriptions of resources for scheduling
     quantum_kernel          *kernelp;    // kernel pointer to allow calling kernel private methods
     Grid                    *gridp;      // grid pointer to know which hops are inter-core
+    GateFactory             *factoryp;   // factory pointer to create the gates that the mapper generates
     utils::UInt             nq;          // width of Past and Virt2Real map is number of real qubits
     utils::UInt             ct;          // cycle time, multiplier from cycles to nano-seconds
 
@@ -624,7 +743,7 @@ public:
 
     // Alter initializer
     // This should only be called after a virgin construction and not after cloning a path.
-    void Init(const quantum_platform *p, quantum_kernel *k, Grid *g);
+    void Init(const quantum_platform *p, quantum_kernel *k, Grid *g, GateFactory *f);
 
     // printing facilities of Paths
     // print path as hd followed by [0->1->2]
@@ -829,6 +948,7 @@ private:
     utils::UInt             cycle_time;     // length in ns of a single cycle of the platform
                                             // is divisor of duration in ns to convert it to cycles
     Grid                    grid;           // current grid
+    GateFactory             factory;        // creates the gates that the mapper generates, memoising their expansions
 
                                             // Initialized by Mapper.Map
     std::mt19937            gen;            // Standard mersenne_twister_engine, not yet seeded
@@ -946,6 +1066,12 @@ private:
     // Map the circuit's gates in the provided context (v2r maps), updating circuit and v2r maps
     void MapCircuit(quantum_kernel& kernel, Virt2Real& v2r);
 
+    // Map the circuit's gates in the provided context (v2r maps), updating circuit and v2r maps,
+    // for a multi-core platform in two levels (option mapmulticore=partition):
+    // cut the circuit in slices by CorePartitioner, move the virtual qubits to the cores assigned to them
+    // for each slice, and then map the gates of the slice, which don't need routing anymore
+    void MapCircuitPartitioned(quantum_kernel& kernel, Virt2Real& v2r);
+
 public:
 
     // decompose all gates that have a definition with _prim appended to its name
@@ -955,11 +1081,18 @@ public:
     // JvS: moved to mapper.cc ahead of restructuring everything else for persistent INITIALPLACE switch
     void Map(quantum_kernel &kernel);
 
+    // hash of the virtual to real qubit map and the real qubit states that Map starts mapping a kernel from;
+    // two kernels with identical circuits and entry states are mapped to the same result (see kernel_dedup.h)
+    utils::UInt EntryHash() const;
+
     // initialize mapper for whole program
     // lots could be split off for the whole program, once that is needed
     //
     // initialization for a particular kernel is separate (in Map entry)
-    void Init(const quantum_platform *p);
+    //
+    // when gridcache is given, the grid is copied from it when it is for the same topology,
+    // and otherwise it is computed and stored in gridcache for a next program on that platform
+    void Init(const quantum_platform *p, Grid *gridcache = nullptr);
 
 };
 
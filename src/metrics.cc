@@ -15,13 +15,16 @@ using namespace utils;
 template<typename T>
 
 void my_print(Vec<T> const &input, const char *id_name) {
+    if (!QL_LOG_ENABLED(LOG_DEBUG)) {
+        return;
+    }
     StrStrm output;
     output << id_name << "(" << input.size() << ")= ";
     for (auto const &i: input) {
         output << i << " ";
     }
     // output << "\n";
-    QL_IOUT(output.str());
+    QL_DOUT(output.str());
 }
 
 Real Metrics::gaussian_pdf(Real x, Real mean, Real sigma) {
@@ -79,13 +82,13 @@ void Metrics::Init(UInt Nqubits, quantum_platform *platform) {
 }
 
 Real Metrics::create_output(const Vec<Real> &fids) {
-    QL_IOUT("Creating output");
+    QL_DOUT("Creating output");
     Vec<Real> result_vector;
     result_vector = fids;
-    QL_IOUT("Creating output2");
+    QL_DOUT("Creating output2");
 
     PRINTER(result_vector);
-    QL_IOUT("Creating output2.5");
+    QL_DOUT("Creating output2.5");
     //We take out negative fidelities
     // UInt dimension = result_vector.size();
     // for (UInt element = dimension-1; element >=0 ; element--)
@@ -95,11 +98,11 @@ Real Metrics::create_output(const Vec<Real> &fids) {
     // PRINTER(result_vector);
     // }
 
-    QL_IOUT("Creating output3.5");
+    QL_DOUT("Creating output3.5");
     PRINTER(result_vector);
-    QL_IOUT("Creating output4");
+    QL_DOUT("Creating output4");
     if (output_mode == "worst") {
-        QL_IOUT("\nOutput mode: worst");
+        QL_DOUT("\nOutput mode: worst");
         return *std::min_element(fids.begin(), fids.end());
     } else if (output_mode == "average") { //DOES NOT WORK
         PRINTER(fids);
@@ -109,9 +112,9 @@ Real Metrics::create_output(const Vec<Real> &fids) {
         {
             sum += x;
         }
-        QL_DOUT("Sum fidelities :" + to_string(sum));
+        QL_DOUT("Sum fidelities :" << sum);
         Real average = sum / fids.size();
-        QL_DOUT("Average fidelity:" + to_string(average));
+        QL_DOUT("Average fidelity:" << average);
         return average;
     // } else if (output_mode == "gaussian") { //DOES NOT WORK
         // 	IOUT("\nOutput mode: gaussian");
@@ -129,7 +132,7 @@ Real Metrics::create_output(const Vec<Real> &fids) {
         // 	return 2*sum; // *2 to normalize (we use half gaussian). divide by Nqubits?
         // }
     } else {
-        QL_IOUT("\nOutput mode: error");
+        QL_DOUT("\nOutput mode: error");
         return 500;
     }
 
@@ -143,7 +146,7 @@ Real Metrics::bounded_fidelity(const circuit &circ, Vec<Real> &fids) {
     //TODO - URGENT!! do not consider the fidelity of used but non initialized qubits (set to 2/-1?)
 
     if (fids.empty()) {
-        QL_IOUT("EMPTY VECTOR - Initializing. Nqubits = " + to_string(Nqubits));
+        QL_DOUT("EMPTY VECTOR - Initializing. Nqubits = " << Nqubits);
         fids.resize(Nqubits, 1.0); //Initiallize a fidelity vector, if one is not provided
         //TODO: non initialized qubits should have undefined fidelity. It shouldn't be taken into account.
     }
@@ -152,12 +155,12 @@ Real Metrics::bounded_fidelity(const circuit &circ, Vec<Real> &fids) {
 
     PRINTER(fids);
     PRINTER(last_op_endtime);
-    QL_IOUT("\n\n");
+    QL_DOUT("\n\n");
 
-    QL_IOUT("Entered loop");
+    QL_DOUT("Entered loop");
     for (auto &gate : circ) {
 
-        QL_IOUT("Next gate\n");
+        QL_DOUT("Next gate\n");
 
         if (gate->name == "measure") {
             continue;
@@ -177,21 +180,21 @@ Real Metrics::bounded_fidelity(const circuit &circ, Vec<Real> &fids) {
         if (type_op == 1) {
             UInt qubit = gate->operands[0];
             UInt last_time = last_op_endtime[qubit];
-            QL_IOUT("Gate " + gate->name + "(" + to_string(gate->operands[0]) + ") at cycle " + to_string(gate->cycle) + " with duration " + to_string(gate->duration));
+            QL_DOUT("Gate " << gate->name << "(" << gate->operands[0] << ") at cycle " << gate->cycle << " with duration " << gate->duration);
             UInt idled_time = gate->cycle - last_time; //get idlying time to introduce decoherence. This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
 
             last_op_endtime[qubit] = gate->cycle  + gate->duration / CYCLE_TIME; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
 
-            QL_IOUT("Idled time:" + to_string(idled_time));
+            QL_DOUT("Idled time:" << idled_time);
 
 
             fids[qubit] *= exp(-((Real)idled_time)/decoherence_time); // Update fidelity with idling-caused decoherence
 
             fids[qubit] *= gatefid_1; //Update fidelity after gate
-            QL_IOUT("METRICS - one qubit gate - END");
+            QL_DOUT("METRICS - one qubit gate - END");
 
         } else if (type_op == 2) {
-            QL_IOUT("METRICS - TWO qubit gate");
+            QL_DOUT("METRICS - TWO qubit gate");
             UInt qubit_c = gate->operands[0];
             UInt qubit_t = gate->operands[1];
 
@@ -202,14 +205,14 @@ Real Metrics::bounded_fidelity(const circuit &circ, Vec<Real> &fids) {
             last_op_endtime[qubit_c] = gate->cycle  + gate->duration / CYCLE_TIME; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
             last_op_endtime[qubit_t] = gate->cycle  + gate->duration / CYCLE_TIME ; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
 
-            QL_IOUT("Gate " + gate->name + "(" + to_string(gate->operands[0]) + ", " + to_string(gate->operands[1]) + ") at cycle " + to_string(gate->cycle) + " with duration " + to_string(gate->duration));
-            QL_IOUT("Idled time q_c:" + to_string(idled_time_c));
-            QL_IOUT("Idled time q_t:" + to_string(idled_time_t) + " gate cycle=" + to_string(gate->cycle) + ". last_time_t=" + to_string(last_time_t));
+            QL_DOUT("Gate " << gate->name << "(" << gate->operands[0] << ", " << gate->operands[1] << ") at cycle " << gate->cycle << " with duration " << gate->duration);
+            QL_DOUT("Idled time q_c:" << idled_time_c);
+            QL_DOUT("Idled time q_t:" << idled_time_t << " gate cycle=" << gate->cycle << ". last_time_t=" << last_time_t);
 
             fids[qubit_c] *= exp(-(Real) idled_time_c/decoherence_time); // Update fidelity with idling-caused decoherence
             fids[qubit_t] *= exp(-(Real)idled_time_t/decoherence_time); // Update fidelity with idling-caused decoherence
 
-            QL_IOUT("Fidelity after idlying: ");
+            QL_DOUT("Fidelity after idlying: ");
             PRINTER(fids);
 
             fids[qubit_c] *=  fids[qubit_t] * gatefid_2; //Update fidelity after gate
@@ -220,7 +223,7 @@ Real Metrics::bounded_fidelity(const circuit &circ, Vec<Real> &fids) {
         PRINTER(fids);
         PRINTER(last_op_endtime);
 
-        QL_IOUT("\n NEXT GATE");
+        QL_DOUT("\n NEXT GATE");
 
     }
     UInt end_cycle = circ.back()->cycle + circ.back()->duration/CYCLE_TIME;
@@ -231,39 +234,137 @@ Real Metrics::bounded_fidelity(const circuit &circ, Vec<Real> &fids) {
 
     //Now we should still add decoherence effect in case the last gate was a two-qubit gate (the other qubits still decohere in the meantime!)
 
-    QL_IOUT(" \n\n THE END \n\n ");
-    QL_IOUT("Fidelity after idlying: ");
+    QL_DOUT(" \n\n THE END \n\n ");
+    QL_DOUT("Fidelity after idlying: ");
     PRINTER(fids);
     //Concatenating data into a single value, to serve as metric
     return create_output(fids);
 }
 
+/**
+ * Returns the number of qubits used by the given circuit, i.e. one more than
+ * the highest qubit operand.
+ */
+static UInt used_qubit_count(const circuit &circ) {
+    UInt count = 0;
+    for (auto &gate : circ) {
+        for (auto q : gate->operands) {
+            count = std::max(count, q + 1);
+        }
+    }
+    return count;
+}
+
 Real quick_fidelity(const List<gate*> &gate_list) {
-    Metrics estimator(17);
-    Vec<Real> previous_fids;
     circuit circuit;
     std::copy(std::begin(gate_list), std::end(gate_list), std::back_inserter(circuit));
-    Real fidelity = estimator.bounded_fidelity(circuit, previous_fids);
-    fidelity =- fidelity; //Symmetric value because lower score is considered better in mapper.h
-    return fidelity;
+    return quick_fidelity(circuit);
 }
 
 Real quick_fidelity_circuit(const circuit &circuit) {
-    Metrics estimator(17);
-    Vec<Real> previous_fids;
-    Real fidelity = estimator.bounded_fidelity(circuit, previous_fids);
-    fidelity =- fidelity; //Symmetric value because lower score is considered better in mapper.h
-    return fidelity;
+    return quick_fidelity(circuit);
 }
 
 Real quick_fidelity(const circuit &circuit) {
-    Metrics estimator(17);
+    Metrics estimator(used_qubit_count(circuit));
     Vec<Real> previous_fids;
     Real fidelity = estimator.bounded_fidelity(circuit, previous_fids);
     fidelity =- fidelity; //Symmetric value because lower score is considered better in mapper.h
     return fidelity;
 }
 
+void FidelityState::Init(const quantum_platform &platform) {
+    auto p = std::make_shared<Parameters>();
+    p->cycle_time = platform.cycle_time;
+    p->gatefid_1 = 0.999;
+    p->gatefid_2 = 0.99;
+    p->decoherence_cycles.resize(platform.qubit_number, 3000.0 / platform.cycle_time);
+
+    const Json &attributes = platform.qubit_attributes;
+    if (attributes.is_object()) {
+        auto rates = attributes.find("gate_error_rates");
+        if (rates != attributes.end()) {
+            if (rates->count("single_qubit") > 0) {
+                p->gatefid_1 = 1.0 - rates->at("single_qubit").get<Real>();
+            }
+            if (rates->count("two_qubit") > 0) {
+                p->gatefid_2 = 1.0 - rates->at("two_qubit").get<Real>();
+            }
+        }
+        auto times = attributes.find("relaxation_times");
+        if (times != attributes.end()) {
+            for (auto it = times->begin(); it != times->end(); ++it) {
+                UInt q = parse_uint(it.key());
+                if (q >= platform.qubit_number || !it->is_array() || it->empty()) {
+                    QL_FATAL("qubit_attributes.relaxation_times: invalid entry for qubit " << it.key());
+                }
+                p->decoherence_cycles[q] = it->at(0).get<Real>() / platform.cycle_time;
+            }
+        }
+    }
+    params = p;
+
+    fids.assign(platform.qubit_number, 1.0);
+    last_op_endtime.assign(platform.qubit_number, 1);
+    end_cycle = 1;
+}
+
+// apply the decoherence of qubit idling from the end of its last operation until cycle
+void FidelityState::idle_until(UInt qubit, UInt cycle) {
+    if (cycle > last_op_endtime[qubit]) {
+        fids[qubit] *= exp(-(Real)(cycle - last_op_endtime[qubit]) / params->decoherence_cycles[qubit]);
+    }
+}
+
+void FidelityState::Add(const gate *gp, UInt start_cycle) {
+    if (fids.empty()) {
+        return;
+    }
+    UInt end = start_cycle + (gp->duration + params->cycle_time - 1) / params->cycle_time;
+    end_cycle = std::max(end_cycle, end);
+
+    Str name = gp->name.substr(0, gp->name.find(' '));
+    if (name == "measure") {
+        return;
+    } else if (name == "prepz" || name == "prep_z") {
+        UInt qubit = gp->operands[0];
+        fids[qubit] = 1.0;
+        last_op_endtime[qubit] = end;
+        return;
+    }
+
+    if (gp->operands.size() == 1) {
+        UInt qubit = gp->operands[0];
+        idle_until(qubit, start_cycle);
+        fids[qubit] *= params->gatefid_1;
+        last_op_endtime[qubit] = end;
+    } else if (gp->operands.size() == 2) {
+        UInt qubit_c = gp->operands[0];
+        UInt qubit_t = gp->operands[1];
+        idle_until(qubit_c, start_cycle);
+        idle_until(qubit_t, start_cycle);
+        fids[qubit_c] *= fids[qubit_t] * params->gatefid_2;
+        fids[qubit_t] = fids[qubit_c];
+        last_op_endtime[qubit_c] = end;
+        last_op_endtime[qubit_t] = end;
+    }
+}
+
+Real FidelityState::Fidelity() const {
+    if (fids.empty()) {
+        return 1.0;
+    }
+    Real sum = 0;
+    for (UInt q = 0; q < fids.size(); q++) {
+        Real fid = fids[q];
+        if (end_cycle > last_op_endtime[q]) {
+            fid *= exp(-(Real)(end_cycle - last_op_endtime[q]) / params->decoherence_cycles[q]);
+        }
+        sum += fid;
+    }
+    return sum / fids.size();
+}
+
 // const unsigned char transition_matrix[4][4]  = {{ 0, 1, 2, 3 },  //[input_state][new_error]
 // 					   						    { 1, 0, 3, 2 },  //I = 0, X = 1, Y = 2, Z = 3
 // 											    { 2, 3, 0, 1 },
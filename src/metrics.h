@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/vec.h"
@@ -68,6 +69,56 @@ public:
 
 };
 
+/**
+ * Incremental version of the bounded fidelity estimate, for use while gates
+ * are being scheduled one by one, e.g. by the mapper. Instead of rescanning a
+ * circuit, it keeps the fidelity and the end cycle of the last operation of
+ * each qubit, which are updated in constant time for each added gate. Copying
+ * a FidelityState is cheap, since the parameters read from the platform are
+ * shared between copies.
+ *
+ * The parameters are taken from the qubit_attributes section of the platform
+ * configuration file: the first of the relaxation_times of each qubit (in ns)
+ * is its decoherence time, and gate_error_rates may specify single_qubit and
+ * two_qubit error rates. Missing values default to those of Metrics.
+ */
+class FidelityState {
+public:
+    FidelityState() = default;
+
+    /**
+     * Resets the state to all qubits being at fidelity 1 at the first cycle,
+     * and loads the parameters from the given platform.
+     */
+    void Init(const quantum_platform &platform);
+
+    /**
+     * Updates the state for the given gate, scheduled at the given cycle. Gates
+     * must be added in order of their start cycle per qubit.
+     */
+    void Add(const gate *gp, utils::UInt start_cycle);
+
+    /**
+     * Returns the average fidelity over all qubits, including decoherence of
+     * each qubit from its last operation to the end of the latest one.
+     */
+    utils::Real Fidelity() const;
+
+private:
+    struct Parameters {
+        utils::UInt cycle_time;
+        utils::Real gatefid_1;
+        utils::Real gatefid_2;
+        utils::Vec<utils::Real> decoherence_cycles;  // per qubit
+    };
+    std::shared_ptr<const Parameters> params;
+    utils::Vec<utils::Real> fids;                   // per qubit
+    utils::Vec<utils::UInt> last_op_endtime;        // per qubit, first cycle has index 1
+    utils::UInt end_cycle = 1;
+
+    void idle_until(utils::UInt qubit, utils::UInt cycle);
+};
+
 utils::Real quick_fidelity(const utils::List<gate*> &gate_list);
 utils::Real quick_fidelity_circuit(const circuit &circuit);
 utils::Real quick_fidelity(const circuit &circuit);
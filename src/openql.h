@@ -8,5 +8,6 @@
 #include "optimizer.h"
 #include "circuit.h"
 #include "program.h"
+#include "snapshot.h"
 #include "compiler.h"
 #include "cqasm/cqasm_reader.h"
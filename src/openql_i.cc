@@ -117,6 +117,18 @@ bool Unitary::is_decompose_support_enabled() {
     return ql::unitary::is_decompose_support_enabled();
 }
 
+void Unitary::clear_decomposition_cache() {
+    ql::unitary::clear_decomposition_cache();
+}
+
+size_t Unitary::get_decomposition_cache_hits() {
+    return ql::unitary::get_decomposition_cache_hits();
+}
+
+size_t Unitary::get_decomposition_cache_misses() {
+    return ql::unitary::get_decomposition_cache_misses();
+}
+
 Kernel::Kernel(const std::string &name) : name(name) {
     QL_DOUT(" API::Kernel named: " << name);
     kernel = new ql::quantum_kernel(name);
@@ -257,6 +269,10 @@ std::string Kernel::get_custom_instructions() const {
     return kernel->get_gates_definition();
 }
 
+size_t Kernel::get_gate_count() const {
+    return kernel->get_circuit().size();
+}
+
 void Kernel::display() {
     kernel->display();
 }
@@ -459,11 +475,116 @@ void Program::add_for(const Program &p, size_t iterations) {
     program->add_for( *(p.program), iterations);
 }
 
+/**
+ * Returns a copy of the wrapped kernel that takes over its gates, so the
+ * (potentially large) circuit is moved instead of copied. The wrapped kernel
+ * is left empty but usable, also when adding the copy fails.
+ */
+static ql::quantum_kernel take_gates(Kernel &k) {
+    ql::circuit gates = std::move(k.kernel->c);
+    k.kernel->c = ql::circuit();
+    k.kernel->circuit_changed();
+    ql::quantum_kernel taken(*(k.kernel));
+    taken.c = std::move(gates);
+    return taken;
+}
+
+void Program::add_kernel(Kernel &k, bool take) {
+    if (take) {
+        program->add(take_gates(k));
+    } else {
+        program->add(*(k.kernel));
+    }
+}
+
+void Program::add_program(Program &p, bool take) {
+    if (take) {
+        program->add_program(std::move(*(p.program)));
+    } else {
+        program->add_program(*(p.program));
+    }
+}
+
+void Program::add_if(Kernel &k, const Operation &operation, bool take) {
+    if (take) {
+        program->add_if(take_gates(k), *(operation.operation));
+    } else {
+        program->add_if(*(k.kernel), *(operation.operation));
+    }
+}
+
+void Program::add_if(Program &p, const Operation &operation, bool take) {
+    if (take) {
+        program->add_if(std::move(*(p.program)), *(operation.operation));
+    } else {
+        program->add_if(*(p.program), *(operation.operation));
+    }
+}
+
+void Program::add_if_else(Kernel &k_if, Kernel &k_else, const Operation &operation, bool take) {
+    if (take) {
+        program->add_if_else(take_gates(k_if), take_gates(k_else), *(operation.operation));
+    } else {
+        program->add_if_else(*(k_if.kernel), *(k_else.kernel), *(operation.operation));
+    }
+}
+
+void Program::add_if_else(Program &p_if, Program &p_else, const Operation &operation, bool take) {
+    if (take) {
+        program->add_if_else(std::move(*(p_if.program)), std::move(*(p_else.program)), *(operation.operation));
+    } else {
+        program->add_if_else(*(p_if.program), *(p_else.program), *(operation.operation));
+    }
+}
+
+void Program::add_do_while(Kernel &k, const Operation &operation, bool take) {
+    if (take) {
+        program->add_do_while(take_gates(k), *(operation.operation));
+    } else {
+        program->add_do_while(*(k.kernel), *(operation.operation));
+    }
+}
+
+void Program::add_do_while(Program &p, const Operation &operation, bool take) {
+    if (take) {
+        program->add_do_while(std::move(*(p.program)), *(operation.operation));
+    } else {
+        program->add_do_while(*(p.program), *(operation.operation));
+    }
+}
+
+void Program::add_for(Kernel &k, size_t iterations, bool take) {
+    if (take) {
+        program->add_for(take_gates(k), iterations);
+    } else {
+        program->add_for(*(k.kernel), iterations);
+    }
+}
+
+void Program::add_for(Program &p, size_t iterations, bool take) {
+    if (take) {
+        program->add_for(std::move(*(p.program)), iterations);
+    } else {
+        program->add_for(*(p.program), iterations);
+    }
+}
+
 void Program::compile() {
     //program->compile();
     program->compile_modular();
 }
 
+void Program::save_snapshot(const std::string &file_name) const {
+    ql::save_snapshot(*program, file_name);
+}
+
+void Program::load_snapshot(const std::string &file_name) {
+    ql::load_snapshot(*program, file_name);
+    qubit_count = program->qubit_count;
+    creg_count = program->creg_count;
+    breg_count = program->breg_count;
+}
+
 std::string Program::microcode() const {
 #if OPT_MICRO_CODE
     return program->microcode();
@@ -553,3 +674,19 @@ void Compiler::set_pass_option(
     QL_DOUT(" Set option " << optionName << " = " << optionValue << " for pass " << passName);
     compiler->setPassOption(passName,optionName, optionValue);
 }
+
+std::string Compiler::get_pass_profile() const {
+    return compiler->getPassProfile().dump(4);
+}
+
+std::vector<std::string> compile_many(const std::vector<Program*> &programs, size_t num_threads) {
+    ql::utils::Vec<ql::quantum_program*> qprograms;
+    for (Program *program : programs) {
+        qprograms.push_back(program->program);
+    }
+    std::vector<std::string> profiles;
+    for (const auto &profile : ql::compile_many(qprograms, num_threads)) {
+        profiles.push_back(profile.dump(4));
+    }
+    return profiles;
+}
@@ -62,6 +62,9 @@ public:
     ~Unitary();
     void decompose();
     static bool is_decompose_support_enabled();
+    static void clear_decomposition_cache();
+    static size_t get_decomposition_cache_hits();
+    static size_t get_decomposition_cache_misses();
 };
 
 /**
@@ -114,6 +117,7 @@ public:
     void wait(const std::vector<size_t> &qubits, size_t duration);
     void barrier(const std::vector<size_t> &qubits = std::vector<size_t>());
     std::string get_custom_instructions() const;
+    size_t get_gate_count() const;
     void display();
     void gate(
         const std::string &name,
@@ -186,7 +190,21 @@ public:
     void add_do_while(const Program &p, const Operation &operation);
     void add_for(const Kernel &k, size_t iterations);
     void add_for(const Program &p, size_t iterations);
+    // with take set, the contents of the kernels are moved into this program
+    // instead of copied, leaving the given kernels/programs empty
+    void add_kernel(Kernel &k, bool take);
+    void add_program(Program &p, bool take);
+    void add_if(Kernel &k, const Operation &operation, bool take);
+    void add_if(Program &p, const Operation &operation, bool take);
+    void add_if_else(Kernel &k_if, Kernel &k_else, const Operation &operation, bool take);
+    void add_if_else(Program &p_if, Program &p_else, const Operation &operation, bool take);
+    void add_do_while(Kernel &k, const Operation &operation, bool take);
+    void add_do_while(Program &p, const Operation &operation, bool take);
+    void add_for(Kernel &k, size_t iterations, bool take);
+    void add_for(Program &p, size_t iterations, bool take);
     void compile();
+    void save_snapshot(const std::string &file_name) const;
+    void load_snapshot(const std::string &file_name);
     std::string microcode() const;
     void print_interaction_matrix() const;
     void write_interaction_matrix() const;
@@ -227,4 +245,11 @@ public:
         const std::string &optionName,
         const std::string &optionValue
     );
+    std::string get_pass_profile() const;
 };
+
+/**
+ * compiles several programs, possibly on several threads, with one pass
+ * pipeline per thread and backend
+ */
+std::vector<std::string> compile_many(const std::vector<Program*> &programs, size_t num_threads = 1);
@@ -24,31 +24,158 @@ public:
 
 /**
  * rotation fuser
+ *
+ * Walks the circuit once, keeping for every qubit the run of single-qubit
+ * gates since the last gate that blocks it, together with the running product
+ * of their matrices after each gate of the run. A window of the run multiplies
+ * to the identity (up to global phase) exactly when the running products at
+ * both of its ends are equal, so when a new gate makes the product equal to
+ * that of an earlier point in the run, everything after that point is removed.
+ * Only the last MAX_WINDOW points are compared, which keeps the whole thing
+ * linear in the number of gates.
+ *
+ * Multi-qubit gates, measurements, conditional gates and gates without a
+ * unitary matrix end the runs of their qubits. With optimize_commute, cz and
+ * cphase (on either qubit) and cnot (on its control) don't end the run but act
+ * like the scheduler's commuting reads: a window that spans them is only
+ * removed when all its gates are diagonal, i.e. commute with them.
  */
 class rotations_merging : public optimizer {
 public:
 
-    circuit optimize(circuit &ic /*, bool verbose=false */) override {
-        circuit c = ic;
-        // if (verbose) COUT("optimizing circuit...");
-        for (size_t i = c.size(); i > 1; i--) {
-            // println("window size : " << i);
-            c = optimize_sliding_window(c,i);
-            if (c.size() < i) {
-                break;
+    circuit optimize(circuit &ic) override {
+        Bool commute = options::get("optimize_commute") == "yes";
+        UInt nqubits = 0;
+        for (auto gp : ic) {
+            for (auto q : gp->operands) {
+                nqubits = max(nqubits, q + 1);
+            }
+        }
+        Vec<run_t> runs(nqubits);
+        Vec<Bool> removed(ic.size(), false);
+
+        for (UInt i = 0; i < ic.size(); i++) {
+            gate *gp = ic[i];
+            if (is_candidate(gp)) {
+                runs[gp->operands[0]].push(i, gp->mat(), removed);
+            } else if (gp->operands.empty()) {
+                // e.g. wait and classical gates, which we conservatively assume touch all qubits
+                for (auto &run : runs) {
+                    run.reset();
+                }
+            } else {
+                for (UInt n = 0; n < gp->operands.size(); n++) {
+                    auto &run = runs[gp->operands[n]];
+                    if (commute && commutes_with_diagonal(gp, n)) {
+                        run.barrier();
+                    } else {
+                        run.reset();
+                    }
+                }
             }
         }
 
-        if (c.size() > 1) {
-            c = optimize_sliding_window(c,2);
+        circuit oc;
+        for (UInt i = 0; i < ic.size(); i++) {
+            if (!removed[i]) {
+                oc.push_back(ic[i]);
+            }
         }
+        return oc;
+    }
+
+protected:
 
-        // if (verbose) COUT("optimization done.");
+#define __epsilon__ (1e-4)
+
+    static const UInt MAX_WINDOW = 64;
+
+    /**
+     * A point in the run of a qubit: the gate that ended there and the product
+     * of the run up to and including it.
+     */
+    struct point_t {
+        UInt index;                 // index of the gate in the circuit
+        cmat_t product;             // product of the matrices of the run up to here
+        UInt last_nondiagonal;      // number of points up to the last non-diagonal gate
+    };
+
+    struct run_t {
+        Vec<point_t> points;        // points of the run after the start
+        UInt last_barrier = 0;      // number of points before the last commuting barrier
+
+        void reset() {
+            points.clear();
+            last_barrier = 0;
+        }
 
-        return c;
+        void barrier() {
+            last_barrier = points.size();
+        }
+
+        void push(UInt index, const cmat_t &mat, Vec<Bool> &removed) {
+            point_t p;
+            p.index = index;
+            p.product = points.empty() ? mat : fuse(mat, points.back().product);
+            p.last_nondiagonal = is_diagonal(mat) ? (points.empty() ? 0 : points.back().last_nondiagonal) : points.size() + 1;
+
+            // look for the most recent earlier point with the same product; the
+            // gates after it up to and including this one form an identity (like
+            // before, single gates are left alone even when they are the identity)
+            UInt lowest = points.size() > MAX_WINDOW ? points.size() - MAX_WINDOW : 0;
+            for (UInt n = points.size(); n-- > lowest; ) {
+                if (n < last_barrier && p.last_nondiagonal > n) {
+                    break;
+                }
+                Bool same = n == 0 ? is_id(p.product) : is_same(p.product, points[n - 1].product);
+                if (same) {
+                    removed[index] = true;
+                    for (UInt k = n; k < points.size(); k++) {
+                        removed[points[k].index] = true;
+                    }
+                    points.resize(n);
+                    last_barrier = min(last_barrier, n);
+                    return;
+                }
+            }
+            points.push_back(p);
+        }
+    };
+
+    // whether gp is a single-qubit gate with a unitary matrix that we may remove
+    static Bool is_candidate(const gate *gp) {
+        if (gp->operands.size() != 1 || !gp->creg_operands.empty() || !gp->breg_operands.empty() || gp->is_conditional()) {
+            return false;
+        }
+        switch (gp->type()) {
+            case __prepz_gate__:
+            case __measure_gate__:
+            case __display__:
+            case __display_binary__:
+            case __nop_gate__:
+            case __dummy_gate__:
+            case __wait_gate__:
+            case __classical_gate__:
+                return false;
+            default:
+                break;
+        }
+        if (gp->name.find("measure") == 0 || gp->name.find("prep") == 0) {
+            return false;
+        }
+        return is_unitary(gp->mat());
     }
 
-protected:
+    // whether operand n of gp commutes with diagonal single-qubit gates on it
+    static Bool commutes_with_diagonal(const gate *gp, UInt n) {
+        if (gp->is_conditional()) {
+            return false;
+        }
+        if (gp->name == "cz" || gp->name == "cphase") {
+            return true;
+        }
+        return gp->name == "cnot" && n == 0;
+    }
 
     static cmat_t fuse(const cmat_t &m1, const cmat_t &m2) {
         cmat_t res;
@@ -56,138 +183,58 @@ protected:
         const Complex *y = m2.m;
         Complex *r = res.m;
 
-        // m1.dump();
-        // m2.dump();
-
         r[0] = x[0]*y[0] + x[1]*y[2];
         r[1] = x[0]*y[1] + x[1]*y[3];
         r[2] = x[2]*y[0] + x[3]*y[2];
         r[3] = x[2]*y[1] + x[3]*y[3];
 
-        // res.dump();
-
         return res;
     }
 
-#define __epsilon__ (1e-4)
-
-    static bool is_id(const cmat_t &mat) {
-        // mat.dump();
+    static Bool is_unitary(const cmat_t &mat) {
         const Complex *m = mat.m;
-        if ((abs(abs(m[0].real())-1.0))>__epsilon__) return false;
-        if ((abs(m[0].imag())  )>__epsilon__) return false;
-        if ((abs(m[1].real())  )>__epsilon__) return false;
-        if ((abs(m[1].imag())  )>__epsilon__) return false;
-        if ((abs(m[2].real())  )>__epsilon__) return false;
-        if ((abs(m[2].imag())  )>__epsilon__) return false;
-        if ((abs(abs(m[3].real())-1.0))>__epsilon__) return false;
-        if ((abs(m[3].imag())  )>__epsilon__) return false;
+        if (std::abs(std::norm(m[0]) + std::norm(m[2]) - 1.0) > __epsilon__) return false;
+        if (std::abs(std::norm(m[1]) + std::norm(m[3]) - 1.0) > __epsilon__) return false;
+        if (std::abs(std::conj(m[0])*m[1] + std::conj(m[2])*m[3]) > __epsilon__) return false;
         return true;
     }
 
-    static bool is_identity(const circuit &c) {
-        if (c.size() == 1) {
-            return false;
-        }
-        cmat_t m = c[0]->mat();
-        for (size_t i = 1; i < c.size(); ++i) {
-            cmat_t m2 = c[i]->mat();
-            m = fuse(m,m2);
-        }
-        return is_id(m);
+    static Bool is_diagonal(const cmat_t &mat) {
+        return std::abs(mat.m[1]) <= __epsilon__ && std::abs(mat.m[2]) <= __epsilon__;
     }
 
-    static circuit optimize_sliding_window(circuit &c, size_t window_size) {
-        circuit oc;
-        Vec<int> id_pos;
-        for (size_t i = 0; i < c.size() - window_size + 1; ++i) {
-            circuit w;
-            w.insert(w.begin(),c.begin()+i,c.begin()+i+window_size);
-            if (is_identity(w)) {
-                id_pos.push_back(i);
-            }
-        }
-        if (id_pos.empty()) {
-            return circuit(c);
-        }
-        // println("id pos:");
-        // for (size_t i=0; i<id_pos.size(); i++)
-        // println(id_pos[i]);
-
-        if (id_pos.size() == 1) {
-            // COUT("rotations cancelling...");
-            size_t pos = id_pos[0];
-            size_t i=0;
-            while (i < c.size()) {
-                if (i == pos) {
-                    i += window_size;
-                } else {
-                    oc.push_back(c[i]);
-                    i++;
-                }
-            }
-            return oc;
-        }
-
-        // COUT("removing overlapping windows...");
-        Vec<int> pid;
-        // int prev = id_pos[0];
-        // COUT("rotation cancelling...");
-        size_t pos = id_pos[0];
-        size_t ip = 0;
-        size_t i = 0;
-        while (i < c.size()) {
-            if (i == pos) {
-                i += window_size;
-                ip++;
-                if (ip < id_pos.size()) {
-                    pos = id_pos[ip];
-                }
-            } else {
-                oc.push_back(c[i]);
-                i++;
-            }
-        }
+    // identity up to global phase
+    static Bool is_id(const cmat_t &mat) {
+        return is_diagonal(mat) && std::abs(mat.m[0] - mat.m[3]) <= __epsilon__;
+    }
 
-        return oc;
+    // equal up to global phase; for unitaries, a = b.phase iff a.b^dagger is the identity
+    static Bool is_same(const cmat_t &a, const cmat_t &b) {
+        cmat_t bdag;
+        bdag.m[0] = std::conj(b.m[0]);
+        bdag.m[1] = std::conj(b.m[2]);
+        bdag.m[2] = std::conj(b.m[1]);
+        bdag.m[3] = std::conj(b.m[3]);
+        return is_id(fuse(a, bdag));
     }
 
 };
 
 inline void rotation_optimize_kernel(quantum_kernel &kernel, const quantum_platform &platform) {
-    QL_DOUT("kernel " << kernel.name << " optimize_kernel(): circuit before optimizing: ");
-    print(kernel.c);
-    QL_DOUT("... end circuit");
-    rotations_merging rm;
-    if (contains_measurements(kernel.c)) {
-        QL_DOUT("kernel contains measurements ...");
-        // decompose the circuit
-        Vec<circuit*> cs = split_circuit(kernel.c);
-        Vec<circuit> cs_opt;
-        for (auto c : cs)
-        {
-            if (!contains_measurements(*c)) {
-                circuit opt = rm.optimize(*c);
-                cs_opt.push_back(opt);
-            } else {
-                cs_opt.push_back(*c);
-            }
-        }
-        // for (int i=0; i<cs_opt.size(); ++i)
-        // print(cs_opt[i]);
-        kernel.c.clear( );
-        for (size_t i = 0; i < cs_opt.size(); ++i) {
-            for (size_t j = 0; j < cs_opt[i].size(); j++) {
-                kernel.c.push_back(cs_opt[i][j]);
-            }
-        }
-    } else {
-        kernel.c = rm.optimize(kernel.c);
+    Bool debug = QL_LOG_ENABLED(LOG_DEBUG);
+    if (debug) {
+        QL_DOUT("kernel " << kernel.name << " optimize_kernel(): circuit before optimizing: ");
+        print(kernel.c);
+        QL_DOUT("... end circuit");
     }
+    rotations_merging rm;
+    kernel.c = rm.optimize(kernel.c);
     kernel.cycles_valid = false;
-    QL_DOUT("kernel " << kernel.name << " rotation_optimize(): circuit after optimizing: ");
-    print(kernel.c);
-    QL_DOUT("... end circuit");
+    if (debug) {
+        QL_DOUT("kernel " << kernel.name << " rotation_optimize(): circuit after optimizing: ");
+        print(kernel.c);
+        QL_DOUT("... end circuit");
+    }
 }
 
 // rotation_optimize pass
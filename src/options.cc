@@ -6,6 +6,7 @@
 
 #include "utils/exception.h"
 #include "utils/logger.h"
+#include "utils/trace.h"
 #include "utils/filesystem.h"
 #include "utils/map.h"
 #include "utils/vec.h"
@@ -30,10 +31,15 @@ private:
         opt_name2opt_val.set("write_report_files") = "no";
 
         opt_name2opt_val.set("optimize") = "no";
+        opt_name2opt_val.set("optimize_commute") = "no";
         opt_name2opt_val.set("use_default_gates") = "yes";
         opt_name2opt_val.set("decompose_toffoli") = "no";
         opt_name2opt_val.set("quantumsim") = "no";
         opt_name2opt_val.set("issue_skip_319") = "no";
+        opt_name2opt_val.set("cqasm_fast_path") = "yes";
+        opt_name2opt_val.set("unitary_decomposition_cache") = "yes";
+        opt_name2opt_val.set("unitary_decomposition_parallel") = "no";
+        opt_name2opt_val.set("unitary_decomposition_optimize") = "no";
 
         opt_name2opt_val.set("scheduler") = "ALAP";
         opt_name2opt_val.set("scheduler_uniform") = "no";
@@ -41,14 +47,20 @@ private:
         opt_name2opt_val.set("prescheduler") = "yes";
         opt_name2opt_val.set("scheduler_post179") = "yes";
         opt_name2opt_val.set("backend_cc_map_input_file") = "";
+        opt_name2opt_val.set("backend_cc_loop_compaction") = "no";
 
         opt_name2opt_val.set("cz_mode") = "manual";
+        opt_name2opt_val.set("ccl_loop_compression") = "no";
         opt_name2opt_val.set("print_dot_graphs") = "no";
+        opt_name2opt_val.set("write_pass_profile") = "no";
+        opt_name2opt_val.set("trace_buffer_size") = "0";
+        opt_name2opt_val.set("kernel_dedup") = "no";
 
         opt_name2opt_val.set("clifford_prescheduler") = "no";
         opt_name2opt_val.set("clifford_postscheduler") = "no";
         opt_name2opt_val.set("clifford_premapper") = "no";
         opt_name2opt_val.set("clifford_postmapper") = "no";
+        opt_name2opt_val.set("clifford_twoqubit_frames") = "no";
 
         opt_name2opt_val.set("mapper") = "no";
         opt_name2opt_val.set("mapassumezeroinitstate") = "no";
@@ -65,6 +77,7 @@ private:
         opt_name2opt_val.set("maptiebreak") = "random";
         opt_name2opt_val.set("mapusemoves") = "yes";
         opt_name2opt_val.set("mapreverseswap") = "yes";
+        opt_name2opt_val.set("mapmulticore") = "flat";
 
         // add options with default values and list of possible values
         app->add_set_ignore_case("--log_level", opt_name2opt_val.at("log_level"),
@@ -74,20 +87,31 @@ private:
         app->add_set_ignore_case("--prescheduler", opt_name2opt_val.at("prescheduler"), {"no", "yes"}, "Run qasm (first) scheduler?", true);
         app->add_set_ignore_case("--scheduler_post179", opt_name2opt_val.at("scheduler_post179"), {"no", "yes"}, "Issue 179 solution included", true);
         app->add_set_ignore_case("--print_dot_graphs", opt_name2opt_val.at("print_dot_graphs"), {"no", "yes"}, "Print (un-)scheduled graphs in DOT format", true);
+        app->add_option("--trace_buffer_size", opt_name2opt_val.at("trace_buffer_size"), "Number of events kept in the binary trace written to <program>_trace.bin; 0 disables tracing", true);
+        app->add_set_ignore_case("--write_pass_profile", opt_name2opt_val.at("write_pass_profile"), {"no", "yes"}, "Write the time, memory and gate counts per pass to <program>_pass_profile.json", true);
         app->add_set_ignore_case("--scheduler", opt_name2opt_val.at("scheduler"), {"ASAP", "ALAP"}, "scheduler type", true);
         app->add_set_ignore_case("--scheduler_uniform", opt_name2opt_val.at("scheduler_uniform"), {"yes", "no"}, "Do uniform scheduling or not", true);
         app->add_set_ignore_case("--scheduler_commute", opt_name2opt_val.at("scheduler_commute"), {"yes", "no"}, "Commute gates when possible, or not", true);
         app->add_set_ignore_case("--use_default_gates", opt_name2opt_val.at("use_default_gates"), {"yes", "no"}, "Use default gates or not", true);
         app->add_set_ignore_case("--optimize", opt_name2opt_val.at("optimize"), {"yes", "no"}, "optimize or not", true);
+        app->add_set_ignore_case("--optimize_commute", opt_name2opt_val.at("optimize_commute"), {"yes", "no"}, "let the optimizer cancel diagonal gates through cz and cnot controls", true);
         app->add_set_ignore_case("--clifford_prescheduler", opt_name2opt_val.at("clifford_prescheduler"), {"yes", "no"}, "clifford optimize before prescheduler yes or not", true);
         app->add_set_ignore_case("--clifford_postscheduler", opt_name2opt_val.at("clifford_postscheduler"), {"yes", "no"}, "clifford optimize after prescheduler yes or not", true);
         app->add_set_ignore_case("--clifford_premapper", opt_name2opt_val.at("clifford_premapper"), {"yes", "no"}, "clifford optimize before mapping yes or not", true);
         app->add_set_ignore_case("--clifford_postmapper", opt_name2opt_val.at("clifford_postmapper"), {"yes", "no"}, "clifford optimize after mapping yes or not", true);
+        app->add_set_ignore_case("--clifford_twoqubit_frames", opt_name2opt_val.at("clifford_twoqubit_frames"), {"yes", "no"}, "let clifford optimization move accumulated cliffords through cz and cnot", true);
         app->add_set_ignore_case("--decompose_toffoli", opt_name2opt_val.at("decompose_toffoli"), {"no", "NC", "AM"}, "Type of decomposition used for toffoli", true);
         app->add_set_ignore_case("--quantumsim", opt_name2opt_val.at("quantumsim"), {"no", "yes", "qsoverlay"}, "Produce quantumsim output, and of which kind", true);
         app->add_set_ignore_case("--issue_skip_319", opt_name2opt_val.at("issue_skip_319"), {"no", "yes"}, "Issue skip instead of wait in bundles", true);
+        app->add_set_ignore_case("--cqasm_fast_path", opt_name2opt_val.at("cqasm_fast_path"), {"yes", "no"}, "Read basic cQASM files without libqasm, falling back to it for anything else", true);
+        app->add_set_ignore_case("--unitary_decomposition_cache", opt_name2opt_val.at("unitary_decomposition_cache"), {"yes", "no"}, "Reuse the decomposition of a unitary matrix that was decomposed before", true);
+        app->add_set_ignore_case("--unitary_decomposition_parallel", opt_name2opt_val.at("unitary_decomposition_parallel"), {"no", "yes", "2", "3", "4", "6", "8", "12", "16", "24", "32", "48", "64"}, "Decompose the independent subproblems of a unitary on this many threads", true);
+        app->add_set_ignore_case("--unitary_decomposition_optimize", opt_name2opt_val.at("unitary_decomposition_optimize"), {"yes", "no"}, "Drop trivial rotations, merge rotations and cancel CNOT pairs in the gates emitted for a unitary", true);
         app->add_option("--backend_cc_map_input_file", opt_name2opt_val.at("backend_cc_map_input_file"), "Name of CC input map file", true);
+        app->add_set_ignore_case("--backend_cc_loop_compaction", opt_name2opt_val.at("backend_cc_loop_compaction"), {"no", "yes"}, "Fold repeated windows of bundles into loops in CC code", true);
         app->add_set_ignore_case("--cz_mode", opt_name2opt_val.at("cz_mode"), {"manual", "auto"}, "CZ mode", true);
+        app->add_set_ignore_case("--ccl_loop_compression", opt_name2opt_val.at("ccl_loop_compression"), {"no", "yes"}, "Fold repeated windows of bundles into loops in CC-light QISA", true);
+        app->add_set_ignore_case("--kernel_dedup", opt_name2opt_val.at("kernel_dedup"), {"no", "yes"}, "Schedule and map identical kernels only once, copying the result to the others", true);
 
         app->add_set_ignore_case("--mapper", opt_name2opt_val.at("mapper"), {"no", "base", "baserc", "minextend", "minextendrc", "maxfidelity"}, "Mapper heuristic", true);
         app->add_set_ignore_case("--mapinitone2one", opt_name2opt_val.at("mapinitone2one"), {"no", "yes"}, "Initialize mapping of virtual qubits one to one to real qubits", true);
@@ -104,6 +128,7 @@ private:
         app->add_set_ignore_case("--maptiebreak", opt_name2opt_val.at("maptiebreak"), {"first", "last", "random", "critical"}, "Tie break method", true);
         app->add_set_ignore_case("--mapusemoves", opt_name2opt_val.at("mapusemoves"), {"no", "yes", "0","1","2","3","4","5","6","7","8","9","10","11","12","13","14","15","16","17","18","19","20"}, "Use unused qubit to move thru", true);
         app->add_set_ignore_case("--mapreverseswap", opt_name2opt_val.at("mapreverseswap"), {"no", "yes"}, "Reverse swap operands when better", true);
+        app->add_set_ignore_case("--mapmulticore", opt_name2opt_val.at("mapmulticore"), {"flat", "partition"}, "Route multi-core platforms as one grid, or partition the qubits over the cores per time slice", true);
 
         app->add_set_ignore_case("--write_qasm_files", opt_name2opt_val.at("write_qasm_files"), {"yes", "no"}, "write (un-)scheduled (with and without resource-constraint) qasm files", true);
         app->add_set_ignore_case("--write_report_files", opt_name2opt_val.at("write_report_files"), {"yes", "no"}, "write report files on circuit characteristics and pass results", true);
@@ -139,6 +164,7 @@ public:
                   << "maptiebreak: "      << opt_name2opt_val.at("maptiebreak") << std::endl
                   << "mapusemoves: "      << opt_name2opt_val.at("mapusemoves") << std::endl
                   << "mapreverseswap: "   << opt_name2opt_val.at("mapreverseswap") << std::endl
+                  << "mapmulticore: "     << opt_name2opt_val.at("mapmulticore") << std::endl
                   << "mapselectswaps: "   << opt_name2opt_val.at("mapselectswaps") << std::endl
                   << "clifford_postmapper: " << opt_name2opt_val.at("clifford_postmapper") << std::endl
                   << "scheduler_post179: " << opt_name2opt_val.at("scheduler_post179") << std::endl
@@ -146,7 +172,8 @@ public:
                   << "cz_mode: " << opt_name2opt_val.at("cz_mode") << std::endl
                   << "write_qasm_files: " << opt_name2opt_val.at("write_qasm_files") << std::endl
                   << "write_report_files: " << opt_name2opt_val.at("write_report_files") << std::endl
-                  << "print_dot_graphs: " << opt_name2opt_val.at("print_dot_graphs") << std::endl;
+                  << "print_dot_graphs: " << opt_name2opt_val.at("print_dot_graphs") << std::endl
+                  << "kernel_dedup: " << opt_name2opt_val.at("kernel_dedup") << std::endl;
         // FIXME: incomplete, function seems unused
     }
 
@@ -200,6 +227,8 @@ void set(const Str &opt_name, const Str &opt_value) {
         logger::set_log_level(opt_value);
     } else if (opt_name == "output_dir") {
         make_dirs(opt_value);
+    } else if (opt_name == "trace_buffer_size") {
+        trace::enable(parse_uint(opt_value));
     }
 }
 
@@ -209,6 +238,7 @@ Str get(const Str &opt_name) {
 
 void reset_options() {
     ql_options.reset_options();
+    trace::enable(0);
 }
 
 } // namespace options
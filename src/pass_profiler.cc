@@ -0,0 +1,164 @@
+/** \file
+ * Profiling of the passes run by the pass manager.
+ */
+
+#include "pass_profiler.h"
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include "options.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace ql {
+
+using namespace utils;
+
+PassProfiler::AllocationCounter PassProfiler::allocation_counter = nullptr;
+
+/**
+ * Installs the allocation counter used by all profilers, or removes it when
+ * counter is nullptr.
+ */
+void PassProfiler::set_allocation_counter(AllocationCounter counter) {
+    allocation_counter = counter;
+}
+
+/**
+ * Returns the resource usage of the process so far.
+ */
+PassProfiler::usage_t PassProfiler::usage_t::now() {
+    usage_t usage;
+    usage.wall_time = std::chrono::duration<Real>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    usage.cpu_time = (Real)std::clock() / CLOCKS_PER_SEC;
+    usage.peak_rss = 0;
+#ifndef _WIN32
+    struct rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+#ifdef __APPLE__
+        usage.peak_rss = ru.ru_maxrss;          // bytes
+#else
+        usage.peak_rss = ru.ru_maxrss * 1024;   // kilobytes
+#endif
+    }
+#endif
+    usage.allocations = allocation_counter ? allocation_counter() : 0;
+    return usage;
+}
+
+/**
+ * Adds the resources used between from and to to the given JSON object.
+ */
+void PassProfiler::add_usage(Json &entry, const usage_t &from, const usage_t &to) {
+    entry["wall_time"] = to.wall_time - from.wall_time;
+    entry["cpu_time"] = to.cpu_time - from.cpu_time;
+    entry["peak_rss_delta"] = to.peak_rss - from.peak_rss;
+    if (allocation_counter) {
+        entry["allocations"] = to.allocations - from.allocations;
+    } else {
+        entry["allocations"] = nullptr;
+    }
+}
+
+/**
+ * Starts a new profile for the compilation of the given program.
+ */
+void PassProfiler::start(const Str &compiler_name, const quantum_program &program) {
+    profile = Json::object();
+    profile["compiler"] = compiler_name;
+    profile["program"] = program.name;
+    profile["passes"] = Json::array();
+    compile_start = usage_t::now();
+}
+
+/**
+ * Marks the start of the given pass.
+ */
+void PassProfiler::begin_pass(const Str &pass_name, const quantum_program &program) {
+    pass_entry = Json::object();
+    pass_entry["name"] = pass_name;
+    kernels_in.clear();
+    for (const auto &kernel : program.kernels) {
+        kernels_in.emplace_back(kernel.name, kernel.c.size());
+    }
+    pass_start = usage_t::now();
+}
+
+/**
+ * Marks the end of the pass started last.
+ */
+void PassProfiler::end_pass(const quantum_program &program, Bool skipped) {
+    usage_t pass_end = usage_t::now();
+    pass_entry["skipped"] = skipped;
+    add_usage(pass_entry, pass_start, pass_end);
+
+    // match kernels before and after the pass by name, in order
+    Vec<Bool> matched(kernels_in.size(), false);
+    Json kernels = Json::array();
+    UInt gates_in = 0;
+    UInt gates_out = 0;
+    for (const auto &kernel : program.kernels) {
+        Json k = Json::object();
+        k["name"] = kernel.name;
+        k["gates_in"] = nullptr;
+        for (UInt i = 0; i < kernels_in.size(); i++) {
+            if (!matched[i] && kernels_in[i].first == kernel.name) {
+                matched[i] = true;
+                k["gates_in"] = kernels_in[i].second;
+                break;
+            }
+        }
+        k["gates_out"] = kernel.c.size();
+        gates_out += kernel.c.size();
+        kernels.push_back(k);
+    }
+    for (UInt i = 0; i < kernels_in.size(); i++) {
+        gates_in += kernels_in[i].second;
+        if (!matched[i]) {
+            Json k = Json::object();
+            k["name"] = kernels_in[i].first;
+            k["gates_in"] = kernels_in[i].second;
+            k["gates_out"] = nullptr;
+            kernels.push_back(k);
+        }
+    }
+    pass_entry["gates_in"] = gates_in;
+    pass_entry["gates_out"] = gates_out;
+    pass_entry["kernels"] = kernels;
+    profile["passes"].push_back(pass_entry);
+
+    QL_DOUT("pass " << pass_entry["name"].get<Str>() << " took " << pass_entry["wall_time"].get<Real>() << " s");
+}
+
+/**
+ * Finishes the profile, adding the totals, and writes it to
+ * <output_dir>/<program name>_pass_profile.json when option write_pass_profile
+ * is yes.
+ */
+void PassProfiler::finish(const quantum_program &program) {
+    Json total = Json::object();
+    add_usage(total, compile_start, usage_t::now());
+    profile["total"] = total;
+
+    if (options::get("write_pass_profile") == "yes") {
+        Str file_name = options::get("output_dir") + "/" + program.name + "_pass_profile.json";
+        QL_IOUT("writing pass profile to " << file_name);
+        std::ofstream out(file_name);
+        if (!out.is_open()) {
+            QL_FATAL("cannot open file " << file_name << " for writing the pass profile");
+        }
+        out << profile.dump(4) << std::endl;
+    }
+}
+
+/**
+ * Returns the profile of the last compilation.
+ */
+const Json &PassProfiler::get_profile() const {
+    return profile;
+}
+
+} // namespace ql
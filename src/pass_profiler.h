@@ -0,0 +1,121 @@
+/** \file
+ * Profiling of the passes run by the pass manager.
+ */
+
+#pragma once
+
+#include "utils/num.h"
+#include "utils/str.h"
+#include "utils/vec.h"
+#include "utils/pair.h"
+#include "utils/json.h"
+#include "program.h"
+
+namespace ql {
+
+/**
+ * Records, for each pass that the pass manager runs on a program, the wall
+ * time and CPU time it took, how much it raised the peak resident set size of
+ * the process, and the number of gates per kernel before and after it. When an
+ * allocation counter is installed (see set_allocation_counter()), the number
+ * of allocations done by the pass is recorded as well.
+ *
+ * The result is a JSON object of the form:
+ *
+ *     {
+ *         "compiler": "<compiler name>",
+ *         "program": "<program name>",
+ *         "passes": [
+ *             {
+ *                 "name": "<pass name>",
+ *                 "skipped": false,
+ *                 "wall_time": <seconds>,
+ *                 "cpu_time": <seconds>,
+ *                 "peak_rss_delta": <bytes>,
+ *                 "allocations": <count, or null without counter>,
+ *                 "gates_in": <count>,
+ *                 "gates_out": <count>,
+ *                 "kernels": [
+ *                     { "name": "<kernel name>", "gates_in": <count or null>, "gates_out": <count or null> },
+ *                     ...
+ *                 ]
+ *             },
+ *             ...
+ *         ],
+ *         "total": { "wall_time": ..., "cpu_time": ..., "peak_rss_delta": ..., "allocations": ... }
+ *     }
+ *
+ * Passes run on the program as a whole, so the times, peak RSS and
+ * allocations are those of the entire pass; only the gate counts are split
+ * per kernel. A kernel that a pass created has a null gates_in, and one that
+ * it removed has a null gates_out. Peak RSS is not available on Windows and is
+ * reported as 0 there.
+ */
+class PassProfiler {
+public:
+
+    /**
+     * Function returning the total number of allocations done by the process
+     * so far, e.g. implemented by a replacement of the global operator new in
+     * a benchmark harness.
+     */
+    typedef utils::UInt (*AllocationCounter)();
+
+    /**
+     * Installs the allocation counter used by all profilers, or removes it
+     * when counter is nullptr.
+     */
+    static void set_allocation_counter(AllocationCounter counter);
+
+    /**
+     * Starts a new profile for the compilation of the given program.
+     */
+    void start(const utils::Str &compiler_name, const quantum_program &program);
+
+    /**
+     * Marks the start of the given pass.
+     */
+    void begin_pass(const utils::Str &pass_name, const quantum_program &program);
+
+    /**
+     * Marks the end of the pass started last.
+     */
+    void end_pass(const quantum_program &program, utils::Bool skipped);
+
+    /**
+     * Finishes the profile, adding the totals, and writes it to
+     * <output_dir>/<program name>_pass_profile.json when option
+     * write_pass_profile is yes.
+     */
+    void finish(const quantum_program &program);
+
+    /**
+     * Returns the profile of the last compilation.
+     */
+    const utils::Json &get_profile() const;
+
+private:
+
+    /**
+     * Resource usage of the process at some point in time.
+     */
+    struct usage_t {
+        utils::Real wall_time;
+        utils::Real cpu_time;
+        utils::UInt peak_rss;
+        utils::UInt allocations;
+        static usage_t now();
+    };
+
+    static AllocationCounter allocation_counter;
+
+    static void add_usage(utils::Json &entry, const usage_t &from, const usage_t &to);
+
+    utils::Json profile;
+    usage_t compile_start;
+    usage_t pass_start;
+    utils::Json pass_entry;
+    utils::Vec<utils::Pair<utils::Str, utils::UInt>> kernels_in;
+};
+
+} // namespace ql
@@ -19,6 +19,7 @@
 #include "visualizer.h"
 
 #include "arch/cc_light/cc_light_eqasm_compiler.h"
+#include "mapper.h"
 #include "arch/cc/eqasm_backend_cc.h"
 
 namespace ql {
@@ -389,16 +390,18 @@ void CCLDecomposePreSchedule::runOnProgram(quantum_program *program) {
  * @brief  Mapper pass constructor
  * @param  Name of the mapper pass
  */
-MapPass::MapPass(const Str &name) : AbstractPass(name) {
+MapPass::MapPass(const Str &name) : AbstractPass(name), gridcache(new mapper::Grid()) {
 }
 
+MapPass::~MapPass() = default;
+
 /**
  * @brief  Maps the input program to the target platform
  * @param  Program object to be mapped
  */
 void MapPass::runOnProgram(quantum_program *program) {
     Str stats;
-    arch::cc_light_eqasm_compiler::map(program, program->platform, getPassName(), &stats);
+    arch::cc_light_eqasm_compiler::map(program, program->platform, getPassName(), &stats, gridcache.get());
     appendStatistics(stats);
 }
 
@@ -477,6 +480,22 @@ void CCLDecomposePostSchedulePass::runOnProgram(quantum_program *program) {
     arch::cc_light_eqasm_compiler().ccl_decompose_post_schedule(program, program->platform, getPassName());
 }
 
+/**
+ * @brief  Post Schedule Pass constructor
+ * @param  Name of the post schedule pass
+ */
+CCLPostSchedulePass::CCLPostSchedulePass(const Str &name) : AbstractPass(name) {
+}
+
+/**
+ * @brief  Latency compensation, buffer delay insertion and CC-Light specific
+ *         decomposition of the scheduled program, in a single sweep
+ * @param  Program object to be post-scheduled
+ */
+void CCLPostSchedulePass::runOnProgram(quantum_program *program) {
+    arch::cc_light_eqasm_compiler().ccl_post_schedule(program, program->platform, getPassName());
+}
+
 /**
  * @brief  QuantumSim Writer Pass constructor
  * @param  Name of the writer pass
@@ -504,7 +523,22 @@ QisaCodeGenerationPass::QisaCodeGenerationPass(const Str &name) : AbstractPass(n
  * @param  Program object to be transformed into QISA output
  */
 void QisaCodeGenerationPass::runOnProgram(quantum_program *program) {
-    arch::cc_light_eqasm_compiler().qisa_code_generation(program, program->platform, getPassName());
+    arch::qisa_statistics_t stats;
+    arch::cc_light_eqasm_compiler().qisa_code_generation(program, program->platform, getPassName(), &stats);
+    Str compression_report;
+    if (options::get("ccl_loop_compression") == "yes") {
+        compression_report = arch::qisa_statistics_report(stats, "# ");
+        appendStatistics(compression_report);
+    }
+
+    // the same cc_light_compiler report as written by quantum_program::compile(),
+    // except for the total time, which the pass profile has
+    auto rf = ReportFile(program, "out", "cc_light_compiler");
+    for (const auto &k : program->kernels) {
+        rf.write_kernel_statistics(k, program->platform, "# ");
+    }
+    rf.write_totals_statistics(program->kernels, program->platform, "# ");
+    rf << compression_report;
 }
 
 /**
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <CLI/CLI.hpp>
 #include "utils/str.h"
 #include "utils/map.h"
@@ -13,6 +14,10 @@ namespace ql {
 
 class PassOptions;
 
+namespace mapper {
+class Grid;
+} // namespace mapper
+
 /**
  * Compiler Pass Interface
  */
@@ -21,6 +26,7 @@ public:
     virtual void runOnProgram(quantum_program *program) = 0;
 
     explicit AbstractPass(const utils::Str &name);
+    virtual ~AbstractPass() = default;
     utils::Str getPassName() const;
     void setPassName(const utils::Str &name);
     void setPassOption(const utils::Str &optionName, const utils::Str &optionValue);
@@ -180,7 +186,12 @@ public:
      * @param  Name of the mapper pass
      */
     explicit MapPass(const utils::Str &name);
+    ~MapPass() override;
     void runOnProgram(quantum_program *program) override;
+
+private:
+    // grid of the platform of the previous program, reused when the next one has the same topology
+    std::unique_ptr<mapper::Grid> gridcache;
 };
 
 /**
@@ -248,6 +259,20 @@ public:
     void runOnProgram(quantum_program *program) override;
 };
 
+/**
+ * CC-Light PostSchedule Pass: LatencyCompensation, InsertBufferDelays and
+ * CCLDecomposePostSchedule in a single pass
+ */
+class CCLPostSchedulePass : public AbstractPass {
+public:
+    /**
+     * @brief  Post Schedule Pass constructor
+     * @param  Name of the post schedule pass
+     */
+    explicit CCLPostSchedulePass(const utils::Str &name);
+    void runOnProgram(quantum_program *program) override;
+};
+
 /**
  * Write QuantumSim Program Pass
  */
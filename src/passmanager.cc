@@ -5,6 +5,9 @@
 #include "utils/num.h"
 #include "passmanager.h"
 #include "write_sweep_points.h"
+#include "options.h"
+#include "report.h"
+#include "utils/trace.h"
 
 namespace ql {
 
@@ -17,6 +20,15 @@ using namespace utils;
 PassManager::PassManager(const Str &name) : name(name) {
 }
 
+/**
+ * @brief   Pass Manager destructor, deletes the passes it owns
+ */
+PassManager::~PassManager() {
+    for (AbstractPass *pass : passes) {
+        delete pass;
+    }
+}
+
 /**
  * @brief   Applies the sequence of compiler passes to the given program
  * @param   program   Object reference to the program to be compiled
@@ -24,6 +36,8 @@ PassManager::PassManager(const Str &name) : name(name) {
 void PassManager::compile(quantum_program *program) const {
 
     QL_DOUT("In PassManager::compile ... ");
+    profiler.start(name, *program);
+    UInt pass_index = 0;
     for (auto pass : passes) {
         ///@todo-rn: implement option to check if following options are actually needed for a pass
         ///@note-rn: currently(0.8.1.dev), all passes require platform as API parameter, and some passes depend on the nqubits internally. Therefore, these are passed through by setting the program with these fields here. However, this should change in the future since compiling for a simulator might not require a platform, and the number of qubits could be optional.
@@ -36,19 +50,46 @@ void PassManager::compile(quantum_program *program) const {
         //If the old interface is used, platform is already set, so it is not needed to look for platform option and configure the platform from there
         if (!program->platformInitialized) {
             Str hwconfig = pass->getPassOptions()->getOption("hwconfig");
-            program->platform = *(new quantum_platform("testPlatform",hwconfig));
+            program->platform = quantum_platform("testPlatform", hwconfig);
         }
 
+        profiler.begin_pass(pass->getPassName(), *program);
+        QL_TRACE("pass.begin", pass_index);
         if (!pass->getSkip()) {
             QL_DOUT(" Calling pass: " << pass->getPassName());
+            report_start_pass();
             pass->initPass(program);
+            // the pass modifies the circuits directly
+            for (auto &kernel : program->kernels) {
+                kernel.circuit_changed();
+            }
             pass->runOnProgram(program);
+            for (auto &kernel : program->kernels) {
+                kernel.circuit_changed();
+            }
             pass->finalizePass(program);
         }
+        QL_TRACE("pass.end", pass_index);
+        profiler.end_pass(*program, pass->getSkip());
+        pass_index++;
     }
 
     // generate sweep_points file ==> TOOD: delete?
     write_sweep_points(program, program->platform, "write_sweep_points");
+    profiler.finish(*program);
+
+    // write the binary trace of this compilation when tracing is enabled
+    if (trace::enabled) {
+        trace::write(options::get("output_dir") + "/" + program->name + "_trace.bin");
+    }
+}
+
+/**
+ * @brief   Returns the pass profile of the last compilation
+ * @return  JSON object as documented in pass_profiler.h
+ */
+const Json &PassManager::getPassProfile() const {
+    return profiler.get_profile();
 }
 
 /**
@@ -114,6 +155,8 @@ AbstractPass *PassManager::createPass(const Str &passName, const Str &aliasName)
         pass = new InsertBufferDelaysPass(aliasName);
     } else if (passName == "CCLDecomposePostSchedule") {
         pass = new CCLDecomposePostSchedulePass(aliasName);
+    } else if (passName == "CCLPostSchedule") {
+        pass = new CCLPostSchedulePass(aliasName);
     } else if (passName == "QisaCodeGeneration") {
         pass = new QisaCodeGenerationPass(aliasName);
     } else if (passName == "Visualizer") {
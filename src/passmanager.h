@@ -6,7 +6,9 @@
 
 #include "utils/str.h"
 #include "utils/list.h"
+#include "utils/json.h"
 #include "passes.h"
+#include "pass_profiler.h"
 #include "program.h"
 
 namespace ql {
@@ -17,18 +19,25 @@ namespace ql {
 class PassManager {
 public:
     PassManager(const utils::Str &n);
+    ~PassManager();
+
+    // the pass manager owns its passes, so it must not be copied
+    PassManager(const PassManager &) = delete;
+    PassManager &operator=(const PassManager &) = delete;
 
     void compile(quantum_program *program) const;
     void addPassNamed(const utils::Str &realPassName, const utils::Str &symbolicPassName);
     static AbstractPass *createPass(const utils::Str &passName, const utils::Str &aliasName);
     AbstractPass *findPass(const utils::Str &passName);
     void setPassOptionAll(const utils::Str &optionName, const utils::Str &optionValue);
+    const utils::Json &getPassProfile() const;
 
 private:
     void addPass(AbstractPass *pass);
 
     utils::Str name;
     utils::List<AbstractPass*> passes;
+    mutable PassProfiler profiler;
 };
 
 } // namespace ql
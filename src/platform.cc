@@ -4,6 +4,12 @@
 
 #include "platform.h"
 
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include "utils/map.h"
+#include "utils/filesystem.h"
+
 namespace ql {
 
 using namespace utils;
@@ -15,12 +21,19 @@ quantum_platform::quantum_platform() : name("default") {
 quantum_platform::quantum_platform(
     const Str &name,
     const Str &configuration_file_name
-) :
-    name(name),
-    configuration_file_name(configuration_file_name)
-{
+) {
+    *this = *load_cached(configuration_file_name);
+    this->name = name;
+    this->configuration_file_name = configuration_file_name;
+}
+
+/**
+ * Loads the platform from the given configuration file, bypassing the cache.
+ */
+void quantum_platform::load(const Str &configuration_file_name) {
+    this->configuration_file_name = configuration_file_name;
     hardware_configuration hwc(configuration_file_name);
-    hwc.load(instruction_map, instruction_settings, hardware_settings, resources, topology, aliases);
+    hwc.load(instruction_map, instruction_settings, hardware_settings, resources, topology, aliases, qubit_attributes);
     eqasm_compiler_name = hwc.eqasm_compiler_name;
     QL_DOUT("eqasm_compiler_name= " << eqasm_compiler_name);
 
@@ -39,6 +52,69 @@ quantum_platform::quantum_platform(
     }
 }
 
+/**
+ * Entry of the process-wide platform cache. The platform it holds is never
+ * modified after loading, platforms constructed from the same file are copies.
+ */
+struct platform_cache_entry_t {
+    Str contents;
+    std::shared_ptr<const quantum_platform> platform;
+};
+
+static std::mutex platform_cache_mutex;
+static Map<Str, platform_cache_entry_t> platform_cache;     // keyed by canonical path
+
+/**
+ * Reads the whole given file into contents, returning whether it could be
+ * opened.
+ */
+static Bool read_file(const Str &path, Str &contents) {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    return true;
+}
+
+/**
+ * Returns the platform loaded from the given configuration file, from the cache
+ * if the contents of the file are the same as when it was loaded. The file is
+ * read and compared every time, since modification times are too coarse to
+ * notice a file that is rewritten right after it was loaded; reading it is
+ * cheap compared to parsing it and creating the gates.
+ */
+std::shared_ptr<const quantum_platform> quantum_platform::load_cached(const Str &configuration_file_name) {
+    Str path = canonical_path(configuration_file_name);
+
+    Str contents;
+    if (!read_file(path, contents)) {
+        // let the loader report the problem
+        auto platform = std::make_shared<quantum_platform>();
+        platform->load(configuration_file_name);
+        return platform;
+    }
+
+    std::lock_guard<std::mutex> lock(platform_cache_mutex);
+    auto it = platform_cache.find(path);
+    if (it != platform_cache.end() && it->second.contents == contents) {
+        QL_DOUT("platform cache hit for " << path);
+        return it->second.platform;
+    }
+
+    QL_DOUT("platform cache miss for " << path << ", loading");
+    auto platform = std::make_shared<quantum_platform>();
+    platform->load(configuration_file_name);
+
+    // the loader reads the file again, so only keep the platform when that
+    // still read the same contents
+    Str loaded_contents;
+    if (read_file(path, loaded_contents) && loaded_contents == contents) {
+        platform_cache.set(path) = {std::move(contents), platform};
+    }
+    return platform;
+}
+
 /**
  * display information about the platform
  */
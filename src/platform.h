@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/json.h"
@@ -25,9 +26,19 @@ public:
     utils::Json             resources;
     utils::Json             topology;
     utils::Json             aliases;                  // workaround the generic instruction composition
+    utils::Json             qubit_attributes;         // optional qubit properties, e.g. relaxation times
 
     // FIXME: constructed object is not usable
     quantum_platform();
+
+    /**
+     * Loads the platform from the given JSON configuration file. The result of
+     * loading a file is kept in a process-wide cache keyed by its canonical
+     * path, and reused as long as the file's contents are unchanged, so
+     * constructing a platform again is cheap. The custom
+     * gates of instruction_map are shared between platforms loaded from the
+     * same file, and must not be modified.
+     */
     quantum_platform(const utils::Str &name, const utils::Str &configuration_file_name);
     void print_info() const;
     utils::UInt get_qubit_number() const;  // FIXME: qubit_number is public anyway
@@ -50,6 +61,10 @@ public:
     utils::Str find_instruction_type(const utils::Str &iname) const;
 
     utils::UInt time_to_cycles(utils::Real time_ns) const;
+
+private:
+    void load(const utils::Str &configuration_file_name);
+    static std::shared_ptr<const quantum_platform> load_cached(const utils::Str &configuration_file_name);
 };
 
 } // namespace ql
@@ -5,9 +5,10 @@
 #include "program.h"
 
 #include "utils/filesystem.h"
+#include "utils/trace.h"
 #include "compiler.h"
 #include "options.h"
-#include "interactionMatrix.h"
+#include "interaction_graph.h"
 #include "scheduler.h"
 #include "optimizer.h"
 #include "decompose_toffoli.h"
@@ -28,6 +29,7 @@ using namespace utils;
  */
 quantum_program::quantum_program(const Str &n) : name(n) {
     platformInitialized = false;
+    kernel_index_valid = false;
     QL_DOUT("Constructor for quantum_program:  " << n);
 }
 
@@ -45,6 +47,7 @@ quantum_program::quantum_program(
     breg_count(nbregs)
 {
     default_config = true;
+    kernel_index_valid = false;
     needs_backend_compiler = true;
     platformInitialized = true;
     eqasm_compiler_name = platform.eqasm_compiler_name;
@@ -72,7 +75,7 @@ quantum_program::quantum_program(
     report_init(this, platform);
 }
 
-void quantum_program::add(const quantum_kernel &k) {
+void quantum_program::check_kernel(const quantum_kernel &k) const {
     // check sanity of supplied qubit/classical operands for each gate
     const circuit &kc = k.get_circuit();
     for (auto &g : kc) {
@@ -92,15 +95,49 @@ void quantum_program::add(const quantum_kernel &k) {
             }
         }
     }
+}
 
-    for (const auto &kernel : kernels) {
-        if (kernel.name == k.name) {
-            QL_FATAL("Cannot add kernel. Duplicate kernel name: " << k.name);
+void quantum_program::invalidate_kernel_index() {
+    kernel_index_valid = false;
+}
+
+Bool quantum_program::has_kernel(const Str &kname) {
+    // the size check catches appends to kernels by code that did not
+    // invalidate the index
+    if (!kernel_index_valid || kernel_index.size() != kernels.size()) {
+        kernel_index.clear();
+        for (UInt i = 0; i < kernels.size(); i++) {
+            kernel_index[kernels[i].name] = i;
         }
+        kernel_index_valid = true;
+    }
+    return kernel_index.find(kname) != kernel_index.end();
+}
+
+void quantum_program::append_kernel(quantum_kernel &&k) {
+    has_kernel(k.name);     // brings the index up to date
+    kernel_index[k.name] = kernels.size();
+    kernels.push_back(std::move(k));
+}
+
+void quantum_program::add(const quantum_kernel &k) {
+    check_kernel(k);
+    if (has_kernel(k.name)) {
+        QL_FATAL("Cannot add kernel. Duplicate kernel name: " << k.name);
+    }
+
+    // if sane, now add a copy of the kernel to list of kernels
+    append_kernel(quantum_kernel(k));
+}
+
+void quantum_program::add(quantum_kernel &&k) {
+    check_kernel(k);
+    if (has_kernel(k.name)) {
+        QL_FATAL("Cannot add kernel. Duplicate kernel name: " << k.name);
     }
 
     // if sane, now add kernel to list of kernels
-    kernels.push_back(k);
+    append_kernel(std::move(k));
 }
 
 void quantum_program::add_program(const quantum_program &p) {
@@ -109,36 +146,58 @@ void quantum_program::add_program(const quantum_program &p) {
     }
 }
 
+void quantum_program::add_program(quantum_program &&p) {
+    for (auto &k : p.kernels) {
+        add(std::move(k));
+    }
+    p.kernels.clear();
+    p.invalidate_kernel_index();
+}
+
 void quantum_program::add_if(const quantum_kernel &k, const operation &cond) {
+    add_if(quantum_kernel(k), cond);
+}
+
+void quantum_program::add_if(quantum_kernel &&k, const operation &cond) {
+    Str kname = k.name;
+
     // phi node
-    quantum_kernel kphi1(k.name+"_if", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi1(kname+"_if", platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::IF_START);
     kphi1.set_condition(cond);
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add(k);
+    add(std::move(k));
 
     // phi node
-    quantum_kernel kphi2(k.name+"_if_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(kname+"_if_end", platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::IF_END);
     kphi2.set_condition(cond);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
 }
 
 void quantum_program::add_if(const quantum_program &p, const operation &cond) {
+    quantum_program pc(p.name);
+    pc.kernels = p.kernels;
+    add_if(std::move(pc), cond);
+}
+
+void quantum_program::add_if(quantum_program &&p, const operation &cond) {
+    Str pname = p.name;
+
     // phi node
-    quantum_kernel kphi1(p.name+"_if", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi1(pname+"_if", platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::IF_START);
     kphi1.set_condition(cond);
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add_program(p);
+    add_program(std::move(p));
 
     // phi node
-    quantum_kernel kphi2(p.name+"_if_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(pname+"_if_end", platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::IF_END);
     kphi2.set_condition(cond);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
 }
 
 void quantum_program::add_if_else(
@@ -146,33 +205,44 @@ void quantum_program::add_if_else(
     const quantum_kernel &k_else,
     const operation &cond
 ) {
-    quantum_kernel kphi1(k_if.name+"_if"+ to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
+    add_if_else(quantum_kernel(k_if), quantum_kernel(k_else), cond);
+}
+
+void quantum_program::add_if_else(
+    quantum_kernel &&k_if,
+    quantum_kernel &&k_else,
+    const operation &cond
+) {
+    Str kname_if = k_if.name;
+    Str kname_else = k_else.name;
+
+    quantum_kernel kphi1(kname_if+"_if"+ to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::IF_START);
     kphi1.set_condition(cond);
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add(k_if);
+    add(std::move(k_if));
 
     // phi node
-    quantum_kernel kphi2(k_if.name+"_if"+ to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(kname_if+"_if"+ to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::IF_END);
     kphi2.set_condition(cond);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
 
 
     // phi node
-    quantum_kernel kphi3(k_else.name+"_else" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi3(kname_else+"_else" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
     kphi3.set_kernel_type(kernel_type_t::ELSE_START);
     kphi3.set_condition(cond);
-    kernels.push_back(kphi3);
+    append_kernel(std::move(kphi3));
 
-    add(k_else);
+    add(std::move(k_else));
 
     // phi node
-    quantum_kernel kphi4(k_else.name+"_else" + to_string(phi_node_count)+"_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi4(kname_else+"_else" + to_string(phi_node_count)+"_end", platform, qubit_count, creg_count, breg_count);
     kphi4.set_kernel_type(kernel_type_t::ELSE_END);
     kphi4.set_condition(cond);
-    kernels.push_back(kphi4);
+    append_kernel(std::move(kphi4));
 
     phi_node_count++;
 }
@@ -182,89 +252,132 @@ void quantum_program::add_if_else(
     const quantum_program &p_else,
     const operation &cond
 ) {
-    quantum_kernel kphi1(p_if.name+"_if"+ to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
+    quantum_program pc_if(p_if.name);
+    pc_if.kernels = p_if.kernels;
+    quantum_program pc_else(p_else.name);
+    pc_else.kernels = p_else.kernels;
+    add_if_else(std::move(pc_if), std::move(pc_else), cond);
+}
+
+void quantum_program::add_if_else(
+    quantum_program &&p_if,
+    quantum_program &&p_else,
+    const operation &cond
+) {
+    Str pname_if = p_if.name;
+    Str pname_else = p_else.name;
+
+    quantum_kernel kphi1(pname_if+"_if"+ to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::IF_START);
     kphi1.set_condition(cond);
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add_program(p_if);
+    add_program(std::move(p_if));
 
     // phi node
-    quantum_kernel kphi2(p_if.name+"_if"+ to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(pname_if+"_if"+ to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::IF_END);
     kphi2.set_condition(cond);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
 
 
     // phi node
-    quantum_kernel kphi3(p_else.name+"_else" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi3(pname_else+"_else" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
     kphi3.set_kernel_type(kernel_type_t::ELSE_START);
     kphi3.set_condition(cond);
-    kernels.push_back(kphi3);
+    append_kernel(std::move(kphi3));
 
-    add_program(p_else);
+    add_program(std::move(p_else));
 
     // phi node
-    quantum_kernel kphi4(p_else.name+"_else" + to_string(phi_node_count)+"_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi4(pname_else+"_else" + to_string(phi_node_count)+"_end", platform, qubit_count, creg_count, breg_count);
     kphi4.set_kernel_type(kernel_type_t::ELSE_END);
     kphi4.set_condition(cond);
-    kernels.push_back(kphi4);
+    append_kernel(std::move(kphi4));
 
     phi_node_count++;
 }
 
 void quantum_program::add_do_while(const quantum_kernel &k, const operation &cond) {
+    add_do_while(quantum_kernel(k), cond);
+}
+
+void quantum_program::add_do_while(quantum_kernel &&k, const operation &cond) {
+    Str kname = k.name;
+
     // phi node
-    quantum_kernel kphi1(k.name+"_do_while"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi1(kname+"_do_while"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::DO_WHILE_START);
     kphi1.set_condition(cond);
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add(k);
+    add(std::move(k));
 
     // phi node
-    quantum_kernel kphi2(k.name+"_do_while" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(kname+"_do_while" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::DO_WHILE_END);
     kphi2.set_condition(cond);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
     phi_node_count++;
 }
 
 void quantum_program::add_do_while(const quantum_program &p, const operation &cond) {
+    quantum_program pc(p.name);
+    pc.kernels = p.kernels;
+    add_do_while(std::move(pc), cond);
+}
+
+void quantum_program::add_do_while(quantum_program &&p, const operation &cond) {
+    Str pname = p.name;
+
     // phi node
-    quantum_kernel kphi1(p.name+"_do_while"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi1(pname+"_do_while"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::DO_WHILE_START);
     kphi1.set_condition(cond);
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add_program(p);
+    add_program(std::move(p));
 
     // phi node
-    quantum_kernel kphi2(p.name+"_do_while" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(pname+"_do_while" + to_string(phi_node_count), platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::DO_WHILE_END);
     kphi2.set_condition(cond);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
     phi_node_count++;
 }
 
 void quantum_program::add_for(const quantum_kernel &k, UInt iterations) {
+    add_for(quantum_kernel(k), iterations);
+}
+
+void quantum_program::add_for(quantum_kernel &&k, UInt iterations) {
+    Str kname = k.name;
+
     // phi node
-    quantum_kernel kphi1(k.name+"_for"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi1(kname+"_for"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::FOR_START);
     kphi1.iterations = iterations;
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
-    add(k);
+    add(std::move(k));
     kernels.back().iterations = iterations;
 
     // phi node
-    quantum_kernel kphi2(k.name+"_for" + to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(kname+"_for" + to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::FOR_END);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
     phi_node_count++;
 }
 
 void quantum_program::add_for(const quantum_program &p, UInt iterations) {
+    quantum_program pc(p.name);
+    pc.kernels = p.kernels;
+    add_for(std::move(pc), iterations);
+}
+
+void quantum_program::add_for(quantum_program &&p, UInt iterations) {
+    Str pname = p.name;
+
     Bool nested_for = false;
     for (auto &k : p.kernels) {
         if (k.type == kernel_type_t::FOR_START) {
@@ -282,22 +395,22 @@ void quantum_program::add_for(const quantum_program &p, UInt iterations) {
     }
 
     // phi node
-    quantum_kernel kphi1(p.name+"_for"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi1(pname+"_for"+ to_string(phi_node_count) +"_start", platform, qubit_count, creg_count, breg_count);
     kphi1.set_kernel_type(kernel_type_t::FOR_START);
     kphi1.iterations = iterations;
-    kernels.push_back(kphi1);
+    append_kernel(std::move(kphi1));
 
     // phi node
-    quantum_kernel kphi2(p.name, platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi2(pname, platform, qubit_count, creg_count, breg_count);
     kphi2.set_kernel_type(kernel_type_t::STATIC);
-    kernels.push_back(kphi2);
+    append_kernel(std::move(kphi2));
 
-    add_program(p);
+    add_program(std::move(p));
 
     // phi node
-    quantum_kernel kphi3(p.name+"_for" + to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
+    quantum_kernel kphi3(pname+"_for" + to_string(phi_node_count) +"_end", platform, qubit_count, creg_count, breg_count);
     kphi3.set_kernel_type(kernel_type_t::FOR_END);
-    kernels.push_back(kphi3);
+    append_kernel(std::move(kphi3));
     phi_node_count++;
 }
 
@@ -310,7 +423,23 @@ void quantum_program::set_platform(const quantum_platform &platform) {
     this->platform = platform;
 }
 
+/**
+ * Writes the binary trace of the compilation of the given program when
+ * tracing is enabled (option trace_buffer_size).
+ */
+static void write_trace(const Str &program_name) {
+    if (trace::enabled) {
+        trace::write(options::get("output_dir") + "/" + program_name + "_trace.bin");
+    }
+}
+
 void quantum_program::compile() {
+    // the passes below modify the kernels directly; nothing in here uses the
+    // caches of the kernels, so it is enough to invalidate them up front
+    invalidate_kernel_index();
+    for (auto &k : kernels) {
+        k.circuit_changed();
+    }
     QL_IOUT("compiling " << name << " ...");
     QL_WOUT("compiling " << name << " ...");
     if (kernels.empty()) {
@@ -344,6 +473,7 @@ void quantum_program::compile() {
     QL_DOUT("eqasm_compiler_name: " << eqasm_compiler_name);
     if (!needs_backend_compiler) {
         QL_WOUT("The eqasm compiler attribute indicated that no backend passes are needed.");
+        write_trace(name);
         return;
     } if (!backend_compiler) {
         QL_EOUT("No known eqasm compiler has been specified in the configuration file.");
@@ -356,11 +486,13 @@ void quantum_program::compile() {
 
     // generate sweep_points file
     write_sweep_points(this, platform, "write_sweep_points");
+    write_trace(name);
 
     QL_IOUT("compilation of program '" << name << "' done.");
 }
 
 void quantum_program::compile_modular() {
+    invalidate_kernel_index();
     QL_IOUT("compiling " << name << " ...");
     QL_WOUT("compiling " << name << " ...");
     if (kernels.empty()) {
@@ -369,48 +501,7 @@ void quantum_program::compile_modular() {
 
     //constuct compiler
     std::unique_ptr<quantum_compiler> compiler(new quantum_compiler("Hard Coded Compiler"));
-
-    //add passes
-    ///@note-rn: WriterPass needs Reader pass to recreate the subciruits! ==> However, then Reader needs to be used to recreate the subcircuits. However, if I do that tests will fail because the harddware configuration file is in synq with qasm reader and tests (error: unrecognized instr prepz)
-    compiler->addPass("Writer", "initialqasmwriter");
-    compiler->addPass("RotationOptimizer", "rotation_optimize");
-    compiler->addPass("DecomposeToffoli", "decompose_toffoli");
-    compiler->addPass("CliffordOptimize", "clifford_prescheduler");
-    compiler->addPass("Scheduler", "prescheduler");
-    compiler->addPass("CliffordOptimize", "clifford_postscheduler");
-    compiler->addPass("Writer", "scheduledqasmwriter");
-
-    // backend passes
-    QL_DOUT("Calling backend compiler passes for eqasm_compiler_name: " << eqasm_compiler_name);
-    if (eqasm_compiler_name.empty()) {
-        QL_FATAL("eqasm compiler name must be specified in the hardware configuration file !");
-    } else if (eqasm_compiler_name == "none" || eqasm_compiler_name == "qx") {
-        QL_WOUT("The eqasm compiler attribute indicated that no backend passes are needed.");
-    } else if (eqasm_compiler_name == "cc_light_compiler") {
-        // from here CCL backend starts
-        compiler->addPass("CCLPrepCodeGeneration", "ccl_prep_code_generation");
-        compiler->addPass("CCLDecomposePreSchedule", "ccl_decompose_pre_schedule");
-        compiler->addPass("WriteQuantumSim", "write_quantumsim_script_unmapped");
-        compiler->addPass("CliffordOptimize", "clifford_premapper");
-        compiler->addPass("Map", "mapper");
-        compiler->addPass("CliffordOptimize", "clifford_postmapper");
-        compiler->addPass("RCSchedule", "rcscheduler");
-        compiler->addPass("LatencyCompensation", "ccl_latency_compensation");
-        compiler->addPass("InsertBufferDelays", "ccl_insert_buffer_delays");
-        compiler->addPass("CCLDecomposePostSchedule", "ccl_decompose_post_schedule");
-        compiler->addPass("WriteQuantumSim", "write_quantumsim_script_mapped");
-        compiler->addPass("Writer", "lastqasmwriter");
-        compiler->addPass("QisaCodeGeneration", "qisa_code_generation");
-        ///@note-rn: Calling the backend like this is equivalend to calling passes individually as above.
-        //compiler->addPass("BackendCompiler");
-        //compiler->setPassOption("BackendCompiler", "eqasm_compiler_name", eqasm_compiler_name);
-        QL_DOUT("Returned from call backend_compiler->compile for " << eqasm_compiler_name);
-    } else if (eqasm_compiler_name == "eqasm_backend_cc") {
-        compiler->addPass("BackendCompiler");
-        compiler->setPassOption("BackendCompiler", "eqasm_compiler_name", "eqasm_backend_cc");
-    } else {
-        QL_FATAL("the '" << eqasm_compiler_name << "' eqasm compiler backend is not suported !");
-    }
+    compiler->addDefaultPasses(eqasm_compiler_name);
 
     //compile with program
     compiler->compile(this);
@@ -423,17 +514,15 @@ void quantum_program::compile_modular() {
 void quantum_program::print_interaction_matrix() const {
     QL_IOUT("printing interaction matrix...");
 
-    for (auto k : kernels) {
-        InteractionMatrix imat( k.get_circuit(), qubit_count);
-        Str mstr = imat.getString();
+    for (const auto &k : kernels) {
+        Str mstr = k.get_interaction_graph().get_matrix_string();
         std::cout << mstr << std::endl;
     }
 }
 
 void quantum_program::write_interaction_matrix() const {
-    for (auto k : kernels) {
-        InteractionMatrix imat(k.get_circuit(), qubit_count);
-        Str mstr = imat.getString();
+    for (const auto &k : kernels) {
+        Str mstr = k.get_interaction_graph().get_matrix_string();
 
         Str fname = options::get("output_dir") + "/" + k.get_name() + "InteractionMatrix.dat";
         QL_IOUT("writing interaction matrix to '" << fname << "' ...");
@@ -449,6 +538,10 @@ void quantum_program::set_sweep_points(const Real *swpts, UInt size) {
 }
 
 Vec<quantum_kernel> &quantum_program::get_kernels() {
+    invalidate_kernel_index();
+    for (auto &k : kernels) {
+        k.circuit_changed();
+    }
     return kernels;
 }
 
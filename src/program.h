@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/vec.h"
@@ -38,16 +39,29 @@ public:
     quantum_program(const utils::Str &n);
     quantum_program(const utils::Str &n, const quantum_platform &platf, utils::UInt nqubits, utils::UInt ncregs = 0, utils::UInt nbregs = 0);
 
+    // the overloads taking an rvalue reference move the kernels into the
+    // program instead of copying them; the kernels of a program passed that
+    // way are moved out, leaving it empty
     void add(const quantum_kernel &k);
+    void add(quantum_kernel &&k);
     void add_program(const quantum_program &p);
+    void add_program(quantum_program &&p);
     void add_if(const quantum_kernel &k, const operation &cond);
+    void add_if(quantum_kernel &&k, const operation &cond);
     void add_if(const quantum_program &p, const operation &cond);
+    void add_if(quantum_program &&p, const operation &cond);
     void add_if_else(const quantum_kernel &k_if, const quantum_kernel &k_else, const operation &cond);
+    void add_if_else(quantum_kernel &&k_if, quantum_kernel &&k_else, const operation &cond);
     void add_if_else(const quantum_program &p_if, const quantum_program &p_else, const operation &cond);
+    void add_if_else(quantum_program &&p_if, quantum_program &&p_else, const operation &cond);
     void add_do_while(const quantum_kernel &k, const operation &cond);
+    void add_do_while(quantum_kernel &&k, const operation &cond);
     void add_do_while(const quantum_program &p, const operation &cond);
+    void add_do_while(quantum_program &&p, const operation &cond);
     void add_for(const quantum_kernel &k, utils::UInt iterations);
+    void add_for(quantum_kernel &&k, utils::UInt iterations);
     void add_for(const quantum_program &p, utils::UInt iterations);
+    void add_for(quantum_program &&p, utils::UInt iterations);
 
     void set_config_file(const utils::Str &file_name);
     void set_platform(const quantum_platform &platform);
@@ -62,6 +76,23 @@ public:
     utils::Vec<quantum_kernel> &get_kernels();
     const utils::Vec<quantum_kernel> &get_kernels() const;
 
+    // marks the kernel name index as out of date; code that modifies kernels
+    // (or their names) directly must call this before the next add*() call.
+    // compile(), compile_modular(), the passes, snapshot loading and the
+    // mutable get_kernels() do so already
+    void invalidate_kernel_index();
+
+private:
+    // index from kernel name to its position in kernels, to check for
+    // duplicate names in constant time; it is rebuilt on the next lookup
+    // after invalidate_kernel_index()
+    std::unordered_map<utils::Str, utils::UInt> kernel_index;
+    utils::Bool                 kernel_index_valid;
+
+    utils::Bool has_kernel(const utils::Str &kname);
+    void append_kernel(quantum_kernel &&k);
+    void check_kernel(const quantum_kernel &k) const;
+
 };
 
 } // namespace ql
@@ -35,6 +35,8 @@
 
 #include "report.h"
 
+#include <atomic>
+
 #include "utils/num.h"
 #include "utils/str.h"
 #include "options.h"
@@ -46,135 +48,139 @@ using namespace utils;
 
 /*
  * support functions for reporting statistics
+ *
+ * the statistics of a kernel are collected in a single sweep over its circuit and cached in the kernel;
+ * the cache is only used when the circuit generation of the kernel (see quantum_kernel::circuit_changed())
+ * is still the one the statistics were collected for, and then only:
+ * - for the totals over the kernels, directly after reporting the kernels individually
+ * - for the "in" report of a pass, when the statistics were collected for the "out" report
+ *   of the pass run just before by the pass manager
+ * the pass manager increments the circuit generation of all kernels before and after running a pass,
+ * so statistics collected while a pass runs are never reused after it; the pass generation keeps
+ * code that reports and modifies circuits within a single pass from reusing its own statistics;
+ * it is shared by the programs that compile_many() compiles in parallel, which only makes reuse
+ * less frequent there
  */
-static UInt get_classical_operations_count(
-    const circuit &c,
-    const quantum_platform &platform
+static std::atomic<UInt> pass_generation(1);
+
+enum class statistics_reuse_t {
+    NONE,           // always collect the statistics again
+    PREVIOUS_PASS,  // reuse statistics collected after the previous pass was done with the circuit
+    SAME_REPORT     // reuse statistics collected for the current report
+};
+
+static const kernel_statistics_t &get_kernel_statistics(
+    const quantum_kernel &k,
+    const quantum_platform &platform,
+    statistics_reuse_t reuse,
+    Bool after_pass
 ) {
-    UInt classical_operations = 0;
-    // DOUT("... reporting get_classical_operations_count");
-    for (auto &gp : c) {
-        switch (gp->type()) {
-            case __classical_gate__:
-                classical_operations++;
-                break;
-            case __wait_gate__:
-                break;
-            default:    // quantum gate
-                break;
+    kernel_statistics_t &stats = k.statistics;
+    if (reuse != statistics_reuse_t::NONE
+        && stats.valid
+        && stats.circuit_generation == k.circuit_generation
+        && stats.qubit_usecount.size() == platform.qubit_number
+    ) {
+        Bool from_previous_pass = stats.after_pass && stats.pass_generation + 1 == pass_generation;
+        Bool from_this_pass = stats.pass_generation == pass_generation;
+        if (from_previous_pass || (reuse == statistics_reuse_t::SAME_REPORT && from_this_pass)) {
+            return stats;
         }
     }
-    // DOUT("... reporting get_classical_operations_count [done]");
-    return classical_operations;
-}
 
-static UInt get_non_single_qubit_quantum_gates_count(
-    const circuit &c,
-    const quantum_platform &platform
-) {
-    UInt quantum_gates = 0;
-    // DOUT("... reporting get_non_single_qubit_quantum_gates_count");
-    for (auto &gp : c) {
+    UInt cycle_time = platform.cycle_time;
+    stats.quantum_gates = 0;
+    stats.non_single_qubit_gates = 0;
+    stats.classical_operations = 0;
+    stats.qubit_usecount.assign(platform.qubit_number, 0);
+    stats.qubit_usedcyclecount.assign(platform.qubit_number, 0);
+    for (auto &gp : k.c) {
         switch (gp->type()) {
             case __classical_gate__:
+                stats.classical_operations++;
                 break;
             case __wait_gate__:
                 break;
-            default:    // quantum gate
+            default: {  // quantum gate
+                stats.quantum_gates++;
                 if (gp->operands.size() > 1) {
-                    quantum_gates++;
+                    stats.non_single_qubit_gates++;
                 }
-                break;
-        }
-    }
-    // DOUT("... reporting get_non_single_qubit_quantum_gates_count [done]");
-    return quantum_gates;
-}
-
-static void get_qubit_usecount(
-    const circuit &c,
-    const quantum_platform &platform,
-    Vec<UInt> &usecount
-) {
-    // DOUT("... reporting get_qubit_usecount");
-    for (auto &gp : c) {
-        switch (gp->type()) {
-            case __classical_gate__:
-            case __wait_gate__:
-                break;
-            default:    // quantum gate
+                UInt cycles = (gp->duration+cycle_time-1)/cycle_time;
                 for (auto v : gp->operands) {
-                    usecount[v]++;
+                    stats.qubit_usecount[v]++;
+                    stats.qubit_usedcyclecount[v] += cycles;
                 }
                 break;
+            }
         }
     }
-    // DOUT("... reporting get_qubit_usecount [done]");
+
+    if (k.c.empty() || k.c.back()->cycle == MAX_CYCLE) {
+        stats.circuit_latency = 0;
+    } else {
+        stats.circuit_latency = k.c.back()->cycle + (k.c.back()->duration+cycle_time-1)/cycle_time - k.c.front()->cycle;
+    }
+
+    stats.valid = true;
+    stats.pass_generation = pass_generation;
+    stats.after_pass = after_pass;
+    stats.circuit_generation = k.circuit_generation;
+    return stats;
 }
 
-static void get_qubit_usedcyclecount(
-    const circuit &c,
-    const quantum_platform &platform,
-    Vec<UInt> &usedcyclecount
+static void write_kernel_statistics(
+    std::ostream &os,
+    const quantum_kernel &k,
+    const kernel_statistics_t &stats,
+    const Str &comment_prefix
 ) {
-    UInt  cycle_time = platform.cycle_time;
+    UInt qubits_used = 0; for (auto v: stats.qubit_usecount) { if (v != 0) { qubits_used++; } }
 
-    // DOUT("... reporting get_qubit_usedcyclecount");
-    for (auto &gp : c) {
-        switch (gp->type()) {
-            case __classical_gate__:
-                break;
-            case __wait_gate__:
-                break;
-            default:    // quantum gate
-                for (auto v : gp->operands) {
-                    usedcyclecount[v] += (gp->duration+cycle_time-1)/cycle_time;
-                }
-                break;
-        }
-    }
-    // DOUT("... reporting get_qubit_usedcyclecount [done]");
+    os << comment_prefix << "kernel: " << k.name << "\n";
+    os << comment_prefix << "----- circuit_latency: " << stats.circuit_latency << "\n";
+    os << comment_prefix << "----- quantum gates: " << stats.quantum_gates << "\n";
+    os << comment_prefix << "----- non single qubit gates: " << stats.non_single_qubit_gates << "\n";
+    os << comment_prefix << "----- classical operations: " << stats.classical_operations << "\n";
+    os << comment_prefix << "----- qubits used: " << qubits_used << "\n";
+    os << comment_prefix << "----- qubit cycles use:" << stats.qubit_usedcyclecount << "\n";
 }
 
-static UInt get_quantum_gates_count(
-    const circuit &c,
-    const quantum_platform &platform
+static void write_totals_statistics(
+    std::ostream &os,
+    const Vec<quantum_kernel> &kernels,
+    const quantum_platform &platform,
+    const Str &comment_prefix
 ) {
-    UInt quantum_gates = 0;
-    // DOUT("... reporting get_quantum_gates_count");
-    for (auto &gp : c) {
-        switch (gp->type()) {
-            case __classical_gate__:
-                break;
-            case __wait_gate__:
-                break;
-            default:    // quantum gate
-                quantum_gates++;
-                break;
+    // totals reporting, collect info from all kernels
+    Vec<Bool> used(platform.qubit_number, false);
+    UInt total_circuit_latency = 0;
+    UInt total_classical_operations = 0;
+    UInt total_quantum_gates = 0;
+    UInt total_non_single_qubit_gates= 0;
+    for (auto &k : kernels) {
+        const kernel_statistics_t &stats = get_kernel_statistics(k, platform, statistics_reuse_t::SAME_REPORT, true);
+        for (UInt q = 0; q < platform.qubit_number; q++) {
+            if (stats.qubit_usecount[q] != 0) {
+                used[q] = true;
+            }
         }
-    }
-    // DOUT("... reporting get_quantum_gates_count [done]");
-    return quantum_gates;
-}
 
-static UInt get_circuit_latency(
-    const circuit &c,
-    const quantum_platform &platform
-) {
-    UInt cycle_time = platform.cycle_time;
-    UInt circuit_latency_result;
-    // DOUT("... reporting get_circuit_latency");
-    if (c.size() < 1) {
-        circuit_latency_result = 0;
-        // DOUT("In get_circuit_latency() result is 0 because circuit is empty");
-    } else if (c.back()->cycle == MAX_CYCLE) {
-        circuit_latency_result = 0;
-        // DOUT("In get_circuit_latency() result is 0 because c.back()->cycle == MAX_CYCLE");
-    } else {
-        circuit_latency_result = c.back()->cycle + (c.back()->duration+cycle_time-1)/cycle_time - c.front()->cycle;
+        total_circuit_latency += stats.circuit_latency;
+        total_classical_operations += stats.classical_operations;
+        total_quantum_gates += stats.quantum_gates;
+        total_non_single_qubit_gates += stats.non_single_qubit_gates;
     }
-    // DOUT("Computed get_circuit_latency(): result is " << circuit_latency_result);
-    return circuit_latency_result;
+    UInt qubits_used = 0; for (auto u: used) { if (u) { qubits_used++; } }
+
+    // report totals
+    os << "\n";
+    os << comment_prefix << "Total circuit_latency: " << total_circuit_latency << "\n";
+    os << comment_prefix << "Total no. of quantum gates: " << total_quantum_gates << "\n";
+    os << comment_prefix << "Total no. of non single qubit gates: " << total_non_single_qubit_gates << "\n";
+    os << comment_prefix << "Total no. of classical operations: " << total_classical_operations << "\n";
+    os << comment_prefix << "Qubits used: " << qubits_used << "\n";
+    os << comment_prefix << "No. kernels: " << kernels.size() << "\n";
 }
 
 /*
@@ -381,23 +387,7 @@ void report_kernel_statistics(
     }
 
     // DOUT("... reporting report_kernel_statistics");
-    Vec<UInt> usecount;
-    usecount.resize(platform.qubit_number, 0);
-    get_qubit_usecount(k.c, platform, usecount);
-    UInt qubits_used = 0; for (auto v: usecount) { if (v != 0) { qubits_used++; } }
-
-    Vec<UInt> usedcyclecount;
-    usedcyclecount.resize(platform.qubit_number, 0);
-    get_qubit_usedcyclecount(k.c, platform, usedcyclecount);
-
-    UInt  circuit_latency = get_circuit_latency(k.c, platform);
-    os << comment_prefix << "kernel: " << k.name << "\n";
-    os << comment_prefix << "----- circuit_latency: " << circuit_latency << "\n";
-    os << comment_prefix << "----- quantum gates: " << get_quantum_gates_count(k.c, platform) << "\n";
-    os << comment_prefix << "----- non single qubit gates: " << get_non_single_qubit_quantum_gates_count(k.c, platform) << "\n";
-    os << comment_prefix << "----- classical operations: " << get_classical_operations_count(k.c, platform) << "\n";
-    os << comment_prefix << "----- qubits used: " << qubits_used << "\n";
-    os << comment_prefix << "----- qubit cycles use:" << usedcyclecount << "\n";
+    write_kernel_statistics(os, k, get_kernel_statistics(k, platform, statistics_reuse_t::NONE, true), comment_prefix);
     // DOUT("... reporting report_kernel_statistics [done]");
 }
 
@@ -416,31 +406,7 @@ void report_totals_statistics(
     }
 
     // DOUT("... reporting report_totals_statistics");
-    // totals reporting, collect info from all kernels
-    Vec<UInt> usecount;
-    usecount.resize(platform.qubit_number, 0);
-    UInt total_circuit_latency = 0;
-    UInt total_classical_operations = 0;
-    UInt total_quantum_gates = 0;
-    UInt total_non_single_qubit_gates= 0;
-    for (auto &k : kernels) {
-        get_qubit_usecount(k.c, platform, usecount);
-
-        total_circuit_latency += get_circuit_latency(k.c, platform);
-        total_classical_operations += get_classical_operations_count(k.c, platform);
-        total_quantum_gates += get_quantum_gates_count(k.c, platform);
-        total_non_single_qubit_gates += get_non_single_qubit_quantum_gates_count(k.c, platform);
-    }
-    UInt qubits_used = 0; for (auto v: usecount) { if (v != 0) { qubits_used++; } }
-
-    // report totals
-    os << "\n";
-    os << comment_prefix << "Total circuit_latency: " << total_circuit_latency << "\n";
-    os << comment_prefix << "Total no. of quantum gates: " << total_quantum_gates << "\n";
-    os << comment_prefix << "Total no. of non single qubit gates: " << total_non_single_qubit_gates << "\n";
-    os << comment_prefix << "Total no. of classical operations: " << total_classical_operations << "\n";
-    os << comment_prefix << "Qubits used: " << qubits_used << "\n";
-    os << comment_prefix << "No. kernels: " << kernels.size() << "\n";
+    write_totals_statistics(os, kernels, platform, comment_prefix);
     // DOUT("... reporting report_totals_statistics [done]");
 }
 
@@ -467,13 +433,18 @@ void report_statistics(
     // DOUT("... reporting report_statistics");
     auto rf = ReportFile(programp, in_or_out, pass_name);
 
-    // per kernel reporting
+    // per kernel reporting;
+    // the circuits are as the previous pass left them when this is the report before a pass
+    Bool in = (in_or_out == "in");
+    StrStrm ss;
     for (auto &k : programp->kernels) {
-        rf.write_kernel_statistics(k, platform, comment_prefix);
+        auto reuse = in ? statistics_reuse_t::PREVIOUS_PASS : statistics_reuse_t::NONE;
+        write_kernel_statistics(ss, k, get_kernel_statistics(k, platform, reuse, !in), comment_prefix);
     }
 
     // and total collecting and reporting
-    rf.write_totals_statistics(programp->kernels, platform, comment_prefix);
+    write_totals_statistics(ss, programp->kernels, platform, comment_prefix);
+    rf << ss.str();
 
     if (!additionalStatistics.empty()) {
         rf << " \n\n" << additionalStatistics;
@@ -482,6 +453,13 @@ void report_statistics(
     // DOUT("... reporting report_statistics [done]");
 }
 
+/*
+ * tells the cache of kernel statistics that the pass manager is about to run a next pass
+ */
+void report_start_pass() {
+    pass_generation++;
+}
+
 /*
  * support a unique file called 'get("output_dir")/name.unique'
  * it is a seed to create unique output files (qasm, report, etc.) for the same program (with name 'name')
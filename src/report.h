@@ -115,6 +115,12 @@ void report_statistics(
     const utils::Str &additionalStatistics = ""
 );
 
+/**
+ * tells the cache of kernel statistics that the pass manager is about to run a next pass,
+ * so that the "in" report of that pass can reuse the statistics collected after the previous one
+ */
+void report_start_pass();
+
 /**
  * initialization of program.unique_name that is used by file name generation for reporting and printing
  * it is the program's name with a suffix appended that represents the number of the run of the program
@@ -18,56 +18,26 @@ typedef enum {
 
 namespace arch {
 
-class resource_t {
-public:
-    utils::Str name;
-    utils::UInt count;
-    scheduling_direction_t direction;
-
-    resource_t(const utils::Str &n, scheduling_direction_t dir);
-    virtual ~resource_t() = default;
-
-    virtual utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) = 0;
-    virtual void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) = 0;
-
-    virtual resource_t *clone() const & = 0;
-    virtual resource_t *clone() && = 0;
-
-    void Print(const utils::Str &s);
-};
-
+// Interface of the platform specific resource managers.
+// The constant description of the resources is shared between copies,
+// so copying a resource manager only copies the state of its resources.
 class platform_resource_manager_t {
 public:
 
-    utils::Vec<resource_t*> resource_ptrs;
-
-    // constructor needed by mapper::FreeCycle to bridge time from its construction to its Init
-    // see the note on the use of constructors and Init functions at the start of mapper.h
     platform_resource_manager_t() = default;
     platform_resource_manager_t(
         const quantum_platform &platform,
         scheduling_direction_t dir
     );
+    virtual ~platform_resource_manager_t() = default;
 
     virtual platform_resource_manager_t *clone() const & = 0;
     virtual platform_resource_manager_t *clone() && = 0;
 
     void Print(const utils::Str &s);
 
-    // copy constructor doing a deep copy
-    // *org_resource_ptr->clone() does the trick to create a copy of the actual derived class' object
-    platform_resource_manager_t(const platform_resource_manager_t &org);
-
-    // copy-assignment operator
-    // follow pattern to use tmp copy to allow self-assignment and to be exception safe
-    platform_resource_manager_t &operator=(const platform_resource_manager_t &rhs);
-
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
-
-    // destructor destroying deep resource_t's
-    // runs before shallow destruction which is done by synthesized platform_resource_manager_t destructor
-    virtual ~platform_resource_manager_t();
+    virtual utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) const = 0;
+    virtual void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) = 0;
 };
 
 class resource_manager_t {
@@ -90,7 +60,7 @@ public:
     // follow pattern to use tmp copy to allow self-assignment and to be exception safe
     resource_manager_t &operator=(const resource_manager_t &rhs);
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) const;
     void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
 
     // destructor destroying deep platform_resource_managert_t
@@ -76,6 +76,8 @@
 
 #include "utils/vec.h"
 #include "utils/filesystem.h"
+#include "utils/trace.h"
+#include "kernel_dedup.h"
 
 namespace ql {
 
@@ -616,6 +618,7 @@ void Scheduler::write_dependence_matrix() const {
 // set_cycle iterates over the circuit's gates and set_cycle_gate over the dependencies of each gate
 // please note that set_cycle_gate expects a caller like set_cycle which iterates gp forward through the circuit
 void Scheduler::set_cycle_gate(gate *gp, scheduling_direction_t dir) {
+    QL_TRACE("scheduler.set_cycle", utils::trace::id_of(gp));
     ListDigraph::Node currNode = node.at(gp);
     UInt  currCycle;
     if (forward_scheduling == dir) {
@@ -1134,6 +1137,7 @@ void Scheduler::schedule(
 
         // commit selected_node to the schedule
         gate* gp = instruction[selected_node];
+        QL_TRACE("scheduler.rc_commit", utils::trace::id_of(gp));
         QL_DOUT("... selected " << gp->qasm() << " in cycle " << curr_cycle);
         gp->cycle = curr_cycle;                     // scheduler result, including s and t
         if (
@@ -1559,10 +1563,16 @@ void schedule(
         report_qasm(programp, platform, "in", passname);
 
         QL_IOUT("scheduling the quantum program");
+        KernelDeduplicator dedup(passname);
         for (auto &k : programp->kernels) {
+            if (dedup.reuse(k)) {
+                QL_IOUT("scheduling the quantum kernel '" << k.name << "' reusing the result of an identical kernel");
+                continue;
+            }
             Str dot;
             Str kernel_sched_dot;
             schedule_kernel(k, platform, dot, kernel_sched_dot);
+            dedup.store(k);
 
             if (options::get("print_dot_graphs") == "yes") {
                 Str fname;
@@ -1577,7 +1587,7 @@ void schedule(
             }
         }
 
-        report_statistics(programp, platform, "out", passname, "# ");
+        report_statistics(programp, platform, "out", passname, "# ", dedup.get_statistics("# "));
         report_qasm(programp, platform, "out", passname);
     }
 }
@@ -1623,7 +1633,12 @@ void rcschedule(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
+    KernelDeduplicator dedup(passname);
     for (auto &kernel : programp->kernels) {
+        if (dedup.reuse(kernel)) {
+            QL_IOUT("Scheduling kernel: " << kernel.name << " reusing the result of an identical kernel");
+            continue;
+        }
         QL_IOUT("Scheduling kernel: " << kernel.name);
         if (!kernel.c.empty()) {
             auto num_creg = kernel.creg_count;
@@ -1632,6 +1647,7 @@ void rcschedule(
 
             rcschedule_kernel(kernel, platform, sched_dot, platform.qubit_number, num_creg, num_breg);
             kernel.cycles_valid = true; // FIXME HvS move this back into call to right after sort_cycle
+            dedup.store(kernel);
 
             if (options::get("print_dot_graphs") == "yes") {
                 StrStrm fname;
@@ -1642,7 +1658,7 @@ void rcschedule(
         }
     }
 
-    report_statistics(programp, platform, "out", passname, "# ");
+    report_statistics(programp, platform, "out", passname, "# ", dedup.get_statistics("# "));
     report_qasm(programp, platform, "out", passname);
 }
 
@@ -0,0 +1,496 @@
+/** \file
+ * Binary snapshots of the IR of a quantum program.
+ */
+
+#include "snapshot.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "utils/map.h"
+#include "utils/filesystem.h"
+#include "classical.h"
+
+namespace ql {
+
+using namespace utils;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'O', 'Q', 'L', 'S', 'N', 'A', 'P', '\0'};
+const std::uint32_t SNAPSHOT_VERSION = 1;
+const std::uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const std::uint32_t NO_STRING = 0xFFFFFFFF;
+
+/**
+ * The sections of a snapshot, in the order of the section table.
+ */
+enum section_id_t {
+    SECTION_STRING_OFFSETS,     // std::uint64_t[string count + 1], offsets into SECTION_STRING_DATA
+    SECTION_STRING_DATA,        // char[], concatenated strings without terminators
+    SECTION_PROGRAM,            // program_record_t[1]
+    SECTION_KERNELS,            // kernel_record_t[]
+    SECTION_GATES,              // gate_record_t[], in kernel and circuit order
+    SECTION_OPERANDS,           // std::uint64_t[], operands of gates
+    SECTION_COPERANDS,          // coperand_record_t[], operands of kernel branch conditions
+    SECTION_REALS,              // double[], sweep points
+    SECTION_COUNT
+};
+
+struct header_t {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t section_count;
+    std::uint32_t reserved;
+};
+
+struct section_t {
+    std::uint64_t offset;       // in bytes, from start of file
+    std::uint64_t count;        // number of records
+};
+
+struct program_record_t {
+    std::uint32_t name;
+    std::uint32_t unique_name;
+    std::uint64_t qubit_count;
+    std::uint64_t creg_count;
+    std::uint64_t breg_count;
+    std::uint64_t first_sweep_point;
+    std::uint64_t sweep_point_count;
+};
+
+struct kernel_record_t {
+    std::uint32_t name;
+    std::uint32_t type;                 // kernel_type_t
+    std::uint64_t iterations;
+    std::uint64_t qubit_count;
+    std::uint64_t creg_count;
+    std::uint64_t breg_count;
+    std::uint64_t first_gate;
+    std::uint64_t gate_count;
+    std::uint32_t cycles_valid;
+    std::uint32_t has_br_condition;
+    std::uint32_t br_operation_name;
+    std::uint32_t br_inv_operation_name;
+    std::uint32_t br_operation_type;    // operation_type_t
+    std::uint32_t br_operand_count;
+    std::uint64_t br_first_operand;
+};
+
+struct gate_record_t {
+    std::uint32_t name;
+    std::uint32_t type;                 // gate_type_t
+    std::uint32_t visual_type;
+    std::uint32_t condition;            // cond_type_t
+    std::uint64_t first_operand;        // qubit, creg, breg and condition operands follow each other
+    std::uint32_t qubit_count;
+    std::uint32_t creg_count;
+    std::uint32_t breg_count;
+    std::uint32_t cond_count;
+    std::int64_t int_operand;
+    std::uint64_t duration;
+    double angle;
+    std::uint64_t cycle;
+    std::uint64_t duration_in_cycles;   // wait gates only
+};
+
+struct coperand_record_t {
+    std::uint32_t type;                 // operand_type_t
+    std::uint32_t reserved;
+    std::int64_t value;                 // creg id or immediate value
+};
+
+static_assert(sizeof(header_t) == 24, "unexpected padding in snapshot header");
+static_assert(sizeof(program_record_t) == 48, "unexpected padding in snapshot program record");
+static_assert(sizeof(kernel_record_t) == 88, "unexpected padding in snapshot kernel record");
+static_assert(sizeof(gate_record_t) == 80, "unexpected padding in snapshot gate record");
+static_assert(sizeof(coperand_record_t) == 16, "unexpected padding in snapshot coperand record");
+
+/**
+ * Collects the contents of a snapshot before writing it.
+ */
+class SnapshotWriter {
+public:
+    Vec<std::uint64_t> string_offsets{0};
+    Str string_data;
+    Map<Str, std::uint32_t> string_index;
+    Vec<program_record_t> programs;
+    Vec<kernel_record_t> kernels;
+    Vec<gate_record_t> gates;
+    Vec<std::uint64_t> operands;
+    Vec<coperand_record_t> coperands;
+    Vec<double> reals;
+
+    std::uint32_t add_string(const Str &s) {
+        auto it = string_index.find(s);
+        if (it != string_index.end()) {
+            return it->second;
+        }
+        std::uint32_t index = string_offsets.size() - 1;
+        string_data += s;
+        string_offsets.push_back(string_data.size());
+        string_index.set(s) = index;
+        return index;
+    }
+
+    void add_operands(const Vec<UInt> &ops) {
+        for (auto op : ops) {
+            operands.push_back(op);
+        }
+    }
+
+    void add_gate(const gate &g) {
+        gate_record_t r{};
+        r.name = add_string(g.name);
+        r.type = g.type();
+        r.visual_type = add_string(g.visual_type);
+        r.condition = g.condition;
+        r.first_operand = operands.size();
+        r.qubit_count = g.operands.size();
+        r.creg_count = g.creg_operands.size();
+        r.breg_count = g.breg_operands.size();
+        r.cond_count = g.cond_operands.size();
+        add_operands(g.operands);
+        add_operands(g.creg_operands);
+        add_operands(g.breg_operands);
+        add_operands(g.cond_operands);
+        r.int_operand = g.int_operand;
+        r.duration = g.duration;
+        r.angle = g.angle;
+        r.cycle = g.cycle;
+        if (g.type() == __wait_gate__) {
+            r.duration_in_cycles = dynamic_cast<const wait &>(g).duration_in_cycles;
+        }
+        gates.push_back(r);
+    }
+
+    void add_kernel(const quantum_kernel &k) {
+        kernel_record_t r{};
+        r.name = add_string(k.name);
+        r.type = (std::uint32_t)k.type;
+        r.iterations = k.iterations;
+        r.qubit_count = k.qubit_count;
+        r.creg_count = k.creg_count;
+        r.breg_count = k.breg_count;
+        r.first_gate = gates.size();
+        r.gate_count = k.c.size();
+        r.cycles_valid = k.cycles_valid;
+        r.br_operation_name = NO_STRING;
+        r.br_inv_operation_name = NO_STRING;
+        if (k.br_condition) {
+            const operation &op = *k.br_condition;
+            r.has_br_condition = 1;
+            r.br_operation_name = add_string(op.operation_name);
+            r.br_inv_operation_name = add_string(op.inv_operation_name);
+            r.br_operation_type = (std::uint32_t)op.operation_type;
+            r.br_first_operand = coperands.size();
+            r.br_operand_count = op.operands.size();
+            for (auto cop : op.operands) {
+                coperand_record_t cr{};
+                cr.type = (std::uint32_t)cop->type();
+                if (cop->type() == operand_type_t::CREG) {
+                    cr.value = cop->as_creg().id;
+                } else {
+                    cr.value = cop->as_cval().value;
+                }
+                coperands.push_back(cr);
+            }
+        }
+        for (auto gp : k.c) {
+            add_gate(*gp);
+        }
+        kernels.push_back(r);
+    }
+
+    void add_program(const quantum_program &p) {
+        program_record_t r{};
+        r.name = add_string(p.name);
+        r.unique_name = add_string(p.unique_name);
+        r.qubit_count = p.qubit_count;
+        r.creg_count = p.creg_count;
+        r.breg_count = p.breg_count;
+        r.first_sweep_point = reals.size();
+        r.sweep_point_count = p.sweep_points.size();
+        for (auto sp : p.sweep_points) {
+            reals.push_back(sp);
+        }
+        programs.push_back(r);
+        for (const auto &k : p.kernels) {
+            add_kernel(k);
+        }
+    }
+
+    void write(const Str &file_name) const {
+        auto parent = dir_name(file_name);
+        if (parent != file_name && !path_exists(parent)) {
+            make_dirs(parent);
+        }
+        std::ofstream ofs(file_name, std::ios::binary);
+        if (!ofs.is_open()) {
+            throw Exception("failed to open snapshot file \"" + file_name + "\" for writing", true);
+        }
+
+        // lay out the sections
+        struct blob_t { const void *data; std::uint64_t size; std::uint64_t count; };
+        blob_t blobs[SECTION_COUNT] = {
+            {string_offsets.data(), string_offsets.size() * sizeof(std::uint64_t), string_offsets.size()},
+            {string_data.data(), string_data.size(), string_data.size()},
+            {programs.data(), programs.size() * sizeof(program_record_t), programs.size()},
+            {kernels.data(), kernels.size() * sizeof(kernel_record_t), kernels.size()},
+            {gates.data(), gates.size() * sizeof(gate_record_t), gates.size()},
+            {operands.data(), operands.size() * sizeof(std::uint64_t), operands.size()},
+            {coperands.data(), coperands.size() * sizeof(coperand_record_t), coperands.size()},
+            {reals.data(), reals.size() * sizeof(double), reals.size()},
+        };
+        header_t header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.byte_order = SNAPSHOT_BYTE_ORDER;
+        header.section_count = SECTION_COUNT;
+        section_t table[SECTION_COUNT];
+        std::uint64_t offset = sizeof(header) + sizeof(table);
+        for (UInt i = 0; i < SECTION_COUNT; i++) {
+            table[i].offset = offset;
+            table[i].count = blobs[i].count;
+            offset = (offset + blobs[i].size + 7) & ~(std::uint64_t)7;
+        }
+
+        // and write them
+        static const char padding[8] = {};
+        ofs.write((const char *)&header, sizeof(header));
+        ofs.write((const char *)table, sizeof(table));
+        std::uint64_t written = sizeof(header) + sizeof(table);
+        for (UInt i = 0; i < SECTION_COUNT; i++) {
+            ofs.write(padding, table[i].offset - written);
+            ofs.write((const char *)blobs[i].data, blobs[i].size);
+            written = table[i].offset + blobs[i].size;
+        }
+        ofs.write(padding, ((written + 7) & ~(std::uint64_t)7) - written);
+        if (ofs.fail()) {
+            throw Exception("failed to write snapshot file \"" + file_name + "\"", true);
+        }
+    }
+};
+
+/**
+ * Gives checked access to the contents of a snapshot file.
+ */
+class SnapshotReader {
+public:
+    Str file_name;
+    Str contents;
+    section_t table[SECTION_COUNT];
+
+    explicit SnapshotReader(const Str &file_name) : file_name(file_name) {
+        std::ifstream ifs(file_name, std::ios::binary);
+        if (!ifs.is_open()) {
+            throw Exception("failed to open snapshot file \"" + file_name + "\"", true);
+        }
+        contents.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+        header_t header;
+        if (contents.size() < sizeof(header) + sizeof(table)) {
+            QL_FATAL("snapshot file '" << file_name << "' is truncated");
+        }
+        std::memcpy(&header, contents.data(), sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+            QL_FATAL("'" << file_name << "' is not an OpenQL snapshot file");
+        }
+        if (header.byte_order != SNAPSHOT_BYTE_ORDER) {
+            QL_FATAL("snapshot file '" << file_name << "' was written on a machine with a different byte order");
+        }
+        if (header.version != SNAPSHOT_VERSION || header.section_count != SECTION_COUNT) {
+            QL_FATAL("snapshot file '" << file_name << "' has unsupported version " << header.version);
+        }
+        std::memcpy(table, contents.data() + sizeof(header), sizeof(table));
+    }
+
+    /**
+     * Returns record index of section id, checking bounds.
+     */
+    template <typename T>
+    T get(section_id_t id, UInt index) const {
+        const section_t &section = table[id];
+        if (index >= section.count || section.offset + section.count * sizeof(T) > contents.size()) {
+            QL_FATAL("snapshot file '" << file_name << "' is corrupt: index " << index << " out of range in section " << id);
+        }
+        T record;
+        std::memcpy(&record, contents.data() + section.offset + index * sizeof(T), sizeof(T));
+        return record;
+    }
+
+    UInt count(section_id_t id) const {
+        return table[id].count;
+    }
+
+    Str get_string(std::uint32_t index) const {
+        if (index == NO_STRING) {
+            return "";
+        }
+        auto begin = get<std::uint64_t>(SECTION_STRING_OFFSETS, index);
+        auto end = get<std::uint64_t>(SECTION_STRING_OFFSETS, (UInt)index + 1);
+        const section_t &data = table[SECTION_STRING_DATA];
+        if (begin > end || end > data.count || data.offset + data.count > contents.size()) {
+            QL_FATAL("snapshot file '" << file_name << "' is corrupt: bad string " << index);
+        }
+        return contents.substr(data.offset + begin, end - begin);
+    }
+
+    Vec<UInt> get_operands(UInt first, UInt count) const {
+        Vec<UInt> ops;
+        for (UInt i = 0; i < count; i++) {
+            ops.push_back(get<std::uint64_t>(SECTION_OPERANDS, first + i));
+        }
+        return ops;
+    }
+};
+
+/**
+ * Creates the gate for a gate record, as kernel::gate() would, but without any
+ * lookup of compositions or decomposition, and then sets all its attributes
+ * from the record.
+ */
+gate *make_gate(const SnapshotReader &reader, const gate_record_t &r, const quantum_kernel &kernel) {
+    Str name = reader.get_string(r.name);
+    Vec<UInt> qubits = reader.get_operands(r.first_operand, r.qubit_count);
+    auto q = [&](UInt i) -> UInt {
+        if (i >= qubits.size()) {
+            QL_FATAL("snapshot file '" << reader.file_name << "' is corrupt: gate '" << name << "' lacks operands");
+        }
+        return qubits[i];
+    };
+
+    gate *g = nullptr;
+    switch ((gate_type_t)r.type) {
+        case __identity_gate__:     g = new identity(q(0)); break;
+        case __hadamard_gate__:     g = new hadamard(q(0)); break;
+        case __pauli_x_gate__:      g = new pauli_x(q(0)); break;
+        case __pauli_y_gate__:      g = new pauli_y(q(0)); break;
+        case __pauli_z_gate__:      g = new pauli_z(q(0)); break;
+        case __phase_gate__:        g = new phase(q(0)); break;
+        case __phasedag_gate__:     g = new phasedag(q(0)); break;
+        case __t_gate__:            g = new t(q(0)); break;
+        case __tdag_gate__:         g = new tdag(q(0)); break;
+        case __rx90_gate__:         g = new rx90(q(0)); break;
+        case __mrx90_gate__:        g = new mrx90(q(0)); break;
+        case __rx180_gate__:        g = new rx180(q(0)); break;
+        case __ry90_gate__:         g = new ry90(q(0)); break;
+        case __mry90_gate__:        g = new mry90(q(0)); break;
+        case __ry180_gate__:        g = new ry180(q(0)); break;
+        case __rx_gate__:           g = new rx(q(0), r.angle); break;
+        case __ry_gate__:           g = new ry(q(0), r.angle); break;
+        case __rz_gate__:           g = new rz(q(0), r.angle); break;
+        case __prepz_gate__:        g = new prepz(q(0)); break;
+        case __cnot_gate__:         g = new cnot(q(0), q(1)); break;
+        case __cphase_gate__:       g = new cphase(q(0), q(1)); break;
+        case __toffoli_gate__:      g = new toffoli(q(0), q(1), q(2)); break;
+        case __swap_gate__:         g = new swap(q(0), q(1)); break;
+        case __measure_gate__:      g = new measure(q(0)); break;
+        case __nop_gate__:          g = new nop(); break;
+        case __display__:           g = new display(); break;
+        case __wait_gate__:         g = new wait(qubits, r.duration, r.duration_in_cycles); break;
+        case __classical_gate__:
+            // there is no generic constructor; all attributes are overwritten below
+            g = new classical("nop");
+            break;
+        case __custom_gate__:
+        case __composite_gate__: {
+            auto it = kernel.instruction_map.find(name);
+            if (it == kernel.instruction_map.end()) {
+                QL_FATAL("gate '" << name << "' in snapshot file '" << reader.file_name << "' is not defined by the platform");
+            }
+            g = new custom_gate(*(it->second));
+            break;
+        }
+        default:
+            QL_FATAL("snapshot file '" << reader.file_name << "' contains gate '" << name << "' of unsupported type " << r.type);
+    }
+
+    UInt op = r.first_operand;
+    g->name = name;
+    g->visual_type = reader.get_string(r.visual_type);
+    g->operands = qubits;
+    op += r.qubit_count;
+    g->creg_operands = reader.get_operands(op, r.creg_count);
+    op += r.creg_count;
+    g->breg_operands = reader.get_operands(op, r.breg_count);
+    op += r.breg_count;
+    g->cond_operands = reader.get_operands(op, r.cond_count);
+    g->condition = (cond_type_t)r.condition;
+    g->int_operand = r.int_operand;
+    g->duration = r.duration;
+    g->angle = r.angle;
+    g->cycle = r.cycle;
+    return g;
+}
+
+} // anonymous namespace
+
+void save_snapshot(const quantum_program &program, const Str &file_name) {
+    QL_DOUT("Saving snapshot of program '" << program.name << "' to " << file_name);
+    SnapshotWriter writer;
+    writer.add_program(program);
+    writer.write(file_name);
+    QL_DOUT("Saved " << writer.kernels.size() << " kernels with " << writer.gates.size() << " gates");
+}
+
+void load_snapshot(quantum_program &program, const Str &file_name) {
+    QL_DOUT("Loading snapshot " << file_name << " into program '" << program.name << "'");
+    if (!program.platformInitialized) {
+        QL_FATAL("cannot load snapshot into program '" << program.name << "' without a platform");
+    }
+    SnapshotReader reader(file_name);
+    if (reader.count(SECTION_PROGRAM) != 1) {
+        QL_FATAL("snapshot file '" << file_name << "' does not contain a single program");
+    }
+
+    auto pr = reader.get<program_record_t>(SECTION_PROGRAM, 0);
+    if (pr.qubit_count > program.platform.qubit_number) {
+        QL_FATAL("snapshot file '" << file_name << "' uses " << pr.qubit_count
+            << " qubits, but the platform only has " << program.platform.qubit_number);
+    }
+    program.qubit_count = pr.qubit_count;
+    program.creg_count = pr.creg_count;
+    program.breg_count = pr.breg_count;
+    program.sweep_points.clear();
+    for (UInt i = 0; i < pr.sweep_point_count; i++) {
+        program.sweep_points.push_back(reader.get<double>(SECTION_REALS, pr.first_sweep_point + i));
+    }
+
+    program.kernels.clear();
+    for (UInt ki = 0; ki < reader.count(SECTION_KERNELS); ki++) {
+        auto kr = reader.get<kernel_record_t>(SECTION_KERNELS, ki);
+        quantum_kernel k(reader.get_string(kr.name), program.platform, kr.qubit_count, kr.creg_count, kr.breg_count);
+        k.set_kernel_type((kernel_type_t)kr.type);
+        k.iterations = kr.iterations;
+        if (kr.has_br_condition) {
+            // start from any operation, and overwrite all of it
+            k.br_condition.emplace(0);
+            operation &op = *k.br_condition;
+            op.operation_name = reader.get_string(kr.br_operation_name);
+            op.inv_operation_name = reader.get_string(kr.br_inv_operation_name);
+            op.operation_type = (operation_type_t)kr.br_operation_type;
+            op.operands.clear();
+            for (UInt i = 0; i < kr.br_operand_count; i++) {
+                auto cr = reader.get<coperand_record_t>(SECTION_COPERANDS, kr.br_first_operand + i);
+                if ((operand_type_t)cr.type == operand_type_t::CREG) {
+                    op.operands.push_back(new creg(cr.value));
+                } else {
+                    op.operands.push_back(new cval(cr.value));
+                }
+            }
+        }
+        for (UInt gi = 0; gi < kr.gate_count; gi++) {
+            auto gr = reader.get<gate_record_t>(SECTION_GATES, kr.first_gate + gi);
+            k.c.push_back(make_gate(reader, gr, k));
+        }
+        k.cycles_valid = kr.cycles_valid;
+        program.kernels.push_back(k);
+    }
+    program.invalidate_kernel_index();
+    QL_DOUT("Loaded " << program.kernels.size() << " kernels");
+}
+
+} // namespace ql
@@ -0,0 +1,41 @@
+/** \file
+ * Binary snapshots of the IR of a quantum program.
+ *
+ * A snapshot stores the kernels of a program as they are at some point during
+ * compilation, e.g. after mapping, including the cycles assigned by the
+ * scheduler, such that the remaining passes can be run on it again later
+ * without having to re-parse and re-map the input.
+ *
+ * The file consists of a header, a table of sections and the sections
+ * themselves. Every section is a flat array of fixed-size records at an 8-byte
+ * aligned offset, so the file can be used through mmap() as is. Strings (gate
+ * names, kernel names, etc.) are stored once in a string table and referred
+ * to by index. Integers are stored in the byte order of the machine writing
+ * the file; loading a file with the other byte order is refused.
+ */
+
+#pragma once
+
+#include "utils/str.h"
+#include "program.h"
+
+namespace ql {
+
+/**
+ * Writes the kernels of the given program, along with its qubit, creg and breg
+ * counts and sweep points, to a binary snapshot file.
+ */
+void save_snapshot(const quantum_program &program, const utils::Str &file_name);
+
+/**
+ * Replaces the kernels of the given program with those stored in the given
+ * snapshot file. Custom gates are looked up in the platform of the program,
+ * which does not need to be the platform the snapshot was made with, as long
+ * as it defines all gates. All other gate attributes, including duration and
+ * cycle, are taken from the snapshot. Classical gates are restored as
+ * ql::classical, so snapshots should be made before backend-specific
+ * decomposition.
+ */
+void load_snapshot(quantum_program &program, const utils::Str &file_name);
+
+} // namespace ql
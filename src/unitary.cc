@@ -5,6 +5,11 @@
 #include "unitary.h"
 
 #include "utils/exception.h"
+#include "utils/map.h"
+#include "utils/list.h"
+#include "utils/pair.h"
+#include "utils/hash.h"
+#include "options.h"
 
 #ifndef WITHOUT_UNITARY_DECOMPOSITION
 #include <Eigen/MatrixFunctions>
@@ -14,7 +19,13 @@
 #include <src/misc/lapacke.h>
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace ql {
 
@@ -56,8 +67,26 @@ Bool unitary::is_decompose_support_enabled() {
     return false;
 }
 
+void unitary::clear_decomposition_cache() {
+}
+
+UInt unitary::get_decomposition_cache_hits() {
+    return 0;
+}
+
+UInt unitary::get_decomposition_cache_misses() {
+    return 0;
+}
+
 #else
 
+// Eigen's thread count is process-global, and decompositions may run concurrently
+// (parallel subproblems, compile_many), so it is saved by the first parallel
+// decomposition that starts and restored by the last one that finishes.
+static std::mutex eigen_threads_mutex;
+static UInt eigen_threads_users = 0;
+static Int eigen_threads_saved = 0;
+
 // JvS: this was originally the class "unitary" itself, but compile times of
 // Eigen are so excessive that I moved it into its own compile unit and
 // provided a wrapper instead. It doesn't actually NEED to be wrapped like
@@ -79,10 +108,28 @@ public:
     Bool is_decomposed;
     Vec<Real> instructionlist;
 
+    // whether zyz_decomp set alpha, beta and gamma
+    Bool did_zyz = false;
+
+    // number of additional threads that may still be started for subproblems,
+    // shared by all decomposers working on the same unitary; null when sequential
+    std::shared_ptr<std::atomic<Int>> free_threads;
+
     typedef Eigen::Matrix<Complex, Eigen::Dynamic, Eigen::Dynamic> complex_matrix;
 
     UnitaryDecomposer() : name(""), is_decomposed(false) {}
 
+    // decomposer for a subproblem of a parallel decomposition
+    UnitaryDecomposer(
+        const Str &name,
+        const std::shared_ptr<std::atomic<Int>> &free_threads
+    ) :
+        name(name),
+        is_decomposed(false),
+        free_threads(free_threads)
+    {
+    }
+
     UnitaryDecomposer(
         const Str &name,
         const Vec<Complex> &array
@@ -131,10 +178,27 @@ public:
 
             throw utils::Exception("Error: Unitary '"+ name+"' is not a unitary matrix. Cannot be decomposed!" + to_string(matmatadjoint), false);
         }
-        // initialize the general M^k lookuptable
-        genMk();
-
-        decomp_function(_matrix, numberofbits); //needed because the matrix is read in columnmajor
+        if (free_threads) {
+            // the subproblems are already spread over the threads, so don't let Eigen start threads of its own
+            struct eigen_threads_t {
+                eigen_threads_t() {
+                    std::lock_guard<std::mutex> lock(eigen_threads_mutex);
+                    if (eigen_threads_users++ == 0) {
+                        eigen_threads_saved = Eigen::nbThreads();
+                        Eigen::setNbThreads(1);
+                    }
+                }
+                ~eigen_threads_t() {
+                    std::lock_guard<std::mutex> lock(eigen_threads_mutex);
+                    if (--eigen_threads_users == 0) {
+                        Eigen::setNbThreads(eigen_threads_saved);
+                    }
+                }
+            } eigen_threads;
+            decomp_function(_matrix, numberofbits); //needed because the matrix is read in columnmajor
+        } else {
+            decomp_function(_matrix, numberofbits); //needed because the matrix is read in columnmajor
+        }
 
         QL_DOUT("Done decomposing");
         is_decomposed = true;
@@ -157,8 +221,69 @@ public:
     // std::chrono::duration<Real> multiplexing_time;
     // std::chrono::duration<Real> demultiplexing_time;
 
+    // Subproblems of at least this many qubits are decomposed on a thread of their own when
+    // parallel decomposition is enabled; smaller ones take less time than starting a thread.
+    static const Int MIN_PARALLEL_QUBITS = 3;
+
+    // take one of the free threads, if any
+    Bool acquire_thread() {
+        if (!free_threads) {
+            return false;
+        }
+        Int available = free_threads->load();
+        while (available > 0) {
+            if (free_threads->compare_exchange_weak(available, available - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs the given steps, each with a decomposer of its own, and appends their instruction lists
+    // to this one in order, so the result does not depend on the order in which the steps finish.
+    // The steps with spawn set run on a new thread when one is free, the others on the current one.
+    void run_steps(const Vec<Pair<Bool, std::function<void(UnitaryDecomposer &)>>> &steps) {
+        Vec<UnitaryDecomposer> children;
+        for (UInt i = 0; i < steps.size(); i++) {
+            children.emplace_back(name, free_threads);
+        }
+        Vec<std::future<void>> futures;
+        for (UInt i = 0; i < steps.size(); i++) {
+            UnitaryDecomposer &child = children[i];
+            const auto &step = steps[i].second;
+            if (steps[i].first && acquire_thread()) {
+                futures.push_back(std::async(std::launch::async, [&child, &step]() {
+                    struct release_t {
+                        std::atomic<Int> &free;
+                        ~release_t() { free++; }
+                    } release{*child.free_threads};
+                    step(child);
+                }));
+            } else {
+                step(child);
+            }
+        }
+        // get() rethrows exceptions of the steps, but only after all of them are done with children
+        for (auto &future : futures) {
+            future.wait();
+        }
+        for (auto &future : futures) {
+            future.get();
+        }
+        for (auto &child : children) {
+            instructionlist.insert(instructionlist.end(), child.instructionlist.begin(), child.instructionlist.end());
+            if (child.did_zyz) {
+                alpha = child.alpha;
+                beta = child.beta;
+                gamma = child.gamma;
+                did_zyz = true;
+            }
+        }
+    }
+
     void decomp_function(const Eigen::Ref<const complex_matrix>& matrix, Int numberofbits) {
         QL_DOUT("decomp_function: \n" << to_string(matrix));
+        Bool parallel = free_threads && numberofbits - 1 >= MIN_PARALLEL_QUBITS;
         if(numberofbits == 1) {
             zyz_decomp(matrix);
         } else {
@@ -178,9 +303,17 @@ public:
                 } else {
                     demultiplexing(matrix.topLeftCorner(n, n), matrix.bottomRightCorner(n,n), V, D, W, numberofbits-1);
 
-                    decomp_function(W, numberofbits-1);
-                    multicontrolledZ(D, D.rows());
-                    decomp_function(V, numberofbits-1);
+                    if (parallel) {
+                        run_steps({
+                            {true, [&](UnitaryDecomposer &d) { d.decomp_function(W, numberofbits-1); }},
+                            {false, [&](UnitaryDecomposer &d) { d.multicontrolledZ(D, D.rows()); }},
+                            {false, [&](UnitaryDecomposer &d) { d.decomp_function(V, numberofbits-1); }}
+                        });
+                    } else {
+                        decomp_function(W, numberofbits-1);
+                        multicontrolledZ(D, D.rows());
+                        decomp_function(V, numberofbits-1);
+                    }
                 }
             } else if (
                 // Check to see if it the kronecker product of a bigger matrix and the identity matrix.
@@ -204,17 +337,37 @@ public:
                 // auto start = std::chrono::steady_clock::now();
                 CSD(matrix, L0, L1, R0, R1, ss);
                 // CSD_time += (std::chrono::steady_clock::now() - start);
-                demultiplexing(R0, R1, V, D, W, numberofbits-1);
-                decomp_function(W, numberofbits-1);
-                multicontrolledZ(D, D.rows());
-                decomp_function(V, numberofbits-1);
+                if (parallel) {
+                    // the four subproblems are independent, as are both demultiplexings
+                    complex_matrix V2(n,n);
+                    complex_matrix W2(n,n);
+                    Eigen::VectorXcd D2(n);
+                    run_steps({
+                        {true, [&](UnitaryDecomposer &d) { d.demultiplexing(R0, R1, V, D, W, numberofbits-1); }},
+                        {false, [&](UnitaryDecomposer &d) { d.demultiplexing(L0, L1, V2, D2, W2, numberofbits-1); }}
+                    });
+                    run_steps({
+                        {true, [&](UnitaryDecomposer &d) { d.decomp_function(W, numberofbits-1); }},
+                        {false, [&](UnitaryDecomposer &d) { d.multicontrolledZ(D, D.rows()); }},
+                        {true, [&](UnitaryDecomposer &d) { d.decomp_function(V, numberofbits-1); }},
+                        {false, [&](UnitaryDecomposer &d) { d.multicontrolledY(ss.diagonal(), n); }},
+                        {true, [&](UnitaryDecomposer &d) { d.decomp_function(W2, numberofbits-1); }},
+                        {false, [&](UnitaryDecomposer &d) { d.multicontrolledZ(D2, D2.rows()); }},
+                        {false, [&](UnitaryDecomposer &d) { d.decomp_function(V2, numberofbits-1); }}
+                    });
+                } else {
+                    demultiplexing(R0, R1, V, D, W, numberofbits-1);
+                    decomp_function(W, numberofbits-1);
+                    multicontrolledZ(D, D.rows());
+                    decomp_function(V, numberofbits-1);
 
-                multicontrolledY(ss.diagonal(), n);
+                    multicontrolledY(ss.diagonal(), n);
 
-                demultiplexing(L0, L1, V, D, W, numberofbits-1);
-                decomp_function(W, numberofbits-1);
-                multicontrolledZ(D, D.rows());
-                decomp_function(V, numberofbits-1);
+                    demultiplexing(L0, L1, V, D, W, numberofbits-1);
+                    decomp_function(W, numberofbits-1);
+                    multicontrolledZ(D, D.rows());
+                    decomp_function(V, numberofbits-1);
+                }
             }
         }
     }
@@ -382,6 +535,7 @@ public:
         instructionlist.push_back(-gamma);
         instructionlist.push_back(-beta);
         instructionlist.push_back(-alpha);
+        did_zyz = true;
         // zyz_time += (std::chrono::steady_clock::now() - start);
     }
 
@@ -437,33 +591,47 @@ public:
 
     }
 
-    Vec<Eigen::MatrixXd> genMk_lookuptable;
+    /**
+     * M^k lookup table entry for a number of qubits, along with its
+     * decomposition, which is what the multicontrolled rotations solve with.
+     */
+    struct MkEntry {
+        Eigen::MatrixXd Mk;
+        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec;
+    };
 
     // returns M^k = (-1)^(b_(i-1)*g_(i-1)), where * is bitwise inner product, g = binary gray code, b = binary code.
-    void genMk() {
-        Int numberqubits = uint64_log2(_matrix.rows());
-        for (Int n = 1; n <= numberqubits; n++) {
+    // The table only depends on the number of qubits, so it is built once per qubit count and shared process-wide;
+    // entries are never removed, so the returned reference remains valid.
+    static const MkEntry &genMk(Int numberqubits) {
+        static std::mutex mutex;
+        static Vec<std::unique_ptr<const MkEntry>> lookuptable;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        while ((Int)lookuptable.size() < numberqubits) {
+            Int n = lookuptable.size() + 1;
             Int size=1<<n;
-            Eigen::MatrixXd Mk(size,size);
+            std::unique_ptr<MkEntry> entry(new MkEntry());
+            entry->Mk.resize(size, size);
             for (Int i = 0; i < size; i++) {
                 for (Int j = 0; j < size ;j++) {
-                    Mk(i,j) = pow(-1, bitParity(i&(j^(j>>1))));
+                    entry->Mk(i,j) = pow(-1, bitParity(i&(j^(j>>1))));
                 }
             }
-            genMk_lookuptable.push_back(Mk);
+            entry->dec.compute(entry->Mk);
+            lookuptable.push_back(std::move(entry));
         }
-
-        // return genMk_lookuptable[numberqubits-1];
+        return *lookuptable[numberqubits-1];
     }
 
     // source: https://stackoverflow.com/questions/994593/how-to-do-an-integer-log2-in-c user Todd Lehman
-    Int uint64_log2(uint64_t n) {
+    static Int uint64_log2(uint64_t n) {
 #define S(k) if (n >= (UINT64_C(1) << k)) { i += k; n >>= k; }
         Int i = -(n == 0); S(32); S(16); S(8); S(4); S(2); S(1); return i;
 #undef S
     }
 
-    Int bitParity(Int i) {
+    static Int bitParity(Int i) {
         if (i < 2 << 16) {
             i = (i >> 16) ^ i;
             i = (i >> 8) ^ i;
@@ -479,15 +647,15 @@ public:
     void multicontrolledY(const Eigen::Ref<const Eigen::VectorXcd> &ss, Int halfthesizeofthematrix) {
         // auto start = std::chrono::steady_clock::now();
         Eigen::VectorXd temp =  2*Eigen::asin(ss.array()).real();
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]);
-        Eigen::VectorXd tr = dec.solve(temp);
+        const MkEntry &Mk = genMk(uint64_log2(halfthesizeofthematrix));
+        Eigen::VectorXd tr = Mk.dec.solve(temp);
         // Check is very approximate to account for low-precision input matrices
-        if (!temp.isApprox(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]*tr, 10e-2)) {
+        if (!temp.isApprox(Mk.Mk*tr, 10e-2)) {
             QL_EOUT("Multicontrolled Y not correct!");
             throw utils::Exception("Demultiplexing of unitary '"+ name+"' not correct! Failed at demultiplexing of matrix ss: \n"  + to_string(ss), false);
         }
 
-        instructionlist.insert(instructionlist.end(), &tr[0], &tr[halfthesizeofthematrix]);
+        instructionlist.insert(instructionlist.end(), tr.data(), tr.data() + halfthesizeofthematrix);
         // multiplexing_time += std::chrono::steady_clock::now() - start;
     }
 
@@ -495,15 +663,15 @@ public:
         // auto start = std::chrono::steady_clock::now();
 
         Eigen::VectorXd temp =  (Complex(0,-2)*Eigen::log(D.array())).real();
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]);
-        Eigen::VectorXd tr = dec.solve(temp);
+        const MkEntry &Mk = genMk(uint64_log2(halfthesizeofthematrix));
+        Eigen::VectorXd tr = Mk.dec.solve(temp);
         // Check is very approximate to account for low-precision input matrices
-        if (!temp.isApprox(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]*tr, 10e-2)) {
+        if (!temp.isApprox(Mk.Mk*tr, 10e-2)) {
             QL_EOUT("Multicontrolled Z not correct!");
             throw utils::Exception("Demultiplexing of unitary '"+ name+"' not correct! Failed at demultiplexing of matrix D: \n"+ to_string(D), false);
         }
 
-        instructionlist.insert(instructionlist.end(), &tr[0], &tr[halfthesizeofthematrix]);
+        instructionlist.insert(instructionlist.end(), tr.data(), tr.data() + halfthesizeofthematrix);
         // multiplexing_time += std::chrono::steady_clock::now() - start;
 
     }
@@ -514,8 +682,118 @@ public:
     }
 };
 
+/**
+ * Result of decomposing a unitary, as kept in the decomposition cache.
+ */
+struct cached_decomposition_t {
+    Vec<Complex> array;
+    Vec<Complex> SU;
+    Real alpha;
+    Real beta;
+    Real gamma;
+    Vec<Real> instructionlist;
+};
+
+/**
+ * Matrix elements that differ by less than this are considered equal by the
+ * decomposition cache. This is far below the precision the decomposition
+ * itself checks its results with.
+ */
+static const Real DECOMPOSITION_CACHE_TOLERANCE = 1e-10;
+
+/**
+ * The cache is cleared when it grows beyond this number of decompositions, to
+ * bound its memory use when many distinct unitaries are decomposed.
+ */
+static const UInt DECOMPOSITION_CACHE_MAX_SIZE = 1024;
+
+static std::mutex decomposition_cache_mutex;
+static Map<UInt, List<std::shared_ptr<const cached_decomposition_t>>> decomposition_cache;
+static UInt decomposition_cache_size = 0;
+static UInt decomposition_cache_hits = 0;
+static UInt decomposition_cache_misses = 0;
+
+/**
+ * Returns a fingerprint of the given matrix, obtained by hashing its elements
+ * rounded to a grid of DECOMPOSITION_CACHE_TOLERANCE. Matrices that are equal
+ * within the tolerance usually, but not necessarily, have the same
+ * fingerprint, so the cache must still compare the elements.
+ */
+static UInt decomposition_fingerprint(const Vec<Complex> &array) {
+    UInt seed = 0;
+    for (const auto &element : array) {
+        hash_combine(seed, (Int)std::llround(element.real() / DECOMPOSITION_CACHE_TOLERANCE));
+        hash_combine(seed, (Int)std::llround(element.imag() / DECOMPOSITION_CACHE_TOLERANCE));
+    }
+    hash_combine(seed, (UInt)array.size());
+    return seed;
+}
+
+static Bool decomposition_matches(const Vec<Complex> &a, const Vec<Complex> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (UInt i = 0; i < a.size(); i++) {
+        if (std::abs(a[i].real() - b[i].real()) > DECOMPOSITION_CACHE_TOLERANCE
+            || std::abs(a[i].imag() - b[i].imag()) > DECOMPOSITION_CACHE_TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the number of threads a single decomposition may use, as given by
+ * option unitary_decomposition_parallel: no for 1, yes for the number of
+ * hardware threads, or an explicit number.
+ */
+static UInt decomposition_thread_count() {
+    Str opt = options::get("unitary_decomposition_parallel");
+    if (opt == "no") {
+        return 1;
+    } else if (opt == "yes") {
+        return std::max<UInt>(1, std::thread::hardware_concurrency());
+    } else {
+        return std::max<UInt>(1, parse_uint(opt));
+    }
+}
+
+/**
+ * Decomposes the unitary, reusing the result of an earlier decomposition of
+ * the same matrix when option unitary_decomposition_cache is enabled. Only
+ * successful decompositions are cached, so a matrix that isn't unitary
+ * throws every time.
+ */
 void unitary::decompose() {
+    Bool use_cache = options::get("unitary_decomposition_cache") == "yes";
+    UInt fingerprint = 0;
+    if (use_cache) {
+        fingerprint = decomposition_fingerprint(array);
+        std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+        auto it = decomposition_cache.find(fingerprint);
+        if (it != decomposition_cache.end()) {
+            for (const auto &cached : it->second) {
+                if (decomposition_matches(cached->array, array)) {
+                    QL_DOUT("reusing cached decomposition for unitary: " << name);
+                    SU = cached->SU;
+                    alpha = cached->alpha;
+                    beta = cached->beta;
+                    gamma = cached->gamma;
+                    instructionlist = cached->instructionlist;
+                    is_decomposed = true;
+                    decomposition_cache_hits++;
+                    return;
+                }
+            }
+        }
+        decomposition_cache_misses++;
+    }
+
     UnitaryDecomposer decomposer(name, array);
+    UInt threads = decomposition_thread_count();
+    if (threads > 1) {
+        decomposer.free_threads = std::make_shared<std::atomic<Int>>(threads - 1);
+    }
     decomposer.decompose();
     SU = decomposer.SU;
     alpha = decomposer.alpha;
@@ -523,12 +801,59 @@ void unitary::decompose() {
     gamma = decomposer.gamma;
     is_decomposed = decomposer.is_decomposed;
     instructionlist = decomposer.instructionlist;
+
+    if (use_cache) {
+        std::shared_ptr<cached_decomposition_t> cached(new cached_decomposition_t());
+        cached->array = array;
+        cached->SU = SU;
+        cached->alpha = alpha;
+        cached->beta = beta;
+        cached->gamma = gamma;
+        cached->instructionlist = instructionlist;
+
+        std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+        if (decomposition_cache_size >= DECOMPOSITION_CACHE_MAX_SIZE) {
+            decomposition_cache.clear();
+            decomposition_cache_size = 0;
+        }
+        decomposition_cache.set(fingerprint).push_back(cached);
+        decomposition_cache_size++;
+    }
 }
 
 Bool unitary::is_decompose_support_enabled() {
     return true;
 }
 
+/**
+ * Empties the decomposition cache and resets its hit and miss counters.
+ */
+void unitary::clear_decomposition_cache() {
+    std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+    decomposition_cache.clear();
+    decomposition_cache_size = 0;
+    decomposition_cache_hits = 0;
+    decomposition_cache_misses = 0;
+}
+
+/**
+ * Returns the number of decompositions taken from the cache since it was last
+ * cleared by clear_decomposition_cache().
+ */
+UInt unitary::get_decomposition_cache_hits() {
+    std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+    return decomposition_cache_hits;
+}
+
+/**
+ * Returns the number of decompositions that were looked up in the cache but
+ * not found, since it was last cleared by clear_decomposition_cache().
+ */
+UInt unitary::get_decomposition_cache_misses() {
+    std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+    return decomposition_cache_misses;
+}
+
 #endif
 
 } // namespace ql
@@ -28,6 +28,9 @@ public:
     utils::Real size() const;
     void decompose();
     static utils::Bool is_decompose_support_enabled();
+    static void clear_decomposition_cache();
+    static utils::UInt get_decomposition_cache_hits();
+    static utils::UInt get_decomposition_cache_misses();
 };
 
 } // namespace ql
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <fstream>
 #include <cerrno>
+#include <cstdlib>
 #include <algorithm>
 
 #ifdef _WIN32
@@ -106,6 +107,28 @@ void make_dirs(const Str &path) {
 
 }
 
+/**
+ * Returns the canonical, absolute form of the given path, with symbolic links
+ * resolved on Linux and MacOS. If this fails, for instance because the path
+ * does not exist, the path is returned as is.
+ */
+Str canonical_path(const Str &path) {
+#ifdef _WIN32
+    char resolved[_MAX_PATH];
+    if (_fullpath(resolved, path.c_str(), _MAX_PATH)) {
+        return Str(resolved);
+    }
+#else
+    char *resolved = realpath(path.c_str(), nullptr);
+    if (resolved) {
+        Str result{resolved};
+        free(resolved);
+        return result;
+    }
+#endif
+    return path;
+}
+
 /**
  * Tries to create a file (if it doesn't already exist) and opens it for
  * writing. If the directory that path is contained by does not exists, it is
@@ -16,6 +16,7 @@ bool is_file(const Str &path);
 bool path_exists(const Str &path);
 Str dir_name(const Str &path);
 void make_dirs(const Str &path);
+Str canonical_path(const Str &path);
 
 /**
  * Wrapper for std::ofstream that:
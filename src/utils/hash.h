@@ -0,0 +1,36 @@
+/** \file
+ * Utilities for combining hashes of values, for use as keys in caches and for
+ * fingerprinting IR structures.
+ */
+
+#pragma once
+
+#include <functional>
+#include "utils/num.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Mixes the hash of value into seed, using the well-known boost recipe. Note
+ * that the order in which values are combined matters.
+ */
+template <typename T>
+inline void hash_combine(UInt &seed, const T &value) {
+    seed ^= std::hash<T>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+/**
+ * Mixes the hashes of all elements of the given container into seed, followed
+ * by its size so that adjacent containers can't alias each other.
+ */
+template <typename C>
+inline void hash_combine_range(UInt &seed, const C &container) {
+    for (const auto &value : container) {
+        hash_combine(seed, value);
+    }
+    hash_combine(seed, (UInt)container.size());
+}
+
+} // namespace utils
+} // namespace ql
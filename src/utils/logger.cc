@@ -41,6 +41,10 @@ LogLevel log_level_from_string(const Str &level) {
  */
 void set_log_level(const Str &level) {
     log_level = log_level_from_string(level);
+    if (log_level > QL_MAX_LOG_LEVEL) {
+        std::cerr << "[OPENQL] log level " << level << " is above the highest level compiled into this build"
+                  << " (OPENQL_MAX_LOG_LEVEL); those messages are not printed" << std::endl;
+    }
 }
 
 } // namespace logger
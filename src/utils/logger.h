@@ -5,9 +5,23 @@
 #pragma once
 
 #include <iostream>
+#include "ql_config.h"
 #include "utils/compat.h"
 #include "utils/str.h"
 
+// Highest log level that is compiled in, as the integer value of a
+// ql::utils::logger::LogLevel. Messages above this level are compiled out and
+// cost nothing at runtime, whatever the runtime log level. Normally set by the
+// OPENQL_MAX_LOG_LEVEL CMake option through ql_config.h.
+#ifndef QL_MAX_LOG_LEVEL
+#define QL_MAX_LOG_LEVEL 5
+#endif
+
+// helper macro: whether messages of the given level (e.g. LOG_DEBUG) are to
+// be logged; constant false when the level is compiled out
+#define QL_LOG_ENABLED(level) \
+    (QL_MAX_LOG_LEVEL >= ::ql::utils::logger::LogLevel::level && ::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::level)
+
 // helper macro: stringstream to string
 // based on https://stackoverflow.com/questions/21924156/how-to-initialize-a-stdstringstream
 #define QL_SS2S(values) ::ql::utils::Str(static_cast<::ql::utils::StrStrm&&>(::ql::utils::StrStrm() << values).str())
@@ -19,28 +33,28 @@
 
 #define QL_EOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_ERROR) {                   \
+        if (QL_LOG_ENABLED(LOG_ERROR)) {                                                                    \
             ::std::cerr << "[OPENQL] " __FILE__ ":" << __LINE__ << " Error: " << content << ::std::endl;    \
         }                                                                                                   \
     } while (false)
 
 #define QL_WOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_WARNING) {                 \
+        if (QL_LOG_ENABLED(LOG_WARNING)) {                                                                  \
             ::std::cerr << "[OPENQL] " __FILE__ ":" << __LINE__ << " Warning: " << content << ::std::endl;  \
         }                                                                                                   \
     } while (false)
 
 #define QL_IOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_INFO) {                    \
+        if (QL_LOG_ENABLED(LOG_INFO)) {                                                                     \
             ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " Info: "<< content << ::std::endl;      \
         }                                                                                                   \
     } while (false)
 
 #define QL_DOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_DEBUG) {                   \
+        if (QL_LOG_ENABLED(LOG_DEBUG)) {                                                                    \
             ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content << ::std::endl;           \
         }                                                                                                   \
     } while (false)
@@ -0,0 +1,181 @@
+/** \file
+ * Lightweight binary trace of compiler events, for diagnosing compilations
+ * without the cost of formatting log messages.
+ */
+
+#include "utils/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include "utils/vec.h"
+#include "utils/map.h"
+#include "utils/exception.h"
+
+namespace ql {
+namespace utils {
+namespace trace {
+
+namespace {
+
+const char TRACE_MAGIC[8] = {'O', 'Q', 'L', 'T', 'R', 'A', 'C', 'E'};
+const std::uint32_t TRACE_VERSION = 1;
+const std::uint32_t TRACE_BYTE_ORDER = 0x01020304;
+
+struct header_t {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t event_count;
+    std::uint64_t dropped_count;
+    std::uint64_t name_count;
+};
+
+struct event_t {
+    std::uint64_t time;
+    std::uint64_t gate_id;
+    std::uint32_t event;
+    std::uint32_t reserved;
+};
+
+/**
+ * A slot of the ring buffer. Once the buffer wraps around, two threads can
+ * claim the same slot for events capacity apart, so the event is written under
+ * a per-slot spin lock, and only when it is newer than the one in the slot.
+ */
+struct slot_t {
+    std::atomic<Bool> busy{false};
+    UInt ticket = 0;                // 1 + index of the event in the slot, 0 if none
+    event_t event{};
+};
+
+/**
+ * The ring buffer. Writers claim a slot by incrementing next; the buffer is
+ * only resized or read while no events are being recorded.
+ */
+std::unique_ptr<slot_t[]> buffer;
+UInt buffer_size = 0;
+std::atomic<UInt> next(0);
+std::chrono::steady_clock::time_point start_time;
+
+/**
+ * Names of the registered events, indexed by event ID.
+ */
+std::mutex names_mutex;
+Vec<Str> names;
+Map<Str, UInt> name_ids;
+
+} // anonymous namespace
+
+/**
+ * Whether events are being recorded. Use enable() to change it.
+ */
+Bool enabled = false;
+
+/**
+ * Enables tracing into a ring buffer of the given number of events, clearing
+ * the events recorded so far, or disables tracing when capacity is 0.
+ */
+void enable(UInt capacity) {
+    enabled = false;
+    buffer.reset(capacity > 0 ? new slot_t[capacity] : nullptr);
+    buffer_size = capacity;
+    next = 0;
+    start_time = std::chrono::steady_clock::now();
+    enabled = capacity > 0;
+}
+
+/**
+ * Returns the ID for the event with the given name, assigning a new one the
+ * first time the name is seen.
+ */
+UInt register_event(const Str &name) {
+    std::lock_guard<std::mutex> lock(names_mutex);
+    auto it = name_ids.find(name);
+    if (it != name_ids.end()) {
+        return it->second;
+    }
+    UInt id = names.size();
+    names.push_back(name);
+    name_ids.set(name) = id;
+    return id;
+}
+
+/**
+ * Records an event with the current time.
+ */
+void record(UInt event, UInt gate_id) {
+    if (buffer_size == 0) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    UInt index = next.fetch_add(1, std::memory_order_relaxed);
+    slot_t &slot = buffer[index % buffer_size];
+    while (slot.busy.exchange(true, std::memory_order_acquire)) {
+    }
+    if (slot.ticket <= index) {
+        slot.ticket = index + 1;
+        event_t &e = slot.event;
+        e.time = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time).count();
+        e.gate_id = gate_id;
+        e.event = event;
+        e.reserved = 0;
+    }
+    slot.busy.store(false, std::memory_order_release);
+}
+
+/**
+ * Returns the number of events in the buffer.
+ */
+UInt size() {
+    return std::min<UInt>(next, buffer_size);
+}
+
+/**
+ * Writes the events in the buffer, oldest first, and the names of the events to
+ * a binary file, and clears the buffer.
+ */
+void write(const Str &file_name) {
+    std::ofstream ofs(file_name, std::ios::binary);
+    if (!ofs.is_open()) {
+        throw Exception("failed to open trace file \"" + file_name + "\"", true);
+    }
+
+    UInt recorded = next;
+    UInt count = std::min<UInt>(recorded, buffer_size);
+    UInt first = recorded - count;
+
+    header_t header{};
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.byte_order = TRACE_BYTE_ORDER;
+    header.event_count = count;
+    header.dropped_count = first;
+    std::lock_guard<std::mutex> lock(names_mutex);
+    header.name_count = names.size();
+    ofs.write((const char *)&header, sizeof(header));
+
+    for (UInt i = first; i < recorded; i++) {
+        ofs.write((const char *)&buffer[i % buffer_size].event, sizeof(event_t));
+    }
+    for (const auto &name : names) {
+        std::uint32_t length = name.size();
+        ofs.write((const char *)&length, sizeof(length));
+        ofs.write(name.data(), name.size());
+    }
+    if (ofs.fail()) {
+        throw Exception("failed to write trace file \"" + file_name + "\"", true);
+    }
+    for (UInt i = 0; i < buffer_size; i++) {
+        buffer[i].ticket = 0;
+    }
+    next = 0;
+}
+
+} // namespace trace
+} // namespace utils
+} // namespace ql
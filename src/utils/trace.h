@@ -0,0 +1,87 @@
+/** \file
+ * Lightweight binary trace of compiler events, for diagnosing compilations
+ * without the cost of formatting log messages.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "utils/compat.h"
+#include "utils/num.h"
+#include "utils/str.h"
+
+/**
+ * Records that the event with the given name (a string literal, e.g.
+ * "scheduler.set_cycle") happened for the gate with the given ID, usually
+ * trace::id_of(gate), or for another object identified by an integer. Costs a
+ * single branch when tracing is disabled. The name is registered the first time
+ * the call site records an event.
+ */
+#define QL_TRACE(name, gate_id) \
+    do {                                                                                                    \
+        if (::ql::utils::trace::enabled) {                                                                  \
+            static const ::ql::utils::UInt ql_trace_event = ::ql::utils::trace::register_event(name);       \
+            ::ql::utils::trace::record(ql_trace_event, (gate_id));                                          \
+        }                                                                                                   \
+    } while (false)
+
+namespace ql {
+namespace utils {
+namespace trace {
+
+/**
+ * Whether events are being recorded. Use enable() to change it.
+ */
+QL_GLOBAL extern Bool enabled;
+
+/**
+ * Returns the trace ID of a gate or other object, i.e. its address, which
+ * identifies it for as long as it exists.
+ */
+inline UInt id_of(const void *object) {
+    return reinterpret_cast<std::uintptr_t>(object);
+}
+
+/**
+ * Enables tracing into a ring buffer of the given number of events, clearing
+ * the events recorded so far, or disables tracing when capacity is 0. Once the
+ * buffer is full, each new event overwrites the oldest one.
+ */
+void enable(UInt capacity);
+
+/**
+ * Returns the ID for the event with the given name, assigning a new one the
+ * first time the name is seen.
+ */
+UInt register_event(const Str &name);
+
+/**
+ * Records an event with the current time. Safe to call from multiple threads,
+ * but not concurrently with enable() or write().
+ */
+void record(UInt event, UInt gate_id);
+
+/**
+ * Returns the number of events in the buffer.
+ */
+UInt size();
+
+/**
+ * Writes the events in the buffer, oldest first, and the names of the events to
+ * a binary file, and clears the buffer. The file consists of (all integers in
+ * host byte order):
+ *
+ *  - header: char magic[8] = "OQLTRACE", uint32 version = 1, uint32
+ *    byte_order = 0x01020304, uint64 event count, uint64 dropped event count
+ *    (overwritten in the ring buffer), uint64 name count;
+ *  - events: per event uint64 time in nanoseconds since tracing was enabled,
+ *    uint64 gate ID, uint32 event ID, uint32 reserved;
+ *  - names: per event ID, in order, uint32 length followed by the characters.
+ *
+ * Throws if the file can't be written.
+ */
+void write(const Str &file_name);
+
+} // namespace trace
+} // namespace utils
+} // namespace ql
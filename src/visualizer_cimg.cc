@@ -12,61 +12,102 @@
 #include "utils/num.h"
 #include "utils/str.h"
 
+#include <mutex>
+
 namespace ql {
 
 using namespace utils;
 
-Image::Image(const Int imageWidth, const Int imageHeight) : cimg((int) imageWidth, (int) imageHeight, 1, 3) {
+RasterImage::RasterImage(const Int imageWidth, const Int imageHeight, const Int xOffset) : cimg((int) imageWidth, (int) imageHeight, 1, 3), xOffset(xOffset) {
     // empty
 }
 
-void Image::fill(const Int rgb) {
+// CImg keeps the phase of line patterns in a static variable that is updated
+// by every line it draws, and restarts the pattern where a shape enters the
+// image. Lines and patterned shapes are therefore drawn one at a time, and a
+// patterned shape that crosses the left or right edge of the image is drawn in
+// full on a scratch image first, so that a slice of a larger picture shows the
+// same dashes as the picture itself.
+static std::mutex patternMutex;
+
+void RasterImage::drawPatterned(const Int x0, const Int x1,
+                          const std::function<void(cimg_library::CImg<unsigned char> &target, Int xOffset)> &draw) {
+    const Int left = x0 - xOffset;
+    const Int right = x1 - xOffset;
+    if (right < 0 || left >= cimg.width()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(patternMutex);
+    if (left >= 0 && right < cimg.width()) {
+        draw(cimg, xOffset);
+        return;
+    }
+    cimg_library::CImg<unsigned char> scratch = cimg.get_crop((int) left, 0, (int) right, cimg.height() - 1);
+    draw(scratch, x0);
+    cimg.draw_image((int) left, 0, scratch);
+}
+
+void RasterImage::fill(const Int rgb) {
     cimg.fill((int) rgb);
 }
 
-void Image::drawLine(const Int x0, const Int y0, const Int x1, const Int y1, const Color color, const Real alpha, const LinePattern pattern) {
-    cimg.draw_line((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+void RasterImage::drawLine(const Int x0, const Int y0, const Int x1, const Int y1, const Color color, const Real alpha, const LinePattern pattern) {
+    if (pattern == LinePattern::UNBROKEN) {
+        std::lock_guard<std::mutex> lock(patternMutex);
+        cimg.draw_line((int) (x0 - xOffset), (int) y0, (int) (x1 - xOffset), (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+        return;
+    }
+    drawPatterned(min(x0, x1), max(x0, x1), [&](cimg_library::CImg<unsigned char> &target, const Int offset) {
+        target.draw_line((int) (x0 - offset), (int) y0, (int) (x1 - offset), (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    });
 }
 
-void Image::drawText(const Int x, const Int y, const Str &text, const Int height, const Color color) {
-    cimg.draw_text((int) x, (int) y, text.c_str(), color.data(), 0, 1, (int) height);
+void RasterImage::drawText(const Int x, const Int y, const Str &text, const Int height, const Color color) {
+    cimg.draw_text((int) (x - xOffset), (int) y, text.c_str(), color.data(), 0, 1, (int) height);
 }
 
-void Image::drawFilledCircle(const Int centerX, const Int centerY, const Int radius,
+void RasterImage::drawFilledCircle(const Int centerX, const Int centerY, const Int radius,
                              const Color color, const Real alpha) {
-    cimg.draw_circle((int) centerX, (int) centerY, (int) radius, color.data(), (float) alpha);
+    cimg.draw_circle((int) (centerX - xOffset), (int) centerY, (int) radius, color.data(), (float) alpha);
 }
 
-void Image::drawOutlinedCircle(const Int centerX, const Int centerY, const Int radius,
+void RasterImage::drawOutlinedCircle(const Int centerX, const Int centerY, const Int radius,
                                const Color color, const Real alpha, const LinePattern pattern) {
-    cimg.draw_circle((int) centerX, (int) centerY, (int) radius, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    drawPatterned(centerX - radius, centerX + radius, [&](cimg_library::CImg<unsigned char> &target, const Int offset) {
+        target.draw_circle((int) (centerX - offset), (int) centerY, (int) radius, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    });
 }
 
-void Image::drawFilledTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
+void RasterImage::drawFilledTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
                                const Color color, const Real alpha) {
-    cimg.draw_triangle((int) x0, (int) y0, (int) x1, (int) y1, (int) x2, (int) y2, color.data(), (float) alpha);
+    cimg.draw_triangle((int) (x0 - xOffset), (int) y0, (int) (x1 - xOffset), (int) y1, (int) (x2 - xOffset), (int) y2, color.data(), (float) alpha);
 }
 
-void Image::drawOutlinedTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
+void RasterImage::drawOutlinedTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
                                  const Color color, const Real alpha, const LinePattern pattern) {
-    cimg.draw_triangle((int) x0, (int) y0, (int) x1, (int) y1, (int) x2, (int) y2, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    drawPatterned(min(x0, min(x1, x2)), max(x0, max(x1, x2)), [&](cimg_library::CImg<unsigned char> &target, const Int offset) {
+        target.draw_triangle((int) (x0 - offset), (int) y0, (int) (x1 - offset), (int) y1, (int) (x2 - offset), (int) y2, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    });
 }
 
-void Image::drawFilledRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
+void RasterImage::drawFilledRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
                                 const Color color, const Real alpha) {
-    cimg.draw_rectangle((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha);
+    cimg.draw_rectangle((int) (x0 - xOffset), (int) y0, (int) (x1 - xOffset), (int) y1, color.data(), (float) alpha);
 }
 
-void Image::drawOutlinedRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
+void RasterImage::drawOutlinedRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
                                   const Color color, const Real alpha, const LinePattern pattern) {
-    cimg.draw_rectangle((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    drawPatterned(min(x0, x1), max(x0, x1), [&](cimg_library::CImg<unsigned char> &target, const Int offset) {
+        target.draw_rectangle((int) (x0 - offset), (int) y0, (int) (x1 - offset), (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    });
 }
 
-void Image::save(const Str &filename) {
+void RasterImage::save(const Str &filename) {
     cimg.save(static_cast<std::string>(filename).c_str());
 }
 
-void Image::display(const Str &caption) {
+void RasterImage::display(const Str &caption) {
     cimg.display(static_cast<std::string>(caption).c_str());
 }
 
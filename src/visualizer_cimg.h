@@ -7,11 +7,14 @@
 #ifdef WITH_VISUALIZER
 
 #include "visualizer_types.h"
+#include "visualizer_image.h"
 #include "utils/num.h"
 #include "utils/str.h"
 
 #include "CImg.h"
 
+#include <functional>
+
 // Undef garbage left behind by CImg.
 #undef cimg_use_opencv
 #undef Bool
@@ -24,40 +27,41 @@ namespace ql {
 
 typedef std::array<utils::Byte, 3> Color;
 
-enum class LinePattern : unsigned int {
-    UNBROKEN = 0xFFFFFFFF,
-    DASHED = 0xF0F0F0F0
-};
-
-class Image {
+class RasterImage : public Image {
 private:
     cimg_library::CImg<unsigned char> cimg;
+    utils::Int xOffset;
+
+    void drawPatterned(const utils::Int x0, const utils::Int x1,
+                       const std::function<void(cimg_library::CImg<unsigned char> &target, utils::Int xOffset)> &draw);
 
 public:
-    Image(const utils::Int imageWidth, const utils::Int imageHeight);
+    // The x offset is subtracted from the x coordinates of everything that is
+    // drawn, so the image can hold a horizontal slice of a larger picture.
+    RasterImage(const utils::Int imageWidth, const utils::Int imageHeight, const utils::Int xOffset = 0);
 
-    void fill(const utils::Int rgb);
+    void fill(const utils::Int rgb) override;
 
     void drawLine(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
-                  const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN);
+                  const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
 
     void drawText(const utils::Int x, const utils::Int y, const utils::Str &text, const utils::Int height,
-                  const Color color = black);
+                  const Color color = black) override;
 
     void drawFilledCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
-                          const Color color = black, const utils::Real alpha = 1);
+                          const Color color = black, const utils::Real alpha = 1) override;
     void drawOutlinedCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
-                            const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN);
+                            const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
 
     void drawFilledTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
-                            const Color color = black, const utils::Real alpha = 1);
+                            const Color color = black, const utils::Real alpha = 1) override;
     void drawOutlinedTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
-                              const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN);
+                              const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
 
     void drawFilledRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
-                             const Color color = black, const utils::Real alpha = 1);
+                             const Color color = black, const utils::Real alpha = 1) override;
     void drawOutlinedRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
-                               const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN);
+                               const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
     
     void save(const utils::Str &filename);
     void display(const utils::Str &caption);
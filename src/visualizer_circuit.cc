@@ -9,6 +9,7 @@
 #include "visualizer_common.h"
 #include "visualizer_circuit.h"
 #include "visualizer_cimg.h"
+#include "visualizer_svg.h"
 #include "utils/json.h"
 #include "utils/num.h"
 #include "utils/vec.h"
@@ -17,6 +18,9 @@
 #include "utils/exception.h"
 
 #include <regex>
+#include <thread>
+#include <future>
+#include <atomic>
 
 namespace ql {
 
@@ -569,19 +573,67 @@ void visualizeCircuit(const ql::quantum_program* program, const VisualizerConfig
     Structure structure(layout, circuitData);
     structure.printProperties();
     
+    // Generate the pulse lines of each qubit if pulse visualization is enabled.
+    Vec<QubitLines> linesPerQubit;
+    if (layout.pulses.areEnabled()) {
+        PulseVisualization pulseVisualization = parseWaveformMapping(configuration.waveformMappingPath);
+        linesPerQubit = generateQubitLines(gates, pulseVisualization, circuitData);
+    }
+
+    // Write the circuit to an SVG file if enabled. The shapes are written to
+    // the file as they are drawn.
+    if (layout.imageFormat == SVG) {
+        const Str path = generateFilePath("circuit_visualization", "svg");
+        SvgImage image(path, structure.getImageWidth(), structure.getImageHeight());
+        image.fill(255);
+        drawCircuit(image, layout, circuitData, structure, linesPerQubit, {0, circuitData.getAmountOfCycles() - 1});
+        image.finish();
+        QL_IOUT("Circuit visualization saved to " << path);
+        return;
+    }
+
+    // Render the circuit in tiles if enabled, the tiles are saved to disk
+    // instead of being displayed.
+    if (layout.tiles.areEnabled()) {
+        Int maxGateCycles = 1;
+        for (const GateProperties &gate : gates) {
+            maxGateCycles = max(maxGateCycles, gate.duration / cycleDuration);
+        }
+        drawCircuitTiles(layout, circuitData, structure, linesPerQubit, maxGateCycles);
+        return;
+    }
+
     // Initialize image.
     QL_DOUT("Initializing image...");
-    Image image(structure.getImageWidth(), structure.getImageHeight());
+    RasterImage image(structure.getImageWidth(), structure.getImageHeight());
     image.fill(255);
 
+    drawCircuit(image, layout, circuitData, structure, linesPerQubit, {0, circuitData.getAmountOfCycles() - 1});
+
+    // Save the image if enabled.
+    if (layout.saveImage) {
+        image.save(generateFilePath("circuit_visualization", "bmp"));
+    }
+
+    // Display the image.
+    QL_DOUT("Displaying image...");
+    image.display("Quantum Circuit");
+}
+
+void drawCircuit(Image &image,
+                 const CircuitLayout &layout,
+                 const CircuitData &circuitData,
+                 const Structure &structure,
+                 const Vec<QubitLines> &linesPerQubit,
+                 const EndPoints &cycleRange) {
     // Draw the cycle labels if the option has been set.
     if (layout.cycles.labels.areEnabled()) {
-        drawCycleLabels(image, layout, circuitData, structure);
+        drawCycleLabels(image, layout, circuitData, structure, cycleRange);
     }
 
     // Draw the cycle edges if the option has been set.
     if (layout.cycles.edges.areEnabled()) {
-        drawCycleEdges(image, layout, circuitData, structure);
+        drawCycleEdges(image, layout, circuitData, structure, cycleRange);
     }
 
     // Draw the bit line edges if enabled.
@@ -596,28 +648,28 @@ void visualizeCircuit(const ql::quantum_program* program, const VisualizerConfig
 
     // Draw the circuit as pulses if enabled.
     if (layout.pulses.areEnabled()) {
-        PulseVisualization pulseVisualization = parseWaveformMapping(configuration.waveformMappingPath);
-        const Vec<QubitLines> linesPerQubit = generateQubitLines(gates, pulseVisualization, circuitData);
-
         // Draw the lines of each qubit.
         QL_DOUT("Drawing qubit lines for pulse visualization...");
         for (Int qubitIndex = 0; qubitIndex < circuitData.amountOfQubits; qubitIndex++) {
             const Int yBase = structure.getCellPosition(0, qubitIndex, QUANTUM).y0;
 
-            drawLine(image, structure, cycleDuration, linesPerQubit[qubitIndex].microwave, qubitIndex,
+            drawLine(image, structure, circuitData.cycleDuration, linesPerQubit[qubitIndex].microwave, qubitIndex,
                 yBase,
                 layout.pulses.getPulseRowHeightMicrowave(),
-                layout.pulses.getPulseColorMicrowave());
+                layout.pulses.getPulseColorMicrowave(),
+                cycleRange);
 
-            drawLine(image, structure, cycleDuration, linesPerQubit[qubitIndex].flux, qubitIndex,
+            drawLine(image, structure, circuitData.cycleDuration, linesPerQubit[qubitIndex].flux, qubitIndex,
                 yBase + layout.pulses.getPulseRowHeightMicrowave(),
                 layout.pulses.getPulseRowHeightFlux(),
-                layout.pulses.getPulseColorFlux());
+                layout.pulses.getPulseColorFlux(),
+                cycleRange);
 
-            drawLine(image, structure, cycleDuration, linesPerQubit[qubitIndex].readout, qubitIndex,
+            drawLine(image, structure, circuitData.cycleDuration, linesPerQubit[qubitIndex].readout, qubitIndex,
                 yBase + layout.pulses.getPulseRowHeightMicrowave() + layout.pulses.getPulseRowHeightFlux(),
                 layout.pulses.getPulseRowHeightReadout(),
-                layout.pulses.getPulseColorReadout());
+                layout.pulses.getPulseColorReadout(),
+                cycleRange);
         }
 
         // // Visualize the gates as pulses on a microwave, flux and readout line.
@@ -685,7 +737,7 @@ void visualizeCircuit(const ql::quantum_program* program, const VisualizerConfig
 
         // Draw the cycles.
         QL_DOUT("Drawing cycles...");
-        for (Int i = 0; i < circuitData.getAmountOfCycles(); i++) {
+        for (Int i = cycleRange.start; i <= cycleRange.end; i++) {
             // Only draw a cut cycle if its the first in its cut range.
             if (circuitData.isCycleCut(i)) {
                 if (i > 0 && !circuitData.isCycleCut(i - 1)) {
@@ -697,15 +749,84 @@ void visualizeCircuit(const ql::quantum_program* program, const VisualizerConfig
             }
         }
     }
+}
 
-    // Save the image if enabled.
-    if (layout.saveImage) {
-        image.save(generateFilePath("circuit_visualization", "bmp"));
+void drawCircuitTiles(const CircuitLayout &layout,
+                      const CircuitData &circuitData,
+                      const Structure &structure,
+                      const Vec<QubitLines> &linesPerQubit,
+                      const Int maxGateCycles) {
+    QL_DOUT("Drawing circuit tiles...");
+
+    // Divide the image into tiles at cycle boundaries. Together the tiles
+    // cover exactly the image that would otherwise be drawn in one piece: the
+    // first tile also contains the bit line labels, and the last one the right
+    // border. Cycles of a cut range all start at the same position, so a tile
+    // boundary within a cut range would give an empty tile; those are merged
+    // into the next tile.
+    struct Tile {
+        Int firstCycle;
+        Int lastCycle;
+        Int x0;
+        Int x1;
+    };
+    const Int amountOfCycles = circuitData.getAmountOfCycles();
+    Vec<Tile> tiles;
+    Int firstCycle = 0;
+    Int x0 = 0;
+    for (Int i = layout.tiles.getCyclesPerTile(); i < amountOfCycles; i += layout.tiles.getCyclesPerTile()) {
+        const Int x1 = structure.getCellPosition(i, 0, QUANTUM).x0;
+        if (x1 > x0) {
+            tiles.push_back({firstCycle, i - 1, x0, x1});
+            firstCycle = i;
+            x0 = x1;
+        }
     }
+    tiles.push_back({firstCycle, amountOfCycles - 1, x0, structure.getImageWidth()});
 
-    // Display the image.
-    QL_DOUT("Displaying image...");
-    image.display("Quantum Circuit");
+    // Each tile only draws the cycles that can reach into it. Gates can extend
+    // over the cycles following their own, and labels can be wider than their
+    // cycle, hence the margins.
+    const auto drawTile = [&](const UInt tileIndex) {
+        const Tile &tile = tiles[tileIndex];
+        QL_DOUT("Drawing tile " << tileIndex << " with cycles " << tile.firstCycle << " to " << tile.lastCycle << "...");
+
+        RasterImage image(tile.x1 - tile.x0, structure.getImageHeight(), tile.x0);
+        image.fill(255);
+        const EndPoints cycleRange {
+            max<Int>(0, tile.firstCycle - maxGateCycles),
+            min<Int>(amountOfCycles - 1, tile.lastCycle + 1)
+        };
+        drawCircuit(image, layout, circuitData, structure, linesPerQubit, cycleRange);
+        image.save(generateFilePath("circuit_visualization_tile" + to_string(tileIndex), "bmp"));
+    };
+
+    // Draw the tiles in parallel. Each thread renders one tile at a time, so
+    // memory use is bounded by the number of threads and the tile size rather
+    // than by the length of the circuit.
+    UInt amountOfThreads = layout.tiles.getThreads() > 0
+        ? itou(layout.tiles.getThreads())
+        : max<UInt>(1, std::thread::hardware_concurrency());
+    amountOfThreads = min<UInt>(amountOfThreads, tiles.size());
+    std::atomic<UInt> nextTile(0);
+    const auto drawTiles = [&]() {
+        for (UInt tileIndex = nextTile++; tileIndex < tiles.size(); tileIndex = nextTile++) {
+            drawTile(tileIndex);
+        }
+    };
+    Vec<std::future<void>> futures;
+    for (UInt i = 1; i < amountOfThreads; i++) {
+        futures.push_back(std::async(std::launch::async, drawTiles));
+    }
+    drawTiles();
+    for (auto &future : futures) {
+        future.wait();
+    }
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    QL_IOUT("Circuit visualization saved as " << tiles.size() << " tiles.");
 }
 
 CircuitLayout parseCircuitConfiguration(Vec<GateProperties> &gates,
@@ -799,6 +920,18 @@ CircuitLayout parseCircuitConfiguration(Vec<GateProperties> &gates,
         layout.saveImage = visualizerConfig["saveImage"];
     }
 
+    // Check in which format the image should be drawn.
+    if (visualizerConfig.count("imageFormat") == 1) {
+        const Str imageFormat = visualizerConfig["imageFormat"];
+        if (imageFormat == "bmp") {
+            layout.imageFormat = BMP;
+        } else if (imageFormat == "svg") {
+            layout.imageFormat = SVG;
+        } else {
+            QL_WOUT("Unknown image format '" << imageFormat << "'! Defaulting to bmp...");
+        }
+    }
+
     // -------------------------------------- //
     // -               CYCLES               - //
     // -------------------------------------- //
@@ -895,6 +1028,17 @@ CircuitLayout parseCircuitConfiguration(Vec<GateProperties> &gates,
         if (grid.count("borderSize") == 1)  layout.grid.setBorderSize(grid["borderSize"]);
     }
 
+    // -------------------------------------- //
+    // -                TILES               - //
+    // -------------------------------------- //
+    if (circuitConfig.count("tiles") == 1) {
+        Json tiles = circuitConfig["tiles"];
+
+        if (tiles.count("enable") == 1)         layout.tiles.setEnabled(tiles["enable"]);
+        if (tiles.count("cyclesPerTile") == 1)  layout.tiles.setCyclesPerTile(tiles["cyclesPerTile"]);
+        if (tiles.count("threads") == 1)        layout.tiles.setThreads(tiles["threads"]);
+    }
+
     // -------------------------------------- //
     // -       GATE DURATION OUTLINES       - //
     // -------------------------------------- //
@@ -1030,6 +1174,17 @@ void validateCircuitLayout(CircuitLayout &layout) {
         layout.cycles.cutting.setEmptyCycleThreshold(1);
     }
 
+    if (layout.imageFormat == SVG && layout.tiles.areEnabled()) {
+        QL_WOUT("Adjusting 'tiles' to disabled. The size of an SVG image does not depend on its area!");
+        layout.tiles.setEnabled(false);
+    }
+
+    if (layout.tiles.getCyclesPerTile() < 1) {
+        QL_WOUT("Adjusting 'cyclesPerTile' to minimum value of 1. Value in configuration file is set to "
+            << layout.tiles.getCyclesPerTile() << ".");
+        layout.tiles.setCyclesPerTile(1);
+    }
+
     if (layout.pulses.areEnabled()) {
         if (layout.bitLines.classical.isEnabled()) {
             QL_WOUT("Adjusting 'showClassicalLines' to false. Unable to show classical lines when 'displayGatesAsPulses' is true!");
@@ -1332,10 +1487,11 @@ void insertFlatLineSegments(Vec<LineSegment> &existingLineSegments, const Int am
 void drawCycleLabels(Image &image,
                      const CircuitLayout &layout,
                      const CircuitData &circuitData,
-                     const Structure &structure) {
+                     const Structure &structure,
+                     const EndPoints &cycleRange) {
     QL_DOUT("Drawing cycle labels...");
 
-    for (Int i = 0; i < circuitData.getAmountOfCycles(); i++) {
+    for (Int i = cycleRange.start; i <= cycleRange.end; i++) {
         Str cycleLabel = "";
         Int cellWidth = 0;
         if (circuitData.isCycleCut(i)) {
@@ -1368,10 +1524,11 @@ void drawCycleLabels(Image &image,
 void drawCycleEdges(Image &image,
                     const CircuitLayout &layout,
                     const CircuitData &circuitData,
-                    const Structure &structure) {
+                    const Structure &structure,
+                    const EndPoints &cycleRange) {
     QL_DOUT("Drawing cycle edges...");
 
-    for (Int i = 0; i < circuitData.getAmountOfCycles(); i++) {
+    for (Int i = cycleRange.start; i <= cycleRange.end; i++) {
         if (i == 0) continue;
         if (circuitData.isCycleCut(i) && circuitData.isCycleCut(i - 1)) continue;
 
@@ -1560,8 +1717,14 @@ void drawLine(Image &image,
               const Int qubitIndex,
               const Int y,
               const Int maxLineHeight,
-              const Color color) {
+              const Color color,
+              const EndPoints &cycleRange) {
     for (const LineSegment &segment : line.segments) {
+        // Skip the segments outside of the cycle range.
+        if (segment.range.end < cycleRange.start || segment.range.start > cycleRange.end) {
+            continue;
+        }
+
         const Int x0 = structure.getCellPosition(segment.range.start, qubitIndex, QUANTUM).x0;
         const Int x1 = structure.getCellPosition(segment.range.end, qubitIndex, QUANTUM).x1;
         const Int yMiddle = y + maxLineHeight / 2;
@@ -154,8 +154,11 @@ utils::Vec<QubitLines> generateQubitLines(const utils::Vec<GateProperties> &gate
 utils::Real calculateMaxAmplitude(const utils::Vec<LineSegment> &lineSegments);
 void insertFlatLineSegments(utils::Vec<LineSegment> &existingLineSegments, const utils::Int amountOfCycles);
 
-void drawCycleLabels(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
-void drawCycleEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
+void drawCircuit(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const utils::Vec<QubitLines> &linesPerQubit, const EndPoints &cycleRange);
+void drawCircuitTiles(const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const utils::Vec<QubitLines> &linesPerQubit, const utils::Int maxGateCycles);
+
+void drawCycleLabels(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
+void drawCycleEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
 void drawBitLineLabels(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
 void drawBitLineEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
 
@@ -164,7 +167,7 @@ void drawGroupedClassicalBitLine(Image &image, const CircuitLayout &layout, cons
 
 void drawWiggle(Image &image, const utils::Int x0, const utils::Int x1, const utils::Int y, const utils::Int width, const utils::Int height, const Color color);
 
-void drawLine(Image &image, const Structure &structure, const utils::Int cycleDuration, const Line &line, const utils::Int qubitIndex, const utils::Int y, const utils::Int maxLineHeight, const Color color);
+void drawLine(Image &image, const Structure &structure, const utils::Int cycleDuration, const Line &line, const utils::Int qubitIndex, const utils::Int y, const utils::Int maxLineHeight, const Color color, const EndPoints &cycleRange);
 
 void drawCycle(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const Cycle &cycle);
 void drawGate(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const GateProperties &gate, const Structure &structure, const utils::Int chunkOffset);
@@ -0,0 +1,56 @@
+/** \file
+ * Drawing interface shared by the visualizer's image formats.
+ */
+
+#pragma once
+
+#ifdef WITH_VISUALIZER
+
+#include "visualizer_types.h"
+#include "utils/num.h"
+#include "utils/str.h"
+
+namespace ql {
+
+enum class LinePattern : unsigned int {
+    UNBROKEN = 0xFFFFFFFF,
+    DASHED = 0xF0F0F0F0
+};
+
+/**
+ * The drawing primitives used by the visualizer. Coordinates are in pixels,
+ * with the origin at the top left corner; the corners given for rectangles
+ * are both included in the shape. Implemented by RasterImage, which draws
+ * with CImg, and by SvgImage, which writes the shapes to an SVG file.
+ */
+class Image {
+public:
+    virtual ~Image() = default;
+
+    virtual void fill(const utils::Int rgb) = 0;
+
+    virtual void drawLine(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                          const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) = 0;
+
+    virtual void drawText(const utils::Int x, const utils::Int y, const utils::Str &text, const utils::Int height,
+                          const Color color = black) = 0;
+
+    virtual void drawFilledCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
+                                  const Color color = black, const utils::Real alpha = 1) = 0;
+    virtual void drawOutlinedCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
+                                    const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) = 0;
+
+    virtual void drawFilledTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
+                                    const Color color = black, const utils::Real alpha = 1) = 0;
+    virtual void drawOutlinedTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
+                                      const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) = 0;
+
+    virtual void drawFilledRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                                     const Color color = black, const utils::Real alpha = 1) = 0;
+    virtual void drawOutlinedRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                                       const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) = 0;
+};
+
+} // namespace ql
+
+#endif // WITH_VISUALIZER
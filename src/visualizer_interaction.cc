@@ -33,8 +33,15 @@ void visualizeInteractionGraph(const quantum_program* program, const VisualizerC
     InteractionGraphLayout layout = parseInteractionGraphLayout(configuration.visualizerConfigPath);
 
     const Int amountOfQubits = calculateAmountOfBits(gates, &GateProperties::operands);
-    // Prepare the interaction list per qubit.
-    const Vec<Qubit> qubits = findQubitInteractions(gates, amountOfQubits);
+    // Combine the interaction graphs of the kernels, and prepare the interaction list per qubit.
+    // Unlike the cached graphs of the kernels, these count waits and barriers as the visualizer always did.
+    InteractionGraphOptions graphOptions;
+    graphOptions.include_waits = true;
+    InteractionGraph graph(amountOfQubits);
+    for (const quantum_kernel &kernel : program->kernels) {
+        graph.add(InteractionGraph(kernel.c, kernel.qubit_count, graphOptions));
+    }
+    const Vec<Qubit> qubits = findQubitInteractions(graph, amountOfQubits);
 
     // Generate the DOT file if enabled.
     if (layout.isDotFileOutputEnabled()) {
@@ -61,19 +68,15 @@ void visualizeInteractionGraph(const quantum_program* program, const VisualizerC
         QL_DOUT("Initializing image...");
         const Int imageWidth = 2 * (layout.getBorderWidth() + interactionCircleRadius);
         const Int imageHeight = 2 * (layout.getBorderWidth() + interactionCircleRadius);
-        Image image(imageWidth, imageHeight);
+        RasterImage image(imageWidth, imageHeight);
         image.fill(255);
 
-        // Draw the edges between interacting qubits.
-        Vec<Pair<Int, Int>> drawnEdges;
-        // std::vector<std::pair<int, int>> drawnEdges;
+        // Draw the edges between interacting qubits, each from the qubit with the lowest index.
         for (const Pair<Qubit, Position2> &qubit : qubitPositions) {
             const Position2 qubitPosition = qubit.second;
             for (const InteractionsWithQubit &interactionsWithQubit : qubit.first.interactions) {
-                if (isEdgeAlreadyDrawn(drawnEdges, qubit.first.qubitIndex, interactionsWithQubit.qubitIndex))
+                if (interactionsWithQubit.qubitIndex < qubit.first.qubitIndex)
                     continue;
-                
-                drawnEdges.push_back( {qubit.first.qubitIndex, interactionsWithQubit.qubitIndex } );
 
                 // Draw the edge.
                 const Real theta = interactionsWithQubit.qubitIndex * thetaSpacing;
@@ -135,13 +138,10 @@ void generateAndSaveDOTFile(const Vec<Qubit> &qubits) {
         output << "graph qubit_interaction_graph {\n";
         output << "    node [shape=circle];\n";
 
-        Vec<Pair<Int, Int>> drawnEdges;
-        // std::vector<std::pair<int, int>> drawnEdges;
         for (const Qubit &qubit : qubits) {
             for (const InteractionsWithQubit &target : qubit.interactions) {
-                if (isEdgeAlreadyDrawn(drawnEdges, qubit.qubitIndex, target.qubitIndex))
+                if (target.qubitIndex < qubit.qubitIndex)
                     continue;
-                drawnEdges.push_back( {qubit.qubitIndex, target.qubitIndex } );
 
                 output << "    " << qubit.qubitIndex << " -- " << target.qubitIndex << " [label=" << target.amountOfInteractions << "];\n";
             }
@@ -227,47 +227,15 @@ Position2 calculatePositionOnCircle(const Int radius, const Real theta, const Po
     return {x, y};
 }
 
-Vec<Qubit> findQubitInteractions(const Vec<GateProperties> &gates, const Int amountOfQubits) {
-    // Initialize the qubit vector.
+Vec<Qubit> findQubitInteractions(const InteractionGraph &graph, const Int amountOfQubits) {
     Vec<Qubit> qubits(amountOfQubits);
     for (Int qubitIndex = 0; qubitIndex < amountOfQubits; qubitIndex++) {
-        Qubit qubit;
+        Qubit &qubit = qubits[qubitIndex];
         qubit.qubitIndex = qubitIndex;
-        // qubits[qubitIndex] = {qubitIndex, {}};
-        qubits[qubitIndex] = qubit;
-    }
-
-    for (const GateProperties &gate : gates) {
-        const Vec<GateOperand> operands = getGateOperands(gate);
-        if (operands.size() > 1) {
-            // Find the qubits the current gate interacts with.
-            Vec<Int> qubitIndices;
-            for (const GateOperand &operand : operands) {
-                if (operand.bitType == QUANTUM) {
-                    qubitIndices.push_back(operand.index);
-                }
-            }
-
-            // Add the interaction indices to the qubits.
-            for (UInt i = 0; i < qubitIndices.size(); i++) {
-                for (UInt j = 0; j < qubitIndices.size(); j++) {
-                    // Do not add an interaction between a qubit and itself.
-                    if (i != j) {
-                        Vec<InteractionsWithQubit> &interactions = qubits[qubitIndices[i]].interactions;
-                        // Find the existing interaction count with the current qubit if it exists.
-                        Bool found = false;
-                        for (InteractionsWithQubit &interactionsWithQubit : interactions) {
-                            if (interactionsWithQubit.qubitIndex == qubitIndices[j]) {
-                                found = true;
-                                interactionsWithQubit.amountOfInteractions++;
-                            }
-                        }
-                        // If the interaction count does not yet exist, add a new one.
-                        if (!found) {
-                            interactions.push_back( {qubitIndices[j], 1} );
-                        }
-                    }
-                }
+        // The neighbors in the graph are sorted by index and counted already.
+        for (const InteractionGraph::Edge &edge : graph.get_neighbors(qubitIndex)) {
+            if (utoi(edge.qubit) < amountOfQubits) {
+                qubit.interactions.push_back( {utoi(edge.qubit), utoi(edge.count)} );
             }
         }
     }
@@ -275,28 +243,6 @@ Vec<Qubit> findQubitInteractions(const Vec<GateProperties> &gates, const Int amo
     return qubits;
 }
 
-Bool isEdgeAlreadyDrawn(const Vec<Pair<Int, Int>> &drawnEdges, const Int first, const Int second) {
-    // Check if the edge already exists.
-    for (const Pair<Int, Int> &drawnEdge : drawnEdges) {
-        if ((drawnEdge.first == first && drawnEdge.second == second) || (drawnEdge.first == second && drawnEdge.second == first)) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-// bool isEdgeAlreadyDrawn(const std::vector<std::pair<int, int>> &drawnEdges, const int first, const int second) {
-//     // Check if the edge already exists.
-//     for (const std::pair<int, int> &drawnEdge : drawnEdges) {
-//         if ((drawnEdge.first == first && drawnEdge.second == second) || (drawnEdge.first == second && drawnEdge.second == first)) {
-//             return true;
-//         }
-//     }
-
-//     return false;
-// }
-
 void printInteractionList(const Vec<Qubit> &qubits) {
     // Print the qubit interaction list.
     for (const Qubit &qubit : qubits) {
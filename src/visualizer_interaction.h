@@ -8,6 +8,7 @@
 
 #include "visualizer.h"
 #include "visualizer_types.h"
+#include "interaction_graph.h"
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/vec.h"
@@ -35,10 +36,7 @@ InteractionGraphLayout parseInteractionGraphLayout(const utils::Str &configPath)
 
 utils::Real calculateQubitCircleRadius(const utils::Int qubitRadius, const utils::Real theta);
 Position2 calculatePositionOnCircle(const utils::Int radius, utils::Real theta, const Position2 &center);
-utils::Vec<Qubit> findQubitInteractions(const utils::Vec<GateProperties> &gates, const utils::Int amountOfQubits);
-
-// bool isEdgeAlreadyDrawn(const std::vector<std::pair<int, int>> &drawnEdges, const int first, const int second);
-utils::Bool isEdgeAlreadyDrawn(const utils::Vec<utils::Pair<utils::Int, utils::Int>> &drawnEdges, const utils::Int first, const utils::Int second);
+utils::Vec<Qubit> findQubitInteractions(const InteractionGraph &graph, const utils::Int amountOfQubits);
 
 void printInteractionList(const utils::Vec<Qubit> &qubits);
 
@@ -0,0 +1,179 @@
+/** \file
+ * SVG output for the visualizer.
+ */
+
+#ifdef WITH_VISUALIZER
+
+#include "visualizer_svg.h"
+#include "visualizer_types.h"
+#include "visualizer_cimg.h"
+#include "utils/num.h"
+#include "utils/str.h"
+#include "utils/exception.h"
+
+#include <cstdio>
+
+namespace ql {
+
+using namespace utils;
+
+// Shapes are drawn through the centers of the pixels given by the visualizer,
+// as CImg does.
+static Str pixelCenter(const Int coordinate) {
+    const Int twice = 2 * coordinate + 1;
+    return (twice < 0 ? "-" : "") + to_string((twice < 0 ? -twice : twice) / 2) + ".5";
+}
+
+static Str colorToHex(const Color color) {
+    char buffer[8];
+    std::snprintf(buffer, sizeof(buffer), "#%02x%02x%02x", color[0], color[1], color[2]);
+    return buffer;
+}
+
+// Converts the bits of a line pattern, starting at the most significant one,
+// to the lengths of the dashes and gaps that make up the pattern.
+static Str patternToDashArray(const LinePattern pattern) {
+    const unsigned int bits = static_cast<unsigned int>(pattern);
+    Str dashArray;
+    Bool on = true;
+    Int length = 0;
+    for (Int i = 31; i >= 0; i--) {
+        if (((bits >> i) & 1) != (on ? 1u : 0u)) {
+            dashArray += (dashArray.empty() ? "" : " ") + to_string(length);
+            on = !on;
+            length = 0;
+        }
+        length++;
+    }
+    dashArray += (dashArray.empty() ? "" : " ") + to_string(length);
+    return dashArray;
+}
+
+static Str escapeText(const Str &text) {
+    Str escaped;
+    for (const char c : text) {
+        switch (c) {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+SvgImage::SvgImage(const Str &filename, const Int imageWidth, const Int imageHeight) : output(filename) {
+    if (!output.is_open()) {
+        QL_FATAL("Failed to open file '" << filename << "' for the SVG image!");
+    }
+    output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    output << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << imageWidth << "\" height=\"" << imageHeight << "\""
+           << " viewBox=\"0 0 " << imageWidth << " " << imageHeight << "\""
+           << " font-family=\"monospace\" stroke-linecap=\"square\">\n";
+}
+
+SvgImage::~SvgImage() {
+    finish();
+}
+
+void SvgImage::finish() {
+    if (output.is_open()) {
+        output << "</svg>\n";
+        output.close();
+    }
+}
+
+void SvgImage::writeStroke(const Color color, const Real alpha, const LinePattern pattern) {
+    output << " fill=\"none\" stroke=\"" << colorToHex(color) << "\"";
+    if (alpha < 1) {
+        output << " stroke-opacity=\"" << alpha << "\"";
+    }
+    if (pattern != LinePattern::UNBROKEN) {
+        output << " stroke-dasharray=\"" << patternToDashArray(pattern) << "\" stroke-linecap=\"butt\"";
+    }
+}
+
+void SvgImage::writeFill(const Color color, const Real alpha) {
+    output << " fill=\"" << colorToHex(color) << "\"";
+    if (alpha < 1) {
+        output << " fill-opacity=\"" << alpha << "\"";
+    }
+}
+
+void SvgImage::fill(const Int rgb) {
+    const Byte value = (Byte) rgb;
+    output << "<rect width=\"100%\" height=\"100%\"";
+    writeFill({{ value, value, value }}, 1);
+    output << "/>\n";
+}
+
+void SvgImage::drawLine(const Int x0, const Int y0, const Int x1, const Int y1, const Color color, const Real alpha, const LinePattern pattern) {
+    output << "<line x1=\"" << pixelCenter(x0) << "\" y1=\"" << pixelCenter(y0)
+           << "\" x2=\"" << pixelCenter(x1) << "\" y2=\"" << pixelCenter(y1) << "\"";
+    writeStroke(color, alpha, pattern);
+    output << "/>\n";
+}
+
+void SvgImage::drawText(const Int x, const Int y, const Str &text, const Int height, const Color color) {
+    if (text.empty()) {
+        return;
+    }
+    const Dimensions dimensions = calculateTextDimensions(text, height);
+    output << "<text x=\"" << x << "\" y=\"" << y << "\" font-size=\"" << height << "\""
+           << " textLength=\"" << dimensions.width << "\" lengthAdjust=\"spacingAndGlyphs\" dominant-baseline=\"hanging\"";
+    writeFill(color, 1);
+    output << ">" << escapeText(text) << "</text>\n";
+}
+
+void SvgImage::drawFilledCircle(const Int centerX, const Int centerY, const Int radius,
+                                const Color color, const Real alpha) {
+    output << "<circle cx=\"" << pixelCenter(centerX) << "\" cy=\"" << pixelCenter(centerY) << "\" r=\"" << pixelCenter(radius) << "\"";
+    writeFill(color, alpha);
+    output << "/>\n";
+}
+
+void SvgImage::drawOutlinedCircle(const Int centerX, const Int centerY, const Int radius,
+                                  const Color color, const Real alpha, const LinePattern pattern) {
+    output << "<circle cx=\"" << pixelCenter(centerX) << "\" cy=\"" << pixelCenter(centerY) << "\" r=\"" << radius << "\"";
+    writeStroke(color, alpha, pattern);
+    output << "/>\n";
+}
+
+void SvgImage::drawFilledTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
+                                  const Color color, const Real alpha) {
+    output << "<polygon points=\"" << pixelCenter(x0) << "," << pixelCenter(y0) << " " << pixelCenter(x1) << "," << pixelCenter(y1)
+           << " " << pixelCenter(x2) << "," << pixelCenter(y2) << "\"";
+    writeFill(color, alpha);
+    output << "/>\n";
+}
+
+void SvgImage::drawOutlinedTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
+                                    const Color color, const Real alpha, const LinePattern pattern) {
+    output << "<polygon points=\"" << pixelCenter(x0) << "," << pixelCenter(y0) << " " << pixelCenter(x1) << "," << pixelCenter(y1)
+           << " " << pixelCenter(x2) << "," << pixelCenter(y2) << "\"";
+    writeStroke(color, alpha, pattern);
+    output << "/>\n";
+}
+
+void SvgImage::drawFilledRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
+                                   const Color color, const Real alpha) {
+    // Both corners are part of the rectangle, so it covers one pixel more
+    // than the difference between them.
+    output << "<rect x=\"" << min(x0, x1) << "\" y=\"" << min(y0, y1)
+           << "\" width=\"" << max(x0, x1) - min(x0, x1) + 1 << "\" height=\"" << max(y0, y1) - min(y0, y1) + 1 << "\"";
+    writeFill(color, alpha);
+    output << "/>\n";
+}
+
+void SvgImage::drawOutlinedRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
+                                     const Color color, const Real alpha, const LinePattern pattern) {
+    output << "<rect x=\"" << pixelCenter(min(x0, x1)) << "\" y=\"" << pixelCenter(min(y0, y1))
+           << "\" width=\"" << max(x0, x1) - min(x0, x1) << "\" height=\"" << max(y0, y1) - min(y0, y1) << "\"";
+    writeStroke(color, alpha, pattern);
+    output << "/>\n";
+}
+
+} // namespace ql
+
+#endif // WITH_VISUALIZER
@@ -0,0 +1,64 @@
+/** \file
+ * SVG output for the visualizer.
+ */
+
+#pragma once
+
+#ifdef WITH_VISUALIZER
+
+#include "visualizer_types.h"
+#include "visualizer_image.h"
+#include "utils/num.h"
+#include "utils/str.h"
+
+#include <fstream>
+
+namespace ql {
+
+/**
+ * Image that writes each shape to an SVG file as soon as it is drawn, so
+ * drawing takes time and space in proportion to the number of shapes rather
+ * than to the size of the image. Text is stretched to the width it has in the
+ * raster images, so the layout of both is the same. The file is complete once
+ * finish() has been called, or the image has been destroyed.
+ */
+class SvgImage : public Image {
+private:
+    std::ofstream output;
+
+    void writeStroke(const Color color, const utils::Real alpha, const LinePattern pattern);
+    void writeFill(const Color color, const utils::Real alpha);
+
+public:
+    SvgImage(const utils::Str &filename, const utils::Int imageWidth, const utils::Int imageHeight);
+    ~SvgImage() override;
+
+    void fill(const utils::Int rgb) override;
+
+    void drawLine(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                  const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
+
+    void drawText(const utils::Int x, const utils::Int y, const utils::Str &text, const utils::Int height,
+                  const Color color = black) override;
+
+    void drawFilledCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
+                          const Color color = black, const utils::Real alpha = 1) override;
+    void drawOutlinedCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
+                            const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
+
+    void drawFilledTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
+                            const Color color = black, const utils::Real alpha = 1) override;
+    void drawOutlinedTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
+                              const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
+
+    void drawFilledRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                             const Color color = black, const utils::Real alpha = 1) override;
+    void drawOutlinedRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                               const Color color = black, const utils::Real alpha = 1, const LinePattern pattern = LinePattern::UNBROKEN) override;
+
+    void finish();
+};
+
+} // namespace ql
+
+#endif // WITH_VISUALIZER
@@ -327,6 +327,22 @@ public:
     void setBorderSize(const utils::Int argument) { assertPositive(argument, "grid.borderSize"); borderSize = argument; }
 };
 
+struct Tiles {
+private:
+    utils::Bool enabled = false;
+    utils::Int cyclesPerTile = 256;
+    utils::Int threads = 0;
+
+public:
+    utils::Bool areEnabled() const { return enabled; }
+    utils::Int getCyclesPerTile() const { return cyclesPerTile; }
+    utils::Int getThreads() const { return threads; }
+
+    void setEnabled(const utils::Bool argument) { enabled = argument; }
+    void setCyclesPerTile(const utils::Int argument) { assertPositive(argument, "tiles.cyclesPerTile"); cyclesPerTile = argument; }
+    void setThreads(const utils::Int argument) { assertPositive(argument, "tiles.threads"); threads = argument; }
+};
+
 struct GateDurationOutlines {
 private:
     utils::Bool enabled = true;
@@ -401,12 +417,16 @@ public:
 // -                CIRCUIT LAYOUT               - //
 // ----------------------------------------------- //
 
+enum ImageFormat {BMP, SVG};
+
 struct CircuitLayout {
     utils::Bool saveImage = false;
+    ImageFormat imageFormat = BMP;
 
     Cycles cycles;
     BitLines bitLines;
     Grid grid;
+    Tiles tiles;
     GateDurationOutlines gateDurationOutlines;
     Measurements measurements;
     Pulses pulses;
@@ -0,0 +1,529 @@
+/** \file
+ * Benchmarks of the stages of the compiler pipeline on synthetic circuits.
+ *
+ * Each benchmark builds its input (untimed), then times a single stage:
+ * kernel construction, dependency graph construction, resource-constrained
+ * ASAP/ALAP scheduling, mapping with each heuristic, the Clifford and rotation
+ * optimizers, unitary decomposition, CC-light QISA generation and the CC
+ * backend. Inputs are random (or, for QISA generation, layered) circuits of the
+ * given number of gates on the test platforms, generated with a fixed seed, so
+ * runs are comparable.
+ *
+ * usage: openql_bench [--quick] [--filter <substring>] [--min-time <seconds>]
+ *                     [--output <file.json>] [--tests-dir <dir>] [--output-dir <dir>]
+ *
+ * The results are printed as a table and, with --output, written as JSON:
+ *
+ *     {
+ *         "openql_version": "<version>",
+ *         "min_time": <seconds>,
+ *         "benchmarks": [
+ *             {
+ *                 "name": "<stage>", "platform": "<platform>", "size": <gates or qubits>,
+ *                 "iterations": <count>,
+ *                 "time_min": <seconds>, "time_median": <seconds>, "time_mean": <seconds>,
+ *                 "items_per_second": <gates per second, based on the median>
+ *             },
+ *             ...
+ *         ]
+ *     }
+ *
+ * --quick runs every benchmark once on the smallest input; the test suite uses
+ * it to check that the benchmarks still work. --output-dir sets the directory
+ * for the files the compiler writes, instead of the one chosen at build time.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "openql.h"
+#include "version.h"
+#include "utils/json.h"
+#include "scheduler.h"
+#include "resource_manager.h"
+#include "mapper.h"
+#include "clifford.h"
+#include "unitary.h"
+#include "arch/cc_light/cc_light_eqasm_compiler.h"
+#include "arch/cc/eqasm_backend_cc.h"
+
+using namespace ql;
+using namespace ql::utils;
+
+#ifndef OPENQL_BENCH_TESTS_DIR
+#define OPENQL_BENCH_TESTS_DIR "."
+#endif
+
+#ifndef OPENQL_BENCH_OUTPUT_DIR
+#define OPENQL_BENCH_OUTPUT_DIR "bench_output"
+#endif
+
+namespace {
+
+/**
+ * One run of a benchmark. The benchmark function brackets the code to be
+ * timed with start() and stop(), and sets the number of items (gates) it
+ * processed.
+ */
+class Iteration {
+public:
+    UInt items = 0;
+
+    void start() {
+        t_start = std::chrono::steady_clock::now();
+    }
+
+    void stop() {
+        elapsed += std::chrono::duration<Real>(std::chrono::steady_clock::now() - t_start).count();
+    }
+
+    Real get_elapsed() const {
+        return elapsed;
+    }
+
+private:
+    std::chrono::steady_clock::time_point t_start;
+    Real elapsed = 0.0;
+};
+
+struct benchmark_t {
+    Str name;
+    Str platform;
+    UInt size;
+    std::function<void(Iteration&)> run;
+};
+
+/**
+ * A test platform with the information needed to generate circuits for it.
+ * When pairs is not empty, nearest-neighbour two-qubit gates only use these
+ * qubit pairs instead of all edges.
+ */
+struct bench_platform_t {
+    Str name;
+    Str config_file;
+    Vec<Str> single_qubit_gates;
+    Str two_qubit_gate;
+    Vec<Pair<UInt, UInt>> pairs;
+};
+
+// the platform configuration files are read from tests_dir; the files that
+// the compiler writes go to output_dir, outside of the source tree
+Str tests_dir = OPENQL_BENCH_TESTS_DIR;
+Str output_dir = OPENQL_BENCH_OUTPUT_DIR;
+
+/**
+ * Platforms are expensive to load, so each is loaded once.
+ */
+const quantum_platform &get_platform(const bench_platform_t &bp) {
+    static Map<Str, std::shared_ptr<quantum_platform>> platforms;
+    auto it = platforms.find(bp.name);
+    if (it != platforms.end()) {
+        return *it->second;
+    }
+    auto platform = std::make_shared<quantum_platform>(bp.name, tests_dir + "/" + bp.config_file);
+    platforms.set(bp.name) = platform;
+    return *platform;
+}
+
+/**
+ * Returns the qubit pairs of the edges of the platform's topology that are
+ * within range of its qubits, or all pairs when the topology doesn't list
+ * edges.
+ */
+Vec<Pair<UInt, UInt>> get_qubit_pairs(const quantum_platform &platform) {
+    Vec<Pair<UInt, UInt>> pairs;
+    if (platform.topology.count("edges") && !platform.topology["edges"].empty()) {
+        for (const auto &edge : platform.topology["edges"]) {
+            UInt src = edge["src"];
+            UInt dst = edge["dst"];
+            if (src < platform.qubit_number && dst < platform.qubit_number) {
+                pairs.emplace_back(src, dst);
+            }
+        }
+    } else {
+        for (UInt i = 0; i < platform.qubit_number; i++) {
+            for (UInt j = 0; j < platform.qubit_number; j++) {
+                if (i != j) {
+                    pairs.emplace_back(i, j);
+                }
+            }
+        }
+    }
+    return pairs;
+}
+
+/**
+ * Adds the given number of random gates to the kernel, about a third of them
+ * two-qubit gates, on platform edges only when nearest_neighbour is set.
+ */
+void add_random_gates(
+    quantum_kernel &kernel,
+    const bench_platform_t &bp,
+    const quantum_platform &platform,
+    UInt gates,
+    Bool nearest_neighbour,
+    UInt seed
+) {
+    std::mt19937_64 rng(seed);
+    UInt nq = platform.qubit_number;
+    Vec<Pair<UInt, UInt>> pairs;
+    if (nearest_neighbour) {
+        pairs = bp.pairs.empty() ? get_qubit_pairs(platform) : bp.pairs;
+    }
+    for (UInt i = 0; i < gates; i++) {
+        if (rng() % 3 == 0) {
+            UInt q0, q1;
+            if (nearest_neighbour) {
+                const auto &pair = pairs[rng() % pairs.size()];
+                q0 = pair.first;
+                q1 = pair.second;
+            } else {
+                q0 = rng() % nq;
+                q1 = (q0 + 1 + rng() % (nq - 1)) % nq;
+            }
+            kernel.gate(bp.two_qubit_gate, q0, q1);
+        } else {
+            kernel.gate(bp.single_qubit_gates[rng() % bp.single_qubit_gates.size()], rng() % nq);
+        }
+    }
+}
+
+/**
+ * Adds about the given number of gates to the kernel in layers: a layer
+ * applies the same single-qubit gate to all qubits, and every third layer is
+ * followed by two-qubit gates on a fixed set of disjoint edges. Unlike random
+ * circuits, these need few CC-light mask registers.
+ */
+void add_layered_gates(
+    quantum_kernel &kernel,
+    const bench_platform_t &bp,
+    const quantum_platform &platform,
+    UInt gates
+) {
+    Vec<Pair<UInt, UInt>> matching;
+    Vec<Bool> used(platform.qubit_number, false);
+    for (const auto &pair : bp.pairs.empty() ? get_qubit_pairs(platform) : bp.pairs) {
+        if (!used[pair.first] && !used[pair.second]) {
+            used[pair.first] = used[pair.second] = true;
+            matching.push_back(pair);
+        }
+    }
+    UInt added = 0;
+    for (UInt layer = 0; added < gates; layer++) {
+        const Str &name = bp.single_qubit_gates[layer % bp.single_qubit_gates.size()];
+        for (UInt q = 0; q < platform.qubit_number && added < gates; q++, added++) {
+            kernel.gate(name, q);
+        }
+        if (layer % 3 == 2) {
+            for (UInt i = 0; i < matching.size() && added < gates; i++, added++) {
+                kernel.gate(bp.two_qubit_gate, matching[i].first, matching[i].second);
+            }
+        }
+    }
+}
+
+/**
+ * Returns a random unitary matrix on the given number of qubits, in row-major
+ * order, by Gram-Schmidt orthonormalization of random complex vectors.
+ */
+Vec<Complex> random_unitary(UInt num_qubits, UInt seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<Real> normal;
+    UInt n = 1ull << num_qubits;
+    Vec<Vec<Complex>> rows(n, Vec<Complex>(n));
+    for (UInt i = 0; i < n; i++) {
+        for (UInt j = 0; j < n; j++) {
+            rows[i][j] = Complex(normal(rng), normal(rng));
+        }
+        for (UInt k = 0; k < i; k++) {
+            Complex dot = 0;
+            for (UInt j = 0; j < n; j++) {
+                dot += std::conj(rows[k][j]) * rows[i][j];
+            }
+            for (UInt j = 0; j < n; j++) {
+                rows[i][j] -= dot * rows[k][j];
+            }
+        }
+        Real norm = 0;
+        for (UInt j = 0; j < n; j++) {
+            norm += std::norm(rows[i][j]);
+        }
+        for (UInt j = 0; j < n; j++) {
+            rows[i][j] /= std::sqrt(norm);
+        }
+    }
+    Vec<Complex> matrix;
+    for (const auto &row : rows) {
+        matrix.insert(matrix.end(), row.begin(), row.end());
+    }
+    return matrix;
+}
+
+const bench_platform_t S17 = {"s17", "test_mapper_s17.json", {"x", "y", "h", "t", "x90", "ym90"}, "cz", {}};
+const bench_platform_t MC4X4 = {"mc4x4full", "test_multi_core_4x4_full.json", {"x", "y", "h", "t", "x90", "ym90"}, "cnot", {}};
+
+// CC-light QISA has mask registers for at most 7 qubits
+const bench_platform_t CCL7 = {"ccl7", "hardware_config_cc_light.json", {"x", "y", "rx90", "ym90"}, "cz", {}};
+
+// the CC backend schedules without resource constraints, so flux pulses of cz
+// gates on pairs sharing a flux instrument could overlap; a single pair avoids
+// that
+const bench_platform_t CC17 = {"cc17", "cc/test_cfg_cc.json", {"x", "y", "x90", "y90"}, "cz", {{6, 7}}};
+
+/**
+ * Resets the options to what the benchmarks expect.
+ */
+void set_default_options() {
+    options::reset_options();
+    options::set("log_level", "LOG_NOTHING");
+    options::set("output_dir", output_dir);
+    options::set("write_qasm_files", "no");
+    options::set("write_report_files", "no");
+    options::set("unitary_decomposition_cache", "no");
+}
+
+/**
+ * Builds the list of all benchmarks.
+ */
+Vec<benchmark_t> make_benchmarks(Bool quick) {
+    Vec<UInt> sizes = quick ? Vec<UInt>{100} : Vec<UInt>{100, 1000, 10000};
+    Vec<UInt> map_sizes = quick ? Vec<UInt>{100} : Vec<UInt>{100, 1000};
+    Vec<UInt> unitary_sizes = quick ? Vec<UInt>{2} : Vec<UInt>{2, 3, 4, 5};
+    Vec<benchmark_t> benchmarks;
+
+    for (const auto *bp : {&S17, &MC4X4}) {
+        for (auto size : sizes) {
+            benchmarks.push_back({"kernel_construction", bp->name, size, [bp, size](Iteration &it) {
+                const auto &platform = get_platform(*bp);
+                it.start();
+                quantum_kernel k("k", platform, platform.qubit_number);
+                add_random_gates(k, *bp, platform, size, true, size);
+                it.stop();
+                it.items = size;
+            }});
+        }
+    }
+
+    for (auto size : sizes) {
+        benchmarks.push_back({"scheduler_init", S17.name, size, [size](Iteration &it) {
+            const auto &platform = get_platform(S17);
+            quantum_kernel k("k", platform, platform.qubit_number);
+            add_random_gates(k, S17, platform, size, true, size);
+            it.start();
+            Scheduler sched;
+            sched.init(k.c, platform, platform.qubit_number, 0, 0);
+            it.stop();
+            it.items = size;
+        }});
+        for (auto dir : {forward_scheduling, backward_scheduling}) {
+            Str name = dir == forward_scheduling ? "rc_schedule_asap" : "rc_schedule_alap";
+            benchmarks.push_back({name, S17.name, size, [size, dir](Iteration &it) {
+                const auto &platform = get_platform(S17);
+                quantum_kernel k("k", platform, platform.qubit_number);
+                add_random_gates(k, S17, platform, size, true, size);
+                Scheduler sched;
+                sched.init(k.c, platform, platform.qubit_number, 0, 0);
+                arch::resource_manager_t rm(platform, dir);
+                Str dot;
+                it.start();
+                if (dir == forward_scheduling) {
+                    sched.schedule_asap(rm, platform, dot);
+                } else {
+                    sched.schedule_alap(rm, platform, dot);
+                }
+                it.stop();
+                it.items = size;
+            }});
+        }
+    }
+
+    for (const auto *bp : {&S17, &MC4X4}) {
+        for (Str heuristic : {"base", "baserc", "minextend", "minextendrc", "maxfidelity"}) {
+            for (auto size : map_sizes) {
+                benchmarks.push_back({"map_" + heuristic, bp->name, size, [bp, heuristic, size](Iteration &it) {
+                    const auto &platform = get_platform(*bp);
+                    options::set("mapper", heuristic);
+                    quantum_kernel k("k", platform, platform.qubit_number);
+                    add_random_gates(k, *bp, platform, size, false, size);
+                    mapper::Mapper mapper;
+                    mapper.Init(&platform);
+                    it.start();
+                    mapper.Map(k);
+                    it.stop();
+                    it.items = size;
+                    options::set("mapper", "no");
+                }});
+            }
+        }
+    }
+
+    for (auto size : sizes) {
+        benchmarks.push_back({"clifford_optimize", S17.name, size, [size](Iteration &it) {
+            const auto &platform = get_platform(S17);
+            options::set("clifford_prescheduler", "yes");
+            quantum_program p("bench_clifford", platform, platform.qubit_number);
+            quantum_kernel k("k", platform, platform.qubit_number);
+            add_random_gates(k, S17, platform, size, true, size);
+            p.add(k);
+            it.start();
+            clifford_optimize(&p, platform, "clifford_prescheduler");
+            it.stop();
+            it.items = size;
+            options::set("clifford_prescheduler", "no");
+        }});
+        benchmarks.push_back({"rotation_optimize", S17.name, size, [size](Iteration &it) {
+            const auto &platform = get_platform(S17);
+            options::set("optimize", "yes");
+            quantum_program p("bench_rotation", platform, platform.qubit_number);
+            quantum_kernel k("k", platform, platform.qubit_number);
+            add_random_gates(k, S17, platform, size, true, size);
+            p.add(k);
+            it.start();
+            rotation_optimize(&p, platform, "rotation_optimize");
+            it.stop();
+            it.items = size;
+            options::set("optimize", "no");
+        }});
+    }
+
+    if (unitary::is_decompose_support_enabled()) {
+        for (auto num_qubits : unitary_sizes) {
+            benchmarks.push_back({"unitary_decomposition", "none", num_qubits, [num_qubits](Iteration &it) {
+                unitary u("u", random_unitary(num_qubits, num_qubits));
+                it.start();
+                u.decompose();
+                it.stop();
+                it.items = 1;
+            }});
+        }
+    }
+
+    for (auto size : sizes) {
+        benchmarks.push_back({"ir2qisa", CCL7.name, size, [size](Iteration &it) {
+            const auto &platform = get_platform(CCL7);
+            quantum_kernel k("k", platform, platform.qubit_number);
+            add_layered_gates(k, CCL7, platform, size);
+            Str dot;
+            rcschedule_kernel(k, platform, dot, platform.qubit_number, 0, 0);
+            k.cycles_valid = true;
+            arch::MaskManager mask_manager;
+            it.start();
+            Str qisa = arch::ir2qisa(k, platform, mask_manager);
+            it.stop();
+            it.items = size;
+        }});
+        benchmarks.push_back({"cc_backend_compile", CC17.name, size, [size](Iteration &it) {
+            const auto &platform = get_platform(CC17);
+            quantum_program p("bench_cc", platform, platform.qubit_number);
+            quantum_kernel k("k", platform, platform.qubit_number);
+            add_random_gates(k, CC17, platform, size, true, size);
+            p.add(k);
+            eqasm_backend_cc backend;
+            it.start();
+            backend.compile(&p, platform);
+            it.stop();
+            it.items = size;
+        }});
+    }
+
+    return benchmarks;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    Bool quick = false;
+    Str filter;
+    Real min_time = 0.5;
+    Str output_file;
+    for (int i = 1; i < argc; i++) {
+        Str arg = argv[i];
+        if (arg == "--quick") {
+            quick = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = parse_real(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_file = argv[++i];
+        } else if (arg == "--tests-dir" && i + 1 < argc) {
+            tests_dir = argv[++i];
+        } else if (arg == "--output-dir" && i + 1 < argc) {
+            output_dir = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--filter <substring>] [--min-time <seconds>]"
+                      << " [--output <file.json>] [--tests-dir <dir>] [--output-dir <dir>]" << std::endl;
+            return 1;
+        }
+    }
+
+    Json results = Json::object();
+    results["openql_version"] = OPENQL_VERSION_STRING;
+    results["min_time"] = quick ? 0.0 : min_time;
+    results["benchmarks"] = Json::array();
+
+    std::cout << std::left << std::setw(24) << "benchmark" << std::setw(12) << "platform"
+              << std::right << std::setw(8) << "size" << std::setw(8) << "iters"
+              << std::setw(14) << "median [s]" << std::setw(14) << "items/s" << std::endl;
+
+    try {
+        for (const auto &b : make_benchmarks(quick)) {
+            Str full_name = b.name + "/" + b.platform + "/" + to_string(b.size);
+            if (full_name.find(filter) == Str::npos) {
+                continue;
+            }
+
+            // run until min_time has been spent in the timed code, at least
+            // once and at most 1000 times
+            Vec<Real> times;
+            Real total = 0.0;
+            UInt items = 0;
+            do {
+                set_default_options();
+                Iteration it;
+                b.run(it);
+                times.push_back(it.get_elapsed());
+                total += it.get_elapsed();
+                items = it.items;
+            } while (!quick && total < min_time && times.size() < 1000);
+
+            std::sort(times.begin(), times.end());
+            Real median = times[times.size() / 2];
+            Real items_per_second = median > 0 ? items / median : 0.0;
+
+            Json entry = Json::object();
+            entry["name"] = b.name;
+            entry["platform"] = b.platform;
+            entry["size"] = b.size;
+            entry["iterations"] = times.size();
+            entry["time_min"] = times.front();
+            entry["time_median"] = median;
+            entry["time_mean"] = total / times.size();
+            entry["items_per_second"] = items_per_second;
+            results["benchmarks"].push_back(entry);
+
+            std::cout << std::left << std::setw(24) << b.name << std::setw(12) << b.platform
+                      << std::right << std::setw(8) << b.size << std::setw(8) << times.size()
+                      << std::setw(14) << median << std::setw(14) << (UInt)items_per_second << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!output_file.empty()) {
+        std::ofstream ofs(output_file);
+        ofs << results.dump(4) << std::endl;
+        if (ofs.fail()) {
+            std::cerr << "failed to write " << output_file << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
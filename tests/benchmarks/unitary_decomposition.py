@@ -0,0 +1,91 @@
+# benchmark for unitary decomposition
+#
+# decomposes random unitaries of 1 to 5 qubits, of the kind used in test_unitary.py,
+# repeatedly, as variational workflows do, with and without the decomposition cache,
+# and compiles programs that apply them;
+# then decomposes single larger unitaries sequentially and in parallel
+#
+# usage: python unitary_decomposition.py [repetitions [max_qubits]]
+
+from openql import openql as ql
+import numpy as np
+import os
+import sys
+import timeit
+
+curdir = os.path.dirname(os.path.realpath(__file__))
+config_fn = os.path.join(curdir, '..', 'test_cfg_none_simple.json')
+output_dir = os.path.join(curdir, '..', 'test_output')
+
+
+def random_unitary(num_qubits, rng):
+    # QR decomposition of a complex Gaussian matrix, with the phases of R's diagonal
+    # divided out to make the distribution uniform (Haar)
+    n = 2 ** num_qubits
+    z = (rng.standard_normal((n, n)) + 1j * rng.standard_normal((n, n))) / np.sqrt(2)
+    q, r = np.linalg.qr(z)
+    d = np.diagonal(r)
+    return q * (d / np.abs(d))
+
+
+def decompose_all(matrices, repetitions):
+    for _ in range(repetitions):
+        for name, matrix in matrices:
+            u = ql.Unitary(name, matrix)
+            u.decompose()
+
+
+def compile_all(platform, matrices, repetitions):
+    for r in range(repetitions):
+        for name, matrix in matrices:
+            num_qubits = int(np.log2(np.sqrt(len(matrix))))
+            p = ql.Program('bench_unitary', platform, num_qubits)
+            k = ql.Kernel('akernel', platform, num_qubits)
+            u = ql.Unitary(name, matrix)
+            u.decompose()
+            k.gate(u, list(range(num_qubits)))
+            p.add_kernel(k)
+            p.compile()
+
+
+def main():
+    repetitions = int(sys.argv[1]) if len(sys.argv) > 1 else 20
+    max_qubits = int(sys.argv[2]) if len(sys.argv) > 2 else 7
+
+    ql.initialize()
+    ql.set_option('output_dir', output_dir)
+    ql.set_option('optimize', 'no')
+    ql.set_option('scheduler', 'ASAP')
+    ql.set_option('log_level', 'LOG_NOTHING')
+    ql.set_option('write_qasm_files', 'no')
+    platform = ql.Platform('platform_none', config_fn)
+
+    rng = np.random.default_rng(42)
+    for num_qubits in range(1, 6):
+        matrices = [
+            ('u%d_%d' % (num_qubits, i), random_unitary(num_qubits, rng).flatten().tolist())
+            for i in range(3)
+        ]
+        for cache in ('no', 'yes'):
+            ql.set_option('unitary_decomposition_cache', cache)
+            t_decompose = timeit.timeit(lambda: decompose_all(matrices, repetitions), number=1)
+            t_compile = timeit.timeit(lambda: compile_all(platform, matrices, max(1, repetitions // 10)), number=1)
+            print('%d qubits, cache=%-3s: %8.2f ms per decomposition, %8.2f ms per compiled program' % (
+                num_qubits,
+                cache,
+                1000 * t_decompose / (repetitions * len(matrices)),
+                1000 * t_compile / (max(1, repetitions // 10) * len(matrices))
+            ))
+
+    ql.set_option('unitary_decomposition_cache', 'no')
+    for num_qubits in range(4, max_qubits + 1):
+        matrices = [('u%d' % num_qubits, random_unitary(num_qubits, rng).flatten().tolist())]
+        for parallel in ('no', 'yes'):
+            ql.set_option('unitary_decomposition_parallel', parallel)
+            t_decompose = timeit.timeit(lambda: decompose_all(matrices, 1), number=1)
+            print('%d qubits, parallel=%-3s: %8.2f ms per decomposition' % (
+                num_qubits, parallel, 1000 * t_decompose))
+
+
+if __name__ == '__main__':
+    main()
@@ -207,6 +207,56 @@ class Test_central_controller(unittest.TestCase):
         p.compile()
 
 
+    def test_loop_compaction(self):
+        ql.set_option('backend_cc_loop_compaction', 'yes')
+        ql.set_option('log_level', 'LOG_WARNING')
+
+        platform = ql.Platform(platform_name, config_fn)
+
+        p = ql.Program('test_loop_compaction', platform, num_qubits, num_cregs)
+        k = ql.Kernel('kernel_0', platform, num_qubits, num_cregs)
+
+        for _ in range(20):
+            k.gate("x", [6])
+            k.gate("cz", [6, 7])
+        k.gate("measure", [6])
+        k.gate("measure", [7])
+
+        p.add_kernel(k)
+        p.compile()
+
+        ql.set_option('backend_cc_loop_compaction', 'no')
+
+        with open(os.path.join(output_dir, 'test_loop_compaction.vq1asm')) as f:
+            text = f.read()
+        lines = [l.split('#')[0].split() for l in text.splitlines()]
+
+        # one loop, whose counter is loaded with the number of iterations of the x/cz pair
+        counter = [l for l in lines if l[-2:-1] == ['move'] and l[-1].endswith(',R61')]
+        self.assertEqual(len(counter), 1)
+        self.assertEqual(counter[0][-1], '20,R61')
+        labels = [i for i, l in enumerate(lines) if l == ['__repeat_0:']]
+        loops = [i for i, l in enumerate(lines) if l == ['loop', 'R61,@__repeat_0']]
+        self.assertEqual(len(labels), 1)
+        self.assertEqual(len(loops), 1)
+        self.assertLess(labels[0], loops[0])
+
+        # the body (the x and cz code words) is emitted exactly once, inside the loop
+        code_words = [
+            (i, l[-1]) for i, l in enumerate(lines)
+            if l[-2:-1] == ['seq_out'] and not l[-1].startswith('0x00000000,')
+        ]
+        body = [cw for i, cw in code_words if labels[0] < i < loops[0]]
+        self.assertEqual(len(body), 3)     # x on 'mw_0' and 'vsm_0', cz on 'flux_0'
+        for cw in body:
+            self.assertEqual([c for _, c in code_words].count(cw), 1)
+
+        # the code after the loop resumes at cycle 1 + 20 iterations * 3 cycles
+        self.assertIn('# REPEAT_START(20): cycle 1-4 per iteration', text)
+        after = text[text.index('# REPEAT_END'):]
+        self.assertRegex(after, r'^# REPEAT_END\s*## Bundle \d+: start_cycle=61,')
+        self.assertIn('0x00000000,61           # cycle 0-61: padding on \'ro_0\'', after)
+
 
     # FIXME: add:
     # - qec_pipelined
@@ -138,6 +138,56 @@ class Test_kernel(unittest.TestCase):
         # compile the program
         p.compile()
 
+    def test_take_kernel(self):
+        nqubits = 3
+
+        p = ql.Program("take_kernel", platf, nqubits)
+        k1 = ql.Kernel("aKernel1", platf, nqubits)
+        k2 = ql.Kernel("aKernel2", platf, nqubits)
+        k3 = ql.Kernel("aKernel1", platf, nqubits)
+
+        k1.gate('x', [0])
+        k2.gate('x', [1])
+        k3.gate('y', [2])
+
+        # move the kernels into the program instead of copying them
+        p.add_kernel(k1, True)
+        p.add_for(k2, 10, True)
+        self.assertEqual(k1.get_gate_count(), 0)
+        self.assertEqual(k2.get_gate_count(), 0)
+
+        # a moved kernel still reserves its name
+        with self.assertRaises(RuntimeError):
+            p.add_kernel(k3, True)
+
+        # the moved-from kernel is empty but can still be used
+        k1.gate('z', [2])
+        self.assertEqual(k1.get_gate_count(), 1)
+
+        # compile the program
+        p.compile()
+
+        # check the kernels and their gates in the initial qasm file
+        kernels = []
+        with open(os.path.join(output_dir, p.name + '.qasm')) as f:
+            for line in f:
+                line = line.strip()
+                if line.startswith('.'):
+                    kernels.append((line[1:], []))
+                elif kernels and line:
+                    kernels[-1][1].append(line)
+        names = [name for name, _ in kernels]
+        self.assertEqual(len(names), 4)
+        self.assertEqual(names[0], 'aKernel1')
+        self.assertRegex(names[1], r'^aKernel2_for\d+_start$')
+        self.assertEqual(names[2], 'aKernel2')
+        self.assertRegex(names[3], r'^aKernel2_for\d+_end$')
+        self.assertEqual(kernels[0][1], ['x q[0]'])
+        self.assertEqual(kernels[2][1], ['x q[1]'])
+        all_gates = [g for _, gates in kernels for g in gates]
+        self.assertNotIn('y q[2]', all_gates)
+        self.assertNotIn('z q[2]', all_gates)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -27,5 +27,18 @@ class Test_platform(unittest.TestCase):
         platf = ql.Platform(platf_name, config_fn)
         self.assertEqual(platf.config_file, config_fn)
 
+    def test_config_file_rewritten(self):
+        # a configuration file that is rewritten right after it was loaded,
+        # within the resolution of file modification times, must be loaded again
+        with open(os.path.join(curdir, 'test_cfg_none_simple.json')) as f:
+            config = f.read()
+        self.assertIn('"qubit_number": 17', config)
+        config_fn = os.path.join(output_dir, 'test_config_file_rewritten.json')
+        for qubit_number in [17, 7, 17]:
+            with open(config_fn, 'w') as f:
+                f.write(config.replace('"qubit_number": 17', '"qubit_number": ' + str(qubit_number)))
+            platf = ql.Platform('platform_none', config_fn)
+            self.assertEqual(platf.get_qubit_number(), qubit_number)
+
 if __name__ == '__main__':
     unittest.main()
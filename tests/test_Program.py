@@ -157,6 +157,33 @@ class Test_program(unittest.TestCase):
 
         p.compile()
 
+    # The interaction matrix counts all gates with two or more qubit operands,
+    # not just cnots; gates with more operands count for every pair of them.
+    # Waits and barriers are not interactions.
+    def test_interaction_matrix(self):
+        nqubits = 4
+        k = ql.Kernel("imat_kernel", platf, nqubits)
+        k.gate('cnot', [0, 1])
+        k.gate('cz', [2, 3])
+        k.gate('cz', [3, 2])
+        k.gate('cz', [0, 2])
+        k.gate('ry90', [1])
+        k.gate('toffoli', [0, 1, 3])
+        k.wait([1, 2], 0)
+        k.barrier([])
+
+        p = ql.Program("imat_program", platf, nqubits)
+        p.add_kernel(k)
+        p.write_interaction_matrix()
+
+        with open(os.path.join(output_dir, 'imat_kernelInteractionMatrix.dat')) as f:
+            rows = [line.split() for line in f.read().splitlines() if line.strip()]
+        self.assertEqual(rows[0], ['q0', 'q1', 'q2', 'q3'])
+        self.assertEqual(rows[1], ['q0', '0', '2', '1', '1'])
+        self.assertEqual(rows[2], ['q1', '2', '0', '0', '1'])
+        self.assertEqual(rows[3], ['q2', '1', '0', '0', '2'])
+        self.assertEqual(rows[4], ['q3', '1', '1', '2', '0'])
+
 
 if __name__ == '__main__':
     unittest.main()
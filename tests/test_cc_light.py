@@ -717,5 +717,96 @@ class Test_advance(unittest.TestCase):
 
         self.assertTrue(file_compare(QISA_fn, GOLD_fn))
 
+    def test_ccl_post_schedule(self):
+        # the fused CCLPostSchedule pass must give the same QISA as the separate
+        # LatencyCompensation, InsertBufferDelays and CCLDecomposePostSchedule passes
+        ql.set_option('output_dir', output_dir)
+        for config, cz_mode in [('test_cfg_cc_light_buffers_latencies.json', 'manual'), ('hardware_config_cc_light.json', 'auto')]:
+            ql.set_option('cz_mode', cz_mode)
+            config_fn = os.path.join(curdir, config)
+            platform  = ql.Platform('seven_qubits_chip', config_fn)
+            num_qubits = platform.get_qubit_number()
+
+            qisa = []
+            for post_schedule in [['CCLPostSchedule'], ['LatencyCompensation', 'InsertBufferDelays', 'CCLDecomposePostSchedule']]:
+                p = ql.Program('test_ccl_post_schedule_' + cz_mode + '_' + str(len(post_schedule)), platform, num_qubits)
+                k = ql.Kernel('aKernel', platform, num_qubits)
+                k.gate('prepz', [0])
+                k.gate('prepz', [2])
+                k.gate('x', [0])
+                k.gate('y', [4])
+                k.gate('y', [5])
+                k.gate('cz', [2, 0])
+                k.gate('x', [0])
+                k.gate('measure', [2])
+                k.gate('cz', [0, 2])
+                k.gate('measure', [0])
+                k.gate('x', [2])
+                p.add_kernel(k)
+
+                c = ql.Compiler('testCompiler')
+                c.add_pass('Scheduler')
+                c.add_pass('CCLPrepCodeGeneration')
+                c.add_pass('CCLDecomposePreSchedule')
+                c.add_pass('Map')
+                c.add_pass('RCSchedule')
+                for name in post_schedule:
+                    c.add_pass(name)
+                c.add_pass('QisaCodeGeneration')
+                c.set_pass_option('ALL', 'skip', 'no')
+                c.set_pass_option('ALL', 'write_report_files', 'no')
+                c.compile(p)
+
+                with open(os.path.join(output_dir, p.name + '.qisa')) as f:
+                    qisa.append(f.read())
+
+            self.assertEqual(qisa[0], qisa[1])
+        ql.set_option('cz_mode', 'manual')
+
+    def test_loop_compression(self):
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('ccl_loop_compression', 'yes')
+        ql.set_option('write_report_files', 'yes')
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+
+        p = ql.Program('test_loop_compression', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+
+        k.gate('prepz', [0])
+        for _ in range(16):
+            k.gate('x', [0])
+            k.gate('y', [0])
+        k.gate('measure', [0])
+
+        p.add_kernel(k)
+        p.compile()
+
+        ql.set_option('ccl_loop_compression', 'no')
+        ql.set_option('write_report_files', 'no')
+
+        GOLD_fn = os.path.join(curdir, 'golden', p.name + '.qisa')
+        QISA_fn = os.path.join(output_dir, p.name+'.qisa')
+        self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+
+        # the x/y pair is emitted once, as the body of a loop of 16 iterations;
+        # the 2-cycle intervals around it are split into a qwait and a pre-interval
+        with open(QISA_fn) as f:
+            qisa = [l.strip() for l in f.readlines()]
+        start = qisa.index('aKernelloop0:')
+        end = qisa.index('br lt, aKernelloop0')
+        self.assertEqual(qisa[start-3:start], ['ldi r29, 16', 'ldi r30, 1', 'ldi r31, 0'])
+        self.assertEqual(qisa[start+1:start+4], ['1    x s0', '2    y s0', 'qwait 1'])
+        self.assertEqual(qisa.count('1    x s0') + qisa.count('2    x s0'), 1)
+        self.assertEqual(qisa.count('2    y s0'), 1)
+        self.assertEqual(qisa[end+1:end+3], ['1    measz s0', 'qwait 2'])
+
+        with open(os.path.join(output_dir, p.name + '_cc_light_compiler_out.report')) as f:
+            report = f.read()
+        self.assertIn('# Loops introduced by QISA compression: 1\n', report)
+        self.assertIn('# Bundles emitted: 4 of 34\n', report)
+        self.assertIn('# QISA compression ratio: 8.5\n', report)
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,65 @@
+import os
+import json
+import unittest
+from openql import openql as ql
+
+curdir = os.path.dirname(os.path.realpath(__file__))
+config_fn = os.path.join(curdir, 'test_mapper_s7.json')
+output_dir = os.path.join(curdir, 'test_output')
+
+
+class Test_compile_many(unittest.TestCase):
+
+    @classmethod
+    def setUp(self):
+        ql.initialize()
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('log_level', 'LOG_WARNING')
+        ql.set_option('maptiebreak', 'first')
+        ql.set_option('mapper', 'minextend')
+        ql.set_option('scheduler', 'ALAP')
+
+    def program(self, name, seed):
+        platform = ql.Platform('starmon', config_fn)
+        num_qubits = 7
+        p = ql.Program(name, platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        for i in range(10):
+            a = (seed + 3 * i) % num_qubits
+            b = (a + 1 + seed + i) % num_qubits
+            if a == b:
+                b = (b + 1) % num_qubits
+            k.gate('x', [a])
+            k.gate('cnot', [a, b])
+        k.gate('measure', [0])
+        p.add_kernel(k)
+        return p
+
+    def read_qisa(self, name):
+        with open(os.path.join(output_dir, name + '.qisa')) as f:
+            return f.read()
+
+    def test_compile_many(self):
+        # the reference: each program compiled on its own
+        expected = []
+        for i in range(4):
+            self.program('test_compile_many_' + str(i), i).compile()
+            expected.append(self.read_qisa('test_compile_many_' + str(i)))
+
+        for num_threads in [1, 2]:
+            programs = [self.program('test_compile_many_' + str(i), i) for i in range(4)]
+            profiles = ql.compile_many(programs, num_threads)
+            self.assertEqual(len(profiles), 4)
+            for i in range(4):
+                self.assertEqual(json.loads(profiles[i])['program'], 'test_compile_many_' + str(i))
+                self.assertEqual(self.read_qisa('test_compile_many_' + str(i)), expected[i])
+
+    def test_compile_many_no_kernels(self):
+        platform = ql.Platform('starmon', config_fn)
+        programs = [self.program('test_compile_many_ok', 0), ql.Program('test_compile_many_empty', platform, 7)]
+        with self.assertRaises(Exception):
+            ql.compile_many(programs, 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
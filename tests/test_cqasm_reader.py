@@ -1,7 +1,7 @@
 from openql import openql as ql
 import unittest
 import os
-from utils import file_compare
+from utils import file_compare, read_trace
 
 
 curdir = os.path.dirname(__file__)
@@ -180,6 +180,42 @@ class TestcQasmReader(unittest.TestCase):
         program.compile()
         self.assertTrue(file_compare(os.path.join(output_dir, name + '.qasm'), os.path.join(curdir, 'golden', name + '.qasm')))
 
+    def test_fast_path(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform = ql.Platform('seven_qubits_chip', config_fn)
+        number_qubits = platform.get_qubit_number()
+        qasm_str = "version 1.0\n"  \
+                   "qubits 6\n"     \
+                   "# comment\n"    \
+                   ".init\n"        \
+                   "  { prep_z q[0] | prep_z q[1:2] }\n"   \
+                   "  skip 2\n"     \
+                   ".body\n"        \
+                   "  x q[0:2]\n"   \
+                   "  cnot q[0], q[3]   # comment\n" \
+                   "  {h q[4]|y q[5]}\n"   \
+                   "  measure_all\n"
+        fast_path_events = {}
+        for fast_path in ['yes', 'no']:
+            ql.set_option('cqasm_fast_path', fast_path)
+            ql.set_option('trace_buffer_size', '1000')
+            name = 'test_cqasm_fast_path_' + fast_path
+            program = ql.Program(name, platform, number_qubits)
+            qasm_rdr = ql.cQasmReader(platform, program)
+            qasm_rdr.string2circuit(qasm_str)
+            program.compile()
+
+            # the fast-path reader leaves a trace event when it converted the input
+            _, _, _, _, events, names = read_trace(os.path.join(output_dir, name + '_trace.bin'))
+            fast_path_events[fast_path] = [e for e in events if names[e[2]] == 'cqasm_reader.fast_path']
+        ql.set_option('trace_buffer_size', '0')
+
+        self.assertEqual(len(fast_path_events['yes']), 1)
+        self.assertEqual(len(fast_path_events['no']), 0)
+        self.assertTrue(file_compare(
+            os.path.join(output_dir, 'test_cqasm_fast_path_yes.qasm'),
+            os.path.join(output_dir, 'test_cqasm_fast_path_no.qasm')))
+
 
 if __name__ == '__main__':
     unittest.main()
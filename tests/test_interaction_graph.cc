@@ -0,0 +1,123 @@
+#include <iostream>
+
+#include "gate.h"
+#include "interaction_graph.h"
+
+using namespace ql;
+using namespace ql::utils;
+
+// a scheduled circuit on 4 qubits with cnots, czs and swaps, a single-qubit
+// gate and a barrier over all qubits
+static circuit make_circuit() {
+    circuit c;
+    auto add = [&c](gate *g, UInt cycle) {
+        g->cycle = cycle;
+        c.push_back(g);
+    };
+    add(new cnot(0, 1), 0);
+    add(new cphase(2, 3), 0);
+    add(new swap(1, 2), 1);
+    add(new cnot(0, 1), 2);
+    add(new pauli_x(3), 2);
+    add(new cphase(0, 1), 3);
+    add(new wait({0, 1, 2, 3}, 0, 0), 3);
+    add(new swap(2, 3), 4);
+    return c;
+}
+
+static void test_weights(const circuit &c) {
+    InteractionGraphOptions options;
+    options.weights.set("cnot") = 2.0;
+    options.weights.set("cz") = 1.0;
+    options.weights.set("swap") = 3.0;
+    InteractionGraph graph(c, 4, options);
+
+    QL_ASSERT(graph.get_gate_count() == 6);
+    QL_ASSERT(graph.get_edge_count() == 3);
+    QL_ASSERT(graph.get_count(0, 1) == 3);
+    QL_ASSERT(graph.get_weight(0, 1) == 2.0 + 2.0 + 1.0);
+    QL_ASSERT(graph.get_weight(1, 0) == graph.get_weight(0, 1));
+    QL_ASSERT(graph.get_count(1, 2) == 1);
+    QL_ASSERT(graph.get_weight(1, 2) == 3.0);
+    QL_ASSERT(graph.get_count(2, 3) == 2);
+    QL_ASSERT(graph.get_weight(2, 3) == 1.0 + 3.0);
+
+    // the barrier is not an interaction by default
+    QL_ASSERT(graph.get_count(0, 2) == 0);
+    QL_ASSERT(graph.get_use_count(0) == 4);
+
+    // without weights, every gate weighs 1
+    InteractionGraph unweighted(c, 4);
+    QL_ASSERT(unweighted.get_weight(0, 1) == 3.0);
+    QL_ASSERT(unweighted.get_weight(2, 3) == 2.0);
+
+    // the barrier adds an edge for every pair of qubits when asked for
+    InteractionGraphOptions with_waits;
+    with_waits.include_waits = true;
+    InteractionGraph waits(c, 4, with_waits);
+    QL_ASSERT(waits.get_gate_count() == 7);
+    QL_ASSERT(waits.get_count(0, 2) == 1);
+    QL_ASSERT(waits.get_count(0, 1) == 4);
+}
+
+static void test_slices(const circuit &c) {
+    InteractionGraphOptions options;
+    options.weights.set("swap") = 3.0;
+    InteractionGraph full(c, 4, options);
+    Vec<InteractionGraph> slices = InteractionGraph::slices(c, 4, 2, options);
+
+    // cycles 0-1, 2-3 and 4
+    QL_ASSERT(slices.size() == 3);
+    QL_ASSERT(slices[0].get_gate_count() == 3);
+    QL_ASSERT(slices[1].get_gate_count() == 2);
+    QL_ASSERT(slices[2].get_gate_count() == 1);
+    QL_ASSERT(slices[1].get_count(0, 1) == 2);
+    QL_ASSERT(slices[2].get_weight(2, 3) == 3.0);
+
+    // the slices add up to the graph of the whole circuit
+    UInt gate_count = 0;
+    for (const auto &slice : slices) {
+        gate_count += slice.get_gate_count();
+    }
+    QL_ASSERT(gate_count == full.get_gate_count());
+    for (UInt q = 0; q < 4; q++) {
+        UInt use_count = 0;
+        for (const auto &slice : slices) {
+            use_count += slice.get_use_count(q);
+        }
+        QL_ASSERT(use_count == full.get_use_count(q));
+        for (UInt r = 0; r < 4; r++) {
+            UInt count = 0;
+            Real weight = 0;
+            for (const auto &slice : slices) {
+                count += slice.get_count(q, r);
+                weight += slice.get_weight(q, r);
+            }
+            QL_ASSERT(count == full.get_count(q, r));
+            QL_ASSERT(weight == full.get_weight(q, r));
+        }
+    }
+    InteractionGraph combined(4);
+    for (const auto &slice : slices) {
+        combined.add(slice);
+    }
+    QL_ASSERT(combined.get_matrix_string() == full.get_matrix_string());
+
+    // slices start at first_cycle
+    options.first_cycle = 2;
+    slices = InteractionGraph::slices(c, 4, 2, options);
+    QL_ASSERT(slices.size() == 2);
+    QL_ASSERT(slices[0].get_count(0, 1) == 2);
+    QL_ASSERT(slices[1].get_count(2, 3) == 1);
+}
+
+int main(int argc, char **argv) {
+    circuit c = make_circuit();
+    test_weights(c);
+    test_slices(c);
+    for (auto gp : c) {
+        delete gp;
+    }
+    std::cout << "interaction graph tests passed" << std::endl;
+    return 0;
+}
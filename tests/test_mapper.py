@@ -274,6 +274,42 @@ class Test_mapper(unittest.TestCase):
         self.assertTrue(file_compare(QISA_fn, GOLD_fn))
 
 
+    def test_mapper_maxfidelity(self):
+        # same as allD but with the maxfidelity heuristic,
+        # which scores alternatives by their estimated fidelity instead of by their latency extension
+        # parameters
+        v = 'maxfidelity'
+        config = os.path.join(curdir, "test_mapper_s7.json")
+        num_qubits = 7
+
+        # create and set platform
+        prog_name = "test_mapper_" + v
+        kernel_name = "kernel_" + v
+        starmon = ql.Platform("starmon", config)
+        prog = ql.Program(prog_name, starmon, num_qubits, 0)
+        k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+        for j in range(7):
+            k.gate("x", [j])
+
+        for i in range(7):
+            for j in range(7):
+                if (i != j):
+                    k.gate("cnot", [i,j])
+
+        for j in range(7):
+            k.gate("x", [j])
+
+        prog.add_kernel(k)
+        ql.set_option('mapper', 'maxfidelity')
+        prog.compile()
+
+        GOLD_fn = os.path.join(curdir, 'golden', prog.name + '.qisa')
+        QISA_fn = os.path.join(output_dir, prog.name+'.qisa')
+
+        self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+
+
     def test_mapper_allDopt(self):
         # all possible cnots in s7, avoiding collisions:
         # - the pair of possible CNOTs in both directions hopefully in parallel
@@ -680,6 +716,38 @@ class Test_mapper(unittest.TestCase):
         self.assertTrue(file_compare(QISA_fn, GOLD_fn))
 
 
+    def test_mapper_kernel_dedup(self):
+        # kernels with identical bodies are mapped once when kernel_dedup is on;
+        # check that this doesn't change the result
+        # parameters
+        v = 'kernel_dedup'
+        config = os.path.join(curdir, "test_mapper_s7.json")
+        num_qubits = 7
+
+        ql.set_option('write_report_files', 'yes')
+
+        def compile(dedup):
+            ql.set_option('kernel_dedup', dedup)
+            prog_name = "test_mapper_" + v + "_" + dedup
+            starmon = ql.Platform("starmon", config)
+            prog = ql.Program(prog_name, starmon, num_qubits, 0)
+            for r in range(3):
+                # the same round, added under different names
+                k = ql.Kernel("round" + str(r), starmon, num_qubits, 0)
+                k.gate("x", [0])
+                k.gate("cz", [0,6])
+                k.gate("cz", [1,5])
+                k.gate("measure", [6])
+                prog.add_for(k, 10)
+            prog.compile()
+            return os.path.join(output_dir, prog.name + '.qisa')
+
+        self.assertTrue(file_compare(compile('no'), compile('yes')))
+
+        with open(os.path.join(output_dir, 'test_mapper_' + v + '_yes_mapper_out.report')) as f:
+            report = f.read()
+        self.assertRegex(report, r'Total no. of kernels deduplicated: 2 of 3')
+
 
 if __name__ == '__main__':
     # ql.set_option('log_level', 'LOG_DEBUG')
@@ -1,6 +1,8 @@
 from openql import openql as ql
 import unittest
 import os
+import re
+import json
 
 curdir = os.path.dirname(os.path.realpath(__file__))
 output_dir = os.path.join(curdir, 'test_output')
@@ -79,5 +81,96 @@ class Test_modularity(unittest.TestCase):
 
       c.compile(p)
 
+  def test_report_statistics_reuse(self):
+      # the "in" report of a pass reuses the statistics collected for the "out"
+      # report of the pass before it; check that they are the same as a full
+      # recomputation after a pass that modified the circuit
+      config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
+      ql.set_option('write_report_files', 'yes')
+      ql.set_option('clifford_prescheduler', 'yes')
+
+      c = ql.Compiler("testCompiler")
+      c.add_pass_alias("CliffordOptimize", "clifford_prescheduler")
+      c.add_pass("ReportStatistics")
+      c.set_pass_option("ALL", "skip", "no")
+      c.set_pass_option("ALL", "write_qasm_files", "no")
+      c.set_pass_option("ALL", "write_report_files", "yes")
+
+      nqubits = 2
+      platform = ql.Platform('platform_none', config_fn)
+      p = ql.Program("report_reuse", platform, nqubits, 0)
+      k = ql.Kernel("aKernel", platform, nqubits, 0)
+      k.gate('z', [0])
+      k.gate('z', [0])        # cancels the first z
+      k.gate('cz', [0, 1])
+      k.gate('measure', [0])
+      k.gate('measure', [1])
+      p.add_kernel(k)
+      c.compile(p)
+      ql.set_option('clifford_prescheduler', 'no')
+
+      def read_report(pass_name, in_or_out):
+          fn = os.path.join(output_dir, 'report_reuse_' + pass_name + '_' + in_or_out + '.report')
+          with open(fn) as f:
+              return f.read()
+
+      def quantum_gates(report):
+          return int(re.search(r'Total no. of quantum gates: (\d+)', report).group(1))
+
+      # the clifford optimizer removed the z gates
+      clifford_in = read_report('clifford_prescheduler', 'in')
+      clifford_out = read_report('clifford_prescheduler', 'out')
+      self.assertEqual(quantum_gates(clifford_in), 5)
+      self.assertEqual(quantum_gates(clifford_out), 3)
+
+      # cached, and recomputed by the ReportStatistics pass itself
+      cached = read_report('ReportStatistics', 'in')
+      recomputed = read_report('ReportStatistics', 'todo-inout')
+      self.assertEqual(cached, recomputed)
+      self.assertTrue(clifford_out.startswith(cached))
+
+  def compile_profiled(self, name):
+      config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
+      platform = ql.Platform('platform_none', config_fn)
+      nqubits = 2
+      p = ql.Program(name, platform, nqubits)
+      k = ql.Kernel('aKernel', platform, nqubits)
+      k.gate('x', [0])
+      k.gate('h', [1])
+      k.gate('cz', [0, 1])
+      k.gate('measure', [0])
+      p.add_kernel(k)
+
+      c = ql.Compiler('testCompiler')
+      c.add_pass('RotationOptimizer')
+      c.add_pass('Scheduler')
+      c.add_pass_alias('Writer', 'outputIR')
+      c.set_pass_option('ALL', 'skip', 'no')
+      c.set_pass_option('outputIR', 'skip', 'yes')
+      c.set_pass_option('ALL', 'write_report_files', 'no')
+      c.compile(p)
+      return c
+
+  def test_pass_profile(self):
+      c = self.compile_profiled('test_pass_profile')
+      profile = json.loads(c.get_pass_profile())
+      self.assertEqual(profile['compiler'], 'testCompiler')
+      self.assertEqual(profile['program'], 'test_pass_profile')
+      self.assertEqual([p['name'] for p in profile['passes']], ['RotationOptimizer', 'Scheduler', 'outputIR'])
+      self.assertEqual([p['skipped'] for p in profile['passes']], [False, False, True])
+      for p in profile['passes']:
+          self.assertGreaterEqual(p['wall_time'], 0)
+          self.assertGreaterEqual(p['cpu_time'], 0)
+          self.assertEqual(p['gates_in'], 4)
+          self.assertEqual(p['gates_out'], 4)
+          self.assertEqual(p['kernels'], [{'name': 'aKernel', 'gates_in': 4, 'gates_out': 4}])
+      self.assertIn('wall_time', profile['total'])
+
+  def test_pass_profile_file(self):
+      ql.set_option('write_pass_profile', 'yes')
+      c = self.compile_profiled('test_pass_profile_file')
+      with open(os.path.join(output_dir, 'test_pass_profile_file_pass_profile.json')) as f:
+          self.assertEqual(json.load(f), json.loads(c.get_pass_profile()))
+
 if __name__ == '__main__':
     unittest.main()
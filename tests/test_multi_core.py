@@ -5,6 +5,7 @@
 
 from openql import openql as ql
 import os
+import re
 import unittest
 from utils import file_compare
 
@@ -80,6 +81,39 @@ class Test_multi_core(unittest.TestCase):
         qasm_fn = os.path.join(output_dir, prog.name+'_last.qasm')
         self.assertTrue( file_compare(qasm_fn, gold_fn) )
 
+    def test_mc_partition(self):
+        ql.set_option('mapmulticore', 'partition')
+        config = os.path.join(curdir, "test_multi_core_4x4_full.json")
+        num_qubits = 16
+
+        prog_name = "test_mc_partition"
+        starmon = ql.Platform("mc4x4full", config)
+        prog = ql.Program(prog_name, starmon, num_qubits, 0)
+        k = ql.Kernel("kernel_partition", starmon, num_qubits, 0)
+
+        for i in range(4):
+            k.gate("x", [4*i])
+            k.gate("x", [4*i+1])
+        for i in range(4):
+            k.gate("cnot", [4*i,4*i+1])
+        for i in range(4):
+            for j in range(4):
+                if i != j:
+                    k.gate("cnot", [4*i,4*j])
+
+        prog.add_kernel(k)
+        prog.compile()
+        ql.set_option('mapmulticore', 'flat')
+
+        # after partitioning, all cnots are within a core and the qubits move between cores by tswap/tmove
+        with open(os.path.join(output_dir, prog.name+'_last.qasm')) as f:
+            qasm = f.read()
+        cnots = re.findall(r'cnot q\[(\d+)\],q\[(\d+)\]', qasm)
+        self.assertEqual(len(cnots), 16)
+        for a, b in cnots:
+            self.assertEqual(int(a)//4, int(b)//4)
+        self.assertTrue(re.search(r'\bt(swap|move)\b', qasm))
+
 if __name__ == '__main__':
     # ql.set_option('log_level', 'LOG_DEBUG')
     unittest.main()
@@ -0,0 +1,134 @@
+import os
+import re
+import random
+import unittest
+from openql import openql as ql
+
+try:
+    from qxelarator import qxelarator
+    qx = qxelarator.QX()
+except ImportError:
+    qx = None
+
+curdir = os.path.dirname(os.path.realpath(__file__))
+config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
+output_dir = os.path.join(curdir, 'test_output')
+
+
+class Test_optimizer(unittest.TestCase):
+
+    @classmethod
+    def setUp(self):
+        ql.initialize()
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('scheduler', 'ASAP')
+        ql.set_option('log_level', 'LOG_WARNING')
+
+    def compile(self, name, gates, num_qubits=2):
+        # compiles a single kernel built from (name, qubits, angle) tuples and
+        # returns the scheduled qasm
+        platform = ql.Platform('platform_none', config_fn)
+        p = ql.Program(name, platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        for gate, qubits, angle in gates:
+            k.gate(gate, qubits, 0, angle)
+        p.add_kernel(k)
+        p.compile()
+
+        with open(os.path.join(output_dir, name + '_scheduled.qasm')) as f:
+            return f.read()
+
+    rotation_gates = [
+        ('x', [0], 0.0),
+        ('x', [0], 0.0),            # cancels against the previous x
+        ('h', [1], 0.0),
+        ('rz', [0], 0.5),
+        ('cz', [0, 1], 0.0),
+        ('rz', [0], -0.5),          # cancels through the cz only with optimize_commute
+        ('s', [1], 0.0),
+        ('sdag', [1], 0.0),         # cancels against the previous s
+        ('measure', [0], 0.0),
+        ('measure', [1], 0.0),
+    ]
+
+    def count_rotation_gates(self, name):
+        qasm = self.compile(name, self.rotation_gates)
+        return {g: len(re.findall(r'\b' + g + r'\b', qasm)) for g in ['x', 'h', 'rz', 'cz', 's', 'sdag', 'measure']}
+
+    def test_optimizer_cancel(self):
+        ql.set_option('optimize', 'yes')
+        ql.set_option('optimize_commute', 'no')
+        counts = self.count_rotation_gates('test_optimizer_cancel')
+        self.assertEqual(counts, {'x': 0, 'h': 1, 'rz': 2, 'cz': 1, 's': 0, 'sdag': 0, 'measure': 2})
+
+    def test_optimizer_commute(self):
+        ql.set_option('optimize', 'yes')
+        ql.set_option('optimize_commute', 'yes')
+        counts = self.count_rotation_gates('test_optimizer_commute')
+        self.assertEqual(counts, {'x': 0, 'h': 1, 'rz': 0, 'cz': 1, 's': 0, 'sdag': 0, 'measure': 2})
+
+    def simulate(self, name):
+        # returns the state vector of the scheduled qasm as {bits: amplitude}
+        qx.set(os.path.join(output_dir, name + '_scheduled.qasm'))
+        qx.execute()
+        state = {}
+        for re_, im, bits in re.findall(r'\(([-+0-9.e]+),\s*([-+0-9.e]+)\)\s*\|?\s*([01]+)', qx.get_state()):
+            state[bits] = complex(float(re_), float(im))
+        return state
+
+    @unittest.skipIf(qx is None, "qxelarator not installed")
+    def test_optimizer_equivalence(self):
+        # the optimized circuits must have the same state vector as the
+        # original ones, up to global phase
+        num_qubits = 3
+        single = ['x', 'y', 'z', 'h', 's', 'sdag', 't', 'tdag', 'rz']
+        rng = random.Random(42)
+        for i in range(20):
+            gates = []
+            for j in range(40):
+                if rng.random() < 0.2:
+                    gates.append((rng.choice(['cnot', 'cz']), rng.sample(range(num_qubits), 2), 0.0))
+                else:
+                    gates.append((rng.choice(single), [rng.randrange(num_qubits)], rng.choice([0.5, -0.5])))
+
+            states = []
+            for optimize, commute in [('no', 'no'), ('yes', 'no'), ('yes', 'yes')]:
+                ql.set_option('optimize', optimize)
+                ql.set_option('optimize_commute', commute)
+                name = 'test_optimizer_equivalence_%d_%s_%s' % (i, optimize, commute)
+                self.compile(name, gates, num_qubits)
+                states.append(self.simulate(name))
+
+            for state in states[1:]:
+                overlap = sum(states[0].get(bits, 0).conjugate() * a for bits, a in state.items())
+                self.assertAlmostEqual(abs(overlap), 1.0, 5)
+
+    clifford_gates = [
+        ('z', [0], 0.0),
+        ('s', [1], 0.0),
+        ('cz', [0, 1], 0.0),
+        ('z', [0], 0.0),            # cancels the first z, when moved through the cz
+        ('sdag', [1], 0.0),         # cancels the s, when moved through the cz
+        ('measure', [0], 0.0),
+        ('measure', [1], 0.0),
+    ]
+
+    def count_clifford_gates(self, name):
+        qasm = self.compile(name, self.clifford_gates)
+        return len(re.findall(r'\b(?:m?x90|m?y90|x180|y180)\b', qasm))
+
+    def test_clifford_sequences(self):
+        # each z is two gates and each s or sdag three
+        ql.set_option('clifford_prescheduler', 'yes')
+        ql.set_option('clifford_twoqubit_frames', 'no')
+        self.assertEqual(self.count_clifford_gates('test_clifford_sequences'), 10)
+
+    def test_clifford_twoqubit_frames(self):
+        ql.set_option('clifford_prescheduler', 'yes')
+        ql.set_option('clifford_twoqubit_frames', 'yes')
+        self.assertEqual(self.count_clifford_gates('test_clifford_twoqubit_frames'), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,136 @@
+import os
+import unittest
+from openql import openql as ql
+from utils import file_compare
+
+curdir = os.path.dirname(os.path.realpath(__file__))
+config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+mapper_config_fn = os.path.join(curdir, 'test_mapper_s7.json')
+output_dir = os.path.join(curdir, 'test_output')
+
+
+class Test_snapshot(unittest.TestCase):
+
+    @classmethod
+    def setUp(self):
+        ql.initialize()
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('scheduler', 'ALAP')
+        ql.set_option('log_level', 'LOG_WARNING')
+
+    def build_program(self, name, platform):
+        nqubits = platform.get_qubit_number()
+        p = ql.Program(name, platform, nqubits, 2)
+        p.set_sweep_points([1.0, 2.0])
+
+        k1 = ql.Kernel('init', platform, nqubits, 2)
+        k1.gate('prepz', [0])
+        k1.gate('prepz', [2])
+        p.add_kernel(k1)
+
+        k2 = ql.Kernel('body', platform, nqubits, 2)
+        k2.gate('x', [0])
+        k2.gate('cz', [0, 2])
+        k2.gate('measure', [2])
+        p.add_for(k2, 10)
+        return p
+
+    def test_snapshot_roundtrip(self):
+        platform = ql.Platform('seven_qubits_chip', config_fn)
+        snapshot_fn = os.path.join(output_dir, 'test_snapshot.oqls')
+
+        p1 = self.build_program('test_snapshot_direct', platform)
+        p1.save_snapshot(snapshot_fn)
+        p1.compile()
+
+        p2 = ql.Program('test_snapshot_loaded', platform, 1)
+        p2.load_snapshot(snapshot_fn)
+        self.assertEqual(p2.qubit_count, platform.get_qubit_number())
+        self.assertEqual(p2.creg_count, 2)
+        self.assertEqual(p2.get_sweep_points(), (1.0, 2.0))
+        p2.compile()
+
+        self.assertTrue(file_compare(
+            os.path.join(output_dir, 'test_snapshot_direct.qisa'),
+            os.path.join(output_dir, 'test_snapshot_loaded.qisa')))
+
+    def build_hybrid_program(self, name, platform):
+        # classical operations, a conditional gate, an if-else on a creg
+        # comparison, and two-qubit gates between qubits that aren't neighbours
+        nqubits = 7
+        ncregs = 4
+        nbregs = 7
+        p = ql.Program(name, platform, nqubits, ncregs, nbregs)
+        rd = ql.CReg(1)
+        rs1 = ql.CReg(2)
+        rs2 = ql.CReg(3)
+
+        k1 = ql.Kernel('init', platform, nqubits, ncregs, nbregs)
+        k1.gate('prepz', [0])
+        k1.gate('prepz', [6])
+        k1.classical(rs1, ql.Operation(2))
+        k1.classical(rs2, ql.Operation(rs1))
+        k1.classical(rd, ql.Operation(rs1, '+', rs2))
+        k1.gate('x', [0])
+        k1.gate('cnot', [0, 6])
+        k1.gate('measure', [0])
+        k1.condgate('x', [6], 'COND_UNARY', [0])
+        p.add_kernel(k1)
+
+        k2 = ql.Kernel('then', platform, nqubits, ncregs, nbregs)
+        k2.gate('cz', [1, 5])
+        k3 = ql.Kernel('else', platform, nqubits, ncregs, nbregs)
+        k3.gate('y', [4])
+        p.add_if_else(k2, k3, ql.Operation(rd, '==', rs1))
+        return p
+
+    def compile_passes(self, p, passes):
+        c = ql.Compiler('testCompiler')
+        for name in passes:
+            c.add_pass(name)
+        c.set_pass_option('ALL', 'skip', 'no')
+        c.set_pass_option('ALL', 'write_report_files', 'no')
+        c.compile(p)
+
+    def test_snapshot_mapped(self):
+        # a snapshot of the mapped program must continue to the same qisa as
+        # compiling it in one go
+        ql.set_option('mapper', 'minextend')
+        ql.set_option('mapinitone2one', 'yes')
+        ql.set_option('mapusemoves', 'yes')
+        ql.set_option('maptiebreak', 'first')
+        platform = ql.Platform('starmon', mapper_config_fn)
+        snapshot_fn = os.path.join(output_dir, 'test_snapshot_mapped.oqls')
+        front = ['Scheduler', 'CCLPrepCodeGeneration', 'CCLDecomposePreSchedule', 'Map']
+        back = ['RCSchedule', 'CCLPostSchedule', 'QisaCodeGeneration']
+
+        p1 = self.build_hybrid_program('test_snapshot_mapped_direct', platform)
+        self.compile_passes(p1, front + back)
+
+        p2 = self.build_hybrid_program('test_snapshot_mapped_front', platform)
+        self.compile_passes(p2, front)
+        p2.save_snapshot(snapshot_fn)
+
+        p3 = ql.Program('test_snapshot_mapped_loaded', platform, 1)
+        p3.load_snapshot(snapshot_fn)
+        self.assertEqual(p3.qubit_count, 7)
+        self.assertEqual(p3.creg_count, 4)
+        self.compile_passes(p3, back)
+
+        self.assertTrue(file_compare(
+            os.path.join(output_dir, 'test_snapshot_mapped_direct.qisa'),
+            os.path.join(output_dir, 'test_snapshot_mapped_loaded.qisa')))
+
+    def test_snapshot_bad_file(self):
+        platform = ql.Platform('seven_qubits_chip', config_fn)
+        bad_fn = os.path.join(output_dir, 'test_snapshot_bad.oqls')
+        with open(bad_fn, 'w') as f:
+            f.write('not a snapshot at all, but long enough to hold a header and section table' * 4)
+        p = ql.Program('test_snapshot_bad', platform, 1)
+        with self.assertRaises(Exception):
+            p.load_snapshot(bad_fn)
+
+
+if __name__ == '__main__':
+    unittest.main()
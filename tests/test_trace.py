@@ -0,0 +1,52 @@
+import os
+import unittest
+from openql import openql as ql
+from utils import read_trace
+
+curdir = os.path.dirname(os.path.realpath(__file__))
+config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+output_dir = os.path.join(curdir, 'test_output')
+
+
+class Test_trace(unittest.TestCase):
+
+    @classmethod
+    def setUp(self):
+        ql.initialize()
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('scheduler', 'ALAP')
+        ql.set_option('log_level', 'LOG_WARNING')
+
+    def tearDown(self):
+        ql.set_option('trace_buffer_size', '0')
+
+    def test_trace(self):
+        ql.set_option('trace_buffer_size', '8')
+        platform = ql.Platform('seven_qubits_chip', config_fn)
+        p = ql.Program('test_trace', platform, platform.get_qubit_number())
+        k = ql.Kernel('aKernel', platform, platform.get_qubit_number())
+        for _ in range(10):
+            k.gate('x', [0])
+            k.gate('cz', [0, 2])
+        k.gate('measure', [2])
+        p.add_kernel(k)
+        p.compile()
+
+        magic, version, byte_order, dropped_count, events, names = read_trace(
+            os.path.join(output_dir, 'test_trace_trace.bin'))
+        self.assertEqual(magic, b'OQLTRACE')
+        self.assertEqual(version, 1)
+        self.assertEqual(byte_order, 0x01020304)
+        self.assertEqual(len(events), 8)    # the ring buffer only keeps the last 8
+        self.assertGreater(dropped_count, 0)
+        self.assertIn('scheduler.set_cycle', names)
+        self.assertIn('bundler.gate', names)
+        times = [e[0] for e in events]
+        self.assertEqual(times, sorted(times))
+        for e in events:
+            self.assertLess(e[2], len(names))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -271,6 +271,102 @@ class Test_conjugated_kernel(unittest.TestCase):
         self.assertAlmostEqual(0.5, helper_regex(c0)[0], 5)
         self.assertAlmostEqual(0.5, helper_regex(c0)[1], 5)  
 
+    def test_unitary_decomposition_cache(self):
+        # decomposing the same matrix again must give the same circuit, whether it comes from the cache or not;
+        # the cache is cleared first, since other tests may have decomposed this matrix already
+        num_qubits = 2
+        matrix = [-0.15050486+0.32164259j, -0.29086861+0.76699622j,
+        0.17865218+0.18573699j, -0.31380116+0.19005417j,
+       -0.65629705+0.20915109j,  0.32782708+0.16363753j,
+       -0.54511727-0.21100055j,  0.0601221 -0.21446079j,
+       -0.38935965-0.47787084j,  0.30279699-0.10056307j,
+        0.04076564+0.54046282j, -0.23847619+0.40939808j,
+        0.13874319-0.01460122j, -0.27256915+0.12950497j,
+       -0.49774672+0.22449364j,  0.6159743 +0.46032394j]
+
+        ql.Unitary.clear_decomposition_cache()
+        for name, cache, hits, misses in [
+            ('test_unitary_cache_none', 'no', 0, 0),
+            ('test_unitary_cache_miss', 'yes', 0, 1),
+            ('test_unitary_cache_hit', 'yes', 1, 1)
+        ]:
+            ql.set_option('unitary_decomposition_cache', cache)
+            p = ql.Program(name, platform, num_qubits)
+            k = ql.Kernel('akernel', platform, num_qubits)
+            u = ql.Unitary('u', matrix)
+            u.decompose()
+            self.assertEqual(ql.Unitary.get_decomposition_cache_hits(), hits)
+            self.assertEqual(ql.Unitary.get_decomposition_cache_misses(), misses)
+            k.gate(u, [0, 1])
+            p.add_kernel(k)
+            p.compile()
+
+        ref_fn = os.path.join(output_dir, 'test_unitary_cache_none.qasm')
+        self.assertTrue(file_compare(ref_fn, os.path.join(output_dir, 'test_unitary_cache_miss.qasm')))
+        self.assertTrue(file_compare(ref_fn, os.path.join(output_dir, 'test_unitary_cache_hit.qasm')))
+
+    def test_unitary_decomposition_parallel(self):
+        # decomposing on several threads must give the same circuit as decomposing sequentially
+        num_qubits = 5
+        rng = np.random.RandomState(42)
+        z = rng.standard_normal((32, 32)) + 1j * rng.standard_normal((32, 32))
+        q, r = np.linalg.qr(z)
+        matrix = q.flatten().tolist()
+
+        ql.set_option('unitary_decomposition_cache', 'no')
+        for name, parallel in [('test_unitary_sequential', 'no'), ('test_unitary_parallel', '4')]:
+            ql.set_option('unitary_decomposition_parallel', parallel)
+            p = ql.Program(name, platform, num_qubits)
+            k = ql.Kernel('akernel', platform, num_qubits)
+            u = ql.Unitary('u', matrix)
+            u.decompose()
+            k.gate(u, list(range(num_qubits)))
+            p.add_kernel(k)
+            p.compile()
+
+        self.assertTrue(file_compare(
+            os.path.join(output_dir, 'test_unitary_sequential.qasm'),
+            os.path.join(output_dir, 'test_unitary_parallel.qasm')))
+
+    def test_unitary_optimized_emission(self):
+        # a diagonal unitary leaves many rotations of the decomposition at zero,
+        # which should be removed when unitary_decomposition_optimize is set
+        num_qubits = 3
+        phases = [0.1, 0.7, 1.3, 0.2, 2.9, 0.5, 1.1, 0.4]
+        matrix = np.diag(np.exp(1j * np.array(phases))).flatten().tolist()
+
+        counts = []
+        states = []
+        for name, optimize in [('test_unitary_unoptimized', 'no'), ('test_unitary_optimized', 'yes')]:
+            ql.set_option('unitary_decomposition_optimize', optimize)
+            p = ql.Program(name, platform, num_qubits)
+            k = ql.Kernel('akernel', platform, num_qubits)
+            u = ql.Unitary('u', matrix)
+            u.decompose()
+            # the hadamards turn the phases of the diagonal into probabilities
+            for q in range(num_qubits):
+                k.hadamard(q)
+            k.gate(u, list(range(num_qubits)))
+            for q in range(num_qubits):
+                k.hadamard(q)
+            p.add_kernel(k)
+            p.compile()
+            with open(os.path.join(output_dir, name + '.qasm')) as f:
+                counts.append(len(re.findall(r'\b(?:rz|ry|cnot)\b', f.read())))
+            if qx is not None:
+                qx.set(os.path.join(output_dir, name + '.qasm'))
+                qx.execute()
+                states.append(helper_regex(qx.get_state()))
+        ql.set_option('unitary_decomposition_optimize', 'no')
+
+        self.assertLess(counts[1], counts[0])
+
+        # the rotations left out must not change the resulting state
+        if qx is not None:
+            self.assertEqual(len(states[0]), len(states[1]))
+            for expected, actual in zip(states[0], states[1]):
+                self.assertAlmostEqual(expected, actual, 5)
+
     def test_unitary_decompose_nonunitary(self):
         num_qubits = 1
         p = ql.Program('test_unitary_nonunitary', platform, num_qubits)
@@ -1,4 +1,5 @@
 import difflib
+import struct
 
 
 def file_compare(fn1, fn2):
@@ -18,3 +19,26 @@ def file_compare(fn1, fn2):
             return False
         else:
             return True
+
+
+def read_trace(fn):
+    """
+    Read a trace file written with option trace_buffer_size set.
+
+    Returns the magic, version, byte order and dropped event count from the
+    header, the events as (time, gate ID, event ID, reserved) tuples, and the
+    event names indexed by event ID.
+    """
+    with open(fn, 'rb') as f:
+        data = f.read()
+    magic, version, byte_order, event_count, dropped_count, name_count = struct.unpack_from('=8sIIQQQ', data, 0)
+    offset = struct.calcsize('=8sIIQQQ')
+    events = [struct.unpack_from('=QQII', data, offset + 24 * i) for i in range(event_count)]
+    offset += 24 * event_count
+    names = []
+    for _ in range(name_count):
+        length, = struct.unpack_from('=I', data, offset)
+        offset += 4
+        names.append(data[offset:offset + length].decode())
+        offset += length
+    return magic, version, byte_order, dropped_count, events, names